@@ -31,6 +31,7 @@ namespace HCUBE
 
         NEAT::FastNetwork<float> substrate;
         map<Node,string> nameLookup; // Name lookup table
+        vector<int> activeInputs; // The input nodes painted this frame, each listed once
 
         // Sets the result path from the genration path
         void setResultsPath(string generationPath);
@@ -41,6 +42,9 @@ namespace HCUBE
         virtual void initializeALE(string rom_file, bool processScreen);
         // Creates the layers and layerinfo
         virtual void initializeTopology();
+        // Saves and restores the values read from the ROM, so the topology can be built without it
+        virtual bool exportTopology(TopologyDescriptor &descriptor);
+        virtual void importTopology(const TopologyDescriptor &descriptor);
 
         AtariCMAExperiment(string _experimentName,int _threadID);
         virtual ~AtariCMAExperiment() {};
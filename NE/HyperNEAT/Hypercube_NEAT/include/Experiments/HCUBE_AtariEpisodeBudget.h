@@ -0,0 +1,77 @@
+#ifndef HCUBE_ATARIEPISODEBUDGET_H_INCLUDED
+#define HCUBE_ATARIEPISODEBUDGET_H_INCLUDED
+
+#include "HCUBE_Defines.h"
+#include "ale_interface.hpp"
+
+/**
+   Limits how long an Atari episode may run.  Every limit is read from
+   the globals and is off when missing or 0:
+
+     EpisodeMaxFrames    frames per episode, on top of ALE's own limit
+     EpisodeMaxSeconds   wall clock seconds per episode
+     StallScoreFrames    frames without a change of the score
+     StallRamFrames      frames without a change of the RAM, i.e. a
+                         game that waits for a button that is never
+                         pressed
+     GenerationMaxSeconds  wall clock seconds after the generation file
+                         was written, see setGenerationDeadline
+
+   An episode that is stopped early keeps the score it had reached, the
+   same as an episode that ran out of ALE's max_num_frames.
+**/
+namespace HCUBE
+{
+    enum AtariEpisodeEnd
+    {
+        ATARI_EPISODE_GAME_OVER=0,
+        ATARI_EPISODE_FRAME_LIMIT,
+        ATARI_EPISODE_TIME_LIMIT,
+        ATARI_EPISODE_STALLED,
+        ATARI_EPISODE_GENERATION_LIMIT
+    };
+
+    class AtariEpisodeBudget
+    {
+    protected:
+        int maxFrames;
+        long long maxUsec;
+        int stallScoreFrames;
+        int stallRamFrames;
+
+        long long startUsec;
+        float lastScore;
+        int lastScoreFrame;
+        ulong lastRamHash;
+        int lastRamFrame;
+
+        AtariEpisodeEnd end;
+
+        // 0 when there is no generation deadline
+        static long long generationDeadlineUsec;
+
+    public:
+        AtariEpisodeBudget();
+
+        // Call after ale.reset_game()
+        void startEpisode(ALEInterface &ale);
+
+        // Returns true when the episode has to stop now.  Call once per frame.
+        bool isExhausted(ALEInterface &ale);
+
+        inline AtariEpisodeEnd getEnd() const
+        {
+            return end;
+        }
+
+        static const char *getEndName(AtariEpisodeEnd end);
+
+        // Sets the deadline to GenerationMaxSeconds after generationStartUsec, or clears it
+        static void setGenerationDeadline(long long generationStartUsec);
+
+    protected:
+        static ulong hashRam(const IntVect &ram);
+    };
+}
+
+#endif // HCUBE_ATARIEPISODEBUDGET_H_INCLUDED
@@ -2,6 +2,7 @@
 #define HCUBE_ATARIEXPERIMENT_H_INCLUDED
 
 #include "HCUBE_Experiment.h"
+#include "HCUBE_EvaluationTelemetry.h"
 #include "ale_interface.hpp"
 #include "common/visual_processor.h"
 
@@ -24,6 +25,18 @@ namespace HCUBE
 
         double epsilon; // Epsilon greedy action selection
 
+        EvaluationRecord lastEvaluation; // Score and stage times of the last episode
+
+        // The input nodes painted this frame, each listed once.  Only set by
+        // setSubstrateValues() of this class, which leaves all other inputs zero.
+        vector<Node> activeInputs;
+        bool sparseInputs;
+
+        // With DeltaRefreshFrames above 0 the network is not reinitialized between
+        // frames and only the input changes are propagated, with a full
+        // recomputation every that many frames
+        int deltaRefreshFrames;
+
     public: // TODO: Make this protected 
         NEAT::LayeredSubstrate<float> substrate;
 
@@ -37,6 +50,9 @@ namespace HCUBE
         virtual void initializeALE(string rom_file, bool processScreen);
         // Creates the layers and layerinfo
         virtual void initializeTopology();
+        // Saves and restores the values read from the ROM, so the topology can be built without it
+        virtual bool exportTopology(TopologyDescriptor &descriptor);
+        virtual void importTopology(const TopologyDescriptor &descriptor);
 
         // Creates the population of individuals
         virtual NEAT::GeneticPopulation* createInitialPopulation(int populationSize);
@@ -44,6 +60,8 @@ namespace HCUBE
         virtual void processGroup(shared_ptr<NEAT::GeneticGeneration> generation);
         // Runs the atari episode using the specified individual
         virtual float runAtariEpisode(NEAT::LayeredSubstrate<float>* substrate);
+        // Returns the score and stage times of the last episode
+        virtual bool getEvaluationRecord(EvaluationRecord &record);
         // Prints the activations at each layer of the substrate
         virtual void printLayerInfo(NEAT::LayeredSubstrate<float>* substrate);
 
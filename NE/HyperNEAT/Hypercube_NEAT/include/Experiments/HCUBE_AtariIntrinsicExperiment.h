@@ -7,24 +7,59 @@
 
 namespace HCUBE
 {
+    // A set of binary features, packed 64 to a word
+    class FeatureBits {
+    public:
+        FeatureBits(int numFeatures=0) { resize(numFeatures); }
+        void resize(int _numFeatures) {
+            numFeatures = _numFeatures;
+            words.assign((numFeatures+63)/64, 0);
+        }
+        inline int size() const { return numFeatures; }
+        inline void clear() { std::fill(words.begin(), words.end(), ulong(0)); }
+        inline void set(int i) { words[i>>6] |= ulong(1)<<(i&63); }
+        inline bool test(int i) const { return (words[i>>6]>>(i&63)) & 1; }
+        // Writes the indices of the set features to active, in ascending order
+        void getActive(std::vector<int>& active) const;
+
+    protected:
+        int numFeatures;
+        std::vector<ulong> words;
+    };
+
     class SarsaLambda {
     public:
         //SarsaLambda() {};
         SarsaLambda(int numFeatures, int numActions, 
-                    float gamma=.999, float alpha=.1, float epsilon=.1, float lambda=.3);
+                    float gamma=.999, float alpha=.1, float epsilon=.1, float lambda=.3,
+                    float traceCutoff=1e-4);
         ~SarsaLambda() {};
         void reset();
-        int act(std::vector<bool>& currState, double lastActionReward);
+        int act(const FeatureBits& currState, double lastActionReward);
         void printinfo();
 
     public:
         float gamma, alpha, epsilon, lambda; // Hyper-parameters
+        float traceCutoff; // Traces that decay below this are dropped
         int numFeatures, numActions;
-        std::vector<float> w; // Weight vector
-        std::vector<float> e; // Eligibility vector
+        // Weight vector, the weights of all actions for a feature are next to each
+        // other so the Q values are summed a row per active feature
+        std::vector<float> w;
+        // The eligibility traces that are not negligible: the weight index and
+        // trace of each, and the position in the list of every weight or -1
+        std::vector<int> traceIndices;
+        std::vector<float> traceValues;
+        std::vector<int> tracePositions;
         double oldQ, reward;
 
         int selectAction(std::vector<double>& qVals);
+
+    protected:
+        std::vector<int> activeFeatures;
+        std::vector<double> qVals;
+
+        void setTrace(int weightIndex, float value);
+        void decayTraces(float decay);
     };
 
 
@@ -44,7 +79,7 @@ namespace HCUBE
         int numObjClasses;
 
         SarsaLambda *agent;
-        std::vector<bool> phi;
+        FeatureBits phi;
 
     public:
         NEAT::FastNetwork<double> substrate;
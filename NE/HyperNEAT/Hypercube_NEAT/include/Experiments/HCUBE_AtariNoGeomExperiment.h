@@ -2,6 +2,7 @@
 #define HCUBE_ATARINOGEOMEXPERIMENT_H_INCLUDED
 
 #include "HCUBE_Experiment.h"
+#include "HCUBE_EvaluationTelemetry.h"
 #include "ale_interface.hpp"
 #include "common/visual_processor.h"
 
@@ -26,13 +27,26 @@ namespace HCUBE
 
         double epsilon; // Epsilon greedy action selection
 
+        EvaluationRecord lastEvaluation; // Score and stage times of the last episode
+
     public:
         NEAT::FastNetwork<double> substrate;
         map<Node,string> nameLookup; // Name lookup table
+        vector<int> activeInputs; // The input nodes painted this frame, each listed once
+        bool sparseInputs; // Set by setSubstrateValues() of this class, which fills activeInputs
+
+        vector<int> inputNodeIndices; // Network index of each input node, row-major over all input layers
+        vector<int> outputNodeIndices; // Network index of the output node of each action
+        bool layeredSubstrate; // The phenotype is feed-forward and is activated in a single pass
 
         virtual void initializeExperiment(string rom_file);
         virtual void initializeALE(string rom_file, bool processScreen);
         virtual void initializeTopology();
+        // Saves and restores the values read from the ROM, so the topology can be built without it
+        virtual bool exportTopology(TopologyDescriptor &descriptor);
+        virtual void importTopology(const TopologyDescriptor &descriptor);
+        // Returns the score and stage times of the last episode
+        virtual bool getEvaluationRecord(EvaluationRecord &record);
 
         AtariNoGeomExperiment(string _experimentName,int _threadID);
         virtual ~AtariNoGeomExperiment() {};
@@ -40,6 +54,8 @@ namespace HCUBE
         virtual NEAT::GeneticPopulation* createInitialPopulation(int populationSize);
         virtual void processGroup(shared_ptr<NEAT::GeneticGeneration> generation);
         void runAtariEpisode(shared_ptr<NEAT::GeneticIndividual> individual);
+        // Looks up the network indices of the input and output nodes of the new phenotype
+        void indexSubstrate();
 
         // Sets the activations on the input layer of the substrates
         virtual void setSubstrateValues();
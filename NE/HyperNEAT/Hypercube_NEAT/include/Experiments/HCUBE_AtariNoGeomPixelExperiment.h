@@ -25,6 +25,10 @@ namespace HCUBE
         const static int numColors = 8;
 
         static uInt32 eightBitPallete[256];
+
+        // Pools the screen into one block of inputs per color
+        ScreenPreprocessor screenPreprocessor;
+        vector<float> pooledScreen;
     };
 }
 
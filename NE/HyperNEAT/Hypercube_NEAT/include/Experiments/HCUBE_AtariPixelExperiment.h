@@ -20,6 +20,9 @@ namespace HCUBE
         virtual NEAT::GeneticPopulation* createInitialPopulation(int populationSize);
         virtual void setSubstrateValues(NEAT::LayeredSubstrate<float>* substrate);
 
+        // Sets up the screen preprocessor for the current substrate dimensions
+        void initializeScreenPreprocessor();
+
 	// Schrum: Needed to set the processing layers
 	void setProcessingLayers(int num);
 	// Schrum: Needed to set the processing levels
@@ -30,6 +33,11 @@ namespace HCUBE
 
         static uInt32 eightBitPallete[256];
 
+        // Pools the screen into one input layer per color
+        ScreenPreprocessor screenPreprocessor;
+        ScreenPreprocessor::PoolingMode poolingMode;
+        bool poolFrames; // Max-pool each frame with the previous one
+
 	int numProcessingLayers; // Schrum: this actually defines the number of processing substrates per level
 	int numProcessingLevels; // Schrum: this is the depth/number of levels worth of processing layers
     };
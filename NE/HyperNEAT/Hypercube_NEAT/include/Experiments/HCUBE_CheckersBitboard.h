@@ -0,0 +1,207 @@
+#ifndef HCUBE_CHECKERSBITBOARD_H_INCLUDED
+#define HCUBE_CHECKERSBITBOARD_H_INCLUDED
+
+#include "HCUBE_Defines.h"
+
+/*
+ * The maximum number of legal moves generated for a single position
+ */
+#define CHECKERS_MAX_MOVES (128)
+
+/*
+ * The maximum number of hops in a single multi-jump
+ */
+#define CHECKERS_MAX_JUMPS (12)
+
+namespace HCUBE
+{
+    class CheckersMove;
+
+    typedef boost::pool<> CheckersMovePool;
+
+    /*
+     * A move on a CheckersBitboard.  from, to and the captured masks are
+     * bitboards so the move can be applied (and undone) with a few XORs.
+     * The squares visited by the moving piece are kept in path so the move
+     * can be converted back to a CheckersMove for the game loop and logs.
+     */
+    class CheckersBitboardMove
+    {
+    public:
+        uint from,to;
+        uint capturedMen,capturedKings;
+        bool kingMoved;
+        bool promoted;
+        uchar numSteps;
+        uchar path[CHECKERS_MAX_JUMPS+1];
+
+        inline bool isJump() const
+        {
+            return (capturedMen|capturedKings)!=0;
+        }
+    };
+
+    /*
+     * A checkers position stored as four 32-square bitboards, using the same
+     * square numbering as Cake's POSITION (square = y*4 + x/2, black on rows 0-2):
+     *
+     *   WHITE
+     *   28  29  30  31
+     *   24  25  26  27
+     *   ...
+     *   4   5   6   7
+     *   0   1   2   3
+     *   BLACK
+     *
+     * Moves are generated with shifts and masks over all pieces at once, and a
+     * Zobrist key of the position (including the side to move) is kept up to date
+     * incrementally by makeMove/unmakeMove.
+     */
+    class CheckersBitboard
+    {
+    public:
+        uint blackMen,blackKings,whiteMen,whiteKings;
+        int colorToMove;
+        ulong hashKey;
+
+        CheckersBitboard();
+
+        CheckersBitboard(uchar b[8][8],int _colorToMove);
+
+        void loadBoard(uchar b[8][8],int _colorToMove);
+
+        //Writes the position to an array board, including the piece counts
+        void saveBoard(uchar b[8][8]) const;
+
+        inline uint getPieces(int color) const
+        {
+            return (color==BLACK)?(blackMen|blackKings):(whiteMen|whiteKings);
+        }
+
+        inline uint getOccupied() const
+        {
+            return blackMen|blackKings|whiteMen|whiteKings;
+        }
+
+        inline bool operator==(const CheckersBitboard &other) const
+        {
+            return
+                blackMen==other.blackMen &&
+                blackKings==other.blackKings &&
+                whiteMen==other.whiteMen &&
+                whiteKings==other.whiteKings &&
+                colorToMove==other.colorToMove;
+        }
+
+        /*
+         * Generates the legal moves for the side to move.  If any capture is
+         * possible only captures are generated and foundJump is set.
+         * Returns the number of moves written to moveList.
+         */
+        int generateMoves(CheckersBitboardMove *moveList,bool &foundJump) const;
+
+        bool hasAnyMove() const;
+
+        //Returns the winner if one side has no pieces left, -1 otherwise
+        int getWinner() const;
+
+        //Like getWinner(), but the side to move also loses if it cannot move
+        int getWinnerWithMoves() const;
+
+        void makeMove(const CheckersBitboardMove &move);
+
+        void unmakeMove(const CheckersBitboardMove &move);
+
+        CheckersMove toCheckersMove(
+            const CheckersBitboardMove &move,
+            boost::shared_ptr<CheckersMovePool> checkersMovePoolPtr
+        ) const;
+
+        /*
+         * Writes the position into a row-major 8x8 input layer with the given
+         * row stride.  Black pieces are positive and white pieces negative, and
+         * empty and light squares are zero.
+         */
+        template<class Type>
+        void getSubstrateInputs(Type *values,int stride,Type manValue,Type kingValue) const
+        {
+            for (int y=0;y<8;y++)
+            {
+                for (int x=0;x<8;x++)
+                {
+                    values[y*stride+x] = Type(0);
+                }
+            }
+
+            setSubstrateInputs(values,stride,blackMen,manValue);
+            setSubstrateInputs(values,stride,blackKings,kingValue);
+            setSubstrateInputs(values,stride,whiteMen,-manValue);
+            setSubstrateInputs(values,stride,whiteKings,-kingValue);
+        }
+
+        ulong computeHashKey() const;
+
+        static inline int squareToX(int square)
+        {
+            return ((square&3)<<1) + ((square>>2)&1);
+        }
+
+        static inline int squareToY(int square)
+        {
+            return square>>2;
+        }
+
+        static inline int lowestSquare(uint bits)
+        {
+#ifdef __GNUC__
+            return __builtin_ctz(bits);
+#else
+            int square=0;
+            while (!(bits&1))
+            {
+                bits >>= 1;
+                square++;
+            }
+            return square;
+#endif
+        }
+
+        static inline int countSquares(uint bits)
+        {
+#ifdef __GNUC__
+            return __builtin_popcount(bits);
+#else
+            int count=0;
+            for (;bits;bits&=bits-1)
+                count++;
+            return count;
+#endif
+        }
+
+    protected:
+        template<class Type>
+        static void setSubstrateInputs(Type *values,int stride,uint bits,Type value)
+        {
+            while (bits)
+            {
+                int square = lowestSquare(bits);
+                bits &= bits-1;
+                values[squareToY(square)*stride+squareToX(square)] = value;
+            }
+        }
+
+        void toggleMove(const CheckersBitboardMove &move,int color);
+
+        void addJumps(
+            CheckersBitboardMove &move,
+            uint square,
+            uint opponents,
+            uint opponentKings,
+            uint empty,
+            CheckersBitboardMove *moveList,
+            int &numMoves
+        ) const;
+    };
+}
+
+#endif // HCUBE_CHECKERSBITBOARD_H_INCLUDED
@@ -18,6 +18,8 @@ extern "C"
 #include "cakepp.h"
 #include "move_gen.h"
 
+#include "Experiments/HCUBE_CheckersBitboard.h"
+
 #define NUM_BLACK_PIECES(ARRAY) (ARRAY[0][1])
 
 #define NUM_WHITE_PIECES(ARRAY) (ARRAY[0][3])
@@ -35,8 +37,6 @@ typedef float CheckersNEATDatatype;
 
 namespace HCUBE
 {
-    typedef boost::pool<> CheckersMovePool;
-
     class CheckersMove
     {
     public:
@@ -121,37 +121,6 @@ namespace HCUBE
 
         void reverseMove(CheckersMove &move,uchar b[8][8]);
 
-        bool hasJump(
-            uchar b[8][8],
-            int color,
-            int x,
-            int y,
-            int deltax,
-            int deltay
-        );
-
-        bool tryMoreJumps(
-            vector<CheckersMove> &totalMoveList,
-            int &numMoves,
-            CheckersMove &moveInProgress,
-            int color,
-            uchar b[8][8]
-        );
-
-
-        void tryMove(
-            vector<CheckersMove> &totalMoveList,
-            int moveBeginIndex,
-            uchar b[8][8],
-            int &numMoves,
-            bool &foundJump,
-            int color,
-            int x,
-            int y,
-            int deltax,
-            int deltay
-        );
-
         int generateMoveList(
             vector<CheckersMove> &totalMoveList,
             int moveBeginIndex,
@@ -501,9 +470,6 @@ namespace HCUBE
 
 //namespace HCUBE
 //{
-    typedef pair<CheckersCachedBoard,CheckersNEATDatatype> BoardCachePair;
-    typedef vector<BoardCachePair> BoardCacheList;
-
     typedef pair<CheckersBoardState,CheckersBoardStateData> BoardStatePair;
     typedef vector<BoardStatePair> BoardStateList;
 
@@ -3,6 +3,7 @@
 
 #include "Experiments/HCUBE_Experiment.h"
 #include "Experiments/HCUBE_CheckersCommon.h"
+#include "Experiments/HCUBE_CheckersTranspositionTable.h"
 
 #define MAX_CACHED_BOARDS (8192)
 
@@ -42,9 +43,8 @@ namespace HCUBE
         uchar userEvaluationBoard[8][8];
         int userEvaluationRound;
 
-        BoardCacheList boardEvaluationCaches[2][65336];
-
-        BoardStateList boardStateLists[3][3][65536];
+        //One table per substrate, plus one for the hand-coded player
+        CheckersTranspositionTable transpositionTables[3];
 
         Vector2<uchar> from;
 
@@ -52,7 +52,6 @@ namespace HCUBE
 
         int DEBUG_USE_HANDCODED_EVALUATION;
         int DEBUG_USE_HYPERNEAT_EVALUATION;
-        CheckersCachedBoard tmpboard;
 
 		bool dumpEvaluationImages;
 
@@ -66,9 +65,15 @@ namespace HCUBE
 
         int currentRound;
 
+        //False if the leaf evaluation does not use the layered substrates and can't be batched
+        bool batchLeafEvaluations;
+
     public:
         CheckersExperiment(string _experimentName,int _threadID);
 
+        //The copy gets search tables of its own, see searchInfo
+        CheckersExperiment(const CheckersExperiment &other);
+
         virtual ~CheckersExperiment();
 
         virtual NEAT::GeneticPopulation* createInitialPopulation(int populationSize);
@@ -89,17 +94,49 @@ namespace HCUBE
 
         virtual pair<CheckersNEATDatatype,int> evaluateLeafWhite(uchar b[8][8]);
 
-        virtual pair<CheckersNEATDatatype,int> evaluateLeafHyperNEAT(uchar b[8][8]);
+        /*
+         * The key of a position in the transposition tables.  The evaluation
+         * settings are mixed in because they change the value of a search.
+         */
+        inline ulong getTranspositionKey(const CheckersBitboard &board) const
+        {
+            ulong settings =
+                ulong(handCodedType*4 + DEBUG_USE_HANDCODED_EVALUATION*2 + DEBUG_USE_HYPERNEAT_EVALUATION);
+
+            return board.hashKey ^ (settings*0x9E3779B97F4A7C15ULL);
+        }
+
+        virtual pair<CheckersNEATDatatype,int> evaluateLeafHyperNEAT(const CheckersBitboard &board);
+
+        /*
+         * Evaluates several leaves with one batched pass through the substrate.
+         * values[a] is set to evaluateLeafHyperNEAT(boards[a]).first
+         */
+        void evaluateLeavesHyperNEAT(
+            const CheckersBitboard *boards,
+            int numBoards,
+            CheckersNEATDatatype *values
+        );
+
+        /*
+         * Stores the evaluations of the quiet positions reached by moveList
+         * in the transposition table, evaluated as one batch
+         */
+        void prefetchLeafEvaluations(
+            CheckersBitboard &board,
+            const CheckersBitboardMove *moveList,
+            int moveListCount
+        );
 
         virtual pair<CheckersNEATDatatype,int> evaluatemax(
-            uchar b[8][8],
+            CheckersBitboard &board,
             CheckersNEATDatatype parentBeta,
             int depth,
             int maxDepth
         );
 
         virtual pair<CheckersNEATDatatype,int> evaluatemin(
-            uchar b[8][8],
+            CheckersBitboard &board,
             CheckersNEATDatatype parentAlpha,
             int depth,
             int maxDepth
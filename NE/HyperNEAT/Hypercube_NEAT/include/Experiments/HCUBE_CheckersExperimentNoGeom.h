@@ -36,7 +36,7 @@ namespace HCUBE
         );
 
 		virtual pair<CheckersNEATDatatype,int> evaluateLeafHyperNEAT(
-			uchar b[8][8]
+			const CheckersBitboard &board
 		);
 
 #if 0
@@ -35,9 +35,9 @@ namespace HCUBE
             int substrateNum=0
         );
 
-        virtual pair<CheckersNEATDatatype,int> evaluateLeafHyperNEAT(uchar b[8][8]);
+        virtual pair<CheckersNEATDatatype,int> evaluateLeafHyperNEAT(const CheckersBitboard &board);
 
-        virtual CheckersNEATDatatype getSpatialInput(uchar b[8][8],int x,int y,int sizex,int sizey);
+        virtual CheckersNEATDatatype getSpatialInput(const CheckersNEATDatatype *pieceValues,int x,int y,int sizex,int sizey);
 
         virtual Experiment* clone();
     };
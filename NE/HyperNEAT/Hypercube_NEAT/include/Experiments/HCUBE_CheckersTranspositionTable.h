@@ -0,0 +1,98 @@
+#ifndef HCUBE_CHECKERSTRANSPOSITIONTABLE_H_INCLUDED
+#define HCUBE_CHECKERSTRANSPOSITIONTABLE_H_INCLUDED
+
+#include "Experiments/HCUBE_CheckersCommon.h"
+
+/*
+ * The number of buckets in each transposition table.  Each bucket is one
+ * 64-byte cache line holding CHECKERS_TRANSPOSITION_BUCKET_SIZE entries.
+ * Must be a power of two.
+ */
+#define CHECKERS_TRANSPOSITION_TABLE_BUCKETS (1<<16)
+
+#define CHECKERS_TRANSPOSITION_BUCKET_SIZE (4)
+
+#define CHECKERS_TRANSPOSITION_NO_MOVE (255)
+
+namespace HCUBE
+{
+    enum CheckersTranspositionBound
+    {
+        CHECKERS_BOUND_EXACT=0,
+        //The value is a lower bound (the search failed high)
+        CHECKERS_BOUND_LOWER,
+        //The value is an upper bound (the search failed low)
+        CHECKERS_BOUND_UPPER
+    };
+
+    class CheckersTranspositionEntry
+    {
+    public:
+        ulong key;
+        CheckersNEATDatatype value;
+        //The remaining search depth the value was computed with
+        char depth;
+        uchar bound;
+        //Index of the best move in the order CheckersBitboard::generateMoves returns them
+        uchar bestMove;
+        //The table generation this entry was stored in.  Entries from older generations are empty.
+        uchar generation;
+    };
+
+    class CheckersTranspositionBucket
+    {
+    public:
+        CheckersTranspositionEntry entries[CHECKERS_TRANSPOSITION_BUCKET_SIZE];
+    };
+
+    /*
+     * A fixed-size hash table of search results keyed by 64-bit Zobrist keys.
+     * The buckets are allocated once, aligned to cache lines, so a probe touches
+     * a single cache line.  clear() only advances the generation counter, so
+     * emptying the table between individuals costs nothing.
+     */
+    class CheckersTranspositionTable
+    {
+    protected:
+        char *memory;
+        CheckersTranspositionBucket *buckets;
+        uchar generation;
+
+    public:
+        CheckersTranspositionTable();
+
+        CheckersTranspositionTable(const CheckersTranspositionTable &other);
+
+        ~CheckersTranspositionTable();
+
+        CheckersTranspositionTable &operator=(const CheckersTranspositionTable &other);
+
+        void clear();
+
+        //Returns the entry for key, or NULL if the position is not in the table
+        const CheckersTranspositionEntry *probe(ulong key) const;
+
+        /*
+         * Stores a search result.  An entry for the same key is overwritten,
+         * otherwise an empty or stale entry of the bucket is used, otherwise
+         * the entry with the smallest depth is replaced.
+         */
+        void store(
+            ulong key,
+            CheckersNEATDatatype value,
+            int depth,
+            CheckersTranspositionBound bound,
+            int bestMove
+        );
+
+    protected:
+        void allocate();
+
+        inline CheckersTranspositionBucket &getBucket(ulong key) const
+        {
+            return buckets[ uint(key>>32) & (CHECKERS_TRANSPOSITION_TABLE_BUCKETS-1) ];
+        }
+    };
+}
+
+#endif // HCUBE_CHECKERSTRANSPOSITIONTABLE_H_INCLUDED
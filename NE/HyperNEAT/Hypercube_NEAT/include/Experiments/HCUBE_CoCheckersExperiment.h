@@ -5,6 +5,11 @@
 
 #ifdef EPLEX_INTERNAL
 
+//How many random moves into the game the openings are.  Keep it even so black is to move.
+#define COCHECKERS_OPENING_PLIES (4)
+
+#define COCHECKERS_OPENING_SEED (3141)
+
 namespace HCUBE
 {
 
@@ -18,12 +23,18 @@ namespace HCUBE
 
         int testCases;
 
+        //The opening pool, 8*8 squares per position
+        vector<uchar> openingBoards;
+
         //The current generation.  Important for getting coevolution test cases.
 
     public:
 
         CoCheckersExperiment(string _experimentName,int _threadID);
 
+        //The copy gets search tables of its own, the tournament threads play on copies
+        CoCheckersExperiment(const CoCheckersExperiment &other);
+
         virtual NEAT::GeneticPopulation* createInitialPopulation(int populationSize);
 
         //virtual CheckersNEATDatatype evaluateLeafWhite(uchar b[8][8]);
@@ -39,6 +50,10 @@ namespace HCUBE
 
         virtual Experiment* clone();
 
+        virtual shared_ptr<NEAT::CoEvoExperiment> cloneCoEvo();
+
+        virtual int getOpeningCount();
+
         virtual int getGroupCapacity()
         {
             return 1;
@@ -47,6 +62,17 @@ namespace HCUBE
         virtual void addGenerationData(shared_ptr<NEAT::GeneticGeneration> generation,shared_ptr<NEAT::GeneticIndividual> individual);
 
     protected:
+        /**
+         * Fills the pool with CoEvoOpenings positions after a few random
+         * moves.  The pool is the same for every run.
+         */
+        void createOpenings();
+
+        /**
+         * Sets up the board of the selected opening, or the usual start
+         * position when there is no pool
+         */
+        void resetToOpening(uchar b[8][8]);
     };
 }
 
@@ -5,6 +5,9 @@
 
 namespace HCUBE
 {
+    class TopologyDescriptor;
+    class EvaluationRecord;
+
     class Experiment
     {
     protected:
@@ -48,6 +51,39 @@ namespace HCUBE
 
         virtual NEAT::GeneticPopulation* createInitialPopulation(int populationSize) = 0;
 
+        /**
+         * Loads the ROM and sets up the experiment.  Only the Atari experiments use a ROM.
+         */
+        virtual void initializeExperiment(string rom_file)
+        {}
+
+        /**
+         * Fills in the parts of the topology that this experiment read from its ROM.
+         * Returns false if the experiment cannot rebuild its topology without the ROM.
+         */
+        virtual bool exportTopology(TopologyDescriptor &descriptor)
+        {
+            return false;
+        }
+
+        /**
+         * Builds the topology from a descriptor filled in by exportTopology instead of
+         * loading the ROM.  The experiment can create populations, but not evaluate them.
+         */
+        virtual void importTopology(const TopologyDescriptor &descriptor)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("This experiment cannot be set up from a topology descriptor");
+        }
+
+        /**
+         * Fills in the score, frame count and stage times of the last individual
+         * processed.  Returns false if the experiment does not keep them.
+         */
+        virtual bool getEvaluationRecord(EvaluationRecord &record)
+        {
+            return false;
+        }
+
         virtual int getGroupCapacity()
         {
             return 1;
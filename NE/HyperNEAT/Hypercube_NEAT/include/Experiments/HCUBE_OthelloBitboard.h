@@ -0,0 +1,172 @@
+#ifndef HCUBE_OTHELLOBITBOARD_H_INCLUDED
+#define HCUBE_OTHELLOBITBOARD_H_INCLUDED
+
+#include "HCUBE_Defines.h"
+
+#include "Experiments/HCUBE_OthelloCommon.h"
+
+namespace HCUBE
+{
+    /*
+     * An Othello position stored as one 64-square bitboard per color.  Square
+     * y*8+x is b[x][y] of the array boards, so bit 0 is the upper left corner
+     * of printBoard and bit 63 the lower right one.
+     *
+     * Moves and flips are computed for all squares at once with Kogge-Stone
+     * fills: in each of the 8 directions the opponent's pieces are filled from
+     * the own pieces in log2 steps of doubling shifts, with the board edge
+     * folded into the fill mask so no ray wraps around.  A move is the square
+     * it is played on plus the mask of flipped pieces, and is made and undone
+     * with XORs.
+     */
+    class OthelloBitboard
+    {
+    public:
+        ulong black,white;
+
+        OthelloBitboard();
+
+        OthelloBitboard(ulong _black,ulong _white);
+
+        OthelloBitboard(ushort b[8][8]);
+
+        void loadBoard(ushort b[8][8]);
+
+        //Writes the position to an array board, including the piece counts
+        void saveBoard(ushort b[8][8]) const;
+
+        //color is OTHELLO_BLACK or OTHELLO_WHITE
+        inline ulong getPieces(int color) const
+        {
+            return (color==OTHELLO_BLACK)?black:white;
+        }
+
+        inline ulong getEmpty() const
+        {
+            return ~(black|white);
+        }
+
+        inline bool operator==(const OthelloBitboard &other) const
+        {
+            return black==other.black && white==other.white;
+        }
+
+        inline bool operator<(const OthelloBitboard &other) const
+        {
+            return black<other.black || (black==other.black && white<other.white);
+        }
+
+        /*
+         * Returns the mask of the empty squares color can play on
+         */
+        ulong generateMoves(int color) const;
+
+        /*
+         * Returns the mask of the pieces that flip when color plays on square.
+         * 0 if the move is not legal.
+         */
+        ulong getFlips(int color,int square) const;
+
+        inline bool hasAnyMove() const
+        {
+            return (generateMoves(OTHELLO_BLACK)|generateMoves(OTHELLO_WHITE))!=0;
+        }
+
+        /*
+         * Same result as OthelloCommon::getWinner: the side with more pieces
+         * once neither side can move, OTHELLO_END_UNKNOWN before that.
+         */
+        int getWinner() const;
+
+        inline void makeMove(int color,int square,ulong flips)
+        {
+            toggleMove(color,square,flips);
+        }
+
+        inline void unmakeMove(int color,int square,ulong flips)
+        {
+            toggleMove(color,square,flips);
+        }
+
+        /*
+         * Sets the input node of every occupied square.  nodeIndices[square]
+         * is the index of the node for that square in network.  The input
+         * layer must be zeroed before.
+         */
+        template<class NetworkType,class Type>
+        void setSubstrateInputs(NetworkType &network,const int *nodeIndices,Type blackValue,Type whiteValue) const
+        {
+            for (ulong bits=black;bits;bits&=bits-1)
+            {
+                network.setValue(nodeIndices[lowestSquare(bits)],blackValue);
+            }
+
+            for (ulong bits=white;bits;bits&=bits-1)
+            {
+                network.setValue(nodeIndices[lowestSquare(bits)],whiteValue);
+            }
+        }
+
+        /*
+         * Writes the squares of bits to squares in ascending order and returns
+         * how many there are
+         */
+        static int listSquares(ulong bits,int *squares);
+
+        static inline int squareToX(int square)
+        {
+            return square&7;
+        }
+
+        static inline int squareToY(int square)
+        {
+            return square>>3;
+        }
+
+        static inline int lowestSquare(ulong bits)
+        {
+#ifdef __GNUC__
+            return __builtin_ctzll(bits);
+#else
+            int square=0;
+            while (!(bits&1))
+            {
+                bits >>= 1;
+                square++;
+            }
+            return square;
+#endif
+        }
+
+        static inline int countSquares(ulong bits)
+        {
+#ifdef __GNUC__
+            return __builtin_popcountll(bits);
+#else
+            int count=0;
+            for (;bits;bits&=bits-1)
+                count++;
+            return count;
+#endif
+        }
+
+    protected:
+        inline void toggleMove(int color,int square,ulong flips)
+        {
+            ulong placed = ulong(1)<<square;
+
+            if (color==OTHELLO_BLACK)
+            {
+                black ^= placed|flips;
+                white ^= flips;
+            }
+            else
+            {
+                white ^= placed|flips;
+                black ^= flips;
+            }
+        }
+    };
+}
+
+#endif // HCUBE_OTHELLOBITBOARD_H_INCLUDED
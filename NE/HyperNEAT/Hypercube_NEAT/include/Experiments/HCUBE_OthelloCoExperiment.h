@@ -8,12 +8,19 @@
 
 #ifdef EPLEX_INTERNAL
 
+//How many random moves into the game the openings are.  Keep it even so black is to move.
+#define OTHELLO_OPENING_PLIES (4)
+
+#define OTHELLO_OPENING_SEED (2718)
+
 namespace HCUBE
 {
     class OthelloCoExperiment : public OthelloExperiment, public NEAT::CoEvoExperiment
     {
     public:
     protected:
+        //The opening pool, 8*8 squares per position
+        vector<ushort> openingBoards;
 
     public:
         OthelloCoExperiment(string _experimentName,int _threadID);
@@ -31,6 +38,23 @@ namespace HCUBE
         virtual void processGroup(shared_ptr<NEAT::GeneticGeneration> generation);
 
         virtual Experiment* clone();
+
+        virtual shared_ptr<NEAT::CoEvoExperiment> cloneCoEvo();
+
+        virtual int getOpeningCount();
+
+    protected:
+        /**
+         * Fills the pool with CoEvoOpenings positions after a few random
+         * moves.  The pool is the same for every run.
+         */
+        void createOpenings();
+
+        /**
+         * Sets up the board of the selected opening, or the usual start
+         * position when there is no pool
+         */
+        void resetToOpening(ushort b[8][8]);
     };
 
 }
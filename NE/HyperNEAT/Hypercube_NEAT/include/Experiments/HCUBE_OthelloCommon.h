@@ -47,7 +47,10 @@
 
 #define OTHELLO_IS_IN_BOUNDS(X,Y) ((X)>=0&&(Y)>=0&&(X)<8&&(Y)<8)
 
-#define MAX_TOTAL_MOVES (262144)
+/*
+ * More than the number of legal moves in any Othello position
+ */
+#define OTHELLO_MAX_MOVES (64)
 
 #define OTHELLO_USE_BOOST_POOL (0)
 
@@ -92,8 +95,7 @@ namespace HCUBE
     {
     protected:
 
-        OthelloMove totalMoveList[MAX_TOTAL_MOVES];
-        int totalNumMoves;
+        OthelloMove totalMoveList[OTHELLO_MAX_MOVES];
     public:
         void printBoard(ushort b[8][8]);
 
@@ -112,6 +114,10 @@ namespace HCUBE
             ushort b[8][8]
         );
 
+        /*
+         * Writes the legal moves of color to moveList, which needs room for
+         * OTHELLO_MAX_MOVES moves, and returns how many there are
+         */
         int generateMoveList(
             ushort b[8][8],
             OthelloMove *moveList,
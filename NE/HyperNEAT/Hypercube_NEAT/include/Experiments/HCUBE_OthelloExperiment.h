@@ -3,6 +3,7 @@
 
 #include "Experiments/HCUBE_Experiment.h"
 #include "Experiments/HCUBE_OthelloCommon.h"
+#include "Experiments/HCUBE_OthelloBitboard.h"
 
 #define MAX_CACHED_BOARDS (8192)
 
@@ -20,82 +21,37 @@ typedef float OthelloNEATDatatype;
 
 namespace HCUBE
 {
-    class OthelloBoardState
-    {
-    public:
-        ushort board[8][8];
-        uchar playerToMove;
-        int depth;
-
-        OthelloBoardState()
-        {}
-
-        OthelloBoardState(ushort _board[8][8],uchar _playerToMove,int _depth)
-                :
-                playerToMove(_playerToMove),
-                depth(_depth)
-        {
-            memcpy(board,_board,sizeof(ushort)*8*8);
-        }
-
-        bool operator <(const OthelloBoardState &bs2) const
-        {
-            if (playerToMove<bs2.playerToMove)
-            {
-                return true;
-            }
-            else if (playerToMove==bs2.playerToMove)
-            {
-                if (depth < bs2.depth)
-                {
-                    return true;
-                }
-                else if (depth == bs2.depth)
-                {
-                    return (memcmp(board,bs2.board,8*8*sizeof(ushort))==-1);
-                }
-            }
-
-            return false;
-        }
-
-        bool operator ==(const OthelloBoardState &bs2) const
-        {
-            return memcmp(this,&bs2,sizeof(OthelloBoardState))==0;
-        }
-    };
-
+    /*
+     * Key of the leaf evaluation cache.  The same board gets a different
+     * rating from each of the two substrates.
+     */
     class OthelloCachedBoard
     {
     public:
-        ushort b[8][8];
+        OthelloBitboard board;
+        int substrateIndex;
 
         OthelloCachedBoard()
         {}
 
-        OthelloCachedBoard(ushort _b[8][8])
-        {
-            memcpy(b,_b,sizeof(ushort)*8*8);
-        }
-
-        void loadBoard(ushort _b[8][8])
-        {
-            memcpy(b,_b,sizeof(ushort)*8*8);
-        }
+        OthelloCachedBoard(const OthelloBitboard &_board,int _substrateIndex)
+                :
+                board(_board),
+                substrateIndex(_substrateIndex)
+        {}
 
         bool operator <(const OthelloCachedBoard &bs2) const
         {
-            return (memcmp(b,bs2.b,8*8*sizeof(ushort))==-1);
+            return substrateIndex<bs2.substrateIndex || (substrateIndex==bs2.substrateIndex && board<bs2.board);
         }
 
         bool operator ==(const OthelloCachedBoard &bs2) const
         {
-            return (memcmp(b,bs2.b,8*8*sizeof(ushort))==0);
+            return substrateIndex==bs2.substrateIndex && board==bs2.board;
         }
     };
 
     typedef map<OthelloCachedBoard,OthelloNEATDatatype> OthelloBoardCacheMap;
-    typedef map<OthelloBoardState,OthelloNEATDatatype> OthelloBoardStateMap;
 
     class OthelloExperiment : public Experiment, public OthelloCommon
     {
@@ -109,6 +65,11 @@ namespace HCUBE
         int currentSubstrateIndex;
         shared_ptr<const NEAT::GeneticIndividual> substrateIndividuals[2];
 
+        //The node index of every board square in the input layer and of the
+        //output node, looked up once when a substrate is generated
+        int inputNodeIndices[2][64];
+        int outputNodeIndices[2];
+
         int numNodesX[3];
         int numNodesY[3];
         //int numGames;
@@ -124,14 +85,11 @@ namespace HCUBE
 
         OthelloBoardCacheMap boardEvaluationCache;
 
-        OthelloBoardStateMap boardStateCache;
-
         int handCodedType;
         int handCodedDepth;
 
         int DEBUG_USE_HANDCODED_EVALUATION;
         int DEBUG_USE_HYPERNEAT_EVALUATION;
-        OthelloCachedBoard tmpboard;
 
         int randomMoveChance;
 
@@ -161,17 +119,24 @@ namespace HCUBE
 
         void resetBoard(ushort b[8][8]);
 
-        virtual OthelloNEATDatatype evaluateLeafHyperNEAT(ushort b[8][8]);
+        virtual OthelloNEATDatatype evaluateLeafHyperNEAT(const OthelloBitboard &board);
+
+        virtual OthelloNEATDatatype evaluateLeafHandCoded(const OthelloBitboard &board);
 
-        virtual OthelloNEATDatatype evaluateLeafHandCoded(ushort b[8][8]);
+        virtual OthelloNEATDatatype evaluateLeafWhite(const OthelloBitboard &board);
 
-        virtual OthelloNEATDatatype evaluateLeafWhite(ushort b[8][8]);
+        virtual OthelloNEATDatatype evaluateLeafBlack(const OthelloBitboard &board);
 
-        virtual OthelloNEATDatatype evaluateLeafBlack(ushort b[8][8]);
+        /*
+         * Searches the moves of black and stores the best one in moveToMake
+         * at depth 0.  The board is changed during the search but is the same
+         * as before when it returns.
+         */
+        OthelloNEATDatatype evaluatemax(OthelloBitboard &board,  OthelloNEATDatatype parentBeta, int depth,int maxDepth);
 
-        OthelloNEATDatatype evaluatemax(ushort b[8][8],  OthelloNEATDatatype parentBeta, int depth,int maxDepth);
+        OthelloNEATDatatype evaluatemin(OthelloBitboard &board,  OthelloNEATDatatype parentAlpha, int depth,int maxDepth);
 
-        OthelloNEATDatatype evaluatemin(ushort b[8][8],  OthelloNEATDatatype parentAlpha, int depth,int maxDepth);
+        void setMoveToMake(int square,int color);
 
         virtual void processGroup(shared_ptr<NEAT::GeneticGeneration> generation);
 
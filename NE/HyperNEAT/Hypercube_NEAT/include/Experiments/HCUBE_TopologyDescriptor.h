@@ -0,0 +1,41 @@
+#ifndef HCUBE_TOPOLOGYDESCRIPTOR_H_INCLUDED
+#define HCUBE_TOPOLOGYDESCRIPTOR_H_INCLUDED
+
+#include "HCUBE_Defines.h"
+
+/**
+   The part of an Atari experiment's network topology that depends on
+   the ROM: the number of actions, the number of object classes and
+   the size of the substrate.  An experiment fills it in once it has
+   loaded the ROM, and can rebuild its topology from a cached copy
+   without starting the emulator, which is all a generator needs.  The
+   substrate layers are written along with it for visualizers.
+*/
+namespace HCUBE
+{
+    class TopologyDescriptor
+    {
+    public:
+        // The ROM file name without its directory, so the cache works on nodes that keep ROMs elsewhere
+        string romName;
+        int experimentType;
+
+        int numActions;
+        int numObjClasses;
+        int substrateWidth, substrateHeight;
+
+        NEAT::LayeredSubstrateInfo layerInfo;
+
+        TopologyDescriptor();
+
+        // Returns false if the file does not exist or cannot be read
+        bool load(const string &fileName);
+
+        // Writes under a temporary name first so readers never see a partial file
+        void save(const string &fileName) const;
+
+        static string getRomName(const string &romFile);
+    };
+}
+
+#endif // HCUBE_TOPOLOGYDESCRIPTOR_H_INCLUDED
@@ -28,6 +28,8 @@ namespace HCUBE
 
         virtual void processIndividualPostHoc(shared_ptr<NEAT::GeneticIndividual> individual);
 
+        virtual shared_ptr<NEAT::CoEvoExperiment> cloneCoEvo();
+
 #ifndef HCUBE_NOGUI
         virtual void createIndividualImage(wxDC &drawContext,shared_ptr<NEAT::GeneticIndividual> individual)
         {}
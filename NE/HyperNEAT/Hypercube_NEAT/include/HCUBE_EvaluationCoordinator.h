@@ -0,0 +1,233 @@
+#ifndef HCUBE_EVALUATIONCOORDINATOR_H_INCLUDED
+#define HCUBE_EVALUATIONCOORDINATOR_H_INCLUDED
+
+#include "HCUBE_Defines.h"
+
+namespace HCUBE
+{
+    /**
+    * Breeds the individuals of a steady-state run for an EvaluationCoordinator
+    * and takes their fitness back.
+    */
+    class SteadyStateBreeder
+    {
+    public:
+        virtual ~SteadyStateBreeder()
+        {}
+
+        /**
+        * Breeds a new individual and writes it to individualData in the format
+        * read by the GeneticIndividual(istream&) constructor.
+        */
+        virtual void breedIndividual(int individualID,string &individualData) = 0;
+
+        /**
+        * Called once for every bred individual with its fitness.  Returns false
+        * when the run is over.
+        */
+        virtual bool addResult(int individualID,float fitness) = 0;
+    };
+
+    /**
+    * EvaluationCoordinator hands out the individuals of a generation to
+    * atari_evaluate workers over TCP and collects their fitness in memory.
+    *
+    * Each individual is leased to one worker at a time.  A lease is reissued
+    * when its worker disconnects or when it has not reported back within the
+    * lease timeout, and late results for an individual that already has a
+    * fitness are ignored.  Workers that ask for a lease while every remaining
+    * individual is leased are not answered until one becomes free or the next
+    * generation starts, so nobody has to poll.
+    *
+    * In a steady-state run there is no generation to wait for: whenever a
+    * worker asks for a lease and nothing is left to reissue, a new individual
+    * is bred by the SteadyStateBreeder and sent along with the lease.  The
+    * worker only loads populationFile for the experiment settings.
+    *
+    * The protocol is one line of text per message:
+    *   worker:      LEASE
+    *   coordinator: EVALUATE (generation) (individual) (populationFile)
+    *                INDIVIDUAL (individual) (numBytes) (populationFile)
+    *                  followed by numBytes of individual data and a newline
+    *                DONE
+    *   worker:      RESULT (generation) (individual) (fitness)
+    * where generation is -1 for the individuals of a steady-state run.
+    */
+    class EvaluationCoordinator
+    {
+    protected:
+        class Connection
+        {
+        public:
+            int socketHandle;
+            string input;
+            bool waitingForLease;
+
+            Connection(int _socketHandle)
+                :
+                socketHandle(_socketHandle),
+                waitingForLease(false)
+            {}
+        };
+
+        class Lease
+        {
+        public:
+            int socketHandle;
+            double deadline;
+
+            Lease(int _socketHandle,double _deadline)
+                :
+                socketHandle(_socketHandle),
+                deadline(_deadline)
+            {}
+        };
+
+        int listenSocket;
+        int port;
+        double leaseSeconds;
+        list<Connection> connections;
+
+        //-1 while a steady-state run is in progress
+        int generation;
+        string populationFile;
+        //The lease message of every individual that has no fitness yet
+        map<int,string> leaseMessages;
+        map<int,Lease> leases;
+        deque<int> unleased;
+        vector<float> fitnesses;
+
+        SteadyStateBreeder *breeder;
+        int nextIndividualID;
+        bool steadyStateFinished;
+
+    public:
+        /**
+        * Listens on port (0 picks a free port).  Throws if the socket cannot be created.
+        */
+        EvaluationCoordinator(int _port,double _leaseSeconds);
+
+        virtual ~EvaluationCoordinator();
+
+        inline int getPort() const
+        {
+            return port;
+        }
+
+        /**
+        * Writes "(hostname) (port)" to fileName so workers can find the coordinator.
+        */
+        void writeAddress(const string &fileName);
+
+        /**
+        * Leases individuals [0,numIndividuals) of generation to the workers and
+        * blocks until every one of them has a fitness.
+        */
+        void evaluateGeneration(
+            int _generation,
+            const string &_populationFile,
+            int numIndividuals,
+            vector<float> &results
+        );
+
+        /**
+        * Leases individuals bred by breeder until its addResult() returns false.
+        * Results that arrive after that are dropped.
+        */
+        void evaluateSteadyState(
+            const string &_populationFile,
+            SteadyStateBreeder *_breeder
+        );
+
+        /**
+        * Tells every waiting worker that the run is over and closes all connections.
+        */
+        void finish();
+
+    protected:
+        //Serves the workers until every lease has a result, or the steady-state run is over
+        void serveLeases();
+
+        void acceptConnection();
+
+        //Returns false if the connection was closed
+        bool readConnection(Connection &connection);
+
+        void processLine(Connection &connection,const string &line);
+
+        void assignLeases();
+
+        void releaseLeases(int socketHandle);
+
+        void expireLeases(double now);
+
+        void closeConnection(list<Connection>::iterator connectionIterator);
+
+        static void sendLine(int socketHandle,const string &line);
+
+        static double getTime();
+
+        /**
+        * This class cannot be copied
+        */
+        EvaluationCoordinator(const EvaluationCoordinator &other)
+        {}
+
+        /**
+        * This class cannot be copied
+        */
+        const EvaluationCoordinator &operator=(const EvaluationCoordinator &other)
+        {
+            return *this;
+        }
+    };
+
+    /**
+    * The worker side of the EvaluationCoordinator protocol.
+    */
+    class EvaluationLeaseClient
+    {
+    protected:
+        int socketHandle;
+        string input;
+
+    public:
+        /**
+        * Connects to address, given as "host:port".  Throws if the connection fails.
+        */
+        EvaluationLeaseClient(const string &address);
+
+        virtual ~EvaluationLeaseClient();
+
+        /**
+        * Blocks until the coordinator leases an individual.  Returns false when
+        * the run is over or the coordinator went away.  For the individuals of
+        * a steady-state run generation is -1 and individualData holds the
+        * individual, otherwise individualData is empty.
+        */
+        bool requestLease(int &generation,int &individual,string &populationFile,string &individualData);
+
+        void sendResult(int generation,int individual,float fitness);
+
+    protected:
+        bool readLine(string &line);
+
+        bool readBytes(int numBytes,string &data);
+
+        /**
+        * This class cannot be copied
+        */
+        EvaluationLeaseClient(const EvaluationLeaseClient &other)
+        {}
+
+        /**
+        * This class cannot be copied
+        */
+        const EvaluationLeaseClient &operator=(const EvaluationLeaseClient &other)
+        {
+            return *this;
+        }
+    };
+}
+
+#endif // HCUBE_EVALUATIONCOORDINATOR_H_INCLUDED
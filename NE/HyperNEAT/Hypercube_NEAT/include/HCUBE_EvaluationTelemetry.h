@@ -0,0 +1,117 @@
+#ifndef HCUBE_EVALUATIONTELEMETRY_H_INCLUDED
+#define HCUBE_EVALUATIONTELEMETRY_H_INCLUDED
+
+#include "HCUBE_Defines.h"
+
+#define EVALUATION_TELEMETRY_MAGIC (0x4C544E48)
+
+#define EVALUATION_TELEMETRY_VERSION (2)
+
+namespace HCUBE
+{
+    /**
+    * What a single evaluation of an individual scored and where its time went.
+    * All times are in microseconds and summed over the whole episode.
+    */
+    class EvaluationRecord
+    {
+    public:
+        int generation;
+        int individual;
+        //The seed of the random generator the episode was played with
+        uint seed;
+        int frames;
+        float score;
+        //Building the network from the genome
+        long long substrateUsec;
+        //Activating the network, divide by frames for the time per frame
+        long long networkUsec;
+        //Running the emulator and copying the screen and ram
+        long long emulationUsec;
+        //Finding the objects on the screen
+        long long visProcUsec;
+        //Why the episode ended, an AtariEpisodeEnd.  0 is game over.
+        int episodeEnd;
+
+        EvaluationRecord();
+
+        /**
+        * Copies everything but the generation, individual and seed, which the
+        * experiment that played the episode does not know.
+        */
+        void copyEpisode(const EvaluationRecord &other);
+
+        /**
+        * Adds the frames and times of another episode of the same individual.
+        * Keeps the end of the last episode that was stopped early.
+        */
+        void addEpisode(const EvaluationRecord &other);
+    };
+
+    /**
+    * EvaluationTelemetry appends EvaluationRecords to a binary log file.
+    *
+    * Records are buffered and written in chunks.  Every chunk starts with four
+    * uint32s: EVALUATION_TELEMETRY_MAGIC, EVALUATION_TELEMETRY_VERSION, the
+    * number of records n and the number of bytes that follow.  After that
+    * each field of EvaluationRecord is stored as one column of n values, in
+    * the order they are declared: int32 generation, int32 individual,
+    * uint32 seed, int32 frames, float32 score, int64 for the four times and
+    * int32 episodeEnd, all in the byte order of the writing machine.  Version
+    * 1 chunks have no episodeEnd column.
+    *
+    * A chunk is written with a single write() to a file opened for appending,
+    * so workers on the same machine can share one log.  out/telemetry.py
+    * reads it.
+    */
+    class EvaluationTelemetry
+    {
+    protected:
+        int fileHandle;
+        int chunkSize;
+        vector<EvaluationRecord> records;
+
+    public:
+        /**
+        * Opens fileName for appending.  Throws if it cannot be opened.
+        */
+        EvaluationTelemetry(const string &fileName,int _chunkSize=64);
+
+        /**
+        * Writes the records that are still buffered.
+        */
+        virtual ~EvaluationTelemetry();
+
+        void addRecord(const EvaluationRecord &record);
+
+        void flush();
+
+        /**
+        * The wall clock time, for timing the stages of an evaluation.
+        */
+        static long long getMicroseconds();
+
+    protected:
+        template<class T>
+        static void appendColumn(string &buffer,const T &value)
+        {
+            buffer.append((const char*)&value,sizeof(T));
+        }
+
+        /**
+        * This class cannot be copied
+        */
+        EvaluationTelemetry(const EvaluationTelemetry &other)
+        {}
+
+        /**
+        * This class cannot be copied
+        */
+        const EvaluationTelemetry &operator=(const EvaluationTelemetry &other)
+        {
+            return *this;
+        }
+    };
+}
+
+#endif // HCUBE_EVALUATIONTELEMETRY_H_INCLUDED
@@ -2,6 +2,8 @@
 #define HCUBE_EXPERIMENTRUN_H_INCLUDED
 
 #include "HCUBE_Defines.h"
+#include "HCUBE_EvaluationCoordinator.h"
+#include "HCUBE_EvaluationTelemetry.h"
 
 namespace HCUBE
 {
@@ -10,7 +12,7 @@ namespace HCUBE
     * and functions to pull information from a run of an experiment and control the experiment while
     * it is running.
     */
-    class ExperimentRun
+    class ExperimentRun : public SteadyStateBreeder
     {
     public:
     protected:
@@ -30,6 +32,29 @@ namespace HCUBE
 
         string outputFileName;
 
+        //Steady-state offspring that are being evaluated, by coordinator individual ID
+        map<int,shared_ptr<NEAT::GeneticIndividual> > steadyStateIndividuals;
+        int steadyStateAdded;
+        int steadyStateMaxGenerations;
+        string steadyStateResultsDir;
+        //The population file served to the workers and the generation files it depends on
+        vector<string> steadyStatePopulationFiles;
+
+        //The generations as they were last written to or read from a generation file.
+        //The next generation file is written as the difference to these.
+        vector<shared_ptr<NEAT::GeneticGeneration> > savedGenerations;
+        //That generation file and the files it depends on, starting with the keyframe
+        vector<string> savedDeltaChain;
+        //Generation files that are kept until no delta depends on them anymore
+        vector<string> obsoleteGenerationFiles;
+
+        //Where the ROM-dependent topology of the experiments is cached, empty to always read the ROM
+        string topologyFile;
+
+        //The episodes played by the last call to evaluateIndividual
+        EvaluationRecord evaluationRecord;
+        bool hasEvaluationRecord;
+
     public:
         ExperimentRun();
 
@@ -54,6 +79,16 @@ namespace HCUBE
             return experiments[0];
         }
 
+        inline shared_ptr<Experiment> getExperiment(int experimentNum)
+        {
+            return experiments[experimentNum];
+        }
+
+        inline void setTopologyFile(const string &_topologyFile)
+        {
+            topologyFile = _topologyFile;
+        }
+
         inline void setActiveExperiment(int experimentNum)
         {
             if (experimentNum < 0 || experimentNum >= experiments.size())
@@ -124,6 +159,24 @@ namespace HCUBE
         void startCondor();
         void start();
 
+        /**
+         * This function runs the experiment with atari_evaluate workers that
+         * lease individuals from an EvaluationCoordinator listening on port.
+         * Each generation is written to resultsDir once, the fitness comes back
+         * over the network and the next generation is produced as soon as the
+         * last result arrives.  Blocks until maxGenerations is reached.
+         *
+         * If the SteadyStateEvolution parameter is set only the first generation
+         * is evaluated this way.  After that an offspring is bred whenever a
+         * worker is idle and replaces the worst individual as soon as its fitness
+         * arrives, so slow evaluations never hold up the other workers.
+         */
+        void startCoordinator(int port, string resultsDir, int maxGenerations,
+                              string rom_file, string populationFile);
+
+        virtual void breedIndividual(int individualID, string &individualData);
+        virtual bool addResult(int individualID, float fitness);
+
         /**
         * This function initializes an experiment given the experiment type ID.
         * This is for beginning a new run from generation 0.
@@ -139,9 +192,24 @@ namespace HCUBE
         */
         void createPopulationFromCondorRun(string populationFile, string fitnessFunctionPrefix,
                                            string evaluationFile, string rom_file);
+
+        /**
+        * This function assigns the fitness of every individual in the current
+        * generation, performing the hybrid switch when it is due.
+        */
+        void setFitnesses(const vector<float> &fitnesses, string evaluationFile, string rom_file);
         void createPopulation(string populationString="");
         void convertPopulation(string rom_file);
 
+        /**
+        * This function initializes an experiment for rom_file.  If the topology
+        * file holds the topology for this experiment type and ROM, the experiment
+        * is set up from it without loading the ROM, and rom_file may be empty.
+        * Otherwise the ROM is loaded and the topology file is written for the
+        * next time.
+        */
+        void initializeExperimentTopology(int experimentNum, string rom_file);
+
         /**
         * This function calls the preprocess function for the experiment on every individual
         * in the population.  This is currently used in scaling the individuals in between 
@@ -150,9 +218,35 @@ namespace HCUBE
         void preprocessPopulation();
 
         /**
-        * This function evaluates all individuals in the population
+        * This function evaluates a single individual.  With EvaluationEpisodes
+        * above 1 it plays up to that many episodes, each with its own seed, and
+        * returns their mean.  With RacingConfidence above 0 it stops as soon as
+        * the upper confidence bound of the mean, that many standard errors above
+        * it, falls below RacingThreshold.  RacingMinEpisodes (default 2) are
+        * always played.  An individual is stopped because it did badly, so the
+        * mean of a stopped individual is biased low: racing trades accuracy on
+        * individuals that would not survive for the episodes it saves.
         */
         virtual float evaluateIndividual(unsigned int individualId);
+        virtual float evaluateIndividual(shared_ptr<NEAT::GeneticIndividual> individual);
+
+        /**
+        * Fills in the frames and stage times summed over the episodes of the
+        * last evaluated individual, and its fitness as the score.  Returns false
+        * if the experiment does not keep them.
+        */
+        bool getEvaluationRecord(EvaluationRecord &record);
+
+        /**
+        * Sets RacingThreshold to the lowest fitness in the top SurvivalThreshold
+        * of the evaluated generation, for racing the evaluations of the next one.
+        */
+        void updateRacingThreshold(const vector<float> &fitnesses);
+
+        /**
+        * Returns true if the scores show the individual cannot reach RacingThreshold.
+        */
+        static bool isHopeless(const vector<float> &scores, int maxEpisodes);
         virtual void evaluatePopulation();
 
         /**
@@ -171,11 +265,30 @@ namespace HCUBE
             return populationMutex;
         }
 
-        // Saves and loads the population using boost serialization
+        // Saves and loads the population using boost serialization.  loadPopulationBoost
+        // also reads the delta-encoded files written by saveGenerationFile.
         void loadPopulationBoost(string filename);
         void savePopulationBoost(string filename);
 
+        /**
+        * Writes the population as a generation file.  Only the changes since the last
+        * generation file are stored, with a full keyframe every GenerationKeyframeInterval
+        * files (10 by default), so loading never has to follow a long chain of files.
+        */
+        void saveGenerationFile(string filename);
+
+        /**
+        * Removes a generation file, or defers that until the next keyframe if the
+        * last generation file still depends on it.
+        */
+        void removeGenerationFile(string filename);
+
+        static string getGenerationFileName(string resultsDir, int generation);
+
     protected:
+        void evolveSteadyState(EvaluationCoordinator &coordinator, string resultsDir,
+                               int maxGenerations, string populationFile);
+
         /**
         * This class cannot be copied
         */
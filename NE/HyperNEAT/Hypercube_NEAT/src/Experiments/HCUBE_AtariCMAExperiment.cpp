@@ -1,6 +1,8 @@
 #include "HCUBE_Defines.h"
 
 #include "Experiments/HCUBE_AtariCMAExperiment.h"
+#include "Experiments/HCUBE_AtariEpisodeBudget.h"
+#include "Experiments/HCUBE_TopologyDescriptor.h"
 #include "Experiments/HCUBE_AtariExperiment.h"
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
@@ -57,6 +59,23 @@ namespace HCUBE
         // TODO: Maybe it is p.remove_leaf();
     }
 
+    bool AtariCMAExperiment::exportTopology(TopologyDescriptor &descriptor) {
+        descriptor.numActions = numActions;
+        descriptor.numObjClasses = numObjClasses;
+        descriptor.substrateWidth = substrate_width;
+        descriptor.substrateHeight = substrate_height;
+        descriptor.layerInfo = layerInfo;
+        return true;
+    }
+
+    void AtariCMAExperiment::importTopology(const TopologyDescriptor &descriptor) {
+        numActions = descriptor.numActions;
+        numObjClasses = descriptor.numObjClasses;
+        substrate_width = descriptor.substrateWidth;
+        substrate_height = descriptor.substrateHeight;
+        initializeTopology();
+    }
+
     void AtariCMAExperiment::initializeTopology() {
         // One input layer for each object class, plus an extra one for the self object
         for (int i=0; i<=numObjClasses; ++i) {
@@ -206,8 +225,10 @@ namespace HCUBE
     void AtariCMAExperiment::runAtariEpisode(shared_ptr<NEAT::GeneticIndividual> individual) {
         // Reset the game
         ale.reset_game();
+        AtariEpisodeBudget budget;
+        budget.startEpisode(ale);
         
-        while (!ale.game_over()) {
+        while (!ale.game_over() && !budget.isExhausted(ale)) {
             // Set value of all nodes to zero
             substrate.reinitialize(); 
             substrate.dummyActivation();
@@ -216,7 +237,7 @@ namespace HCUBE
 
             // Propagate values through the ANN
             // This is necessary to fully propagate through the different layers
-            substrate.updateFixedIterations(2);
+            substrate.updateSparse(activeInputs, 2);
 
             //printLayerInfo();
 
@@ -225,12 +246,17 @@ namespace HCUBE
             ale.act(action);
         }
         cout << "Game ended in " << ale.frame << " frames with score " << ale.game_score << endl;
+        if (budget.getEnd() != ATARI_EPISODE_GAME_OVER) {
+            cout << "Episode stopped early: " << AtariEpisodeBudget::getEndName(budget.getEnd()) << endl;
+        }
  
         // Give the reward to the agent
         individual->reward(ale.game_score);
     }
 
     void AtariCMAExperiment::setSubstrateValues() {
+        activeInputs.clear();
+
         // Set substrate value for all objects (of a certain size)
         setSubstrateObjectValues(*visProc);
 
@@ -254,7 +280,10 @@ namespace HCUBE
             point obj_centroid = visProc.composite_objs[obj_id].get_centroid();
             int adj_x = obj_centroid.x * substrate_width / visProc.screen_width;
             int adj_y = obj_centroid.y * substrate_height / visProc.screen_height;
-            substrate.setValue(nameLookup[Node(substrate_width*substrateIndx+adj_x,adj_y,0)], assigned_value);
+            int nodeIndex = substrate.getNodeIndex(nameLookup[Node(substrate_width*substrateIndx+adj_x,adj_y,0)]);
+            if (substrate.getValue(nodeIndex) == 0)
+                activeInputs.push_back(nodeIndex);
+            substrate.setValue(nodeIndex, assigned_value);
         }
     }
 
@@ -0,0 +1,110 @@
+#include "HCUBE_Defines.h"
+
+#include "Experiments/HCUBE_AtariEpisodeBudget.h"
+#include "HCUBE_EvaluationTelemetry.h"
+
+namespace HCUBE
+{
+    long long AtariEpisodeBudget::generationDeadlineUsec = 0;
+
+    static int getBudgetParameter(const char *name) {
+        if (!NEAT::Globals::getSingleton()->hasParameterValue(name)) {
+            return 0;
+        }
+        return max(0, int(NEAT::Globals::getSingleton()->getParameterValue(name) + 0.001));
+    }
+
+    AtariEpisodeBudget::AtariEpisodeBudget():
+        maxFrames(getBudgetParameter("EpisodeMaxFrames")), maxUsec(0),
+        stallScoreFrames(getBudgetParameter("StallScoreFrames")), stallRamFrames(getBudgetParameter("StallRamFrames")),
+        startUsec(0), lastScore(0), lastScoreFrame(0), lastRamHash(0), lastRamFrame(0), end(ATARI_EPISODE_GAME_OVER)
+    {
+        if (NEAT::Globals::getSingleton()->hasParameterValue("EpisodeMaxSeconds")) {
+            maxUsec = (long long)(NEAT::Globals::getSingleton()->getParameterValue("EpisodeMaxSeconds") * 1e6);
+        }
+    }
+
+    void AtariEpisodeBudget::startEpisode(ALEInterface &ale) {
+        startUsec = EvaluationTelemetry::getMicroseconds();
+        lastScore = ale.game_score;
+        lastScoreFrame = ale.frame;
+        lastRamHash = stallRamFrames > 0 ? hashRam(ale.ram_content) : 0;
+        lastRamFrame = ale.frame;
+        end = ATARI_EPISODE_GAME_OVER;
+    }
+
+    bool AtariEpisodeBudget::isExhausted(ALEInterface &ale) {
+        if (maxFrames > 0 && ale.frame >= maxFrames) {
+            end = ATARI_EPISODE_FRAME_LIMIT;
+            return true;
+        }
+
+        if (ale.game_score != lastScore) {
+            lastScore = ale.game_score;
+            lastScoreFrame = ale.frame;
+        } else if (stallScoreFrames > 0 && ale.frame - lastScoreFrame >= stallScoreFrames) {
+            end = ATARI_EPISODE_STALLED;
+            return true;
+        }
+
+        if (stallRamFrames > 0) {
+            ulong ramHash = hashRam(ale.ram_content);
+            if (ramHash != lastRamHash) {
+                lastRamHash = ramHash;
+                lastRamFrame = ale.frame;
+            } else if (ale.frame - lastRamFrame >= stallRamFrames) {
+                end = ATARI_EPISODE_STALLED;
+                return true;
+            }
+        }
+
+        if (maxUsec > 0 || generationDeadlineUsec > 0) {
+            long long now = EvaluationTelemetry::getMicroseconds();
+            if (maxUsec > 0 && now - startUsec >= maxUsec) {
+                end = ATARI_EPISODE_TIME_LIMIT;
+                return true;
+            }
+            if (generationDeadlineUsec > 0 && now >= generationDeadlineUsec) {
+                end = ATARI_EPISODE_GENERATION_LIMIT;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    const char *AtariEpisodeBudget::getEndName(AtariEpisodeEnd end) {
+        switch (end) {
+        case ATARI_EPISODE_GAME_OVER:
+            return "game over";
+        case ATARI_EPISODE_FRAME_LIMIT:
+            return "frame limit";
+        case ATARI_EPISODE_TIME_LIMIT:
+            return "time limit";
+        case ATARI_EPISODE_STALLED:
+            return "stalled";
+        case ATARI_EPISODE_GENERATION_LIMIT:
+            return "generation time limit";
+        }
+        return "unknown";
+    }
+
+    void AtariEpisodeBudget::setGenerationDeadline(long long generationStartUsec) {
+        generationDeadlineUsec = 0;
+        if (generationStartUsec > 0 && NEAT::Globals::getSingleton()->hasParameterValue("GenerationMaxSeconds") &&
+            NEAT::Globals::getSingleton()->getParameterValue("GenerationMaxSeconds") > 0) {
+            generationDeadlineUsec = generationStartUsec +
+                (long long)(NEAT::Globals::getSingleton()->getParameterValue("GenerationMaxSeconds") * 1e6);
+        }
+    }
+
+    ulong AtariEpisodeBudget::hashRam(const IntVect &ram) {
+        // FNV-1a over the 128 bytes of RAM
+        ulong hash = 14695981039346656037ULL;
+        for (int i=0; i<int(ram.size()); i++) {
+            hash ^= ulong(ram[i] & 0xff);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
@@ -4,6 +4,8 @@
 #include "HCUBE_Defines.h"
 
 #include "Experiments/HCUBE_AtariExperiment.h"
+#include "Experiments/HCUBE_AtariEpisodeBudget.h"
+#include "Experiments/HCUBE_TopologyDescriptor.h"
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -13,12 +15,16 @@ namespace HCUBE
 {
     AtariExperiment::AtariExperiment(string _experimentName,int _threadID):
         Experiment(_experimentName,_threadID), substrate_width(8), substrate_height(10), visProc(NULL),
-        rom_file(""), numActions(0), numObjClasses(0), display_active(false), outputLayerIndx(-1), epsilon(0)
+        rom_file(""), numActions(0), numObjClasses(0), display_active(false), outputLayerIndx(-1), epsilon(0),
+        sparseInputs(false), deltaRefreshFrames(0)
     {
         if (NEAT::Globals::getSingleton()->hasParameterValue("epsilon")) {
             epsilon = NEAT::Globals::getSingleton()->getParameterValue("epsilon");
         }
         cout << "Using epsilon: " << epsilon << endl;
+        if (NEAT::Globals::getSingleton()->hasParameterValue("DeltaRefreshFrames")) {
+            deltaRefreshFrames = int(NEAT::Globals::getSingleton()->getParameterValue("DeltaRefreshFrames") + 0.001);
+        }
     }
 
     void AtariExperiment::initializeExperiment(string rom_file) {
@@ -42,6 +48,7 @@ namespace HCUBE
             exit(-1);
         }
         numActions = ale.legal_actions.size();
+        ale.profile_stages = true;
 
         if (processScreen) {
             // Load the visual processing framework
@@ -54,6 +61,23 @@ namespace HCUBE
         }
     }
 
+    bool AtariExperiment::exportTopology(TopologyDescriptor &descriptor) {
+        descriptor.numActions = numActions;
+        descriptor.numObjClasses = numObjClasses;
+        descriptor.substrateWidth = substrate_width;
+        descriptor.substrateHeight = substrate_height;
+        descriptor.layerInfo = layerInfo;
+        return true;
+    }
+
+    void AtariExperiment::importTopology(const TopologyDescriptor &descriptor) {
+        numActions = descriptor.numActions;
+        numObjClasses = descriptor.numObjClasses;
+        substrate_width = descriptor.substrateWidth;
+        substrate_height = descriptor.substrateHeight;
+        initializeTopology();
+    }
+
     void AtariExperiment::initializeTopology() {
         // Clear old layerinfo if present
         layerInfo.layerNames.clear();
@@ -144,27 +168,47 @@ namespace HCUBE
     {
         shared_ptr<NEAT::GeneticIndividual> individual = group.front();
         individual->setFitness(0);
-        clock_t start = clock();
+        long long start = EvaluationTelemetry::getMicroseconds();
         substrate.populateSubstrate(individual);
-        clock_t end = clock();
+        long long substrateUsec = EvaluationTelemetry::getMicroseconds() - start;
         cout << "Populated Substrate Size (" << substrate_width << "x" << substrate_height <<") in "
-             << float(end-start)/CLOCKS_PER_SEC << " seconds." << endl;
+             << substrateUsec/1e6 << " seconds." << endl;
         float score = runAtariEpisode(&substrate);
+        lastEvaluation.substrateUsec = substrateUsec;
         individual->reward(score);
     }
 
     float AtariExperiment::runAtariEpisode(NEAT::LayeredSubstrate<float>* substrate) {
         ale.reset_game();
+        ale.reset_stage_timers();
+        AtariEpisodeBudget budget;
+        budget.startEpisode(ale);
+        long long networkUsec = 0;
         
-        while (!ale.game_over()) {
-            // Set value of all nodes to zero
-            substrate->getNetwork()->reinitialize(); 
-            substrate->getNetwork()->dummyActivation();
+        substrate->getNetwork()->reinitialize();
+        activeInputs.clear();
+
+        while (!ale.game_over() && !budget.isExhausted(ale)) {
+            // Set value of all nodes to zero.  The delta update keeps the values
+            // of the last frame instead and only the painted inputs are cleared.
+            if (deltaRefreshFrames <= 0) {
+                substrate->getNetwork()->reinitialize(); 
+                substrate->getNetwork()->dummyActivation();
+            }
 
+            sparseInputs = false;
             setSubstrateValues(substrate);
 
             // Propagate values through the ANN
-            substrate->getNetwork()->update();
+            long long start = EvaluationTelemetry::getMicroseconds();
+            if (sparseInputs && deltaRefreshFrames > 0) {
+                substrate->getNetwork()->updateDelta(activeInputs, deltaRefreshFrames);
+            } else if (sparseInputs) {
+                substrate->getNetwork()->updateSparse(activeInputs);
+            } else {
+                substrate->getNetwork()->update();
+            }
+            networkUsec += EvaluationTelemetry::getMicroseconds() - start;
 
             // Print the Activations of the different layers
             //printLayerInfo(substrate);
@@ -178,16 +222,42 @@ namespace HCUBE
             }
         }
         cout << "Game ended in " << ale.frame << " frames with score " << ale.game_score << endl;
+        if (budget.getEnd() != ATARI_EPISODE_GAME_OVER) {
+            cout << "Episode stopped early: " << AtariEpisodeBudget::getEndName(budget.getEnd()) << endl;
+        }
+
+        lastEvaluation = EvaluationRecord();
+        lastEvaluation.frames = ale.frame;
+        lastEvaluation.score = ale.game_score;
+        lastEvaluation.networkUsec = networkUsec;
+        lastEvaluation.emulationUsec = ale.emulation_usec + ale.screen_usec;
+        lastEvaluation.visProcUsec = ale.vis_proc_usec;
+        lastEvaluation.episodeEnd = budget.getEnd();
  
         return ale.game_score;
     }
 
+    bool AtariExperiment::getEvaluationRecord(EvaluationRecord &record) {
+        record.copyEpisode(lastEvaluation);
+        return true;
+    }
+
     void AtariExperiment::setSubstrateValues(NEAT::LayeredSubstrate<float>* substrate) {
+        // Clear the inputs of the last frame, which are still set if the network
+        // was not reinitialized
+        for (int i=0; i<int(activeInputs.size()); i++) {
+            substrate->setValue(activeInputs[i], 0);
+        }
+        activeInputs.clear();
+
         // Set substrate value for all objects (of a certain size)
         setSubstrateObjectValues(*visProc, substrate);
 
         // Set substrate value for self
         setSubstrateSelfValue(*visProc, substrate);
+
+        // Only a few objects are on screen, so the network can skip the zero inputs
+        sparseInputs = true;
     }
 
     void AtariExperiment::setSubstrateObjectValues(VisualProcessor& visProc,
@@ -215,7 +285,11 @@ namespace HCUBE
             //         substrate->setValue(Node(x,y,i),substrate->getValue(Node(x,y,i))+val);
             //     }
             // }
-            substrate->setValue((Node(adj_x,adj_y,substrateIndx)),assigned_value);
+            Node node(adj_x,adj_y,substrateIndx);
+            // The valid sizes are the full layer sizes, so this is also the network node
+            if (substrate->getValue(node) == 0)
+                activeInputs.push_back(node);
+            substrate->setValue(node,assigned_value);
         }
     }
 
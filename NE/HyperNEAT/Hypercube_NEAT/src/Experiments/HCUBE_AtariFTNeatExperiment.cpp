@@ -4,6 +4,8 @@
 #include "HCUBE_Defines.h"
 
 #include "Experiments/HCUBE_AtariFTNeatExperiment.h"
+#include "Experiments/HCUBE_AtariEpisodeBudget.h"
+#include "Experiments/HCUBE_TopologyDescriptor.h"
 #include "Experiments/HCUBE_AtariExperiment.h"
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
@@ -14,7 +16,8 @@ namespace HCUBE
 {
     AtariFTNeatExperiment::AtariFTNeatExperiment(string _experimentName,int _threadID):
         Experiment(_experimentName,_threadID), visProc(NULL), rom_file(""),
-        numActions(0), numObjClasses(0), display_active(false)
+        numActions(0), numObjClasses(0), display_active(false), sparseInputs(false),
+        layeredSubstrate(false)
     {
     }
 
@@ -42,6 +45,7 @@ namespace HCUBE
             exit(-1);
         }
         numActions = ale.legal_actions.size();
+        ale.profile_stages = true;
 
         if (processScreen) {
             // Load the visual processing framework
@@ -54,6 +58,28 @@ namespace HCUBE
         }
     }
 
+    bool AtariFTNeatExperiment::exportTopology(TopologyDescriptor &descriptor) {
+        descriptor.numActions = numActions;
+        descriptor.numObjClasses = numObjClasses;
+        descriptor.substrateWidth = substrate_width;
+        descriptor.substrateHeight = substrate_height;
+        descriptor.layerInfo = layerInfo;
+        return true;
+    }
+
+    void AtariFTNeatExperiment::importTopology(const TopologyDescriptor &descriptor) {
+        numActions = descriptor.numActions;
+        numObjClasses = descriptor.numObjClasses;
+        substrate_width = descriptor.substrateWidth;
+        substrate_height = descriptor.substrateHeight;
+        initializeTopology();
+    }
+
+    bool AtariFTNeatExperiment::getEvaluationRecord(EvaluationRecord &record) {
+        record.copyEpisode(lastEvaluation);
+        return true;
+    }
+
     void AtariFTNeatExperiment::initializeTopology() {
         // One input layer for each object class, plus an extra one for the self object
         for (int i=0; i<=numObjClasses; ++i) {
@@ -271,24 +297,44 @@ namespace HCUBE
     void AtariFTNeatExperiment::evaluateIndividual(shared_ptr<GeneticIndividual> individual)
     {
         individual->setFitness(0);
+        long long start = EvaluationTelemetry::getMicroseconds();
         substrate = individual->spawnFastPhenotypeStack<float>();
+        indexSubstrate();
+        // Two iterations of the relaxation reach from the inputs through the processing
+        // layer to the outputs, only genomes with more hidden structure need them all
+        layeredSubstrate = substrate.compileLayered(2);
+        long long substrateUsec = EvaluationTelemetry::getMicroseconds() - start;
         runAtariEpisode(individual);
+        lastEvaluation.substrateUsec = substrateUsec;
     }
 
     void AtariFTNeatExperiment::runAtariEpisode(shared_ptr<NEAT::GeneticIndividual> individual) {
         // Reset the game
         ale.reset_game();
+        ale.reset_stage_timers();
+        AtariEpisodeBudget budget;
+        budget.startEpisode(ale);
+        long long networkUsec = 0;
         
-        while (!ale.game_over()) {
+        while (!ale.game_over() && !budget.isExhausted(ale)) {
             // Set value of all nodes to zero
             substrate.reinitialize(); 
             substrate.dummyActivation();
 
+            sparseInputs = false;
             setSubstrateValues();
 
             // Propagate values through the ANN
             // This is necessary to fully propagate through the different layers
-            substrate.updateFixedIterations(2);
+            long long start = EvaluationTelemetry::getMicroseconds();
+            if (sparseInputs && layeredSubstrate) {
+                substrate.updateLayered(activeInputs);
+            } else if (sparseInputs) {
+                substrate.updateSparse(activeInputs, 2);
+            } else {
+                substrate.updateFixedIterations(2);
+            }
+            networkUsec += EvaluationTelemetry::getMicroseconds() - start;
 
             //printLayerInfo();
 
@@ -297,17 +343,32 @@ namespace HCUBE
             ale.act(action);
         }
         cout << "Game ended in " << ale.frame << " frames with score " << ale.game_score << endl;
+        if (budget.getEnd() != ATARI_EPISODE_GAME_OVER) {
+            cout << "Episode stopped early: " << AtariEpisodeBudget::getEndName(budget.getEnd()) << endl;
+        }
+
+        lastEvaluation = EvaluationRecord();
+        lastEvaluation.frames = ale.frame;
+        lastEvaluation.score = ale.game_score;
+        lastEvaluation.networkUsec = networkUsec;
+        lastEvaluation.emulationUsec = ale.emulation_usec + ale.screen_usec;
+        lastEvaluation.visProcUsec = ale.vis_proc_usec;
+        lastEvaluation.episodeEnd = budget.getEnd();
  
         // Give the reward to the agent
         individual->reward(ale.game_score);
     }
 
     void AtariFTNeatExperiment::setSubstrateValues() {
+        activeInputs.clear();
+
         // Set substrate value for all objects (of a certain size)
         setSubstrateObjectValues(*visProc);
 
         // Set substrate value for self
         setSubstrateSelfValue(*visProc);
+
+        sparseInputs = true;
     }
 
     void AtariFTNeatExperiment::setSubstrateObjectValues(VisualProcessor& visProc) {
@@ -326,7 +387,10 @@ namespace HCUBE
             point obj_centroid = visProc.composite_objs[obj_id].get_centroid();
             int adj_x = obj_centroid.x * substrate_width / visProc.screen_width;
             int adj_y = obj_centroid.y * substrate_height / visProc.screen_height;
-            substrate.setValue(nameLookup[Node(substrate_width*substrateIndx+adj_x,adj_y,0)], assigned_value);
+            int nodeIndex = inputNodeIndices[(substrateIndx*substrate_height+adj_y)*substrate_width+adj_x];
+            if (substrate.getValue(nodeIndex) == 0)
+                activeInputs.push_back(nodeIndex);
+            substrate.setValue(nodeIndex, assigned_value);
         }
     }
 
@@ -336,11 +400,30 @@ namespace HCUBE
         paintSubstrate(visProc, visProc.manual_self, numObjClasses);
     }
 
+    void AtariFTNeatExperiment::indexSubstrate() {
+        // Input layers the subclasses do not use are left at -1
+        inputNodeIndices.assign((numObjClasses+1)*substrate_height*substrate_width, -1);
+        for (int i=0; i<=numObjClasses; ++i) {
+            for (int y=0; y<substrate_height; y++) {
+                for (int x=0; x<substrate_width; x++) {
+                    map<Node,string>::iterator it = nameLookup.find(Node(substrate_width*i+x,y,0));
+                    if (it != nameLookup.end() && substrate.hasNode(it->second))
+                        inputNodeIndices[(i*substrate_height+y)*substrate_width+x] = substrate.getNodeIndex(it->second);
+                }
+            }
+        }
+
+        outputNodeIndices.resize(numActions);
+        for (int i=0; i<numActions; i++) {
+            outputNodeIndices[i] = substrate.getNodeIndex(nameLookup[Node(i,0,2)]);
+        }
+    }
+
     Action AtariFTNeatExperiment::selectAction(VisualProcessor& visProc) {
         vector<int> max_inds;
         float max_val = -1e37;
         for (int i=0; i < numActions; i++) {
-            float output = substrate.getValue(nameLookup[Node(i,0,2)]);
+            float output = substrate.getValue(outputNodeIndices[i]);
             if (output == max_val)
                 max_inds.push_back(i);
             else if (output > max_val) {
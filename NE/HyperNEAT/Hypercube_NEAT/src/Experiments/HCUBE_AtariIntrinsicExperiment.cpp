@@ -8,34 +8,51 @@ using namespace NEAT;
 
 namespace HCUBE
 {
+    void FeatureBits::getActive(std::vector<int>& active) const {
+        active.clear();
+        for (int i=0; i<int(words.size()); i++) {
+            for (ulong bits=words[i]; bits; bits&=bits-1) {
+#ifdef __GNUC__
+                active.push_back(i*64 + __builtin_ctzll(bits));
+#else
+                int bit = 0;
+                while (!((bits>>bit) & 1))
+                    bit++;
+                active.push_back(i*64 + bit);
+#endif
+            }
+        }
+    }
+
     SarsaLambda::SarsaLambda(int numFeatures, int numActions,
-                             float gamma, float alpha, float epsilon, float lambda):
-        numFeatures(numFeatures), numActions(numActions), gamma(gamma), alpha(alpha), epsilon(epsilon), lambda(lambda)
+                             float gamma, float alpha, float epsilon, float lambda, float traceCutoff):
+        numFeatures(numFeatures), numActions(numActions), gamma(gamma), alpha(alpha), epsilon(epsilon), lambda(lambda),
+        traceCutoff(traceCutoff), oldQ(0), reward(0)
     {
         // Initialize the SARSA(Lambda) vectors
-        for (int i=0; i<numFeatures*numActions; i++) {
-            w.push_back(0);
-            e.push_back(0);
-        }
+        w.assign(numFeatures*numActions, 0);
+        tracePositions.assign(numFeatures*numActions, -1);
     }
 
     void SarsaLambda::reset() {
         // Reset eligibility vector
-        for (int i=0; i<numFeatures*numActions; i++)
-            e[i] = 0;
+        for (int t=0; t<int(traceIndices.size()); t++)
+            tracePositions[traceIndices[t]] = -1;
+        traceIndices.clear();
+        traceValues.clear();
         reward = 0;
     }
 
-    int SarsaLambda::act(std::vector<bool>& currState, double lastActionReward) {
+    int SarsaLambda::act(const FeatureBits& currState, double lastActionReward) {
         assert(currState.size() == numFeatures);
 
-        vector<double> qVals;
-        for (int a=0; a<numActions; a++) {
-            double Q_a = 0;
-            for (int i=0; i<numFeatures; i++)
-                if (currState[i])
-                    Q_a += w[a*numFeatures+i];
-            qVals.push_back(Q_a);
+        // Only a few features are set, so Q is the sum of their rows of weights
+        currState.getActive(activeFeatures);
+        qVals.assign(numActions, 0);
+        for (int f=0; f<int(activeFeatures.size()); f++) {
+            const float* row = &w[activeFeatures[f]*numActions];
+            for (int a=0; a<numActions; a++)
+                qVals[a] += row[a];
         }
 
         int action = selectAction(qVals);
@@ -44,26 +61,53 @@ namespace HCUBE
         // Compute bellman error 
         double delta = lastActionReward + (gamma * Q) - oldQ;
 
-        // Update the weights
-        for (int i=0; i<numFeatures*numActions; i++) {
-            w[i] += alpha * delta * e[i];
+        // Update the weights, all others have a negligible trace
+        for (int t=0; t<int(traceIndices.size()); t++) {
+            w[traceIndices[t]] += alpha * delta * traceValues[t];
         }
                 
         // Decay the eligibility traces
-        for (int i=0; i<numFeatures*numActions; i++) {
-            e[i] *= gamma * lambda;
-        }
+        decayTraces(gamma * lambda);
 
         // Set the active features' eligibility traces to 1
-        for (int i=0; i<numFeatures; i++) {
-            if (currState[i])
-                e[numFeatures*action + i] = 1;
+        for (int f=0; f<int(activeFeatures.size()); f++) {
+            setTrace(activeFeatures[f]*numActions + action, 1);
         }
 
         oldQ = Q;
         return action;
     }
 
+    void SarsaLambda::setTrace(int weightIndex, float value) {
+        int position = tracePositions[weightIndex];
+        if (position < 0) {
+            tracePositions[weightIndex] = int(traceIndices.size());
+            traceIndices.push_back(weightIndex);
+            traceValues.push_back(value);
+        } else {
+            traceValues[position] = value;
+        }
+    }
+
+    void SarsaLambda::decayTraces(float decay) {
+        // Compact the list in place, dropping the traces below the cutoff
+        int kept = 0;
+        for (int t=0; t<int(traceIndices.size()); t++) {
+            int weightIndex = traceIndices[t];
+            float value = traceValues[t] * decay;
+            if (value < traceCutoff) {
+                tracePositions[weightIndex] = -1;
+            } else {
+                traceIndices[kept] = weightIndex;
+                traceValues[kept] = value;
+                tracePositions[weightIndex] = kept;
+                kept++;
+            }
+        }
+        traceIndices.resize(kept);
+        traceValues.resize(kept);
+    }
+
     int SarsaLambda::selectAction(vector<double>& qVals) {
         if (double(rand())/RAND_MAX < epsilon) {
             return rand() % numActions;
@@ -87,7 +131,8 @@ namespace HCUBE
         printf("Gamma %f alpha %f epsilon %f lambda %f\n",gamma,alpha,epsilon,lambda);
         cout << "Weight Vec: ";
         for (int i=0; i<numFeatures*numActions; i++) {
-            printf("%1.2f ",w[i]);
+            // In the order of action, then feature
+            printf("%1.2f ",w[(i%numFeatures)*numActions + i/numFeatures]);
             if (i%numFeatures == 0)
                 printf("\n");
         }
@@ -120,13 +165,6 @@ namespace HCUBE
             exit(-1);
         }
         numActions = ale.legal_actions.size();
-        numFeatures = substrate_width * substrate_height * (numObjClasses + 1);
-
-        for (int i=0; i<numFeatures; i++)
-            phi.push_back(0);
-
-        if (agent) delete agent;
-        agent = new SarsaLambda(numFeatures, numActions);
 
         // Load the visual processing framework
         visProc = ale.visProc;
@@ -136,6 +174,13 @@ namespace HCUBE
             exit(-1);
         }
 
+        // One feature per cell of every object class layer and the self layer
+        numFeatures = substrate_width * substrate_height * (numObjClasses + 1);
+        phi.resize(numFeatures);
+
+        if (agent) delete agent;
+        agent = new SarsaLambda(numFeatures, numActions);
+
         // One input layer for each object class, plus an extra one for the self object
         for (int i=0; i<=numObjClasses; ++i) {
             for (int y=0; y<substrate_height; y++) {
@@ -206,8 +251,7 @@ namespace HCUBE
             agent->reset();
         
             while (!ale.game_over()) {
-                for (int i=0; i<numFeatures; i++)
-                    phi[i] = false;
+                phi.clear();
 
                 // Set value of all nodes to zero
                 substrate.reinitialize(); 
@@ -259,7 +303,7 @@ namespace HCUBE
             int adj_y = obj_centroid.y * substrate_height / visProc.screen_height;
             substrate.setValue(nameLookup[Node(substrate_width*substrateIndx+adj_x,adj_y,0)], assigned_value);
             // Set the phi-feature to true
-            phi[(substrate_width*substrate_height*substrateIndx) + (substrate_width*adj_y) + adj_x] = true;
+            phi.set((substrate_width*substrate_height*substrateIndx) + (substrate_width*adj_y) + adj_x);
         }
     }
 
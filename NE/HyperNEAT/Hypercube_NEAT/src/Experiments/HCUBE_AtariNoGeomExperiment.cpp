@@ -4,6 +4,8 @@
 #include "HCUBE_Defines.h"
 
 #include "Experiments/HCUBE_AtariNoGeomExperiment.h"
+#include "Experiments/HCUBE_AtariEpisodeBudget.h"
+#include "Experiments/HCUBE_TopologyDescriptor.h"
 #include <boost/foreach.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -14,7 +16,7 @@ namespace HCUBE
     AtariNoGeomExperiment::AtariNoGeomExperiment(string _experimentName,int _threadID):
         Experiment(_experimentName,_threadID), visProc(NULL), rom_file(""),
         numActions(0), numObjClasses(0), display_active(false), epsilon(0),
-        last_action(Action(0))
+        last_action(Action(0)), sparseInputs(false), layeredSubstrate(false)
     {
         if (NEAT::Globals::getSingleton()->hasParameterValue("epsilon")) {
             epsilon = NEAT::Globals::getSingleton()->getParameterValue("epsilon");
@@ -43,6 +45,7 @@ namespace HCUBE
             exit(-1);
         }
         numActions = ale.legal_actions.size();
+        ale.profile_stages = true;
 
         // Load the visual processing framework
         if (processScreen) {
@@ -55,6 +58,28 @@ namespace HCUBE
         }
     }
 
+    bool AtariNoGeomExperiment::exportTopology(TopologyDescriptor &descriptor) {
+        descriptor.numActions = numActions;
+        descriptor.numObjClasses = numObjClasses;
+        descriptor.substrateWidth = substrate_width;
+        descriptor.substrateHeight = substrate_height;
+        descriptor.layerInfo = layerInfo;
+        return true;
+    }
+
+    void AtariNoGeomExperiment::importTopology(const TopologyDescriptor &descriptor) {
+        numActions = descriptor.numActions;
+        numObjClasses = descriptor.numObjClasses;
+        substrate_width = descriptor.substrateWidth;
+        substrate_height = descriptor.substrateHeight;
+        initializeTopology();
+    }
+
+    bool AtariNoGeomExperiment::getEvaluationRecord(EvaluationRecord &record) {
+        record.copyEpisode(lastEvaluation);
+        return true;
+    }
+
     void AtariNoGeomExperiment::initializeTopology() {
         substrate_width = 8;
         substrate_height = 10;
@@ -119,24 +144,42 @@ namespace HCUBE
         shared_ptr<NEAT::GeneticIndividual> individual = group.front();
         individual->setFitness(0);
 
+        long long start = EvaluationTelemetry::getMicroseconds();
         substrate = individual->spawnFastPhenotypeStack<double>();
+        indexSubstrate();
+        // update() runs a single iteration, so only genomes without hidden nodes
+        // are feed-forward within it
+        layeredSubstrate = substrate.compileLayered(1);
+        long long substrateUsec = EvaluationTelemetry::getMicroseconds() - start;
 
         runAtariEpisode(individual);
+        lastEvaluation.substrateUsec = substrateUsec;
     }
 
     void AtariNoGeomExperiment::runAtariEpisode(shared_ptr<NEAT::GeneticIndividual> individual) {
         // Reset the game
         ale.reset_game();
+        ale.reset_stage_timers();
+        AtariEpisodeBudget budget;
+        budget.startEpisode(ale);
+        long long networkUsec = 0;
         
-        while (!ale.game_over()) {
+        while (!ale.game_over() && !budget.isExhausted(ale)) {
             // Set value of all nodes to zero
             substrate.reinitialize(); 
             substrate.dummyActivation();
 
+            sparseInputs = false;
             setSubstrateValues();
 
             // Propagate values through the ANN
-            substrate.update();
+            long long start = EvaluationTelemetry::getMicroseconds();
+            if (sparseInputs && layeredSubstrate) {
+                substrate.updateLayered(activeInputs);
+            } else {
+                substrate.update();
+            }
+            networkUsec += EvaluationTelemetry::getMicroseconds() - start;
 
             //printLayerInfo();
 
@@ -151,6 +194,17 @@ namespace HCUBE
             }
         }
         cout << "Game ended in " << ale.frame << " frames with score " << ale.game_score << endl;
+        if (budget.getEnd() != ATARI_EPISODE_GAME_OVER) {
+            cout << "Episode stopped early: " << AtariEpisodeBudget::getEndName(budget.getEnd()) << endl;
+        }
+
+        lastEvaluation = EvaluationRecord();
+        lastEvaluation.frames = ale.frame;
+        lastEvaluation.score = ale.game_score;
+        lastEvaluation.networkUsec = networkUsec;
+        lastEvaluation.emulationUsec = ale.emulation_usec + ale.screen_usec;
+        lastEvaluation.visProcUsec = ale.vis_proc_usec;
+        lastEvaluation.episodeEnd = budget.getEnd();
  
         // Give the reward to the agent
         individual->reward(ale.game_score);
@@ -158,11 +212,15 @@ namespace HCUBE
 
 
     void AtariNoGeomExperiment::setSubstrateValues() {
+        activeInputs.clear();
+
         // Set substrate value for all objects (of a certain size)
         setSubstrateObjectValues(*visProc);
 
         // Set substrate value for self
         setSubstrateSelfValue(*visProc);
+
+        sparseInputs = true;
     }
 
 
@@ -182,7 +240,10 @@ namespace HCUBE
             point obj_centroid = visProc.composite_objs[obj_id].get_centroid();
             int adj_x = obj_centroid.x * substrate_width / visProc.screen_width;
             int adj_y = obj_centroid.y * substrate_height / visProc.screen_height;
-            substrate.setValue(nameLookup[Node(substrate_width*substrateIndx+adj_x,adj_y,0)], assigned_value);
+            int nodeIndex = inputNodeIndices[(substrateIndx*substrate_height+adj_y)*substrate_width+adj_x];
+            if (substrate.getValue(nodeIndex) == 0)
+                activeInputs.push_back(nodeIndex);
+            substrate.setValue(nodeIndex, assigned_value);
         }
     }
 
@@ -192,11 +253,30 @@ namespace HCUBE
         paintSubstrate(visProc, visProc.manual_self, numObjClasses);
     }
 
+    void AtariNoGeomExperiment::indexSubstrate() {
+        // Input layers the subclasses do not use are left at -1
+        inputNodeIndices.assign((numObjClasses+1)*substrate_height*substrate_width, -1);
+        for (int i=0; i<=numObjClasses; ++i) {
+            for (int y=0; y<substrate_height; y++) {
+                for (int x=0; x<substrate_width; x++) {
+                    map<Node,string>::iterator it = nameLookup.find(Node(substrate_width*i+x,y,0));
+                    if (it != nameLookup.end() && substrate.hasNode(it->second))
+                        inputNodeIndices[(i*substrate_height+y)*substrate_width+x] = substrate.getNodeIndex(it->second);
+                }
+            }
+        }
+
+        outputNodeIndices.resize(numActions);
+        for (int i=0; i<numActions; i++) {
+            outputNodeIndices[i] = substrate.getNodeIndex(nameLookup[Node(i,0,2)]);
+        }
+    }
+
     Action AtariNoGeomExperiment::selectAction(VisualProcessor& visProc) {
         vector<int> max_inds;
         float max_val = -1e37;
         for (int i=0; i < numActions; i++) {
-            float output = substrate.getValue(nameLookup[Node(i,0,2)]);
+            float output = substrate.getValue(outputNodeIndices[i]);
             if (output == max_val)
                 max_inds.push_back(i);
             else if (output > max_val) {
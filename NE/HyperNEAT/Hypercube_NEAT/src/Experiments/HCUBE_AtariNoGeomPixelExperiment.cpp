@@ -57,6 +57,15 @@ namespace HCUBE
         substrate_width = ale.screen_width / 10;
         substrate_height = ale.screen_height / 10;
 
+        uInt8 planeMap[256];
+        for (int i=0; i<256; i++) {
+            planeMap[i] = eightBitPallete[i];
+        }
+        screenPreprocessor = ScreenPreprocessor(ale.screen_width, ale.screen_height,
+                                                substrate_width, substrate_height,
+                                                planeMap, numColors);
+        pooledScreen.resize(numColors * substrate_width * substrate_height);
+
         initializeTopology();
     }
 
@@ -115,15 +124,21 @@ namespace HCUBE
     }
 
     void AtariNoGeomPixelExperiment::setSubstrateValues() {
-        for (int y=0; y<ale.screen_height; y++) {
-            for (int x=0; x<ale.screen_width; x++) {
-                int substrate_y = min(int((y / float(ale.screen_height)) * substrate_width), substrate_height-1);
-                int substrate_x = min(int((x / float(ale.screen_width)) * substrate_width), substrate_width-1);
-                uInt32 eightBitVal = eightBitPallete[ale.screen_matrix[y][x]];
-                assert(eightBitVal < numColors);
-                assert(substrate_x < substrate_width);
-                assert(substrate_y < substrate_height);
-                substrate.setValue(nameLookup[Node(substrate_width*eightBitVal+substrate_x,substrate_y,0)], 1.0);
+        int planeSize = substrate_width * substrate_height;
+        float* planes[numColors];
+        for (int i=0; i<numColors; i++) {
+            planes[i] = &pooledScreen[i * planeSize];
+        }
+        screenPreprocessor.process(&ale.screen_buffer[0], planes, ScreenPreprocessor::POOL_MAX, false);
+
+        // Only the occupied cells need to be set, the rest were zeroed by reinitialize()
+        for (int i=0; i<numColors; i++) {
+            for (int y=0; y<substrate_height; y++) {
+                for (int x=0; x<substrate_width; x++) {
+                    if (planes[i][y * substrate_width + x] > 0) {
+                        substrate.setValue(nameLookup[Node(substrate_width*i+x,y,0)], 1.0);
+                    }
+                }
             }
         }
     }
@@ -49,8 +49,17 @@ namespace HCUBE
 
 
     AtariPixelExperiment::AtariPixelExperiment(string _experimentName,int _threadID):
-        AtariExperiment(_experimentName,_threadID)
-    {}
+        AtariExperiment(_experimentName,_threadID), poolingMode(ScreenPreprocessor::POOL_MAX),
+        poolFrames(false)
+    {
+        if (NEAT::Globals::getSingleton()->hasParameterValue("PixelAreaPooling") &&
+            NEAT::Globals::getSingleton()->getParameterValue("PixelAreaPooling") > 0.5) {
+            poolingMode = ScreenPreprocessor::POOL_AREA;
+        }
+        if (NEAT::Globals::getSingleton()->hasParameterValue("PixelFramePooling")) {
+            poolFrames = NEAT::Globals::getSingleton()->getParameterValue("PixelFramePooling") > 0.5;
+        }
+    }
 
     void AtariPixelExperiment::initializeExperiment(string rom_file) {
         initializeALE(rom_file, false); // No screen processing necessary
@@ -59,9 +68,20 @@ namespace HCUBE
         substrate_width = ale.screen_width / 10;
         substrate_height = ale.screen_height / 10;
 
+        initializeScreenPreprocessor();
         initializeTopology();
     }
 
+    void AtariPixelExperiment::initializeScreenPreprocessor() {
+        uInt8 planeMap[256];
+        for (int i=0; i<256; i++) {
+            planeMap[i] = eightBitPallete[i];
+        }
+        screenPreprocessor = ScreenPreprocessor(ale.screen_width, ale.screen_height,
+                                                substrate_width, substrate_height,
+                                                planeMap, numColors);
+    }
+
     // Schrum: Added to allow for more generality
     void AtariPixelExperiment::setProcessingLayers(int num) {
 	numProcessingLayers = num;
@@ -197,16 +217,14 @@ namespace HCUBE
     }
 
     void AtariPixelExperiment::setSubstrateValues(NEAT::LayeredSubstrate<float>* substrate) {
-        for (int y=0; y<ale.screen_height; y++) {
-            for (int x=0; x<ale.screen_width; x++) {
-                int substrate_y = min(int((y / float(ale.screen_height)) * substrate_width), substrate_height-1);
-                int substrate_x = min(int((x / float(ale.screen_width)) * substrate_width), substrate_width-1);
-                uInt32 eightBitVal = eightBitPallete[ale.screen_matrix[y][x]];
-                assert(eightBitVal < numColors);
-                assert(substrate_x < substrate_width);
-                assert(substrate_y < substrate_height);
-                substrate->setValue((Node(substrate_x, substrate_y, eightBitVal)), 1.0);
-            }
+        // The first numColors layers are the color planes
+        float* planes[numColors];
+        for (int i=0; i<numColors; i++) {
+            planes[i] = substrate->getLayerValues(i);
+        }
+        if (ale.frame == 0) {
+            screenPreprocessor.reset();
         }
+        screenPreprocessor.process(&ale.screen_buffer[0], planes, poolingMode, poolFrames);
     }
 }
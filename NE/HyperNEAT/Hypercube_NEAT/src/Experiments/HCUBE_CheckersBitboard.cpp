@@ -0,0 +1,510 @@
+#include "HCUBE_Defines.h"
+
+#include "Experiments/HCUBE_CheckersCommon.h"
+
+//Squares on even rows (0,2,4,6) and odd rows (1,3,5,7)
+#define EVEN_ROWS (0x0F0F0F0Fu)
+#define ODD_ROWS (0xF0F0F0F0u)
+
+//Even row squares that are not on the left edge, odd row squares not on the right edge
+#define EVEN_ROWS_NOT_LEFT (0x0E0E0E0Eu)
+#define ODD_ROWS_NOT_RIGHT (0x70707070u)
+
+//Men are promoted when they reach these rows
+#define BLACK_PROMOTION_ROW (0xF0000000u)
+#define WHITE_PROMOTION_ROW (0x0000000Fu)
+
+namespace HCUBE
+{
+    //The four diagonal directions.  Black men move up (+y), white men move down.
+    //The opposite of direction d is (d^3).
+    enum CheckersDirection
+    {
+        UP_LEFT=0,
+        UP_RIGHT,
+        DOWN_LEFT,
+        DOWN_RIGHT
+    };
+
+    //Moves every square in bits one step in the given direction, dropping
+    //squares that would leave the board
+    static inline uint stepSquares(uint bits,int direction)
+    {
+        switch (direction)
+        {
+        case UP_LEFT:
+            return ((bits&EVEN_ROWS_NOT_LEFT)<<3) | ((bits&ODD_ROWS)<<4);
+        case UP_RIGHT:
+            return ((bits&EVEN_ROWS)<<4) | ((bits&ODD_ROWS_NOT_RIGHT)<<5);
+        case DOWN_LEFT:
+            return ((bits&EVEN_ROWS_NOT_LEFT)>>5) | ((bits&ODD_ROWS)>>4);
+        default: //DOWN_RIGHT
+            return ((bits&EVEN_ROWS)>>4) | ((bits&ODD_ROWS_NOT_RIGHT)>>3);
+        }
+    }
+
+    static inline bool isForward(int color,int direction)
+    {
+        return (color==BLACK)?(direction<=UP_RIGHT):(direction>=DOWN_LEFT);
+    }
+
+    //The pieces that may move in the given direction
+    static inline uint getMovers(uint men,uint kings,int color,int direction)
+    {
+        return isForward(color,direction)?(men|kings):kings;
+    }
+
+    /*
+     * Zobrist keys: one per piece type and square, plus one for the side to move.
+     * The keys come from a fixed-seed generator so that they are the same in
+     * every process and every run.
+     */
+    enum CheckersPieceType
+    {
+        PIECE_BLACK_MAN=0,
+        PIECE_BLACK_KING,
+        PIECE_WHITE_MAN,
+        PIECE_WHITE_KING
+    };
+
+    static ulong zobristKeys[4][32];
+    static ulong zobristBlackToMove;
+
+    class CheckersZobristInitializer
+    {
+    public:
+        CheckersZobristInitializer()
+        {
+            //splitmix64
+            ulong state = 0x2545F4914F6CDD1DULL;
+            for (int piece=0;piece<4;piece++)
+            {
+                for (int square=0;square<32;square++)
+                {
+                    zobristKeys[piece][square] = nextKey(state);
+                }
+            }
+            zobristBlackToMove = nextKey(state);
+        }
+
+        static ulong nextKey(ulong &state)
+        {
+            state += 0x9E3779B97F4A7C15ULL;
+            ulong z = state;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+    };
+
+    static CheckersZobristInitializer checkersZobristInitializer;
+
+    static inline ulong hashSquares(uint bits,int piece)
+    {
+        ulong key=0;
+        while (bits)
+        {
+            key ^= zobristKeys[piece][CheckersBitboard::lowestSquare(bits)];
+            bits &= bits-1;
+        }
+        return key;
+    }
+
+    CheckersBitboard::CheckersBitboard()
+        :
+    blackMen(0),
+        blackKings(0),
+        whiteMen(0),
+        whiteKings(0),
+        colorToMove(BLACK),
+        hashKey(0)
+    {
+        hashKey = computeHashKey();
+    }
+
+    CheckersBitboard::CheckersBitboard(uchar b[8][8],int _colorToMove)
+    {
+        loadBoard(b,_colorToMove);
+    }
+
+    void CheckersBitboard::loadBoard(uchar b[8][8],int _colorToMove)
+    {
+        blackMen = blackKings = whiteMen = whiteKings = 0;
+        colorToMove = _colorToMove;
+
+        for (int square=0;square<32;square++)
+        {
+            uchar piece = b[squareToX(square)][squareToY(square)];
+            uint bit = (1u<<square);
+
+            if (piece&BLACK)
+            {
+                if (piece&KING)
+                    blackKings |= bit;
+                else
+                    blackMen |= bit;
+            }
+            else if (piece&WHITE)
+            {
+                if (piece&KING)
+                    whiteKings |= bit;
+                else
+                    whiteMen |= bit;
+            }
+        }
+
+        hashKey = computeHashKey();
+    }
+
+    void CheckersBitboard::saveBoard(uchar b[8][8]) const
+    {
+        for (int y=0;y<8;y++)
+        {
+            for (int x=0;x<8;x++)
+            {
+                b[x][y] = ((x+y)%2==0)?0:FREE;
+            }
+        }
+
+        for (int square=0;square<32;square++)
+        {
+            uint bit = (1u<<square);
+            uchar &piece = b[squareToX(square)][squareToY(square)];
+
+            if (blackMen&bit)
+                piece = BLACK|MAN;
+            else if (blackKings&bit)
+                piece = BLACK|KING;
+            else if (whiteMen&bit)
+                piece = WHITE|MAN;
+            else if (whiteKings&bit)
+                piece = WHITE|KING;
+        }
+
+        NUM_BLACK_PIECES(b) = (uchar)countSquares(blackMen|blackKings);
+        NUM_WHITE_PIECES(b) = (uchar)countSquares(whiteMen|whiteKings);
+    }
+
+    ulong CheckersBitboard::computeHashKey() const
+    {
+        ulong key =
+            hashSquares(blackMen,PIECE_BLACK_MAN) ^
+            hashSquares(blackKings,PIECE_BLACK_KING) ^
+            hashSquares(whiteMen,PIECE_WHITE_MAN) ^
+            hashSquares(whiteKings,PIECE_WHITE_KING);
+
+        if (colorToMove==BLACK)
+        {
+            key ^= zobristBlackToMove;
+        }
+
+        return key;
+    }
+
+    void CheckersBitboard::addJumps(
+        CheckersBitboardMove &move,
+        uint square,
+        uint opponents,
+        uint opponentKings,
+        uint empty,
+        CheckersBitboardMove *moveList,
+        int &numMoves
+    ) const
+    {
+        uint promotionRow = (colorToMove==BLACK)?BLACK_PROMOTION_ROW:WHITE_PROMOTION_ROW;
+        bool extended=false;
+
+        for (int direction=UP_LEFT;direction<=DOWN_RIGHT;direction++)
+        {
+            if (!move.kingMoved && !isForward(colorToMove,direction))
+                continue;
+
+            uint jumped = stepSquares(square,direction)&opponents;
+            if (!jumped)
+                continue;
+
+            uint landing = stepSquares(jumped,direction)&empty;
+            if (!landing)
+                continue;
+
+            extended=true;
+
+            if (move.numSteps==CHECKERS_MAX_JUMPS || numMoves==CHECKERS_MAX_MOVES)
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO("Too many possible moves for a given board state!");
+            }
+
+            CheckersBitboardMove jump = move;
+            if (jumped&opponentKings)
+                jump.capturedKings |= jumped;
+            else
+                jump.capturedMen |= jumped;
+            jump.to = landing;
+            jump.path[++jump.numSteps] = (uchar)lowestSquare(landing);
+
+            if (!move.kingMoved && (landing&promotionRow))
+            {
+                //"A piece that has just kinged, cannot continue jumping pieces, until the next move."
+                jump.promoted=true;
+                moveList[numMoves++] = jump;
+            }
+            else
+            {
+                //Captured pieces are removed as they are jumped
+                addJumps(jump,landing,opponents&(~jumped),opponentKings&(~jumped),(empty&(~landing))|square,moveList,numMoves);
+            }
+        }
+
+        if (!extended && move.numSteps>0)
+        {
+            if (numMoves==CHECKERS_MAX_MOVES)
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO("Too many possible moves for a given board state!");
+            }
+            moveList[numMoves++] = move;
+        }
+    }
+
+    int CheckersBitboard::generateMoves(CheckersBitboardMove *moveList,bool &foundJump) const
+    {
+        uint men,kings,opponents,opponentKings;
+        if (colorToMove==BLACK)
+        {
+            men = blackMen;
+            kings = blackKings;
+            opponents = whiteMen|whiteKings;
+            opponentKings = whiteKings;
+        }
+        else
+        {
+            men = whiteMen;
+            kings = whiteKings;
+            opponents = blackMen|blackKings;
+            opponentKings = blackKings;
+        }
+        uint empty = ~getOccupied();
+
+        //Find every piece that can capture in one pass of shifts
+        uint jumpers=0;
+        for (int direction=UP_LEFT;direction<=DOWN_RIGHT;direction++)
+        {
+            int back = direction^3;
+            jumpers |=
+                stepSquares(stepSquares(empty,back)&opponents,back) &
+                getMovers(men,kings,colorToMove,direction);
+        }
+
+        int numMoves=0;
+        foundJump = (jumpers!=0);
+
+        if (foundJump)
+        {
+            while (jumpers)
+            {
+                uint square = jumpers&(0-jumpers);
+                jumpers &= jumpers-1;
+
+                CheckersBitboardMove move;
+                move.from = move.to = square;
+                move.capturedMen = move.capturedKings = 0;
+                move.kingMoved = (kings&square)!=0;
+                move.promoted = false;
+                move.numSteps = 0;
+                move.path[0] = (uchar)lowestSquare(square);
+
+                addJumps(move,square,opponents,opponentKings,empty|square,moveList,numMoves);
+            }
+
+            return numMoves;
+        }
+
+        uint promotionRow = (colorToMove==BLACK)?BLACK_PROMOTION_ROW:WHITE_PROMOTION_ROW;
+
+        for (int direction=UP_LEFT;direction<=DOWN_RIGHT;direction++)
+        {
+            uint targets = stepSquares(getMovers(men,kings,colorToMove,direction),direction)&empty;
+
+            while (targets)
+            {
+                if (numMoves==CHECKERS_MAX_MOVES)
+                {
+                    throw CREATE_LOCATEDEXCEPTION_INFO("Too many possible moves for a given board state!");
+                }
+
+                uint to = targets&(0-targets);
+                targets &= targets-1;
+                uint from = stepSquares(to,direction^3);
+
+                CheckersBitboardMove &move = moveList[numMoves++];
+                move.from = from;
+                move.to = to;
+                move.capturedMen = move.capturedKings = 0;
+                move.kingMoved = (kings&from)!=0;
+                move.promoted = (!move.kingMoved && (to&promotionRow));
+                move.numSteps = 1;
+                move.path[0] = (uchar)lowestSquare(from);
+                move.path[1] = (uchar)lowestSquare(to);
+            }
+        }
+
+        return numMoves;
+    }
+
+    bool CheckersBitboard::hasAnyMove() const
+    {
+        uint men,kings,opponents;
+        if (colorToMove==BLACK)
+        {
+            men = blackMen;
+            kings = blackKings;
+            opponents = whiteMen|whiteKings;
+        }
+        else
+        {
+            men = whiteMen;
+            kings = whiteKings;
+            opponents = blackMen|blackKings;
+        }
+        uint empty = ~getOccupied();
+
+        for (int direction=UP_LEFT;direction<=DOWN_RIGHT;direction++)
+        {
+            uint movers = getMovers(men,kings,colorToMove,direction);
+            uint next = stepSquares(movers,direction);
+
+            if (next&empty)
+                return true;
+
+            if (stepSquares(next&opponents,direction)&empty)
+                return true;
+        }
+
+        return false;
+    }
+
+    int CheckersBitboard::getWinner() const
+    {
+        if (!(whiteMen|whiteKings))
+        {
+            return BLACK;
+        }
+        else if (!(blackMen|blackKings))
+        {
+            return WHITE;
+        }
+
+        return -1;
+    }
+
+    int CheckersBitboard::getWinnerWithMoves() const
+    {
+        int pieceWin = getWinner();
+
+        if (pieceWin!=-1)
+            return pieceWin;
+
+        if (!hasAnyMove())
+        {
+            return (colorToMove==BLACK)?WHITE:BLACK;
+        }
+
+        return -1;
+    }
+
+    void CheckersBitboard::toggleMove(const CheckersBitboardMove &move,int color)
+    {
+        uint *men,*kings,*opponentMen,*opponentKings;
+        int manPiece,kingPiece,opponentManPiece,opponentKingPiece;
+
+        if (color==BLACK)
+        {
+            men = &blackMen;
+            kings = &blackKings;
+            opponentMen = &whiteMen;
+            opponentKings = &whiteKings;
+            manPiece = PIECE_BLACK_MAN;
+            kingPiece = PIECE_BLACK_KING;
+            opponentManPiece = PIECE_WHITE_MAN;
+            opponentKingPiece = PIECE_WHITE_KING;
+        }
+        else
+        {
+            men = &whiteMen;
+            kings = &whiteKings;
+            opponentMen = &blackMen;
+            opponentKings = &blackKings;
+            manPiece = PIECE_WHITE_MAN;
+            kingPiece = PIECE_WHITE_KING;
+            opponentManPiece = PIECE_BLACK_MAN;
+            opponentKingPiece = PIECE_BLACK_KING;
+        }
+
+        int fromSquare = move.path[0];
+        int toSquare = move.path[move.numSteps];
+
+        //A multi-jump may end where it started, in which case from==to
+        if (move.kingMoved)
+        {
+            *kings ^= move.from^move.to;
+            hashKey ^= zobristKeys[kingPiece][fromSquare]^zobristKeys[kingPiece][toSquare];
+        }
+        else if (move.promoted)
+        {
+            *men ^= move.from;
+            *kings ^= move.to;
+            hashKey ^= zobristKeys[manPiece][fromSquare]^zobristKeys[kingPiece][toSquare];
+        }
+        else
+        {
+            *men ^= move.from^move.to;
+            hashKey ^= zobristKeys[manPiece][fromSquare]^zobristKeys[manPiece][toSquare];
+        }
+
+        if (move.capturedMen)
+        {
+            *opponentMen ^= move.capturedMen;
+            hashKey ^= hashSquares(move.capturedMen,opponentManPiece);
+        }
+        if (move.capturedKings)
+        {
+            *opponentKings ^= move.capturedKings;
+            hashKey ^= hashSquares(move.capturedKings,opponentKingPiece);
+        }
+
+        hashKey ^= zobristBlackToMove;
+    }
+
+    void CheckersBitboard::makeMove(const CheckersBitboardMove &move)
+    {
+        toggleMove(move,colorToMove);
+        colorToMove = (colorToMove==BLACK)?WHITE:BLACK;
+    }
+
+    void CheckersBitboard::unmakeMove(const CheckersBitboardMove &move)
+    {
+        colorToMove = (colorToMove==BLACK)?WHITE:BLACK;
+        toggleMove(move,colorToMove);
+    }
+
+    CheckersMove CheckersBitboard::toCheckersMove(
+        const CheckersBitboardMove &move,
+        boost::shared_ptr<CheckersMovePool> checkersMovePoolPtr
+    ) const
+    {
+        CheckersMove checkersMove(
+            Vector2<uchar>(squareToX(move.path[0]),squareToY(move.path[0])),
+            Vector2<uchar>(squareToX(move.path[1]),squareToY(move.path[1])),
+            checkersMovePoolPtr
+        );
+
+        for (int step=1;step<move.numSteps;step++)
+        {
+            checkersMove.addJump(
+                Vector2<uchar>(squareToX(move.path[step]),squareToY(move.path[step])),
+                Vector2<uchar>(squareToX(move.path[step+1]),squareToY(move.path[step+1]))
+            );
+        }
+
+        return checkersMove;
+    }
+}
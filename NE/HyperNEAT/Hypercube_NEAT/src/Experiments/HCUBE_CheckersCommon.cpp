@@ -571,249 +571,6 @@ namespace HCUBE
 
 #define IS_IN_BOUNDS(X,Y) ((X)>=0&&(Y)>=0&&(X)<8&&(Y)<8)
 
-    //Check if we haven't found a jump yet, erase the moves and add the jump
-#define CHECK_FIRST_JUMP if (!foundJump) { totalMoveList.erase(totalMoveList.begin()+moveBeginIndex,totalMoveList.end()); numMoves=0; foundJump=true; }
-
-#define MAX_MOVES (128)
-
-    bool CheckersCommon::hasJump(
-        uchar b[8][8],
-        int color,
-        int x,
-        int y,
-        int deltax,
-        int deltay
-        )
-    {
-#if CHECKERS_COMMON_DEBUG
-        cout << "Running hasJump\n";
-#endif
-        if (IS_IN_BOUNDS(x+deltax,y+deltay))
-        {
-            if (b[x+deltax][y+deltay]&(MAN|KING))
-            {
-                //A piece exists in the square we could move to, can we jump it?
-
-                if (
-                    IS_IN_BOUNDS(x+deltax*2,y+deltay*2) && //must be in bounds
-                    (!(b[x+deltax][y+deltay]&color)) && //can't jump your own color
-                    (!(b[x+deltax*2][y+deltay*2]&(MAN|KING))) //must have an empty square behind
-                    )
-                {
-                    return true;
-                }
-            }
-        }
-#if CHECKERS_COMMON_DEBUG
-        cout << "Done Running hasJump\n";
-#endif
-
-        return false;
-    }
-
-    /* tryMoveJumps:
-    returns true if more jumps exist and false otherwise.
-    If returns true, that means that you don't need to worry about adding the current jump
-    */
-    bool CheckersCommon::tryMoreJumps(
-        vector<CheckersMove> &totalMoveList,
-        int &numMoves,
-        CheckersMove &moveInProgress,
-        int color,
-        uchar b[8][8]
-    )
-    {
-        int x = moveInProgress.getFinalDestination().x;
-        int y = moveInProgress.getFinalDestination().y;
-#if CHECKERS_COMMON_DEBUG
-        cout << "Running tryMoreJumps on location " << x << ',' << y << endl;
-#endif
-
-        bool hasMoreJumps=false;
-
-        if ( (b[x][y]&color) )
-        {
-            if ( (b[x][y]&(BLACK|KING)) )
-            {
-                //Black moves in the +y direction
-
-                for (int deltax=-1;deltax<=1;deltax+=2)
-                {
-                    if (
-                        hasJump(b,color,x,y,deltax,1)
-                        &&
-                        (
-                        moveInProgress.from.x != x+deltax*2 ||
-                        moveInProgress.from.y != y+2
-                        //This conditional logic is there to prevent making jumps which
-                        //contain the starting position.  This is because it tends to bomb on
-                        //the current checkers implementation
-                        )
-                        )
-                    {
-                        hasMoreJumps=true;
-
-                        //A new jump exists.  Try the jump
-                        CheckersMove jump = CheckersMove(Vector2<uchar>(x,y),Vector2<uchar>(x+deltax*2,y+2),checkersMovePoolPtr);
-
-                        CheckersMove fullMove = moveInProgress;
-                        fullMove.addJump(jump);
-
-                        makeMove(jump,b);
-                        bool moreJumps=false;
-                        if (!jump.promoted)
-                        {
-                            //"A piece that has just kinged, cannot continue jumping pieces, until the next move."
-                            moreJumps = tryMoreJumps(totalMoveList,numMoves,fullMove,color,b);
-                        }
-                        reverseMove(jump,b);
-
-                        if (!moreJumps)
-                        {
-                            //Add the current move if there's no more jumps
-                            //(otherwise you shuold have added the
-                            //jumps and this move is not legal)
-                            //CheckersMove tmpMove = moveInProgress;
-                            //tmpMove.addJump(Vector2<uchar>(x,y),Vector2<uchar>(x+deltax*2,y+2));
-                            totalMoveList.push_back(fullMove);
-                            numMoves++;
-                        }
-                    }
-                }
-            }
-
-            if ( (b[x][y]&(WHITE|KING)) )
-            {
-                //White moves in the -y direction
-
-                for (int deltax=-1;deltax<=1;deltax+=2)
-                {
-                    if (
-                        hasJump(b,color,x,y,deltax,-1)
-                        &&
-                        (
-                        moveInProgress.from.x != x+deltax*2 ||
-                        moveInProgress.from.y != y-2
-                        //This conditional logic is there to prevent making jumps which
-                        //contain the starting position.  This is because it tends to bomb on
-                        //the current checkers implementation
-                        )
-                        )
-                    {
-                        hasMoreJumps=true;
-
-                        //A new jump exists.  Try the jump
-                        CheckersMove jump = CheckersMove(Vector2<uchar>(x,y),Vector2<uchar>(x+deltax*2,y-2),checkersMovePoolPtr);
-
-                        CheckersMove fullMove = moveInProgress;
-                        fullMove.addJump(jump);
-
-                        makeMove(jump,b);
-                        bool moreJumps=false;
-                        if (!jump.promoted)
-                        {
-                            //"A piece that has just kinged, cannot continue jumping pieces, until the next move."
-                            moreJumps = tryMoreJumps(totalMoveList,numMoves,fullMove,color,b);
-                        }
-                        reverseMove(jump,b);
-
-                        if (!moreJumps)
-                        {
-                            //Add the current move if there's no more jumps
-                            //(otherwise you shuold have added the
-                            //jumps and this move is not legal)
-                            //CheckersMove tmpMove = moveInProgress;
-                            //tmpMove.addJump(Vector2<uchar>(x,y),Vector2<uchar>(x+deltax*2,y-2));
-
-                            totalMoveList.push_back(fullMove);
-                            numMoves++;
-                        }
-                    }
-                }
-            }
-        }
-        else
-        {
-            CREATE_PAUSE("ERROR!");
-            throw CREATE_LOCATEDEXCEPTION_INFO("Tried to add more jumps but there wasn't a piece!");
-        }
-
-#if CHECKERS_COMMON_DEBUG
-        cout << "Done Running tryMoreJumps\n";
-#endif
-        return hasMoreJumps;
-    }
-
-    void CheckersCommon::tryMove(
-        vector<CheckersMove> &totalMoveList,
-        int moveBeginIndex,
-        uchar b[8][8],
-        int &numMoves,
-        bool &foundJump,
-        int color,
-        int x,
-        int y,
-        int deltax,
-        int deltay
-        )
-    {
-#if CHECKERS_COMMON_DEBUG
-        cout << "Running tryMove\n";
-#endif
-        if (IS_IN_BOUNDS(x+deltax,y+deltay))
-        {
-            if (b[x+deltax][y+deltay]&(MAN|KING))
-            {
-                //A piece exists in the square we could move to, can we jump it?
-
-                if (
-                    IS_IN_BOUNDS(x+deltax*2,y+deltay*2) && //must be in bounds
-                    (!(b[x+deltax][y+deltay]&color)) && //can't jump your own color
-                    (!(b[x+deltax*2][y+deltay*2]&(MAN|KING))) //must have an empty square behind
-                    )
-                {
-                    CHECK_FIRST_JUMP
-                        CheckersMove jump = CheckersMove(Vector2<uchar>(x,y),Vector2<uchar>(x+deltax*2,y+deltay*2),checkersMovePoolPtr);
-
-                    bool foundMoreJumps=false;
-                    //At this point, we have found a jump, try to find more jumps
-                    makeMove(jump,b);
-                    if (!jump.promoted)
-                    {
-                        //"A piece that has just kinged, cannot continue jumping pieces, until the next move."
-                        foundMoreJumps = tryMoreJumps(totalMoveList,numMoves,jump,color,b);
-                    }
-                    reverseMove(jump,b);
-
-                    if (!foundMoreJumps)
-                    {
-                        //No multi-jumps found, just add the one jump
-                        totalMoveList.push_back(jump);
-                        numMoves++;
-                    }
-                }
-            }
-            else
-            {
-                //No piece exists, a move is possible
-                if (!foundJump)
-                {
-                    //Only try to move if you haven't yet found a possible capture
-                    totalMoveList.push_back(CheckersMove(Vector2<uchar>(x,y),Vector2<uchar>(x+deltax,y+deltay),checkersMovePoolPtr) );
-                    numMoves++;
-                }
-            }
-        }
-
-        if (numMoves==MAX_MOVES)
-        {
-            throw CREATE_LOCATEDEXCEPTION_INFO("Too many possible moves for a given board state! Oh shiz!");
-        }
-#if CHECKERS_COMMON_DEBUG
-        cout << "Done Running tryMove\n";
-#endif
-    }
-
     int CheckersCommon::generateMoveList(
         vector<CheckersMove> &totalMoveList,
         int moveBeginIndex,
@@ -825,31 +582,14 @@ namespace HCUBE
 #if CHECKERS_COMMON_DEBUG
         cout << "Running generateMoveList\n";
 #endif
-        int numMoves=0;
+        CheckersBitboard board(b,color);
+        CheckersBitboardMove moveList[CHECKERS_MAX_MOVES];
 
-        foundJump=false;
+        int numMoves = board.generateMoves(moveList,foundJump);
 
-        for (int x=0;x<8;x++)
+        for (int a=0;a<numMoves;a++)
         {
-            for (int y=(x%2);y<8;y+=2)
-            {
-                if ( (b[x][y]&color) )
-                {
-                    if ( (b[x][y]&(BLACK|KING)) )
-                    {
-                        //Black moves in the +y direction
-                        tryMove(totalMoveList,moveBeginIndex,b,numMoves,foundJump,color,x,y,1,1);
-                        tryMove(totalMoveList,moveBeginIndex,b,numMoves,foundJump,color,x,y,-1,1);
-                    }
-
-                    if ( (b[x][y]&(WHITE|KING)) )
-                    {
-                        //White moves in the -y direction
-                        tryMove(totalMoveList,moveBeginIndex,b,numMoves,foundJump,color,x,y,1,-1);
-                        tryMove(totalMoveList,moveBeginIndex,b,numMoves,foundJump,color,x,y,-1,-1);
-                    }
-                }
-            }
+            totalMoveList.push_back(board.toCheckersMove(moveList[a],checkersMovePoolPtr));
         }
 
 #if CHECKERS_COMMON_DEBUG
@@ -924,29 +664,7 @@ namespace HCUBE
 
 	bool CheckersCommon::hasAnyMove(uchar b[8][8],int color)
     {
-        for (int x=0;x<8;x++)
-        {
-            for (int y=(x%2);y<8;y+=2)
-            {
-                if ( (b[x][y]&color) )
-                {
-                    if ( (b[x][y]&(BLACK|KING)) )
-                    {
-                        //Black regular pieces move in the +y direction
-                        if (hasMove(b,color,x,y,1,1)) return true;
-                        if (hasMove(b,color,x,y,-1,1)) return true;
-                    }
-
-                    if ( (b[x][y]&(WHITE|KING)) )
-                    {
-                        //White regular pieces move in the -y direction
-                        if (hasMove(b,color,x,y,1,-1)) return true;
-                        if (hasMove(b,color,x,y,-1,-1)) return true;
-                    }
-                }
-            }
-        }
-        return false;
+        return CheckersBitboard(b,color).hasAnyMove();
     }
 
     int CheckersCommon::getWinner(uchar b[8][8])
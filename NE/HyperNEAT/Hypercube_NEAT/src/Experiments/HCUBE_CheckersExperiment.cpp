@@ -6,7 +6,9 @@
 
 #define DEBUG_CHECK_HAND_CODED_HEURISTIC (0)
 
-#define DEBUG_USE_BOARD_EVALUATION_CACHE (1)
+#define DEBUG_USE_TRANSPOSITION_TABLE (1)
+
+#define DEBUG_BATCH_LEAF_EVALUATIONS (1)
 
 #define DEBUG_DUMP_BOARD_LEAF_EVALUATIONS (0)
 
@@ -93,7 +95,9 @@ namespace HCUBE
 
     using namespace NEAT;
 
-    mutex cakeMutex;
+    //Cliche keeps its search state in globals.  Cake searches with the
+    //tables of each experiment's searchInfo and needs no lock.
+    mutex clicheMutex;
 
     CheckersExperiment::CheckersExperiment(string _experimentName,int _threadID)
         :
@@ -104,9 +108,10 @@ namespace HCUBE
         DEBUG_USE_HYPERNEAT_EVALUATION(0),
         chanceToMakeSecondBestMove(0.0),
 		dumpEvaluationImages(false),
-		cakeRandomSeed(1000)
+		cakeRandomSeed(1000),
+        batchLeafEvaluations(true)
     {
-        searchInfo.repcheck = NULL;
+        cake_initsearchinfo(&searchInfo,0);
         //boardEvaluationCaches[0].resize(10000);
         //boardEvaluationCaches[1].resize(10000);
 
@@ -147,10 +152,55 @@ namespace HCUBE
         }
     }
 
+    CheckersExperiment::CheckersExperiment(const CheckersExperiment &other)
+        :
+    Experiment(other),
+        CheckersCommon(other),
+        currentSubstrateIndex(other.currentSubstrateIndex),
+        nameLookup(other.nameLookup),
+        moveToMake(other.moveToMake),
+        chanceToMakeSecondBestMove(other.chanceToMakeSecondBestMove),
+        childAlphaForSecondBestMove(other.childAlphaForSecondBestMove),
+        childBetaForSecondBestMove(other.childBetaForSecondBestMove),
+        secondBestMoveToMake(other.secondBestMoveToMake),
+        totalMoveList(other.totalMoveList),
+        userEvaluationRound(other.userEvaluationRound),
+        from(other.from),
+        handCodedType(other.handCodedType),
+        DEBUG_USE_HANDCODED_EVALUATION(other.DEBUG_USE_HANDCODED_EVALUATION),
+        DEBUG_USE_HYPERNEAT_EVALUATION(other.DEBUG_USE_HYPERNEAT_EVALUATION),
+		dumpEvaluationImages(other.dumpEvaluationImages),
+		numHandCodedStreams(other.numHandCodedStreams),
+		numHandCodedEvaluations(other.numHandCodedEvaluations),
+		numHyperNEATStreams(other.numHyperNEATStreams),
+		numHyperNEATEvaluations(other.numHyperNEATEvaluations),
+		cakeRandomSeed(other.cakeRandomSeed),
+        currentRound(other.currentRound),
+        batchLeafEvaluations(other.batchLeafEvaluations)
+    {
+        //Copies run in other threads, sharing the tables would race on
+        //them and free them twice
+        cake_initsearchinfo(&searchInfo,0);
+
+        for(int a=0;a<2;a++)
+        {
+            substrates[a] = other.substrates[a];
+            substrateIndividuals[a] = other.substrateIndividuals[a];
+        }
+
+        for(int a=0;a<3;a++)
+        {
+            numNodesX[a] = other.numNodesX[a];
+            numNodesY[a] = other.numNodesY[a];
+            transpositionTables[a] = other.transpositionTables[a];
+        }
+
+        memcpy(userEvaluationBoard,other.userEvaluationBoard,sizeof(userEvaluationBoard));
+    }
+
     CheckersExperiment::~CheckersExperiment()
     {
-        if(searchInfo.repcheck)
-            free(searchInfo.repcheck);
+        cake_exitsearchinfo(&searchInfo);
     }
 
     GeneticPopulation* CheckersExperiment::createInitialPopulation(int populationSize)
@@ -216,24 +266,8 @@ namespace HCUBE
 
         substrate = &substrates[substrateNum];
 
-        //Clear the evaluation cache
-        for (int a=0;a<65536;a++)
-        {
-            boardEvaluationCaches[substrateNum][a].clear();
-            boardEvaluationCaches[substrateNum][a].reserve(0);
-        }
-
-        //Clear the state list caches
-        for (int a=0;a<65536;a++)
-        {
-            boardStateLists[substrateNum][BLACK][a].clear();
-            boardStateLists[substrateNum][BLACK][a].reserve(0);
-        }
-        for (int a=0;a<65536;a++)
-        {
-            boardStateLists[substrateNum][WHITE][a].clear();
-            boardStateLists[substrateNum][WHITE][a].reserve(0);
-        }
+        //Search results from the previous individual are no longer valid
+        transpositionTables[substrateNum].clear();
 
         substrate->populateSubstrate(individual);
     }
@@ -1104,7 +1138,7 @@ namespace HCUBE
     }
 
     pair<CheckersNEATDatatype,int> CheckersExperiment::evaluateLeafHyperNEAT(
-        uchar b[8][8]
+        const CheckersBitboard &board
     )
     {
         NEAT::LayeredSubstrate<CheckersNEATDatatype>* substrate = &substrates[currentSubstrateIndex];
@@ -1115,115 +1149,36 @@ namespace HCUBE
         }
         CheckersNEATDatatype output;
 
-#if DEBUG_USE_BOARD_EVALUATION_CACHE
-        tmpboard.loadBoard(b);
-        ushort hashVal = tmpboard.getShortHash();
-
-        BoardCacheList::iterator bIterator =
-            boardEvaluationCaches[currentSubstrateIndex][hashVal].begin();
-        BoardCacheList::iterator bEnd =
-            boardEvaluationCaches[currentSubstrateIndex][hashVal].end();
-
-        for (;bIterator != bEnd;bIterator++)
-        {
-            if (bIterator->first == tmpboard)
-            {
-                //We have a match!
-                break;
-            }
-        }
-
-        if (bIterator != bEnd)
-        {
-            output = bIterator->second;
-        }
-        else
-#endif
-        {
-
-            substrate->getNetwork()->reinitialize();
-            substrate->getNetwork()->dummyActivation();
-
-            for (int y=0;y<numNodesY[0];y++)
-            {
-                for (int x=0;x<numNodesX[0];x++)
-                {
-                    if ( (x+y)%2==1 ) //ignore empty squares.
-                        continue;
-
-                    int boardx = x;
-                    int boardy = y;
-
-                    //cout << boardx << ',' << boardy << ": " << b[boardx][boardy] << endl;
-
-                    if ( (b[boardx][boardy]&WHITE) )
-                    {
-                        //cout << "FOUND WHITE\n";
-                        if ( (b[boardx][boardy]&KING) )
-                        {
-                            substrate->setValue( (Node(x,y,0)) , -0.75 );
-                        }
-                        else if ( (b[boardx][boardy]&MAN) )
-                        {
-                            substrate->setValue( (Node(x,y,0)) , -0.5 );
-                        }
-                        else
-                        {
-                            throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
-                        }
-                    }
-                    else if ( (b[boardx][boardy]&BLACK) )
-                    {
-                        //cout << "FOUND BLACK\n";
-                        if ( (b[boardx][boardy]&KING) )
-                        {
-                            substrate->setValue( (Node(x,y,0)) , 0.75 );
-                        }
-                        else if ( (b[boardx][boardy]&MAN) )
-                        {
-                            substrate->setValue( (Node(x,y,0)) , 0.5 );
-                        }
-                        else
-                        {
-                            throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
-                        }
-                    }
-                    else
-                    {
-                        //cout << "FOUND NOTHING\n";
-                        substrate->setValue( (Node(x,y,0)) , 0.0 );
-                    }
+        substrate->getNetwork()->reinitialize();
+        substrate->getNetwork()->dummyActivation();
 
-                }
-            }
+        board.getSubstrateInputs(
+            substrate->getLayerValues(0),
+            numNodesX[0],
+            CheckersNEATDatatype(0.5),
+            CheckersNEATDatatype(0.75)
+            );
 
-            substrate->getNetwork()->update();
-            output = substrate->getValue((Node(0,0,2)));
+        substrate->getNetwork()->update();
+        output = substrate->getValue((Node(0,0,2)));
 
 #if CHECKERS_EXPERIMENT_DEBUG
-            static CheckersNEATDatatype prevOutput;
+        static CheckersNEATDatatype prevOutput;
 
-            if (fabs(output-prevOutput)>1e-3)
-            {
-                prevOutput = output;
-                cout << "BOARD RATING:" << output << endl;
-                CREATE_PAUSE("");
-            }
-#endif
-
-#if DEBUG_USE_BOARD_EVALUATION_CACHE
-            if (boardEvaluationCaches[currentSubstrateIndex][hashVal].size()<10000)
-            {
-                boardEvaluationCaches[currentSubstrateIndex][hashVal].push_back(
-                    BoardCachePair(tmpboard,output)
-                    );
-            }
-#endif
+        if (fabs(output-prevOutput)>1e-3)
+        {
+            prevOutput = output;
+            cout << "BOARD RATING:" << output << endl;
+            CREATE_PAUSE("");
         }
+#endif
 
 #if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
         cout << "Printing board leaf evaluations\n";
 
+        uchar b[8][8];
+        board.saveBoard(b);
+
         int whiteMen,blackMen,whiteKings,blackKings;
         countPieces(b,whiteMen,blackMen,whiteKings,blackKings);
 
@@ -1295,6 +1250,9 @@ namespace HCUBE
 
 		if(dumpEvaluationImages)
 		{
+			uchar b[8][8];
+			board.saveBoard(b);
+
 			hyperNEATEvalStream << "Evaluation #" << numHyperNEATEvaluations << ":" << endl;
 			printBoard(b,hyperNEATEvalStream,substrate->getNetwork(),nameLookup);
 			hyperNEATEvalStream << "Evaluation Score: " << output << endl << endl << endl;
@@ -1302,12 +1260,82 @@ namespace HCUBE
 		numHyperNEATEvaluations++;
 
 #if DEBUG_SHOW_HYPERNEAT_ALTERNATIVES
-		boardEvaluationList.push_back(BoardEvaluation(b,output));
+		{
+			uchar b[8][8];
+			board.saveBoard(b);
+			boardEvaluationList.push_back(BoardEvaluation(b,output));
+		}
 #endif
 
         return pair<CheckersNEATDatatype,int>(output,numHyperNEATEvaluations-1);
     }
 
+    void CheckersExperiment::evaluateLeavesHyperNEAT(
+        const CheckersBitboard *boards,
+        int numBoards,
+        CheckersNEATDatatype *values
+    )
+    {
+        bool evaluateSeparately = dumpEvaluationImages;
+#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS || DEBUG_SHOW_HYPERNEAT_ALTERNATIVES
+        evaluateSeparately = true;
+#endif
+
+        if (evaluateSeparately)
+        {
+            //The debug output needs the activation of each network, so go one board at a time
+            for (int a=0;a<numBoards;a++)
+            {
+                values[a] = evaluateLeafHyperNEAT(boards[a]).first;
+            }
+            return;
+        }
+
+        if (DEBUG_USE_HANDCODED_EVALUATION)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("WRONG TIME FOR HANDCODED EVALUATION");
+        }
+
+        NEAT::LayeredSubstrate<CheckersNEATDatatype>* substrate = &substrates[currentSubstrateIndex];
+
+        int numInputs = numNodesX[0]*numNodesY[0];
+        CheckersNEATDatatype *inputValues = substrate->getNetwork()->getBatchLayerValues(0,numBoards);
+        vector<CheckersNEATDatatype> boardInputs(numInputs);
+
+        for (int a=0;a<numBoards;a++)
+        {
+            fill(boardInputs.begin(),boardInputs.end(),CheckersNEATDatatype(0));
+            boards[a].getSubstrateInputs(
+                &boardInputs[0],
+                numNodesX[0],
+                CheckersNEATDatatype(0.5),
+                CheckersNEATDatatype(0.75)
+                );
+
+            //The batch is node-major: input n of board a goes to n*numBoards+a
+            for (int n=0;n<numInputs;n++)
+            {
+                inputValues[n*numBoards+a] = boardInputs[n];
+            }
+        }
+
+        substrate->getNetwork()->updateBatch(numBoards);
+
+        //Node (0,0) of the output layer holds the evaluation of each board
+        const CheckersNEATDatatype *outputValues = substrate->getNetwork()->getBatchLayerValues(2,numBoards);
+
+        for (int a=0;a<numBoards;a++)
+        {
+            CheckersNEATDatatype output = outputValues[a];
+
+            //ROUNDING: Same as evaluateLeafHyperNEAT
+            output = floor(output*1000.0+0.50001)/1000.0;
+
+            values[a] = output;
+            numHyperNEATEvaluations++;
+        }
+    }
+
     class CheckersBoardMoveState
     {
     public:
@@ -1327,194 +1355,134 @@ namespace HCUBE
         {}
     };
 
-    pair<CheckersNEATDatatype,int> CheckersExperiment::evaluatemax(uchar b[8][8],  CheckersNEATDatatype parentBeta, int depth,int maxDepth)
+    //Returns the index of the moveIndex'th move to search when tableMove is
+    //searched first and the other moves keep their generated order
+    static inline int getOrderedMoveIndex(int moveIndex,int tableMove,int moveListCount)
     {
-        if (depth==0)
+        if (tableMove>=moveListCount)
         {
-            totalMoveList.clear();
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-            cout << "Creating new outfile\n";
-            if (outfile) delete outfile;
-            outfile = new ofstream("BoardEvaluations.txt");
-#endif
-
+            return moveIndex;
         }
-
-        int moveListCount;
-
-        pair<CheckersNEATDatatype,int> alpha=pair<CheckersNEATDatatype,int>(CheckersNEATDatatype(INT_MIN),-1);
-
-        bool foundJump;
-        int bestMoveSoFarIndex=-1;
-
-		int oldMoveListSize = (int)totalMoveList.size();
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        bool useCachedTable=false;
-
-        CheckersBoardState bState(b,BLACK);
-
-        if (depth==0)
+        if (moveIndex==0)
         {
+            return tableMove;
         }
-        else
-        {
-            vector<BoardStatePair> &bsVector = boardStateLists[currentSubstrateIndex][BLACK][bState.getShortHash()];
-            vector<BoardStatePair>::iterator stateIterator = bsVector.begin();
-            vector<BoardStatePair>::iterator stateEnd = bsVector.end();
-
-            for (;stateIterator != stateEnd;stateIterator++)
-            {
-                if (stateIterator->first==bState)
-                {
-                    //We have a match
-                    int depthSearched =
-                        stateIterator->second.maxDepth - stateIterator->second.depth;
-
-                    int depthToSearch = maxDepth - depth;
-
-                    if (depthSearched >= depthToSearch)
-                    {
-                        //We've been down this path before (or we are currently
-                        //going down it in another branch of the tree),
-                        //just return the best score
-                        if (stateIterator->second.getNumMoves()==0)
-                        {
-                            //No moves possible, return the min score
-                            return INT_MIN/2;
-                        }
+        return (moveIndex<=tableMove)?(moveIndex-1):moveIndex;
+    }
 
-                        return stateIterator->second.getHighestScore();
-                    }
-                    else
-                    {
-                        //We've been down this path before, but not to this level of detail.
-                        //Use the previous alpha values, but continue
-                        useCachedTable=true;
+    void CheckersExperiment::prefetchLeafEvaluations(
+        CheckersBitboard &board,
+        const CheckersBitboardMove *moveList,
+        int moveListCount
+    )
+    {
+        CheckersTranspositionTable &transpositionTable = transpositionTables[currentSubstrateIndex];
 
-                        moveListCount = stateIterator->second.getNumMoves();
+        CheckersBitboard leaves[CHECKERS_MAX_MOVES];
+        ulong leafKeys[CHECKERS_MAX_MOVES];
+        int numLeaves=0;
 
-                        /* FOR evaluatemin() FUNCTION!
-                        int index=0;
-                        for(int a=(moveListCount-1);a>=0;a--)
-                        {
-                        //We have to iterate backwards because they are sorted lowest
-                        //to highest score
-                        moveList[index] = stateIterator->second.moves.getIndexData[a];
-                        index++;
-                        }
-                        */
-
-                        for (int a=0;a<moveListCount;a++)
-                        {
-                            totalMoveList.push_back(stateIterator->second.getMove(a));
-                        }
+        for (int a=0;a<moveListCount;a++)
+        {
+            board.makeMove(moveList[a]);
 
-                        foundJump = stateIterator->second.foundJump;
+            ulong leafKey = getTranspositionKey(board);
 
-                        //Erase this, because it will get replaced.
-                        bsVector.erase(stateIterator);
+            //Wins are scored by the search itself, and positions in the table need no evaluation
+            if (board.getWinner()==-1 && !transpositionTable.probe(leafKey))
+            {
+                //Same leaf test as evaluatemax: the side to move can move, but not capture
+                bool foundJump;
+                CheckersBitboardMove childMoveList[CHECKERS_MAX_MOVES];
 
-                        //Break out of the loop so we do not keep searching
-                        //(especially because the vector has now been invalidated with
-                        //the erase)
-                        break;
-                    }
+                if (board.generateMoves(childMoveList,foundJump) && !foundJump)
+                {
+                    leaves[numLeaves] = board;
+                    leafKeys[numLeaves] = leafKey;
+                    numLeaves++;
                 }
             }
+
+            board.unmakeMove(moveList[a]);
         }
-#endif
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        if (!useCachedTable)
-#endif
+        if (numLeaves<2)
         {
-            moveListCount = generateMoveList(totalMoveList,int(totalMoveList.size()),b,BLACK,foundJump);
+            //Nothing to gain over evaluating the leaf during the search
+            return;
         }
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        else
-        {
-#if CHECKERS_DEBUG
-            //Run a test to cross-verify moves
-            HCUBE::CheckersMove tmpMoves[128];
-            bool tmpFoundJump;
-
-            int tmpMoveListCount = generateMoveList(b,tmpMoves,BLACK,tmpFoundJump);
 
-            if (moveListCount != tmpMoveListCount)
-            {
-                for (int b=0;b<moveListCount;b++)
-                {
-                    cout << (int)moveList[b].from.x << ',' << (int)moveList[b].from.y << " -> ";
-                    cout << (int)moveList[b].to.x << ',' << (int)moveList[b].to.y << endl;
-                }
-
-                cout << "***" << endl;
-
-                for (int a=0;a<tmpMoveListCount;a++)
-                {
-                    cout << (int)tmpMoves[a].from.x << ',' << (int)tmpMoves[a].from.y << " -> ";
-                    cout << (int)tmpMoves[a].to.x << ',' << (int)tmpMoves[a].to.y << endl;
-                }
+        CheckersNEATDatatype leafValues[CHECKERS_MAX_MOVES];
+        evaluateLeavesHyperNEAT(leaves,numLeaves,leafValues);
 
-                throw CREATE_LOCATEDEXCEPTION_INFO("FOUND A DIFFERING NUMBER OF MOVES!");
-            }
+        for (int a=0;a<numLeaves;a++)
+        {
+            transpositionTable.store(
+                leafKeys[a],
+                leafValues[a],
+                0,
+                CHECKERS_BOUND_EXACT,
+                CHECKERS_TRANSPOSITION_NO_MOVE
+                );
+        }
+    }
 
-            if (foundJump != tmpFoundJump)
-            {
-                throw CREATE_LOCATEDEXCEPTION_INFO("FOUND A DIFFERING JUMP VALUE!");
-            }
+    pair<CheckersNEATDatatype,int> CheckersExperiment::evaluatemax(CheckersBitboard &board,  CheckersNEATDatatype parentBeta, int depth,int maxDepth)
+    {
+        if (depth==0)
+        {
+#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
+            cout << "Creating new outfile\n";
+            if (outfile) delete outfile;
+            outfile = new ofstream("BoardEvaluations.txt");
+#endif
+        }
 
-            for (int a=0;a<moveListCount;a++)
-            {
-                for (int b=0;b<=moveListCount;b++)
-                {
-                    if (b==moveListCount)
-                    {
-                        cout << tmpMoves[a].from.x << ',' << tmpMoves[a].from.y << endl;
-                        cout << tmpMoves[a].to.x << ',' << tmpMoves[a].to.y << endl;
+        pair<CheckersNEATDatatype,int> alpha=pair<CheckersNEATDatatype,int>(CheckersNEATDatatype(INT_MIN),-1);
 
-                        cout << "***" << endl;
+        int remainingDepth = (maxDepth>depth)?(maxDepth-depth):0;
+        ulong transpositionKey = getTranspositionKey(board);
+        CheckersTranspositionTable &transpositionTable = transpositionTables[currentSubstrateIndex];
+        int tableMove = CHECKERS_TRANSPOSITION_NO_MOVE;
 
-                        for (int b=0;b<moveListCount;b++)
-                        {
-                            cout << moveList[b].from.x << ',' << moveList[b].from.y << endl;
-                            cout << moveList[b].to.x << ',' << moveList[b].to.y << endl;
+        const CheckersTranspositionEntry *tableEntry = NULL;
+        if (DEBUG_USE_TRANSPOSITION_TABLE)
+        {
+            tableEntry = transpositionTable.probe(transpositionKey);
+        }
 
-                        }
+        if (tableEntry)
+        {
+            tableMove = tableEntry->bestMove;
 
-                        throw CREATE_LOCATEDEXCEPTION_INFO("ERROR! MISSING A MOVE!");
-                    }
+            //The root is always searched so that the best and second best moves are known
+            if (
+                depth>0 &&
+                tableEntry->depth >= remainingDepth &&
+                (
+                    tableEntry->bound==CHECKERS_BOUND_EXACT ||
+                    (tableEntry->bound==CHECKERS_BOUND_LOWER && tableEntry->value >= parentBeta)
+                )
+            )
+            {
+				if(dumpEvaluationImages)
+				{
+					for(int a=0;a<depth;a++)
+					{
+						handCodedTreeStream << ">";
+					}
+					handCodedTreeStream << " ";
+					handCodedTreeStream << "[TABLE HIT] " << tableEntry->value << endl;
+				}
 
-                    if (moveList[b]==tmpMoves[a])
-                    {
-                        break;
-                    }
-                }
+                return pair<CheckersNEATDatatype,int>(tableEntry->value,-1);
             }
-#endif
         }
-#endif
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        //We have a movelist, let's cache it.
-        CheckersBoardStateData bStateData;
-
-        bStateData.depth = depth;
-        bStateData.maxDepth = maxDepth;
-        bStateData.foundJump = foundJump;
 
-        /*
-        for(int a=0;a<moveListCount;a++)
-        {
-        bStateData.moves.insert(CheckersNEATDatatype(INT_MIN/2.0),moveList[a]);
-        }
+        bool foundJump;
+        CheckersBitboardMove moveList[CHECKERS_MAX_MOVES];
 
-        boardStateLists[currentSubstrateIndex][BLACK][bState.getShortHash()].push_back(
-        BoardStatePair(bState,bStateData)
-        );
-        */
-#endif
+        int moveListCount = board.generateMoves(moveList,foundJump);
 
         if (!moveListCount)
         {
@@ -1525,36 +1493,21 @@ namespace HCUBE
         if (depth==0 && moveListCount==1)
         {
             //Forced move, don't bother doing any evaluations
-            secondBestMoveToMake = moveToMake = totalMoveList.at(oldMoveListSize);
-            totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+            secondBestMoveToMake = moveToMake = board.toCheckersMove(moveList[0],checkersMovePoolPtr);
             return pair<CheckersNEATDatatype,int>(0,-1);
         }
 
-#if 0
-        //Check for duplicate moves
-        for (int a=0;a<moveListCount;a++)
+#if CHECKERS_EXPERIMENT_DEBUG
         {
-            for (int b=0;b<moveListCount;b++)
-            {
-                if (a==b)
-                    continue;
-
-                if (moveList[a]==moveList[b])
-                {
-                    throw CREATE_LOCATEDEXCEPTION_INFO("OOPS!");
-                }
-            }
+            uchar b[8][8];
+            board.saveBoard(b);
+            printBoard(b);
         }
-#endif
-
-
-#if CHECKERS_EXPERIMENT_DEBUG
-        printBoard(b);
         cout << "Moves for black: " << endl;
         for (int a=0;a<moveListCount;a++)
         {
-            cout << "MOVE: (" << ((int)moveList[a].from.x) << ',' << ((int)moveList[a].from.y) << ") -> "
-                << "(" << ((int)moveList[a].to.x) << ',' << ((int)moveList[a].to.y) << ")" << endl;
+            cout << "MOVE: " << ((int)moveList[a].path[0]) << " -> "
+                << ((int)moveList[a].path[moveList[a].numSteps]) << endl;
         }
         CREATE_PAUSE("Done listing moves");
 #endif
@@ -1562,9 +1515,15 @@ namespace HCUBE
         if (depth >= maxDepth && DEBUG_USE_HYPERNEAT_EVALUATION && foundJump == false)
         {
             //This is a leaf node, return the neural network's evaluation
-            totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
-
-			pair<CheckersNEATDatatype,int> retval = evaluateLeafHyperNEAT(b);
+			pair<CheckersNEATDatatype,int> retval = evaluateLeafHyperNEAT(board);
+
+            transpositionTable.store(
+                transpositionKey,
+                retval.first,
+                remainingDepth,
+                CHECKERS_BOUND_EXACT,
+                CHECKERS_TRANSPOSITION_NO_MOVE
+                );
 
 			if(dumpEvaluationImages)
 			{
@@ -1583,7 +1542,7 @@ namespace HCUBE
 
         if (depth==0)
         {
-            secondBestMoveToMake = moveToMake = totalMoveList.at(oldMoveListSize);
+            secondBestMoveToMake = moveToMake = board.toCheckersMove(moveList[0],checkersMovePoolPtr);
             childBetaForSecondBestMove = (CheckersNEATDatatype)(INT_MIN/2.0);
         }
 
@@ -1597,21 +1556,33 @@ namespace HCUBE
             handCodedTreeStream << "[# MOVES] " << moveListCount << endl;
 		}
 
-        for (int a=0;a<moveListCount;a++)
+        int bestMoveIndex = CHECKERS_TRANSPOSITION_NO_MOVE;
+
+        for (int moveIndex=0;moveIndex<moveListCount;moveIndex++)
         {
-            CheckersMove currentMove = totalMoveList.at(oldMoveListSize+a);
+            //Search the best move from the transposition table first
+            int a = getOrderedMoveIndex(moveIndex,tableMove,moveListCount);
+            const CheckersBitboardMove &currentMove = moveList[a];
 
-            makeMove(currentMove,b);
+            board.makeMove(currentMove);
 
-            int winner = getWinner(b);
+            int winner = board.getWinner();
 
             if (winner==BLACK)
             {
                 //CREATE_PAUSE("FOUND WIN FOR BLACK!");
-                reverseMove(currentMove,b);
+                board.unmakeMove(currentMove);
+
+                transpositionTable.store(
+                    transpositionKey,
+                    CheckersNEATDatatype(INT_MAX/2),
+                    remainingDepth,
+                    CHECKERS_BOUND_EXACT,
+                    a
+                    );
 
                 if (depth==0)
-                    secondBestMoveToMake = moveToMake = currentMove;
+                    secondBestMoveToMake = moveToMake = board.toCheckersMove(currentMove,checkersMovePoolPtr);
 
 				if(dumpEvaluationImages)
 				{
@@ -1623,23 +1594,18 @@ namespace HCUBE
 					handCodedTreeStream << "[FOUND WIN] " << (INT_MAX/2) << endl;
 				}
 
-				totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
                 return pair<CheckersNEATDatatype,int>(CheckersNEATDatatype(INT_MAX/2),-1);
             }
 
-            childBeta = evaluatemin(b,alpha.first,depth+1,maxDepth);
-            reverseMove(currentMove,b);
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-            bStateData.insertMove(childBeta,currentMove);
-#endif
+            childBeta = evaluatemin(board,alpha.first,depth+1,maxDepth);
+            board.unmakeMove(currentMove);
 
 #if CHECKERS_EXPERIMENT_DEBUG
             for (int dd=0;dd<depth;dd++)
             {
                 cout << "*";
             }
-            cout << childBeta << endl;
+            cout << childBeta.first << endl;
 #endif
 
             if (childBeta.first > alpha.first)
@@ -1654,17 +1620,11 @@ namespace HCUBE
                 }
 
                 alpha = childBeta;
-                bestMoveSoFarIndex = a;
+                bestMoveIndex = a;
                 if (depth==0)
                 {
                     //This means that this is the root max, so store the best move.
-#if CHECKERS_EXPERIMENT_DEBUG
-                    cout << "BLACK: MOVE_TO_MAKE: (" << moveList[a].from.x << ',' << moveList[a].from.y << ") -> "
-                        << "(" << moveList[a].to.x << ',' << moveList[a].to.y << ")" << endl;
-                    CREATE_PAUSE("SETTING MOVE_TO_MAKE");
-#endif
-
-                    moveToMake = currentMove;
+                    moveToMake = board.toCheckersMove(currentMove,checkersMovePoolPtr);
                 }
                 else
                 {
@@ -1675,26 +1635,6 @@ namespace HCUBE
                         CREATE_PAUSE("");
 #endif
                         //parent will never choose this alpha
-
-                        //because we are ending prematurely, we have to fill the rest of the cached
-                        //data
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-                        for (int restOfList=(a+1);restOfList<moveListCount;restOfList++)
-                        {
-                            bStateData.insertMove(CheckersNEATDatatype(INT_MIN/2.0),totalMoveList.at(oldMoveListSize+restOfList));
-                        }
-
-                        if (memcmp(bState.b,b,sizeof(uchar)*8*8))
-                        {
-                            throw CREATE_LOCATEDEXCEPTION_INFO("BOARD STATE CHANGED SOMEHOW!");
-                        }
-
-                        boardStateLists[currentSubstrateIndex][BLACK][bState.getShortHash()].push_back(
-                            BoardStatePair(bState,bStateData)
-                            );
-#endif
-
 						if(dumpEvaluationImages)
 						{
 							for(int a=0;a<depth;a++)
@@ -1705,7 +1645,14 @@ namespace HCUBE
 							handCodedTreeStream << "PRUNED BECAUSE OF VALUE: " << parentBeta << endl;
 						}
 
-						totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+                        transpositionTable.store(
+                            transpositionKey,
+                            childBeta.first,
+                            remainingDepth,
+                            CHECKERS_BOUND_LOWER,
+                            a
+                            );
+
                         return childBeta;
                     }
                 }
@@ -1714,19 +1661,12 @@ namespace HCUBE
             {
                 if (depth==0 && childBeta.first>childBetaForSecondBestMove)
                 {
-                    secondBestMoveToMake = currentMove;
+                    secondBestMoveToMake = board.toCheckersMove(currentMove,checkersMovePoolPtr);
                     childBetaForSecondBestMove = childBeta.first;
                 }
             }
         }
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        ushort shortHash = bState.getShortHash();
-        boardStateLists[currentSubstrateIndex][BLACK][shortHash].push_back(
-            BoardStatePair(bState,bStateData)
-            );
-#endif
-
 		if(dumpEvaluationImages)
 		{
 			for(int a=0;a<depth;a++)
@@ -1737,198 +1677,73 @@ namespace HCUBE
 			handCodedTreeStream << "RETURNING VALUE: " << alpha.first << "/" << alpha.second << endl;
 		}
 
-        totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+        transpositionTable.store(
+            transpositionKey,
+            alpha.first,
+            remainingDepth,
+            CHECKERS_BOUND_EXACT,
+            bestMoveIndex
+            );
+
         return alpha;
     }
 
-    pair<CheckersNEATDatatype,int> CheckersExperiment::evaluatemin(uchar b[8][8],  CheckersNEATDatatype parentAlpha, int depth,int maxDepth)
+    pair<CheckersNEATDatatype,int> CheckersExperiment::evaluatemin(CheckersBitboard &board,  CheckersNEATDatatype parentAlpha, int depth,int maxDepth)
     {
         if (depth==0)
         {
-            totalMoveList.clear();
 #if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
             cout << "Creating new outfile\n";
             if (outfile) delete outfile;
             outfile = new ofstream("BoardEvaluations.txt");
 #endif
-
         }
 
-        int moveListCount;
-
         pair<CheckersNEATDatatype,int> beta(CheckersNEATDatatype(INT_MAX),-1);
 
-        bool foundJump;
-        int bestMoveSoFarIndex=-1;
-
-		int oldMoveListSize = (int)totalMoveList.size();
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        bool useCachedTable=false;
-
-        CheckersBoardState bState(b,WHITE);
+        int remainingDepth = (maxDepth>depth)?(maxDepth-depth):0;
+        ulong transpositionKey = getTranspositionKey(board);
+        CheckersTranspositionTable &transpositionTable = transpositionTables[currentSubstrateIndex];
+        int tableMove = CHECKERS_TRANSPOSITION_NO_MOVE;
 
-        if (depth==0)
+        const CheckersTranspositionEntry *tableEntry = NULL;
+        if (DEBUG_USE_TRANSPOSITION_TABLE)
         {
+            tableEntry = transpositionTable.probe(transpositionKey);
         }
-        else
-        {
-            vector<BoardStatePair> &bsVector = boardStateLists[currentSubstrateIndex][WHITE][bState.getShortHash()];
-            vector<BoardStatePair>::iterator stateIterator = bsVector.begin();
-            vector<BoardStatePair>::iterator stateEnd = bsVector.end();
-
-            for (;stateIterator != stateEnd;stateIterator++)
-            {
-                if (stateIterator->first==bState)
-                {
-                    //We have a match
-                    int depthSearched =
-                        stateIterator->second.maxDepth - stateIterator->second.depth;
-
-                    int depthToSearch = maxDepth - depth;
-
-                    if (depthSearched >= depthToSearch)
-                    {
-                        //We've been down this path before (or we are currently
-                        //going down it in another branch of the tree),
-                        //just return the best score
-                        if (stateIterator->second.getNumMoves()==0)
-                        {
-                            //No moves possible, return the worst score
-                            return CheckersNEATDatatype(INT_MAX/2.0);
-                        }
-
-                        return stateIterator->second.getLowestScore();
-                    }
-                    else
-                    {
-                        //We've been down this path before, but not to this level of detail.
-                        //Use the previous alpha values, but continue
-                        useCachedTable=true;
-
-                        moveListCount = stateIterator->second.getNumMoves();
-
-                        /* FOR evaluatemin() FUNCTION!
-                        int index=0;
-                        for(int a=(moveListCount-1);a>=0;a--)
-                        {
-                        //We have to iterate backwards because they are sorted lowest
-                        //to highest score
-                        moveList[index] = stateIterator->second.moves.getIndexData[a];
-                        index++;
-                        }
-                        */
-
-                        for (int a=0;a<moveListCount;a++)
-                        {
-                            totalMoveList.push_back(stateIterator->second.getMove(a));
-                        }
-
-                        foundJump = stateIterator->second.foundJump;
-
-                        //Erase this, because it will get replaced.
-                        bsVector.erase(stateIterator);
-
-                        //Break out of the loop so we do not keep searching
-                        //(especially because the vector has now been invalidated with
-                        //the erase)
-                        break;
-                    }
-                }
-            }
-        }
-#endif
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        if (!useCachedTable)
-#endif
+        if (tableEntry)
         {
-            moveListCount = generateMoveList(totalMoveList,int(totalMoveList.size()),b,WHITE,foundJump);
-        }
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        else
-        {
-#if CHECKERS_DEBUG
-            //Run a test to cross-verify moves
-            HCUBE::CheckersMove tmpMoves[128];
-            bool tmpFoundJump;
-
-            int tmpMoveListCount = generateMoveList(b,tmpMoves,WHITE,tmpFoundJump);
+            tableMove = tableEntry->bestMove;
 
-            if (moveListCount != tmpMoveListCount)
-            {
-                for (int b=0;b<moveListCount;b++)
-                {
-                    cout << (int)moveList[b].from.x << ',' << (int)moveList[b].from.y << " -> ";
-                    cout << (int)moveList[b].to.x << ',' << (int)moveList[b].to.y << endl;
-                }
-
-                cout << "***" << endl;
-
-                for (int a=0;a<tmpMoveListCount;a++)
-                {
-                    cout << (int)tmpMoves[a].from.x << ',' << (int)tmpMoves[a].from.y << " -> ";
-                    cout << (int)tmpMoves[a].to.x << ',' << (int)tmpMoves[a].to.y << endl;
-                }
-
-                throw CREATE_LOCATEDEXCEPTION_INFO("FOUND A DIFFERING NUMBER OF MOVES!");
-            }
-
-            if (foundJump != tmpFoundJump)
-            {
-                throw CREATE_LOCATEDEXCEPTION_INFO("FOUND A DIFFERING JUMP VALUE!");
-            }
-
-            for (int a=0;a<moveListCount;a++)
+            //The root is always searched so that the best and second best moves are known
+            if (
+                depth>0 &&
+                tableEntry->depth >= remainingDepth &&
+                (
+                    tableEntry->bound==CHECKERS_BOUND_EXACT ||
+                    (tableEntry->bound==CHECKERS_BOUND_UPPER && tableEntry->value <= parentAlpha)
+                )
+            )
             {
-                for (int b=0;b<=moveListCount;b++)
-                {
-                    if (b==moveListCount)
-                    {
-                        cout << tmpMoves[a].from.x << ',' << tmpMoves[a].from.y << endl;
-                        cout << tmpMoves[a].to.x << ',' << tmpMoves[a].to.y << endl;
-
-                        cout << "***" << endl;
-
-                        for (int b=0;b<moveListCount;b++)
-                        {
-                            cout << moveList[b].from.x << ',' << moveList[b].from.y << endl;
-                            cout << moveList[b].to.x << ',' << moveList[b].to.y << endl;
-
-                        }
-
-                        throw CREATE_LOCATEDEXCEPTION_INFO("ERROR! MISSING A MOVE!");
-                    }
+				if(dumpEvaluationImages)
+				{
+					for(int a=0;a<depth;a++)
+					{
+						handCodedTreeStream << ">";
+					}
+					handCodedTreeStream << " ";
+					handCodedTreeStream << "[TABLE HIT] " << tableEntry->value << endl;
+				}
 
-                    if (moveList[b]==tmpMoves[a])
-                    {
-                        break;
-                    }
-                }
+                return pair<CheckersNEATDatatype,int>(tableEntry->value,-1);
             }
-#endif
         }
-#endif
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        //We have a movelist, let's cache it.
-        CheckersBoardStateData bStateData;
 
-        bStateData.depth = depth;
-        bStateData.maxDepth = maxDepth;
-        bStateData.foundJump = foundJump;
-
-        /*
-        for(int a=0;a<moveListCount;a++)
-        {
-        bStateData.moves.insert(CheckersNEATDatatype(INT_MIN/2.0),moveList[a]);
-        }
+        bool foundJump;
+        CheckersBitboardMove moveList[CHECKERS_MAX_MOVES];
 
-        boardStateLists[currentSubstrateIndex][BLACK][bState.getShortHash()].push_back(
-        BoardStatePair(bState,bStateData)
-        );
-        */
-#endif
+        int moveListCount = board.generateMoves(moveList,foundJump);
 
         if (!moveListCount)
         {
@@ -1939,35 +1754,21 @@ namespace HCUBE
         if (depth==0 && moveListCount==1)
         {
             //Forced move, don't bother doing any evaluations
-            secondBestMoveToMake = moveToMake = totalMoveList.at(oldMoveListSize);
-            totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+            secondBestMoveToMake = moveToMake = board.toCheckersMove(moveList[0],checkersMovePoolPtr);
             return pair<CheckersNEATDatatype,int>(0,-1);
         }
 
-#if 0
-        //Check for duplicate moves
-        for (int a=0;a<moveListCount;a++)
+#if CHECKERS_EXPERIMENT_DEBUG
         {
-            for (int b=0;b<moveListCount;b++)
-            {
-                if (a==b)
-                    continue;
-
-                if (moveList[a]==moveList[b])
-                {
-                    throw CREATE_LOCATEDEXCEPTION_INFO("OOPS!");
-                }
-            }
+            uchar b[8][8];
+            board.saveBoard(b);
+            printBoard(b);
         }
-#endif
-
-#if CHECKERS_EXPERIMENT_DEBUG
-        printBoard(b);
-        cout << "Moves for black: " << endl;
+        cout << "Moves for white: " << endl;
         for (int a=0;a<moveListCount;a++)
         {
-            cout << "MOVE: (" << ((int)moveList[a].from.x) << ',' << ((int)moveList[a].from.y) << ") -> "
-                << "(" << ((int)moveList[a].to.x) << ',' << ((int)moveList[a].to.y) << ")" << endl;
+            cout << "MOVE: " << ((int)moveList[a].path[0]) << " -> "
+                << ((int)moveList[a].path[moveList[a].numSteps]) << endl;
         }
         CREATE_PAUSE("Done listing moves");
 #endif
@@ -1975,9 +1776,19 @@ namespace HCUBE
         if (depth>=maxDepth && DEBUG_USE_HANDCODED_EVALUATION && foundJump==false)
         {
             //This is a leaf node, return the hand-coded evaluation
-            totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+            uchar b[8][8];
+            board.saveBoard(b);
+
             pair<CheckersNEATDatatype,int> retval = evaluateLeafWhite(b);
 
+            transpositionTable.store(
+                transpositionKey,
+                retval.first,
+                remainingDepth,
+                CHECKERS_BOUND_EXACT,
+                CHECKERS_TRANSPOSITION_NO_MOVE
+                );
+
 			if(dumpEvaluationImages)
 			{
 				for(int a=0;a<depth;a++)
@@ -1995,7 +1806,7 @@ namespace HCUBE
 
         if (depth==0)
         {
-            secondBestMoveToMake = moveToMake = totalMoveList.at(oldMoveListSize);
+            secondBestMoveToMake = moveToMake = board.toCheckersMove(moveList[0],checkersMovePoolPtr);
             childAlphaForSecondBestMove = (CheckersNEATDatatype)(INT_MAX/2.0);
         }
 
@@ -2009,23 +1820,47 @@ namespace HCUBE
             handCodedTreeStream << "[# MOVES] " << moveListCount << endl;
 		}
 
-        for (int a=0;a<moveListCount;a++)
+        if (
+            DEBUG_BATCH_LEAF_EVALUATIONS &&
+            DEBUG_USE_TRANSPOSITION_TABLE &&
+            DEBUG_USE_HYPERNEAT_EVALUATION &&
+            batchLeafEvaluations &&
+            depth+1 >= maxDepth
+        )
+        {
+            //The replies are at the search horizon.  Evaluate the quiet ones in
+            //one batch before searching them, the searches then find the values
+            //in the transposition table.
+            prefetchLeafEvaluations(board,moveList,moveListCount);
+        }
+
+        int bestMoveIndex = CHECKERS_TRANSPOSITION_NO_MOVE;
+
+        for (int moveIndex=0;moveIndex<moveListCount;moveIndex++)
         {
-            CheckersMove currentMove = totalMoveList.at(oldMoveListSize+a);
+            //Search the best move from the transposition table first
+            int a = getOrderedMoveIndex(moveIndex,tableMove,moveListCount);
+            const CheckersBitboardMove &currentMove = moveList[a];
 
-            makeMove(currentMove,b);
+            board.makeMove(currentMove);
 
-            int winner = getWinner(b);
+            int winner = board.getWinner();
 
             if (winner==WHITE)
             {
                 //CREATE_PAUSE("FOUND WIN FOR WHITE!");
-                reverseMove(currentMove,b);
+                board.unmakeMove(currentMove);
+
+                transpositionTable.store(
+                    transpositionKey,
+                    CheckersNEATDatatype(INT_MIN/2),
+                    remainingDepth,
+                    CHECKERS_BOUND_EXACT,
+                    a
+                    );
 
                 if (depth==0)
-                    secondBestMoveToMake = moveToMake = currentMove;
-
-				totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+                    secondBestMoveToMake = moveToMake = board.toCheckersMove(currentMove,checkersMovePoolPtr);
 
 				if(dumpEvaluationImages)
 				{
@@ -2040,19 +1875,15 @@ namespace HCUBE
 				return pair<CheckersNEATDatatype,int>(CheckersNEATDatatype(INT_MIN/2),-1);
             }
 
-            childAlpha = evaluatemax(b,beta.first,depth+1,maxDepth);
-            reverseMove(currentMove,b);
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-            bStateData.insertMove(childAlpha,currentMove);
-#endif
+            childAlpha = evaluatemax(board,beta.first,depth+1,maxDepth);
+            board.unmakeMove(currentMove);
 
 #if CHECKERS_EXPERIMENT_DEBUG
             for (int dd=0;dd<depth;dd++)
             {
                 cout << "*";
             }
-            cout << childAlpha << endl;
+            cout << childAlpha.first << endl;
 #endif
 
             if (childAlpha.first < beta.first)
@@ -2068,17 +1899,11 @@ namespace HCUBE
                 }
 
                 beta = childAlpha;
-                bestMoveSoFarIndex = a;
+                bestMoveIndex = a;
                 if (depth==0)
                 {
-                    //This means that this is the root max, so store the best move.
-#if CHECKERS_EXPERIMENT_DEBUG
-                    cout << "WHITE: MOVE_TO_MAKE: (" << moveList[a].from.x << ',' << moveList[a].from.y << ") -> "
-                        << "(" << moveList[a].to.x << ',' << moveList[a].to.y << ")" << endl;
-                    CREATE_PAUSE("SETTING MOVE_TO_MAKE");
-#endif
-
-                    moveToMake = currentMove;
+                    //This means that this is the root min, so store the best move.
+                    moveToMake = board.toCheckersMove(currentMove,checkersMovePoolPtr);
                 }
                 else
                 {
@@ -2089,26 +1914,6 @@ namespace HCUBE
                         CREATE_PAUSE("");
 #endif
                         //parent will never choose this alpha
-
-                        //because we are ending prematurely, we have to fill the rest of the cached
-                        //data
-
-#if DEBUG_DO_ITERATIVE_DEEPENING
-                        for (int restOfList=(a+1);restOfList<moveListCount;restOfList++)
-                        {
-                            bStateData.insertMove(CheckersNEATDatatype(INT_MAX/2.0),totalMoveList.at(oldMoveListSize+restOfList));
-                        }
-
-                        if (memcmp(bState.b,b,sizeof(uchar)*8*8))
-                        {
-                            throw CREATE_LOCATEDEXCEPTION_INFO("BOARD STATE CHANGED SOMEHOW!");
-                        }
-
-                        boardStateLists[currentSubstrateIndex][WHITE][bState.getShortHash()].push_back(
-                            BoardStatePair(bState,bStateData)
-                            );
-#endif
-
 						if(dumpEvaluationImages)
 						{
 							for(int a=0;a<depth;a++)
@@ -2119,7 +1924,14 @@ namespace HCUBE
 							handCodedTreeStream << "PRUNED BECAUSE OF VALUE: " << parentAlpha << endl;
 						}
 
-						totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+                        transpositionTable.store(
+                            transpositionKey,
+                            childAlpha.first,
+                            remainingDepth,
+                            CHECKERS_BOUND_UPPER,
+                            a
+                            );
+
                         return beta;
                     }
                 }
@@ -2128,19 +1940,12 @@ namespace HCUBE
             {
                 if (depth==0 && childAlpha.first<childAlphaForSecondBestMove)
                 {
-                    secondBestMoveToMake = currentMove;
+                    secondBestMoveToMake = board.toCheckersMove(currentMove,checkersMovePoolPtr);
                     childAlphaForSecondBestMove = childAlpha.first;
                 }
             }
         }
 
-#if DEBUG_DO_ITERATIVE_DEEPENING
-        ushort shortHash = bState.getShortHash();
-        boardStateLists[currentSubstrateIndex][WHITE][shortHash].push_back(
-            BoardStatePair(bState,bStateData)
-            );
-#endif
-
 		if(dumpEvaluationImages)
 		{
 			for(int a=0;a<depth;a++)
@@ -2151,7 +1956,14 @@ namespace HCUBE
 			handCodedTreeStream << "RETURNING VALUE: " << beta.first << "/" << beta.second << endl;
 		}
 
-        totalMoveList.erase(totalMoveList.begin()+oldMoveListSize,totalMoveList.end());
+        transpositionTable.store(
+            transpositionKey,
+            beta.first,
+            remainingDepth,
+            CHECKERS_BOUND_EXACT,
+            bestMoveIndex
+            );
+
         return beta;
     }
 
@@ -2161,6 +1973,8 @@ namespace HCUBE
         double timeLimit
         )
     {
+        CheckersBitboard board(b,BLACK);
+
 #if DEBUG_DO_ITERATIVE_DEEPENING
         /*
         for(int a=0;a<65536;a++)
@@ -2178,7 +1992,7 @@ namespace HCUBE
         timer t;
         for (int a=2-useOdd;;a+=2)
         {
-            retval = evaluatemax(b,CheckersNEATDatatype(INT_MAX/2.0),0,a);
+            retval = evaluatemax(board,CheckersNEATDatatype(INT_MAX/2.0),0,a);
 
             if (a+2>maxDepth || t.elapsed()>timeLimit)
             {
@@ -2196,7 +2010,7 @@ namespace HCUBE
 			hyperNEATTreeStream.open(filename2.c_str());
 		}
 
-		pair<CheckersNEATDatatype,int> retval = evaluatemax(b,CheckersNEATDatatype(INT_MAX/2),0,maxDepth);
+		pair<CheckersNEATDatatype,int> retval = evaluatemax(board,CheckersNEATDatatype(INT_MAX/2),0,maxDepth);
 
 		if(dumpEvaluationImages)
 		{
@@ -2214,6 +2028,8 @@ namespace HCUBE
         double timeLimit
         )
     {
+        CheckersBitboard board(b,WHITE);
+
 #if DEBUG_DO_ITERATIVE_DEEPENING
         /*
         for(int a=0;a<65536;a++)
@@ -2231,7 +2047,7 @@ namespace HCUBE
         timer t;
         for (int a=2-useOdd;;a+=2)
         {
-            retval = evaluatemin(b,CheckersNEATDatatype(INT_MIN/2.0),0,a);
+            retval = evaluatemin(board,CheckersNEATDatatype(INT_MIN/2.0),0,a);
 
             if (a+2>maxDepth || t.elapsed()>timeLimit)
             {
@@ -2249,7 +2065,7 @@ namespace HCUBE
 			handCodedTreeStream.open(filename2.c_str());
 		}
 
-        CheckersNEATDatatype retval = evaluatemin(b,INT_MIN/2,0,maxDepth).first;
+        CheckersNEATDatatype retval = evaluatemin(board,INT_MIN/2,0,maxDepth).first;
 
 		if(dumpEvaluationImages)
 		{
@@ -2272,7 +2088,7 @@ namespace HCUBE
         DEBUG_USE_HYPERNEAT_EVALUATION = 0;
         currentSubstrateIndex=handCodedAISubstrateIndex;
 
-	    boost::mutex::scoped_lock lock(cakeMutex);
+	    boost::mutex::scoped_lock lock(clicheMutex);
 
         cout << "CLICHE BEFORE\n";
 	    printBoard(b);
@@ -2358,8 +2174,7 @@ namespace HCUBE
 		currentSubstrateIndex=handCodedAISubstrateIndex;
 
 
-		boost::mutex::scoped_lock lock(cakeMutex);
-		srand(cakeRandomSeed);
+		searchInfo.randseed = cakeRandomSeed;
 
         //cout << "CAKE BEFORE\n";
 		//printBoard(b);
@@ -2438,11 +2253,7 @@ namespace HCUBE
         for (handCodedType=0;handCodedType<HANDCODED_PLAYER_TESTS;handCodedType++)
         {
 			cakeRandomSeed = 1000 + handCodedType;
-            if(searchInfo.repcheck)
-		        free(searchInfo.repcheck);
 		    resetsearchinfo(&searchInfo);
-		    // allocate memory for repcheck array
-		    searchInfo.repcheck = (REPETITION*)malloc((MAXDEPTH+HISTORYOFFSET) * sizeof(REPETITION));
 
             resetBoard(b);
 
@@ -2454,42 +2265,6 @@ namespace HCUBE
             for (currentRound=0;currentRound<CHECKERS_MAX_ROUNDS&&retval==-1;currentRound++)
             {
 #if 1
-				//Clear the evaluation cache
-				for (int a=0;a<65536;a++)
-				{
-					boardEvaluationCaches[0][a].clear();
-					boardEvaluationCaches[0][a].reserve(0);
-				}
-				//Clear the state list caches
-				for (int a=0;a<65536;a++)
-				{
-					boardStateLists[0][BLACK][a].clear();
-					boardStateLists[0][BLACK][a].reserve(0);
-				}
-				for (int a=0;a<65536;a++)
-				{
-					boardStateLists[0][WHITE][a].clear();
-					boardStateLists[0][WHITE][a].reserve(0);
-				}
-
-				//Clear the evaluation cache
-				for (int a=0;a<65536;a++)
-				{
-					boardEvaluationCaches[1][a].clear();
-					boardEvaluationCaches[1][a].reserve(0);
-				}
-				//Clear the state list caches
-				for (int a=0;a<65536;a++)
-				{
-					boardStateLists[1][BLACK][a].clear();
-					boardStateLists[1][BLACK][a].reserve(0);
-				}
-				for (int a=0;a<65536;a++)
-				{
-					boardStateLists[1][WHITE][a].clear();
-					boardStateLists[1][WHITE][a].reserve(0);
-				}
-
                 //cout << "Round: " << currentRound << endl;
                 moveToMake = CheckersMove();
                 secondBestMoveToMake = CheckersMove();
@@ -12,6 +12,9 @@ namespace HCUBE
             :
             CheckersExperiment(_experimentName,_threadID)
     {
+        //Leaves are evaluated by a FastNetwork, not the layered substrate
+        batchLeafEvaluations = false;
+
         generateSubstrate();
     }
 
@@ -60,7 +63,7 @@ namespace HCUBE
     }
 
     pair<CheckersNEATDatatype,int> CheckersExperimentNoGeom::evaluateLeafHyperNEAT(
-        uchar b[8][8]
+        const CheckersBitboard &board
     )
     {
 #if CHECKERS_EXPERIMENT_ENABLE_BIASES
@@ -79,120 +82,53 @@ namespace HCUBE
         }
         CheckersNEATDatatype output;
 
-#if DEBUG_USE_BOARD_EVALUATION_CACHE
-        tmpboard.loadBoard(b);
-        ushort hashVal = tmpboard.getShortHash();
-
-        BoardCacheList::iterator bIterator =
-            boardEvaluationCaches[currentSubstrateIndex][hashVal].begin();
-        BoardCacheList::iterator bEnd =
-            boardEvaluationCaches[currentSubstrateIndex][hashVal].end();
+        network->reinitialize();
+        network->dummyActivation();
 
-        for (;bIterator != bEnd;bIterator++)
+        if (network->hasNode("Bias"))
         {
-            if (bIterator->first == tmpboard)
-            {
-                //We have a match!
-                break;
-            }
+            network->setValue("Bias",(CheckersNEATDatatype)0.3);
         }
 
-        if (bIterator != bEnd)
-        {
-            output = bIterator->second;
-        }
-        else
-#endif
-        {
-
-            network->reinitialize();
-            network->dummyActivation();
-
-            if (network->hasNode("Bias"))
-            {
-                network->setValue("Bias",(CheckersNEATDatatype)0.3);
-            }
+        CheckersNEATDatatype inputValues[8*8];
+        board.getSubstrateInputs(
+            inputValues,
+            8,
+            CheckersNEATDatatype(0.5),
+            CheckersNEATDatatype(0.75)
+            );
 
-            for (int y=0;y<numNodesY[0];y++)
+        for (int y=0;y<numNodesY[0];y++)
+        {
+            for (int x=0;x<numNodesX[0];x++)
             {
-                for (int x=0;x<numNodesX[0];x++)
-                {
-                    if ( (x+y)%2==1 ) //ignore empty squares.
-                        continue;
+                if ( (x+y)%2==1 ) //ignore empty squares.
+                    continue;
 
-                    int boardx = x;
-                    int boardy = y;
-
-                    //cout << boardx << ',' << boardy << ": " << b[boardx][boardy] << endl;
-
-                    if ( (b[boardx][boardy]&WHITE) )
-                    {
-                        //cout << "FOUND WHITE\n";
-                        if ( (b[boardx][boardy]&KING) )
-                        {
-                            network->setValue( getNameFromNode(Node(x,y,0)) , -0.75 );
-                        }
-                        else if ( (b[boardx][boardy]&MAN) )
-                        {
-                            network->setValue( getNameFromNode(Node(x,y,0)) , -0.5 );
-                        }
-                        else
-                        {
-                            throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
-                        }
-                    }
-                    else if ( (b[boardx][boardy]&BLACK) )
-                    {
-                        //cout << "FOUND BLACK\n";
-                        if ( (b[boardx][boardy]&KING) )
-                        {
-							network->setValue( getNameFromNode(Node(x,y,0)) , 0.75 );
-                        }
-                        else if ( (b[boardx][boardy]&MAN) )
-                        {
-                            network->setValue( getNameFromNode(Node(x,y,0)) , 0.5 );
-                        }
-                        else
-                        {
-                            throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
-                        }
-                    }
-                    else
-                    {
-                        //cout << "FOUND NOTHING\n";
-                        network->setValue( getNameFromNode(Node(x,y,0)) , 0.0 );
-                    }
-
-                }
+                network->setValue( getNameFromNode(Node(x,y,0)) , inputValues[y*8+x] );
             }
+        }
 
-            network->updateFixedIterations(2);
-            output = network->getValue(getNameFromNode(Node(0,0,2)));
+        network->updateFixedIterations(2);
+        output = network->getValue(getNameFromNode(Node(0,0,2)));
 
 #if CHECKERS_EXPERIMENT_DEBUG
-            static CheckersNEATDatatype prevOutput;
+        static CheckersNEATDatatype prevOutput;
 
-            if (fabs(output-prevOutput)>1e-3)
-            {
-                prevOutput = output;
-                cout << "BOARD RATING:" << output << endl;
-                CREATE_PAUSE("");
-            }
-#endif
-
-#if DEBUG_USE_BOARD_EVALUATION_CACHE
-            if (boardEvaluationCaches[currentSubstrateIndex][hashVal].size()<10000)
-            {
-                boardEvaluationCaches[currentSubstrateIndex][hashVal].push_back(
-                    BoardCachePair(tmpboard,output)
-                    );
-            }
-#endif
+        if (fabs(output-prevOutput)>1e-3)
+        {
+            prevOutput = output;
+            cout << "BOARD RATING:" << output << endl;
+            CREATE_PAUSE("");
         }
+#endif
 
 #if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
         cout << "Printing board leaf evaluations\n";
 
+        uchar b[8][8];
+        board.saveBoard(b);
+
         int whiteMen,blackMen,whiteKings,blackKings;
         countPieces(b,whiteMen,blackMen,whiteKings,blackKings);
 
@@ -287,21 +223,8 @@ namespace HCUBE
 
         substrateIndividuals[substrateNum]=individual;
 
-        //Clear the evaluation cache
-        for (int a=0;a<65536;a++)
-        {
-            boardEvaluationCaches[substrateNum][a].clear();
-        }
-
-        //Clear the state list caches
-        for (int a=0;a<65536;a++)
-        {
-            boardStateLists[substrateNum][BLACK][a].clear();
-        }
-        for (int a=0;a<65536;a++)
-        {
-            boardStateLists[substrateNum][WHITE][a].clear();
-        }
+        //Search results from the previous individual are no longer valid
+        transpositionTables[substrateNum].clear();
 
         networks[substrateNum] = individual->spawnFastPhenotypeStack<CheckersNEATDatatype>();
     }
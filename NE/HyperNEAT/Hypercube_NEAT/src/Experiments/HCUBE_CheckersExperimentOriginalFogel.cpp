@@ -12,6 +12,9 @@ namespace HCUBE
             :
             CheckersExperiment(_experimentName,_threadID)
     {
+        //Leaves are evaluated by a FastNetwork, not the layered substrate
+        batchLeafEvaluations = false;
+
         generateSubstrate();
     }
 
@@ -175,26 +178,13 @@ namespace HCUBE
 
         substrateIndividuals[substrateNum]=individual;
 
-        //Clear the evaluation cache
-        for (int a=0;a<65536;a++)
-        {
-            boardEvaluationCaches[substrateNum][a].clear();
-        }
-
-        //Clear the state list caches
-        for (int a=0;a<65536;a++)
-        {
-            boardStateLists[substrateNum][BLACK][a].clear();
-        }
-        for (int a=0;a<65536;a++)
-        {
-            boardStateLists[substrateNum][WHITE][a].clear();
-        }
+        //Search results from the previous individual are no longer valid
+        transpositionTables[substrateNum].clear();
 
         networks[substrateNum] = individual->spawnFastPhenotypeStack<CheckersNEATDatatype>();
     }
 
-    pair<CheckersNEATDatatype,int> CheckersExperimentOriginalFogel::evaluateLeafHyperNEAT(uchar b[8][8])
+    pair<CheckersNEATDatatype,int> CheckersExperimentOriginalFogel::evaluateLeafHyperNEAT(const CheckersBitboard &board)
     {
 #if CHECKERS_EXPERIMENT_ENABLE_BIASES
         NEAT::FastBiasNetwork<CheckersNEATDatatype>* substrate;
@@ -208,6 +198,14 @@ namespace HCUBE
 
         substrate->reinitialize();
 
+        CheckersNEATDatatype pieceValues[8*8];
+        board.getSubstrateInputs(
+            pieceValues,
+            8,
+            CheckersNEATDatatype(1.0),
+            CheckersNEATDatatype(1.3)
+            );
+
         if (substrate->hasNode("Bias"))
         {
             substrate->setValue("Bias",(CheckersNEATDatatype)0.3);
@@ -220,37 +218,37 @@ namespace HCUBE
                 if (x<6&&y<6)
                 {
                     string nodeName = string("Input_3x3_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,3,3));
+                    substrate->setValue(nodeName,getSpatialInput(pieceValues,x,y,3,3));
                 }
 
                 if (x<5&&y<5)
                 {
                     string nodeName = string("Input_4x4_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,4,4));
+                    substrate->setValue(nodeName,getSpatialInput(pieceValues,x,y,4,4));
                 }
 
                 if (x<4&&y<4)
                 {
                     string nodeName = string("Input_5x5_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,5,5));
+                    substrate->setValue(nodeName,getSpatialInput(pieceValues,x,y,5,5));
                 }
 
                 if (x<3&&y<3)
                 {
                     string nodeName = string("Input_6x6_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,6,6));
+                    substrate->setValue(nodeName,getSpatialInput(pieceValues,x,y,6,6));
                 }
 
                 if (x<2&&y<2)
                 {
                     string nodeName = string("Input_7x7_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,7,7));
+                    substrate->setValue(nodeName,getSpatialInput(pieceValues,x,y,7,7));
                 }
 
                 if (x<1&&y<1)
                 {
                     string nodeName = string("Input_8x8_") + toString(x) + string("_") + toString(y);
-                    substrate->setValue(nodeName,getSpatialInput(b,x,y,8,8));
+                    substrate->setValue(nodeName,getSpatialInput(pieceValues,x,y,8,8));
                 }
             }
         }
@@ -272,7 +270,7 @@ namespace HCUBE
         return pair<CheckersNEATDatatype,int>(output,-1);
     }
 
-    CheckersNEATDatatype CheckersExperimentOriginalFogel::getSpatialInput(uchar b[8][8],int x,int y,int sizex,int sizey)
+    CheckersNEATDatatype CheckersExperimentOriginalFogel::getSpatialInput(const CheckersNEATDatatype *pieceValues,int x,int y,int sizex,int sizey)
     {
         CheckersNEATDatatype sum=0.0;
         for (int boardx=x;boardx<x+sizex;boardx++)
@@ -282,42 +280,7 @@ namespace HCUBE
                 if ( (boardx+boardy)%2==1 ) //ignore empty squares.
                     continue;
 
-                if ( (b[boardx][boardy]&WHITE) )
-                {
-                    //cout << "FOUND WHITE\n";
-                    if ( (b[boardx][boardy]&KING) )
-                    {
-                        sum -= (CheckersNEATDatatype)1.3;
-                    }
-                    else if ( (b[boardx][boardy]&MAN) )
-                    {
-                        sum -= (CheckersNEATDatatype)1.0;
-                    }
-                    else
-                    {
-                        throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
-                    }
-                }
-                else if ( (b[boardx][boardy]&BLACK) )
-                {
-                    //cout << "FOUND BLACK\n";
-                    if ( (b[boardx][boardy]&KING) )
-                    {
-                        sum += (CheckersNEATDatatype)1.3;
-                    }
-                    else if ( (b[boardx][boardy]&MAN) )
-                    {
-                        sum += (CheckersNEATDatatype)1.0;
-                    }
-                    else
-                    {
-                        throw CREATE_LOCATEDEXCEPTION_INFO("Could not determine piece type (man/king)!");
-                    }
-                }
-                else
-                {
-                }
-
+                sum += pieceValues[boardy*8+boardx];
             }
         }
 
@@ -53,8 +53,6 @@ extern ofstream hyperNEATTreeStream;
 
 #define DEBUG_SHOW_HYPERNEAT_ALTERNATIVES (0)
 
-extern CheckersAdvisor *checkersAdvisor;
-
 namespace HCUBE
 {
     class BoardEvaluation
@@ -95,8 +93,6 @@ namespace HCUBE
 
     using namespace NEAT;
 
-    extern mutex cakeMutex;
-
     CheckersExperimentPruning::CheckersExperimentPruning(string _experimentName,int _threadID)
         :
     Experiment(_experimentName,_threadID),
@@ -108,7 +104,7 @@ namespace HCUBE
         cakeRandomSeed(1000),
 		maxCakeNodes(10000)
     {
-        searchInfo.repcheck = (REPETITION*)malloc((MAXDEPTH+HISTORYOFFSET)*sizeof(REPETITION));
+        cake_initsearchinfo(&searchInfo,0);
         //boardEvaluationCaches[0].resize(10000);
         //boardEvaluationCaches[1].resize(10000);
 
@@ -142,10 +138,46 @@ namespace HCUBE
         substrate.setLayerInfo(layerInfo);
     }
 
+    CheckersExperimentPruning::CheckersExperimentPruning(const CheckersExperimentPruning &other)
+        :
+    Experiment(other),
+        CheckersCommon(other),
+        CheckersAdvisor(other),
+        substrate(other.substrate),
+        substrateIndividual(other.substrateIndividual),
+        nameLookup(other.nameLookup),
+        moveToMake(other.moveToMake),
+        chanceToMakeSecondBestMove(other.chanceToMakeSecondBestMove),
+        childAlphaForSecondBestMove(other.childAlphaForSecondBestMove),
+        childBetaForSecondBestMove(other.childBetaForSecondBestMove),
+        secondBestMoveToMake(other.secondBestMoveToMake),
+        totalMoveList(other.totalMoveList),
+        userEvaluationRound(other.userEvaluationRound),
+        from(other.from),
+        handCodedType(other.handCodedType),
+        DEBUG_USE_HANDCODED_EVALUATION(other.DEBUG_USE_HANDCODED_EVALUATION),
+        DEBUG_USE_HYPERNEAT_EVALUATION(other.DEBUG_USE_HYPERNEAT_EVALUATION),
+        tmpboard(other.tmpboard),
+        dumpEvaluationImages(other.dumpEvaluationImages),
+		numHandCodedStreams(other.numHandCodedStreams),
+		numHandCodedEvaluations(other.numHandCodedEvaluations),
+		numHyperNEATStreams(other.numHyperNEATStreams),
+		numHyperNEATEvaluations(other.numHyperNEATEvaluations),
+        cakeRandomSeed(other.cakeRandomSeed),
+        currentRound(other.currentRound),
+		maxCakeNodes(other.maxCakeNodes)
+    {
+        //Copies run in other threads, sharing the tables would race on
+        //them and free them twice
+        cake_initsearchinfo(&searchInfo,0);
+
+        memcpy(userEvaluationBoard,other.userEvaluationBoard,sizeof(userEvaluationBoard));
+        memcpy(boardHistory,other.boardHistory,sizeof(boardHistory));
+    }
+
     CheckersExperimentPruning::~CheckersExperimentPruning()
     {
-        if(searchInfo.repcheck)
-            free(searchInfo.repcheck);
+        cake_exitsearchinfo(&searchInfo);
     }
 
     GeneticPopulation* CheckersExperimentPruning::createInitialPopulation(int populationSize)
@@ -284,16 +316,15 @@ namespace HCUBE
         if(colorToMove==BLACK)
             otherColor=WHITE;
 
-        boost::mutex::scoped_lock lock(cakeMutex);
-        srand(cakeRandomSeed);
+        searchInfo.randseed = cakeRandomSeed;
 
 		if(useAdvisor)
 		{
-			checkersAdvisor = this;
+			searchInfo.advisor = this;
 		}
 		else
 		{
-			checkersAdvisor = NULL;
+			searchInfo.advisor = NULL;
 		}
 
         //cout << "CAKE BEFORE\n";
@@ -319,7 +350,7 @@ namespace HCUBE
         //firstevaluatemin(b,BASE_EVOLUTION_SEARCH_DEPTH);
         //cout << "SimpleCheckers time: ";
 
-		checkersAdvisor = NULL;
+		searchInfo.advisor = NULL;
 
 		if(cakeReturn==WIN)
 		{
@@ -575,7 +606,6 @@ int GIVE_OPPONENT_HANDICAP=false;
     Experiment* CheckersExperimentPruning::clone()
     {
         CheckersExperimentPruning* experiment = new CheckersExperimentPruning(*this);
-        experiment->searchInfo.repcheck = (REPETITION*)malloc((MAXDEPTH+HISTORYOFFSET)*sizeof(REPETITION));
 
         return experiment;
     }
@@ -106,21 +106,8 @@ namespace HCUBE
 
         substrateIndividuals[substrateNum]=individual;
 
-        //Clear the evaluation cache
-        for (int a=0;a<65536;a++)
-        {
-            boardEvaluationCaches[substrateNum][a].clear();
-        }
-
-        //Clear the state list caches
-        for (int a=0;a<65536;a++)
-        {
-            boardStateLists[substrateNum][BLACK][a].clear();
-        }
-        for (int a=0;a<65536;a++)
-        {
-            boardStateLists[substrateNum][WHITE][a].clear();
-        }
+        //Search results from the previous individual are no longer valid
+        transpositionTables[substrateNum].clear();
 
         networks[substrateNum] = individual->spawnFastPhenotypeStack<CheckersNEATDatatype>();
     }
@@ -0,0 +1,132 @@
+#include "HCUBE_Defines.h"
+
+#include "Experiments/HCUBE_CheckersTranspositionTable.h"
+
+#define CACHE_LINE_SIZE (64)
+
+namespace HCUBE
+{
+    CheckersTranspositionTable::CheckersTranspositionTable()
+    {
+        allocate();
+    }
+
+    CheckersTranspositionTable::CheckersTranspositionTable(const CheckersTranspositionTable &other)
+    {
+        allocate();
+        *this = other;
+    }
+
+    CheckersTranspositionTable::~CheckersTranspositionTable()
+    {
+        delete[] memory;
+    }
+
+    CheckersTranspositionTable &CheckersTranspositionTable::operator=(const CheckersTranspositionTable &other)
+    {
+        if (this != &other)
+        {
+            memcpy(
+                buckets,
+                other.buckets,
+                sizeof(CheckersTranspositionBucket)*CHECKERS_TRANSPOSITION_TABLE_BUCKETS
+                );
+            generation = other.generation;
+        }
+        return *this;
+    }
+
+    void CheckersTranspositionTable::allocate()
+    {
+        memory = new char[sizeof(CheckersTranspositionBucket)*CHECKERS_TRANSPOSITION_TABLE_BUCKETS + CACHE_LINE_SIZE];
+
+        //Align the buckets to the start of a cache line
+        size_t offset = size_t(memory) & (CACHE_LINE_SIZE-1);
+        buckets = (CheckersTranspositionBucket*)(memory + (offset ? CACHE_LINE_SIZE-offset : 0));
+
+        memset(buckets,0,sizeof(CheckersTranspositionBucket)*CHECKERS_TRANSPOSITION_TABLE_BUCKETS);
+
+        //Zeroed entries belong to generation 0, so they start out empty
+        generation = 1;
+    }
+
+    void CheckersTranspositionTable::clear()
+    {
+        generation++;
+
+        if (generation==0)
+        {
+            //The generation counter wrapped around, so old entries could look current again
+            memset(buckets,0,sizeof(CheckersTranspositionBucket)*CHECKERS_TRANSPOSITION_TABLE_BUCKETS);
+            generation = 1;
+        }
+    }
+
+    const CheckersTranspositionEntry *CheckersTranspositionTable::probe(ulong key) const
+    {
+        const CheckersTranspositionBucket &bucket = getBucket(key);
+
+        for (int a=0;a<CHECKERS_TRANSPOSITION_BUCKET_SIZE;a++)
+        {
+            const CheckersTranspositionEntry &entry = bucket.entries[a];
+
+            if (entry.key==key && entry.generation==generation)
+            {
+                return &entry;
+            }
+        }
+
+        return NULL;
+    }
+
+    void CheckersTranspositionTable::store(
+        ulong key,
+        CheckersNEATDatatype value,
+        int depth,
+        CheckersTranspositionBound bound,
+        int bestMove
+    )
+    {
+        CheckersTranspositionBucket &bucket = getBucket(key);
+
+        CheckersTranspositionEntry *replace = NULL;
+
+        for (int a=0;a<CHECKERS_TRANSPOSITION_BUCKET_SIZE;a++)
+        {
+            CheckersTranspositionEntry &entry = bucket.entries[a];
+
+            if (entry.generation!=generation)
+            {
+                //Empty or stale entry, use it unless the key is found further on
+                if (!replace || replace->generation==generation)
+                {
+                    replace = &entry;
+                }
+                continue;
+            }
+
+            if (entry.key==key)
+            {
+                if (bestMove==CHECKERS_TRANSPOSITION_NO_MOVE)
+                {
+                    //Keep the move from an earlier search for ordering
+                    bestMove = entry.bestMove;
+                }
+                replace = &entry;
+                break;
+            }
+
+            if (!replace || (replace->generation==generation && entry.depth < replace->depth))
+            {
+                replace = &entry;
+            }
+        }
+
+        replace->key = key;
+        replace->value = value;
+        replace->depth = char(depth);
+        replace->bound = uchar(bound);
+        replace->bestMove = uchar(bestMove);
+        replace->generation = generation;
+    }
+}
@@ -17,6 +17,69 @@ namespace HCUBE
             CheckersExperiment(_experimentName,_threadID)
     {
         DEBUG_USE_HYPERNEAT_EVALUATION=1;
+
+        createOpenings();
+    }
+
+    CoCheckersExperiment::CoCheckersExperiment(const CoCheckersExperiment &other)
+            :
+            CheckersExperiment(other),
+            NEAT::CoEvoExperiment(other),
+            individualBlack(other.individualBlack),
+            individualWhite(other.individualWhite),
+            testCases(other.testCases),
+            openingBoards(other.openingBoards)
+    {
+    }
+
+    void CoCheckersExperiment::createOpenings()
+    {
+        int numOpenings=0;
+
+        if (NEAT::Globals::getSingleton()->hasParameterValue("CoEvoOpenings"))
+        {
+            numOpenings = max(0,int(NEAT::Globals::getSingleton()->getParameterValue("CoEvoOpenings")+0.001));
+        }
+
+        NEAT::Random random(COCHECKERS_OPENING_SEED);
+
+        uchar b[8][8];
+        vector<CheckersMove> moveList;
+
+        openingBoards.reserve(numOpenings*8*8);
+        for (int a=0;a<numOpenings;a++)
+        {
+            resetBoard(b);
+
+            for (int ply=0;ply<COCHECKERS_OPENING_PLIES;ply++)
+            {
+                //Nobody runs out of moves this early in the game
+                bool foundJump=false;
+                moveList.clear();
+                int numMoves = generateMoveList(moveList,0,b,(ply%2==0)?BLACK:WHITE,foundJump);
+
+                makeMove(moveList[random.getRandomInt(numMoves)],b);
+            }
+
+            openingBoards.insert(openingBoards.end(),&b[0][0],&b[0][0]+8*8);
+        }
+    }
+
+    int CoCheckersExperiment::getOpeningCount()
+    {
+        return int(openingBoards.size())/(8*8);
+    }
+
+    void CoCheckersExperiment::resetToOpening(uchar b[8][8])
+    {
+        if (openingBoards.empty())
+        {
+            resetBoard(b);
+        }
+        else
+        {
+            memcpy(b,&openingBoards[(opening%getOpeningCount())*8*8],sizeof(uchar)*8*8);
+        }
     }
 
     NEAT::GeneticPopulation* CoCheckersExperiment::createInitialPopulation(int populationSize)
@@ -113,7 +176,8 @@ namespace HCUBE
                 individualWhite = ind1;
             }
 
-            resetBoard(b);
+            //Both games start from the same position
+            resetToOpening(b);
 
             int retval=-1;
             int rounds=0;
@@ -133,7 +197,10 @@ namespace HCUBE
                 }
 
                 //cout << "Black is thinking...\n";
-                evaluatemax(b,CheckersNEATDatatype(INT_MAX/2),0,2);
+                {
+                    CheckersBitboard board(b,BLACK);
+                    evaluatemax(board,CheckersNEATDatatype(INT_MAX/2),0,2);
+                }
 
 #if CHECKERS_EXPERIMENT_DEBUG
                 cout << "BLACK MAKING MOVE\n";
@@ -179,7 +246,8 @@ namespace HCUBE
                         }
 
                         //cout << "White is thinking...\n";
-                        evaluatemin(b,CheckersNEATDatatype(INT_MAX/2),0,3);
+                        CheckersBitboard board(b,WHITE);
+                        evaluatemin(board,CheckersNEATDatatype(INT_MAX/2),0,3);
                         //cout << "SimpleCheckers time: ";
                     }
 
@@ -299,6 +367,9 @@ namespace HCUBE
         //Play all the tests, but do not change test fitness
         for (int a=0;a<coEvoGeneration->getTestCount();a++)
         {
+            //Every individual plays a test from the same opening
+            setOpening(a);
+
             pair<double,double> rewards =
                 playGame(
                     group[0],
@@ -327,6 +398,12 @@ namespace HCUBE
         return experiment;
     }
 
+    shared_ptr<NEAT::CoEvoExperiment> CoCheckersExperiment::cloneCoEvo()
+    {
+        //CheckersExperiment's copy constructor gives the clone its own searchInfo
+        return shared_ptr<NEAT::CoEvoExperiment>(new CoCheckersExperiment(*this));
+    }
+
     void CoCheckersExperiment::addGenerationData(
         shared_ptr<NEAT::GeneticGeneration> generation,
         shared_ptr<NEAT::GeneticIndividual> individual
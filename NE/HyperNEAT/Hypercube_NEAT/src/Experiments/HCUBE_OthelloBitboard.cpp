@@ -0,0 +1,199 @@
+#include "HCUBE_Defines.h"
+
+#include "Experiments/HCUBE_OthelloBitboard.h"
+
+namespace HCUBE
+{
+    //Squares that are not on the left or right edge of the board
+    static const ulong NOT_LEFT_EDGE = 0xFEFEFEFEFEFEFEFEULL;
+    static const ulong NOT_RIGHT_EDGE = 0x7F7F7F7F7F7F7F7FULL;
+
+    //The 8 directions as the change of the square index, and the squares a
+    //step in that direction can land on without wrapping around an edge
+    static const int directionDeltas[8] = { 1, -1, 8, -8, 9, 7, -7, -9 };
+
+    static const ulong directionMasks[8] =
+    {
+        NOT_LEFT_EDGE,
+        NOT_RIGHT_EDGE,
+        ~ulong(0),
+        ~ulong(0),
+        NOT_LEFT_EDGE,
+        NOT_RIGHT_EDGE,
+        NOT_LEFT_EDGE,
+        NOT_RIGHT_EDGE
+    };
+
+    static inline ulong shiftSquares(ulong bits,int delta)
+    {
+        return (delta>0)?(bits<<delta):(bits>>(-delta));
+    }
+
+    /*
+     * Kogge-Stone occluded fill: extends gen in direction delta over the
+     * squares in pro, which has to be masked for that direction already.
+     * Three doubling steps cover the 6 squares a run of flips can be long.
+     */
+    static inline ulong fillSquares(ulong gen,ulong pro,int delta)
+    {
+        gen |= pro & shiftSquares(gen,delta);
+        pro &= shiftSquares(pro,delta);
+        gen |= pro & shiftSquares(gen,2*delta);
+        pro &= shiftSquares(pro,2*delta);
+        gen |= pro & shiftSquares(gen,4*delta);
+        return gen;
+    }
+
+    OthelloBitboard::OthelloBitboard()
+        :
+        black(0),
+        white(0)
+    {}
+
+    OthelloBitboard::OthelloBitboard(ulong _black,ulong _white)
+        :
+        black(_black),
+        white(_white)
+    {}
+
+    OthelloBitboard::OthelloBitboard(ushort b[8][8])
+    {
+        loadBoard(b);
+    }
+
+    void OthelloBitboard::loadBoard(ushort b[8][8])
+    {
+        black = white = 0;
+
+        for (int y=0;y<8;y++)
+        {
+            for (int x=0;x<8;x++)
+            {
+                int piece = OTHELLO_GET_PIECE(b[x][y]);
+
+                if (piece==OTHELLO_BLACK)
+                {
+                    black |= ulong(1)<<(y*8+x);
+                }
+                else if (piece==OTHELLO_WHITE)
+                {
+                    white |= ulong(1)<<(y*8+x);
+                }
+            }
+        }
+    }
+
+    void OthelloBitboard::saveBoard(ushort b[8][8]) const
+    {
+        memset(b,0,sizeof(ushort)*8*8);
+
+        for (ulong bits=black;bits;bits&=bits-1)
+        {
+            int square = lowestSquare(bits);
+            b[squareToX(square)][squareToY(square)] = OTHELLO_BLACK;
+        }
+
+        for (ulong bits=white;bits;bits&=bits-1)
+        {
+            int square = lowestSquare(bits);
+            b[squareToX(square)][squareToY(square)] = OTHELLO_WHITE;
+        }
+
+        OTHELLO_SET_NUM_BLACK_PIECES(b,countSquares(black));
+        OTHELLO_SET_NUM_WHITE_PIECES(b,countSquares(white));
+    }
+
+    ulong OthelloBitboard::generateMoves(int color) const
+    {
+        ulong own = getPieces(color);
+        ulong opponents = getPieces(OTHELLO_BLACK+OTHELLO_WHITE-color);
+        ulong moves=0;
+
+        for (int d=0;d<8;d++)
+        {
+            int delta = directionDeltas[d];
+            ulong pro = opponents & directionMasks[d];
+
+            //Runs of opponents that start next to one of our pieces
+            ulong runs = fillSquares(shiftSquares(own,delta) & pro,pro,delta);
+
+            moves |= shiftSquares(runs,delta) & directionMasks[d];
+        }
+
+        return moves & getEmpty();
+    }
+
+    ulong OthelloBitboard::getFlips(int color,int square) const
+    {
+        ulong placed = ulong(1)<<square;
+
+        if (placed & (black|white))
+        {
+            return 0;
+        }
+
+        ulong own = getPieces(color);
+        ulong opponents = getPieces(OTHELLO_BLACK+OTHELLO_WHITE-color);
+        ulong flips=0;
+
+        for (int d=0;d<8;d++)
+        {
+            int delta = directionDeltas[d];
+            ulong pro = opponents & directionMasks[d];
+
+            ulong run = fillSquares(shiftSquares(placed,delta) & pro,pro,delta);
+
+            //The run only flips if one of our pieces closes it
+            if (shiftSquares(run,delta) & directionMasks[d] & own)
+            {
+                flips |= run;
+            }
+        }
+
+        return flips;
+    }
+
+    int OthelloBitboard::getWinner() const
+    {
+        int blackPieces = countSquares(black);
+        int whitePieces = countSquares(white);
+
+        if (!blackPieces)
+        {
+            return OTHELLO_WHITE;
+        }
+        else if (!whitePieces)
+        {
+            return OTHELLO_BLACK;
+        }
+        else if (hasAnyMove())
+        {
+            //Game is still ongoing
+            return OTHELLO_END_UNKNOWN;
+        }
+        else if (blackPieces<whitePieces)
+        {
+            return OTHELLO_WHITE;
+        }
+        else if (blackPieces>whitePieces)
+        {
+            return OTHELLO_BLACK;
+        }
+        else
+        {
+            return OTHELLO_END_TIE;
+        }
+    }
+
+    int OthelloBitboard::listSquares(ulong bits,int *squares)
+    {
+        int numSquares=0;
+
+        for (;bits;bits&=bits-1)
+        {
+            squares[numSquares++] = lowestSquare(bits);
+        }
+
+        return numSquares;
+    }
+}
@@ -37,6 +37,55 @@ namespace HCUBE
             OthelloExperiment(_experimentName,_threadID)
     {
         generateSubstrate(1);
+
+        createOpenings();
+    }
+
+    void OthelloCoExperiment::createOpenings()
+    {
+        int numOpenings=0;
+
+        if (NEAT::Globals::getSingleton()->hasParameterValue("CoEvoOpenings"))
+        {
+            numOpenings = max(0,int(NEAT::Globals::getSingleton()->getParameterValue("CoEvoOpenings")+0.001));
+        }
+
+        NEAT::Random random(OTHELLO_OPENING_SEED);
+
+        ushort b[8][8];
+
+        openingBoards.reserve(numOpenings*8*8);
+        for (int a=0;a<numOpenings;a++)
+        {
+            resetBoard(b);
+
+            for (int ply=0;ply<OTHELLO_OPENING_PLIES;ply++)
+            {
+                //Nobody has to pass this early in the game
+                int numMoves = generateMoveList(b,totalMoveList,(ply%2==0)?OTHELLO_BLACK:OTHELLO_WHITE);
+
+                makeMove(totalMoveList[random.getRandomInt(numMoves)],b);
+            }
+
+            openingBoards.insert(openingBoards.end(),&b[0][0],&b[0][0]+8*8);
+        }
+    }
+
+    int OthelloCoExperiment::getOpeningCount()
+    {
+        return int(openingBoards.size())/(8*8);
+    }
+
+    void OthelloCoExperiment::resetToOpening(ushort b[8][8])
+    {
+        if (openingBoards.empty())
+        {
+            resetBoard(b);
+        }
+        else
+        {
+            memcpy(b,&openingBoards[(opening%getOpeningCount())*8*8],sizeof(ushort)*8*8);
+        }
     }
 
     GeneticPopulation* OthelloCoExperiment::createInitialPopulation(int populationSize)
@@ -141,7 +190,8 @@ namespace HCUBE
                 whiteReward = &(rewards.first);
             }
 
-            resetBoard(b);
+            //Both games start from the same position
+            resetToOpening(b);
 
             int retval=OTHELLO_END_UNKNOWN;
             int rounds=0;
@@ -158,7 +208,10 @@ namespace HCUBE
                 //in the first game, the first individual is black.
                 currentSubstrateIndex = curGame;
 
-                evaluatemax(b,OthelloNEATDatatype(INT_MAX/2),0,1);
+                {
+                    OthelloBitboard board(b);
+                    evaluatemax(board,OthelloNEATDatatype(INT_MAX/2),0,1);
+                }
 
 #if OTHELLO_EXPERIMENT_PRINT_GAMES
                 cout << "Playing games with HyperNEAT as black\n";
@@ -197,7 +250,10 @@ namespace HCUBE
                         //in the first game, the second invidiaul is white.
                         currentSubstrateIndex = 1-curGame;
 
-                        evaluatemin(b,OthelloNEATDatatype(INT_MAX/2),0,1);
+                        {
+                            OthelloBitboard board(b);
+                            evaluatemin(board,OthelloNEATDatatype(INT_MAX/2),0,1);
+                        }
                         //cout << "SimpleOthello time: ";
                     }
 
@@ -305,6 +361,9 @@ namespace HCUBE
         //Play all the tests, but do not change test fitness
         for (int a=0;a<coEvoGeneration->getTestCount();a++)
         {
+            //Every individual plays a test from the same opening
+            setOpening(a);
+
             pair<double,double> rewards =
                 playGame(
                     group[0],
@@ -321,6 +380,11 @@ namespace HCUBE
 
         return experiment;
     }
+
+    shared_ptr<NEAT::CoEvoExperiment> OthelloCoExperiment::cloneCoEvo()
+    {
+        return shared_ptr<NEAT::CoEvoExperiment>(new OthelloCoExperiment(*this));
+    }
 }
 
 #endif
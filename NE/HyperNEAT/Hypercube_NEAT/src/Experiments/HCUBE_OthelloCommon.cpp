@@ -1,6 +1,7 @@
 #include "HCUBE_Defines.h"
 
 #include "Experiments/HCUBE_OthelloCommon.h"
+#include "Experiments/HCUBE_OthelloBitboard.h"
 
 #define OTHELLO_COMMON_DEBUG (0)
 
@@ -130,119 +131,36 @@ namespace HCUBE
 
     void OthelloCommon::makeMove(OthelloMove &move,ushort b[8][8])
     {
+        OthelloBitboard board(b);
+
+        ulong flips = board.getFlips(move.color,move.position.y*8+move.position.x);
+
         OTHELLO_SET_PIECE(b[move.position.x][move.position.y],move.color);
 
-        if (move.position.x==0)
+        int flipSquares[OTHELLO_MAX_FLIPS];
+        int numFlips = OthelloBitboard::listSquares(flips,flipSquares);
+        for (int a=0;a<numFlips;a++)
         {
-            if (move.position.y==0)
-            {
-                //cout << "SETTING PIECE IN DANGER ZONE1!\n";
-            }
-            else if (move.position.y==1)
-            {
-                //cout << "SETTING PIECE IN DANGER ZONE2!\n";
-            }
+            Vector2<uchar> location(
+                OthelloBitboard::squareToX(flipSquares[a]),
+                OthelloBitboard::squareToY(flipSquares[a])
+            );
+
+            move.piecesFlipped[a] = location;
+
+            OTHELLO_REVERSE_PIECE(b[location.x][location.y]);
         }
+        move.piecesFlipped[numFlips] = Vector2<uchar>(255,255);
 
         if (move.color==OTHELLO_BLACK)
         {
-            int before = OTHELLO_GET_NUM_BLACK_PIECES(b);
-
-            OTHELLO_INC_NUM_BLACK_PIECES(b);
-
-            int after = OTHELLO_GET_NUM_BLACK_PIECES(b);
-
-            if ((before+1)!=after)
-            {
-                throw CREATE_LOCATEDEXCEPTION_INFO("ERROR ON INC");
-            }
-
+            OTHELLO_SET_NUM_BLACK_PIECES(b,OTHELLO_GET_NUM_BLACK_PIECES(b)+1+numFlips);
+            OTHELLO_SET_NUM_WHITE_PIECES(b,OTHELLO_GET_NUM_WHITE_PIECES(b)-numFlips);
         }
         else // (move.color==OTHELLO_WHITE)
         {
-            int before = OTHELLO_GET_NUM_WHITE_PIECES(b);
-
-            OTHELLO_INC_NUM_WHITE_PIECES(b);
-
-            int after = OTHELLO_GET_NUM_WHITE_PIECES(b);
-
-            if ((before+1)!=after)
-            {
-                throw CREATE_LOCATEDEXCEPTION_INFO("ERROR ON INC");
-            }
-        }
-
-        //We use short so we can check out of bounds
-        Vector2<short> lookLoc;
-
-        for (int deltax=-1;deltax<=1;deltax++)
-        {
-            for (int deltay=-1;deltay<=1;deltay++)
-            {
-                if (!deltax && !deltay)
-                    continue; //no movement
-
-                lookLoc.x = move.position.x + deltax;
-                lookLoc.y = move.position.y + deltay;
-
-                for (;;)
-                {
-                    if ( !(OTHELLO_IS_IN_BOUNDS(lookLoc.x,lookLoc.y)) )
-                    {
-                        break; //off the board
-                    }
-
-                    int pieceOnSquare = OTHELLO_GET_PIECE(b[lookLoc.x][lookLoc.y]);
-
-                    if (pieceOnSquare==OTHELLO_EMPTY)
-                    {
-                        //No possible captures on this axis
-                        break;
-                    }
-                    else if (pieceOnSquare==move.color)
-                    {
-                        //You see your own color, time to capture some pieces (0 or more)
-                        lookLoc.x -= deltax;
-                        lookLoc.y -= deltay;
-
-                        int pieceFlipIndex=move.getNumPiecesFlipped();
-
-                        for (;lookLoc != move.position;)
-                        {
-                            move.piecesFlipped[pieceFlipIndex++] = lookLoc;
-
-                            if (pieceFlipIndex==OTHELLO_MAX_FLIPS)
-                            {
-                                throw CREATE_LOCATEDEXCEPTION_INFO("TRIED TO FLIP TOO MANY PIECES IN ONE MOVE!");
-                            }
-
-                            OTHELLO_REVERSE_PIECE(b[lookLoc.x][lookLoc.y]);
-
-                            if (move.color==OTHELLO_BLACK)
-                            {
-                                OTHELLO_INC_NUM_BLACK_PIECES(b);
-                                OTHELLO_DEC_NUM_WHITE_PIECES(b);
-                            }
-                            else // (move.color==OTHELLO_WHITE)
-                            {
-                                OTHELLO_INC_NUM_WHITE_PIECES(b);
-                                OTHELLO_DEC_NUM_BLACK_PIECES(b);
-                            }
-
-                            lookLoc.x -= deltax;
-                            lookLoc.y -= deltay;
-                        }
-
-                        break;
-                    }
-                    else //pieceOnSquare == other color
-                    {
-                        //Keep going, maybe these are supposed to be captured.
-                        lookLoc.x += deltax;
-                        lookLoc.y += deltay;
-                    }
-                }
-            }
+            OTHELLO_SET_NUM_WHITE_PIECES(b,OTHELLO_GET_NUM_WHITE_PIECES(b)+1+numFlips);
+            OTHELLO_SET_NUM_BLACK_PIECES(b,OTHELLO_GET_NUM_BLACK_PIECES(b)-numFlips);
         }
     }
 
@@ -352,86 +270,14 @@ namespace HCUBE
         int y
     )
     {
-        if (OTHELLO_GET_PIECE(b[x][y])!=OTHELLO_EMPTY)
-        {
-            //place is taken
-            return false;
-        }
-
-        //We use short so we can check out of bounds
-        Vector2<short> lookLoc;
-
-        for (int deltax=-1;deltax<=1;deltax++)
-        {
-            for (int deltay=-1;deltay<=1;deltay++)
-            {
-                if (!deltax && !deltay)
-                    continue; //no movement
-
-                lookLoc.x = x+deltax;
-                lookLoc.y = y+deltay;
-
-                bool jumpedOnce=false;
-
-                for (;;)
-                {
-                    if ( !OTHELLO_IS_IN_BOUNDS(lookLoc.x,lookLoc.y) )
-                    {
-                        break; //off the board
-                    }
-
-                    int pieceOnSquare = OTHELLO_GET_PIECE(b[lookLoc.x][lookLoc.y]);
-
-                    if (pieceOnSquare==OTHELLO_EMPTY)
-                    {
-                        //No possible captures on this axis
-                        break;
-                    }
-                    else if (pieceOnSquare==color)
-                    {
-                        if (!jumpedOnce)
-                        {
-                            //You haven't jumped any pieces, not valid
-                            break;
-                        }
-
-                        //You see your own color, you can jump, this is a valid move
-                        return true;
-                    }
-                    else //pieceOnSquare == other color
-                    {
-                        //Keep going, maybe these are supposed to be captured.
-                        jumpedOnce=true;
-                        lookLoc.x += deltax;
-                        lookLoc.y += deltay;
-                    }
-                }
-            }
-        }
-
-        return false;
+        return OthelloBitboard(b).getFlips(color,y*8+x)!=0;
     }
 
     bool OthelloCommon::hasAnyMove(
         ushort b[8][8]
     )
     {
-        for (int x=0;x<8;x++)
-        {
-            for (int y=0;y<8;y++)
-            {
-                if (hasMove(b,OTHELLO_BLACK,x,y))
-                {
-                    return true;
-                }
-                if (hasMove(b,OTHELLO_WHITE,x,y))
-                {
-                    return true;
-                }
-            }
-        }
-
-        return false;
+        return OthelloBitboard(b).hasAnyMove();
     }
 
     int OthelloCommon::generateMoveList(ushort b[8][8],OthelloMove *moveList,int color)
@@ -439,21 +285,15 @@ namespace HCUBE
 #if OTHELLO_COMMON_DEBUG
         cout << "Running generateMoveList\n";
 #endif
-        int numMoves=0;
+        int squares[OTHELLO_MAX_MOVES];
+        int numMoves = OthelloBitboard::listSquares(OthelloBitboard(b).generateMoves(color),squares);
 
-        for (int x=0;x<8;x++)
+        for (int a=0;a<numMoves;a++)
         {
-            for (int y=0;y<8;y++)
-            {
-                if (hasMove(b,color,x,y))
-                {
-                    moveList[numMoves++].reset( Vector2<uchar>(x,y), color );
-                    if ( (moveList+numMoves) >= (totalMoveList+MAX_TOTAL_MOVES) )
-                    {
-                        throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: MAXED OUT MOVE LIST!");
-                    }
-                }
-            }
+            moveList[a].reset(
+                Vector2<uchar>(OthelloBitboard::squareToX(squares[a]),OthelloBitboard::squareToY(squares[a])),
+                color
+            );
         }
 
 #if OTHELLO_COMMON_DEBUG
@@ -464,33 +304,6 @@ namespace HCUBE
 
     int OthelloCommon::getWinner(ushort b[8][8])
     {
-        int blackPieces = OTHELLO_GET_NUM_BLACK_PIECES(b);
-        int whitePieces = OTHELLO_GET_NUM_WHITE_PIECES(b);
-
-        if (!blackPieces)
-        {
-            return OTHELLO_WHITE;
-        }
-        else if (!whitePieces)
-        {
-            return OTHELLO_BLACK;
-        }
-        else if (hasAnyMove(b))
-        {
-            //Game is still ongoing
-            return OTHELLO_END_UNKNOWN;
-        }
-        else if (blackPieces<whitePieces)
-        {
-            return OTHELLO_WHITE;
-        }
-        else if (blackPieces>whitePieces)
-        {
-            return OTHELLO_BLACK;
-        }
-        else
-        {
-            return OTHELLO_END_TIE;
-        }
+        return OthelloBitboard(b).getWinner();
     }
 }
@@ -6,14 +6,10 @@
 
 #define OTHELLO_EXPERIMENT_PRINT_GAMES (0)
 
-#define DEBUG_BOARD_CACHE (0)
-
 #define DEBUG_CHECK_HAND_CODED_HEURISTIC (0)
 
 #define DEBUG_USE_BOARD_EVALUATION_CACHE (1)
 
-#define DEBUG_DUMP_BOARD_LEAF_EVALUATIONS (0)
-
 #define DEBUG_DIRECT_LINKS (0)
 
 #define MAX_GAME_COUNT (90)
@@ -50,8 +46,6 @@ namespace HCUBE
 
 		resetBoard(userEvaluationBoard);
 		userEvaluationRound = (0);
-
-		//boardStateCache.reserve(10000);
 	}
 
 	GeneticPopulation* OthelloExperiment::createInitialPopulation(int populationSize)
@@ -234,6 +228,16 @@ namespace HCUBE
 			);
 #endif
 
+		//Look the nodes up by name once instead of at every leaf
+		for (int y=0;y<numNodesY[0];y++)
+		{
+			for (int x=0;x<numNodesX[0];x++)
+			{
+				inputNodeIndices[substrateNum][y*8+x] = substrate->getNodeIndex(getNameFromNode(Node(x,y,0)));
+			}
+		}
+		outputNodeIndices[substrateNum] = substrate->getNodeIndex(getNameFromNode(Node(0,0,2)));
+
 		for (int a=0;a<nodeCounter;a++)
 		{
 			nodes[a].~NetworkNode();
@@ -656,7 +660,7 @@ namespace HCUBE
 
 	//For evaluation.  Positive means winning for black, and negative means
 	//winning for white.
-	OthelloNEATDatatype OthelloExperiment::evaluateLeafHandCoded(ushort b[8][8])
+	OthelloNEATDatatype OthelloExperiment::evaluateLeafHandCoded(const OthelloBitboard &board)
 	{
 		if (DEBUG_USE_HYPERNEAT_EVALUATION)
 		{
@@ -665,47 +669,24 @@ namespace HCUBE
 
 		OthelloNEATDatatype retval=0;
 
-		//ushort posval;
-		for (int x=0;x<8;x++)
+		//Multiply the weight times the board position, only occupied squares count
+		for (ulong bits=board.black;bits;bits&=bits-1)
 		{
-			for (int y=0;y<8;y++)
-			{
-				//Multiply the weight times the board position
-				//posval = (*( ((ushort*)b) + a));
-				int pieceType = OTHELLO_GET_PIECE( b[x][y] );
-				int typeToVal;
-				switch (pieceType)
-				{
-				case OTHELLO_BLACK:
-					{
-						typeToVal = 1;
-					}
-					break;
-				case OTHELLO_WHITE:
-					{
-						typeToVal = -1;
-					}
-					break;
-				case OTHELLO_EMPTY:
-					{
-						typeToVal = 0;
-					}
-					break;
-				default:
-					{
-						throw CREATE_LOCATEDEXCEPTION_INFO("ERROR: BOARD CORRUPTION!");
-					}
-					break;
-				}
-				retval += (OthelloNEATDatatype)(weights[handCodedType][y][x] * typeToVal);
-			}
+			int square = OthelloBitboard::lowestSquare(bits);
+			retval += (OthelloNEATDatatype)(weights[handCodedType][OthelloBitboard::squareToY(square)][OthelloBitboard::squareToX(square)]);
+		}
+
+		for (ulong bits=board.white;bits;bits&=bits-1)
+		{
+			int square = OthelloBitboard::lowestSquare(bits);
+			retval -= (OthelloNEATDatatype)(weights[handCodedType][OthelloBitboard::squareToY(square)][OthelloBitboard::squareToX(square)]);
 		}
 
 		return retval;
 	}
 
 	OthelloNEATDatatype OthelloExperiment::evaluateLeafHyperNEAT(
-		ushort b[8][8]
+		const OthelloBitboard &board
 	)
 	{
 #if OTHELLO_EXPERIMENT_ENABLE_BIASES
@@ -724,8 +705,9 @@ namespace HCUBE
 		OthelloNEATDatatype output;
 
 #if DEBUG_USE_BOARD_EVALUATION_CACHE
-		tmpboard.loadBoard(b);
-		OthelloBoardCacheMap::iterator bIterator = boardEvaluationCache.find(tmpboard);
+		//The two substrates rate the same board differently
+		OthelloCachedBoard cachedBoard(board,currentSubstrateIndex);
+		OthelloBoardCacheMap::iterator bIterator = boardEvaluationCache.find(cachedBoard);
 
 		if (bIterator != boardEvaluationCache.end())
 		{
@@ -738,38 +720,24 @@ namespace HCUBE
 			substrate->reinitialize();
 			substrate->dummyActivation();
 
-			for (int y=0;y<numNodesY[0];y++)
-			{
-				for (int x=0;x<numNodesX[0];x++)
-				{
-					int boardx = x;
-					int boardy = y;
-
-					//cout << boardx << ',' << boardy << ": " << b[boardx][boardy] << endl;
-
-					if ( OTHELLO_GET_PIECE(b[boardx][boardy]) == OTHELLO_WHITE )
-					{
-						substrate->setValue( getNameFromNode(Node(x,y,0)) , -1.0 );
-					}
-					else if ( OTHELLO_GET_PIECE(b[boardx][boardy]) == OTHELLO_BLACK )
-					{
-						substrate->setValue( getNameFromNode(Node(x,y,0)) , 1.0 );
-					}
-					else
-					{
-						//Not necessary, reinitialize will set all to 0 in the beginning.
-						//substrate->setValue( getNameFromNode(Node(x,y,0)) , 0.0 );
-					}
-
-				}
-			}
+			//Empty squares stay at 0 from reinitialize
+			board.setSubstrateInputs(
+				*substrate,
+				inputNodeIndices[currentSubstrateIndex],
+				OthelloNEATDatatype(1.0),
+				OthelloNEATDatatype(-1.0)
+				);
 
 			substrate->update();
 			substrate->update();
-			output = substrate->getValue(getNameFromNode(Node(0,0,2)));
+			output = substrate->getValue(outputNodeIndices[currentSubstrateIndex]);
 
 #if OTHELLO_EXPERIMENT_PRINT_BOARD_RATINGS
-			printBoard(b);
+			{
+				ushort b[8][8];
+				board.saveBoard(b);
+				printBoard(b);
+			}
 			cout << "BOARD RATING:" << output << endl;
 			CREATE_PAUSE("");
 #endif
@@ -788,179 +756,54 @@ namespace HCUBE
 #if DEBUG_USE_BOARD_EVALUATION_CACHE
 			if (boardEvaluationCache.size()<10000)
 			{
-				boardEvaluationCache[tmpboard] = output;
+				boardEvaluationCache[cachedBoard] = output;
 			}
 #endif
 		}
 
-#if 0 //#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-		//cout << "Printing board leaf evaluations\n";
-		for (int y=0;y<8;y++)
-		{
-			for (int x=7;x>=0;x--)
-			{
-				if (b[x][y]&FREE)
-				{
-					*outfile << " ";
-				}
-				else if (b[x][y]&BLACK)
-				{
-					if (b[x][y]&MAN)
-					{
-						*outfile << "b";
-					}
-					else
-					{
-						*outfile << "B";
-					}
-				}
-				else if (b[x][y]&WHITE)
-				{
-					if (b[x][y]&MAN)
-					{
-						*outfile << "w";
-					}
-					else
-					{
-						*outfile << "W";
-					}
-				}
-				else
-				{
-					*outfile << "_";
-				}
-			}
-			*outfile << endl;
-		}
-		*outfile << "BOARD RATING: " << output << endl;
-		*outfile << endl;
-#endif
 		return output;
 	}
 
-	OthelloNEATDatatype OthelloExperiment::evaluateLeafWhite(ushort b[8][8])
+	OthelloNEATDatatype OthelloExperiment::evaluateLeafWhite(const OthelloBitboard &board)
 	{
 		if (DEBUG_USE_HANDCODED_EVALUATION)
 		{
-			return evaluateLeafHandCoded(b);
+			return evaluateLeafHandCoded(board);
 		}
 		else //DEBUG_USE_HYPERNEAT_EVALUATION
 		{
-			//You have to flip the board to keep the initiative consisent
 #if OTHELLO_EXPERIMENT_USE_TEMPO
-			for(int x=0;x<8;x++)
-			{
-				for(int y=0;y<8;y++)
-				{
-					if(OTHELLO_GET_PIECE(b[x][y]) != OTHELLO_EMPTY)
-					{
-						OTHELLO_REVERSE_PIECE(b[x][y]);
-					}
-				}
-			}
-#endif
-
-			OthelloNEATDatatype retval = evaluateLeafHyperNEAT(b);
-
-#if OTHELLO_EXPERIMENT_USE_TEMPO
-			//Now, flip the evaluation and then unflip the pieces
-			retval = -retval;
-			for(int x=0;x<8;x++)
-			{
-				for(int y=0;y<8;y++)
-				{
-					if(OTHELLO_GET_PIECE(b[x][y]) != OTHELLO_EMPTY)
-					{
-						OTHELLO_REVERSE_PIECE(b[x][y]);
-					}
-				}
-			}
+			//You have to flip the board to keep the initiative consisent, and
+			//then flip the evaluation
+			return -evaluateLeafHyperNEAT(OthelloBitboard(board.white,board.black));
+#else
+			return evaluateLeafHyperNEAT(board);
 #endif
-
-			return retval;
 		}
 	}
 
-	OthelloNEATDatatype OthelloExperiment::evaluateLeafBlack(ushort b[8][8])
+	OthelloNEATDatatype OthelloExperiment::evaluateLeafBlack(const OthelloBitboard &board)
 	{
 		if (DEBUG_USE_HANDCODED_EVALUATION)
 		{
-			return evaluateLeafHandCoded(b);
+			return evaluateLeafHandCoded(board);
 		}
 		else //DEBUG_USE_HYPERNEAT_EVALUATION
 		{
-			return evaluateLeafHyperNEAT(b);
+			return evaluateLeafHyperNEAT(board);
 		}
 	}
 
-	class OthelloBoardMoveState
+	OthelloNEATDatatype OthelloExperiment::evaluatemax(OthelloBitboard &board,  OthelloNEATDatatype parentBeta, int depth,int maxDepth)
 	{
-	public:
-		OthelloNEATDatatype parentBeta;
-		int depth,maxDepth;
-		OthelloBoardMoveState()
-		{}
-		OthelloBoardMoveState(
-			OthelloNEATDatatype _parentBeta,
-			int _depth,
-			int _maxDepth
-			)
-			:
-		parentBeta(_parentBeta),
-			depth(_depth),
-			maxDepth(_maxDepth)
-		{}
-	};
-
-	OthelloNEATDatatype OthelloExperiment::evaluatemax(ushort b[8][8],  OthelloNEATDatatype parentBeta, int depth,int maxDepth)
-	{
-		if (depth==0)
-		{
-			totalNumMoves=0;
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-			cout << "Creating new outfile\n";
-			if (outfile) delete outfile;
-			outfile = new ofstream("BoardEvaluations.txt");
-#endif
-		}
-#if DEBUG_BOARD_CACHE
-		OthelloBoardState boardState(b,OTHELLO_BLACK,depth);
-		if (depth==0)
-		{
-			boardStateCache.clear();
-		}
-		else
-		{
-			OthelloBoardStateMap::iterator bsIterator = boardStateCache.find(boardState);
-
-			if (bsIterator!=boardStateCache.end())
-			{
-				//cout << "CACHE HIT, BAILING\n";
-				//This board has already been explored before, treat this as a loss
-				if (bsIterator->second>parentBeta)
-				{
-					//This will be worse than the last time this state was seen.  Don't bother.
-					return INT_MIN/2;
-				}
-			}
-
-			if (boardStateCache.size()<10000)
-			{
-				boardStateCache.insert(boardState,parentBeta);
-			}
-		}
-#endif
-
-		int newMoveStart = totalNumMoves;
-
-		OthelloMove *moveList = &totalMoveList[newMoveStart];
+		//Each level keeps its own moves on the stack, there are never more
+		//than OTHELLO_MAX_MOVES
+		int moveList[OTHELLO_MAX_MOVES];
 		int moveListCount;
 
 		OthelloNEATDatatype alpha=OthelloNEATDatatype(INT_MIN);
 
-		int bestMoveSoFarIndex=-1;
-
-		moveListCount = generateMoveList(b,moveList,OTHELLO_BLACK);
+		moveListCount = OthelloBitboard::listSquares(board.generateMoves(OTHELLO_BLACK),moveList);
 
 		if (!moveListCount)
 		{
@@ -971,7 +814,7 @@ namespace HCUBE
 		if (depth==0 && moveListCount==1)
 		{
 			//Forced move, don't bother doing any evaluations
-			moveToMake = moveList[0];
+			setMoveToMake(moveList[0],OTHELLO_BLACK);
 			return 0;
 		}
 
@@ -985,17 +828,21 @@ namespace HCUBE
 				int randomMove =
 					NEAT::Globals::getSingleton()->getRandom().getRandomWithinRange(0,moveListCount-1);
 
-				moveToMake = moveList[randomMove];
+				setMoveToMake(moveList[randomMove],OTHELLO_BLACK);
 				return 0;
 			}
 		}
 
 #if OTHELLO_EXPERIMENT_DEBUG
-		printBoard(b);
+		{
+			ushort b[8][8];
+			board.saveBoard(b);
+			printBoard(b);
+		}
 		cout << "Moves for black: " << endl;
 		for (int a=0;a<moveListCount;a++)
 		{
-			cout << "MOVE: (" << (int)moveList[a].position.x << ',' << (int)moveList[a].position.y << ")" << endl;
+			cout << "MOVE: (" << OthelloBitboard::squareToX(moveList[a]) << ',' << OthelloBitboard::squareToY(moveList[a]) << ")" << endl;
 		}
 		CREATE_PAUSE("Done listing moves");
 #endif
@@ -1003,37 +850,31 @@ namespace HCUBE
 		if (depth==maxDepth)
 		{
 			//This is a leaf node, return the neural network's evaluation
-			return evaluateLeafBlack(b);
+			return evaluateLeafBlack(board);
 		}
 
 		OthelloNEATDatatype childBeta;
 
-		totalNumMoves+=moveListCount;
-
-		if (totalNumMoves >= MAX_TOTAL_MOVES)
-		{
-			CREATE_PAUSE("Shit! I blew my move stack!");
-		}
-
 		for (int a=0;a<moveListCount;a++)
 		{
-			makeMove(moveList[a],b);
+			ulong flips = board.getFlips(OTHELLO_BLACK,moveList[a]);
+			board.makeMove(OTHELLO_BLACK,moveList[a],flips);
 
-			int winner = getWinner(b);
+			int winner = board.getWinner();
 
 			if (winner==OTHELLO_BLACK)
 			{
 				//CREATE_PAUSE("FOUND WIN FOR BLACK!");
-				reverseMove(moveList[a],b);
+				board.unmakeMove(OTHELLO_BLACK,moveList[a],flips);
 
 				if (depth==0)
-					moveToMake = moveList[a];
+					setMoveToMake(moveList[a],OTHELLO_BLACK);
 
 				return OthelloNEATDatatype(INT_MAX/2);
 			}
 
-			childBeta = evaluatemin(b,alpha,depth+1,maxDepth);
-			reverseMove(moveList[a],b);
+			childBeta = evaluatemin(board,alpha,depth+1,maxDepth);
+			board.unmakeMove(OTHELLO_BLACK,moveList[a],flips);
 
 #if OTHELLO_EXPERIMENT_DEBUG
 			for (int dd=0;dd<depth;dd++)
@@ -1049,205 +890,33 @@ namespace HCUBE
 				cout << "Found new alpha\n";
 #endif
 				alpha = childBeta;
-				bestMoveSoFarIndex = a;
 				if (depth==0)
 				{
 					//This means that this is the root max, so store the best move.
-#if OTHELLO_EXPERIMENT_DEBUG
-					cout << "BLACK: MOVE_TO_MAKE: (" << moveList[a].position.x << ',' << moveList[a].position.y << ")" << endl;
-					CREATE_PAUSE("SETTING MOVE_TO_MAKE");
-#endif
-
-					moveToMake = moveList[a];
+					setMoveToMake(moveList[a],OTHELLO_BLACK);
 				}
 				else
 				{
 					if (parentBeta <= childBeta)
 					{
-#if OTHELLO_EXPERIMENT_DEBUG
-						cout << "Parent will never choose this path\n";
-						CREATE_PAUSE("");
-#endif
 						//parent will never choose this alpha
-						totalNumMoves-=moveListCount;
-
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-						//cout << "Printing board leaf evaluations\n";
-						if (depth<=2)
-						{
-							*outfile << "Depth: " << depth << endl;
-							for (int y=0;y<8;y++)
-							{
-								for (int x=7;x>=0;x--)
-								{
-									if (b[x][y]&FREE)
-									{
-										*outfile << " ";
-									}
-									else if (b[x][y]&BLACK)
-									{
-										if (b[x][y]&MAN)
-										{
-											*outfile << "b";
-										}
-										else
-										{
-											*outfile << "B";
-										}
-									}
-									else if (b[x][y]&WHITE)
-									{
-										if (b[x][y]&MAN)
-										{
-											*outfile << "w";
-										}
-										else
-										{
-											*outfile << "W";
-										}
-									}
-									else
-									{
-										*outfile << "_";
-									}
-								}
-								*outfile << endl;
-							}
-							*outfile << "BEST MOVE FOR BLACK: " << (int)moveList[a].from.x << ',' << (int)moveList[a].from.y << " to "
-								<< (int)moveList[a].getFinalDestination().x << ',' << (int)moveList[a].getFinalDestination().y << endl;
-							*outfile << endl;
-						}
-#endif
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-						if (depth==0)
-						{
-							cout << __LINE__ << " Closing outfile handle\n";
-							if (outfile)
-							{
-								outfile->close();
-								delete outfile;
-							}
-							outfile = NULL;
-						}
-#endif
 						return alpha;
 					}
 				}
 			}
 		}
 
-		totalNumMoves-=moveListCount;
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-		//cout << "Printing board leaf evaluations\n";
-		if (depth<=2)
-		{
-			*outfile << "Depth: " << depth << endl;
-			for (int y=0;y<8;y++)
-			{
-				for (int x=7;x>=0;x--)
-				{
-					if (b[x][y]&FREE)
-					{
-						*outfile << " ";
-					}
-					else if (b[x][y]&BLACK)
-					{
-						if (b[x][y]&MAN)
-						{
-							*outfile << "b";
-						}
-						else
-						{
-							*outfile << "B";
-						}
-					}
-					else if (b[x][y]&WHITE)
-					{
-						if (b[x][y]&MAN)
-						{
-							*outfile << "w";
-						}
-						else
-						{
-							*outfile << "W";
-						}
-					}
-					else
-					{
-						*outfile << "_";
-					}
-				}
-				*outfile << endl;
-			}
-			if (bestMoveSoFarIndex!=-1)
-			{
-				*outfile << "BEST MOVE FOR BLACK: " << (int)moveList[bestMoveSoFarIndex].from.x << ',' << (int)moveList[bestMoveSoFarIndex].from.y << " to "
-					<< (int)moveList[bestMoveSoFarIndex].getFinalDestination().x << ',' << (int)moveList[bestMoveSoFarIndex].getFinalDestination().y << endl;
-				*outfile << endl;
-			}
-			else
-			{
-				*outfile << "NO MOVES FOUND (OR WILL NEVER GET TO THIS PART OF THE GAME TREE)\n";
-			}
-		}
-#endif
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-		if (depth==0)
-		{
-			cout << __LINE__ << " Closing outfile handle\n";
-			if (outfile)
-			{
-				outfile->close();
-				delete outfile;
-			}
-			outfile = NULL;
-		}
-#endif
 		return alpha;
 	}
 
-	OthelloNEATDatatype OthelloExperiment::evaluatemin(ushort b[8][8],  OthelloNEATDatatype parentAlpha, int depth,int maxDepth)
+	OthelloNEATDatatype OthelloExperiment::evaluatemin(OthelloBitboard &board,  OthelloNEATDatatype parentAlpha, int depth,int maxDepth)
 	{
-		if (depth==0)
-		{
-			totalNumMoves=0;
-		}
-#if DEBUG_BOARD_CACHE
-		OthelloBoardState boardState(b,OTHELLO_WHITE,depth);
-		if (depth==0)
-		{
-			boardStateCache.clear();
-		}
-		else
-		{
-			OthelloBoardStateMap::iterator bsIterator = boardStateCache.find(boardState);
-
-			if (bsIterator!=boardStateCache.end())
-			{
-				//cout << "CACHE HIT, BAILING\n";
-				//This board has already been explored before, treat this as a loss
-				if (bsIterator->second<parentAlpha)
-				{
-					//This will be a subset of the moves seen previously.  Ignore
-					return (OthelloNEATDatatype)INT_MAX/2;
-				}
-			}
-
-			boardStateCache.insert(boardState,parentAlpha);
-		}
-#endif
-
-
-		int newMoveStart = totalNumMoves;
-
-		OthelloMove *moveList = &totalMoveList[newMoveStart];
+		int moveList[OTHELLO_MAX_MOVES];
 		int moveListCount;
 
 		OthelloNEATDatatype beta=OthelloNEATDatatype(INT_MAX);
 
-		int bestMoveSoFarIndex=-1;
-
-		moveListCount = generateMoveList(b,moveList,OTHELLO_WHITE);
+		moveListCount = OthelloBitboard::listSquares(board.generateMoves(OTHELLO_WHITE),moveList);
 
 		if (!moveListCount)
 		{
@@ -1264,7 +933,7 @@ namespace HCUBE
 		if (depth==0 && moveListCount==1)
 		{
 			//Forced move, don't bother doing any evaluations
-			moveToMake = moveList[0];
+			setMoveToMake(moveList[0],OTHELLO_WHITE);
 			return 0;
 		}
 
@@ -1278,17 +947,21 @@ namespace HCUBE
 				int randomMove =
 					NEAT::Globals::getSingleton()->getRandom().getRandomWithinRange(0,moveListCount-1);
 
-				moveToMake = moveList[randomMove];
+				setMoveToMake(moveList[randomMove],OTHELLO_WHITE);
 				return 0;
 			}
 		}
 
 #if OTHELLO_EXPERIMENT_DEBUG
-		printBoard(b);
+		{
+			ushort b[8][8];
+			board.saveBoard(b);
+			printBoard(b);
+		}
 		cout << "Moves for white: " << endl;
 		for (int a=0;a<moveListCount;a++)
 		{
-			cout << "MOVE: (" << (int)moveList[a].position.x << ',' << (int)moveList[a].position.y << ")\n";
+			cout << "MOVE: (" << OthelloBitboard::squareToX(moveList[a]) << ',' << OthelloBitboard::squareToY(moveList[a]) << ")\n";
 		}
 		CREATE_PAUSE("Done listing moves");
 #endif
@@ -1296,37 +969,31 @@ namespace HCUBE
 		if (depth==maxDepth)
 		{
 			//This is a leaf node, return the hand coded evaluation
-			return evaluateLeafWhite(b);
+			return evaluateLeafWhite(board);
 		}
 
 		OthelloNEATDatatype childAlpha;
 
-		totalNumMoves+=moveListCount;
-
-		if (totalNumMoves >= MAX_TOTAL_MOVES)
-		{
-			CREATE_PAUSE("Shit! I blew my move stack!");
-		}
-
 		for (int a=0;a<moveListCount;a++)
 		{
-			makeMove(moveList[a],b);
+			ulong flips = board.getFlips(OTHELLO_WHITE,moveList[a]);
+			board.makeMove(OTHELLO_WHITE,moveList[a],flips);
 
-			int winner = getWinner(b);
+			int winner = board.getWinner();
 
 			if (winner==OTHELLO_WHITE)
 			{
 				//CREATE_PAUSE("FOUND WIN FOR WHITE!");
-				reverseMove(moveList[a],b);
+				board.unmakeMove(OTHELLO_WHITE,moveList[a],flips);
 
 				if (depth==0)
-					moveToMake = moveList[a];
+					setMoveToMake(moveList[a],OTHELLO_WHITE);
 
 				return (OthelloNEATDatatype)INT_MIN/2;
 			}
 
-			childAlpha = evaluatemax(b,beta,depth+1,maxDepth);
-			reverseMove(moveList[a],b);
+			childAlpha = evaluatemax(board,beta,depth+1,maxDepth);
+			board.unmakeMove(OTHELLO_WHITE,moveList[a],flips);
 
 			if (childAlpha < beta)
 			{
@@ -1334,147 +1001,34 @@ namespace HCUBE
 				cout << "Found new beta\n";
 #endif
 				beta = childAlpha;
-				bestMoveSoFarIndex = a;
 
 				if (depth==0)
 				{
 					//This means that this is the root max, so store the best move.
-#if OTHELLO_EXPERIMENT_DEBUG
-					cout << "WHITE: MOVE_TO_MAKE: (" << moveList[a].position.x << ',' << moveList[a].position.y << ")\n";
-					CREATE_PAUSE("SETTING MOVE_TO_MAKE");
-#endif
-
-					moveToMake = moveList[a];
+					setMoveToMake(moveList[a],OTHELLO_WHITE);
 				}
 				else
 				{
 					if (parentAlpha >= beta)
 					{
 						//parent will never choose this beta
-						totalNumMoves-=moveListCount;
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-						if (depth<=2)
-						{
-							*outfile << "Depth: " << depth << endl;
-							//cout << "Printing board leaf evaluations\n";
-							for (int y=0;y<8;y++)
-							{
-								for (int x=7;x>=0;x--)
-								{
-									if (b[x][y]&FREE)
-									{
-										*outfile << " ";
-									}
-									else if (b[x][y]&BLACK)
-									{
-										if (b[x][y]&MAN)
-										{
-											*outfile << "b";
-										}
-										else
-										{
-											*outfile << "B";
-										}
-									}
-									else if (b[x][y]&WHITE)
-									{
-										if (b[x][y]&MAN)
-										{
-											*outfile << "w";
-										}
-										else
-										{
-											*outfile << "W";
-										}
-									}
-									else
-									{
-										*outfile << "_";
-									}
-								}
-								*outfile << endl;
-							}
-							if (bestMoveSoFarIndex!=-1)
-							{
-								*outfile << "BEST MOVE FOR WHITE: " << (int)moveList[bestMoveSoFarIndex].from.x << ',' << (int)moveList[bestMoveSoFarIndex].from.y << " to "
-									<< (int)moveList[bestMoveSoFarIndex].getFinalDestination().x << ',' << (int)moveList[bestMoveSoFarIndex].getFinalDestination().y << endl;
-								*outfile << endl;
-							}
-							else
-							{
-								*outfile << "NO MOVES FOUND (OR WILL NEVER GET TO THIS PART OF THE GAME TREE)\n";
-							}
-						}
-#endif
 						return beta;
 					}
 				}
 			}
 		}
 
-		if (depth==0 && moveListCount==0)
-		{
-			cout << "NO MOVES TO MAKE!!!\n";
-		}
-
-		totalNumMoves-=moveListCount;
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-		//cout << "Printing board leaf evaluations\n";
-		if (depth<=2)
-		{
-			*outfile << "Depth: " << depth << endl;
-			for (int y=0;y<8;y++)
-			{
-				for (int x=7;x>=0;x--)
-				{
-					if (b[x][y]&FREE)
-					{
-						*outfile << " ";
-					}
-					else if (b[x][y]&BLACK)
-					{
-						if (b[x][y]&MAN)
-						{
-							*outfile << "b";
-						}
-						else
-						{
-							*outfile << "B";
-						}
-					}
-					else if (b[x][y]&WHITE)
-					{
-						if (b[x][y]&MAN)
-						{
-							*outfile << "w";
-						}
-						else
-						{
-							*outfile << "W";
-						}
-					}
-					else
-					{
-						*outfile << "_";
-					}
-				}
-				*outfile << endl;
-			}
-			if (bestMoveSoFarIndex!=-1)
-			{
-				*outfile << "BEST MOVE FOR WHITE: " << (int)moveList[bestMoveSoFarIndex].from.x << ',' << (int)moveList[bestMoveSoFarIndex].from.y << " to "
-					<< (int)moveList[bestMoveSoFarIndex].getFinalDestination().x << ',' << (int)moveList[bestMoveSoFarIndex].getFinalDestination().y << endl;
-				*outfile << endl;
-			}
-			else
-			{
-				*outfile << "NO MOVES FOUND (OR WILL NEVER GET TO THIS PART OF THE GAME TREE)\n";
-			}
-		}
-#endif
 		return beta;
 	}
 
+	void OthelloExperiment::setMoveToMake(int square,int color)
+	{
+		moveToMake.reset(
+			Vector2<uchar>(OthelloBitboard::squareToX(square),OthelloBitboard::squareToY(square)),
+			color
+			);
+	}
+
 	void OthelloExperiment::processGroup(shared_ptr<NEAT::GeneticGeneration> generation)
 	{
 		//cout << "Processing group\n";
@@ -1536,7 +1090,10 @@ namespace HCUBE
 						moveToMake = OthelloMove();
 						DEBUG_USE_HANDCODED_EVALUATION = 0;
 						DEBUG_USE_HYPERNEAT_EVALUATION = 1;
-						evaluatemax(b,OthelloNEATDatatype(INT_MAX/2),0,1);
+						{
+							OthelloBitboard board(b);
+							evaluatemax(board,OthelloNEATDatatype(INT_MAX/2),0,1);
+						}
 
 #if OTHELLO_EXPERIMENT_PRINT_GAMES
 						cout << "Playing games with HyperNEAT as black\n";
@@ -1573,7 +1130,10 @@ namespace HCUBE
 								//progress_timer t;
 								DEBUG_USE_HANDCODED_EVALUATION = 1;
 								DEBUG_USE_HYPERNEAT_EVALUATION = 0;
-								evaluatemin(b,OthelloNEATDatatype(INT_MAX/2),0,1+(handCodedDepth));
+								{
+									OthelloBitboard board(b);
+									evaluatemin(board,OthelloNEATDatatype(INT_MAX/2),0,1+(handCodedDepth));
+								}
 								//cout << "SimpleOthello time: ";
 							}
 
@@ -1750,7 +1310,10 @@ namespace HCUBE
 						moveToMake = OthelloMove();
 						DEBUG_USE_HANDCODED_EVALUATION = 1;
 						DEBUG_USE_HYPERNEAT_EVALUATION = 0;
-						evaluatemax(b,OthelloNEATDatatype(INT_MAX/2),0,1+(handCodedDepth));
+						{
+							OthelloBitboard board(b);
+							evaluatemax(board,OthelloNEATDatatype(INT_MAX/2),0,1+(handCodedDepth));
+						}
 
 #if OTHELLO_EXPERIMENT_PRINT_GAMES
 						cout << "Playing games with HyperNEAT as white\n";
@@ -1787,7 +1350,10 @@ namespace HCUBE
 								//progress_timer t;
 								DEBUG_USE_HANDCODED_EVALUATION = 0;
 								DEBUG_USE_HYPERNEAT_EVALUATION = 1;
-								evaluatemin(b,OthelloNEATDatatype(INT_MAX/2),0,1);
+								{
+									OthelloBitboard board(b);
+									evaluatemin(board,OthelloNEATDatatype(INT_MAX/2),0,1);
+								}
 								//cout << "SimpleOthello time: ";
 							}
 
@@ -2003,17 +1569,14 @@ namespace HCUBE
 		{
 			//Computer makes his move
 			timer t;
-#if DEBUG_DUMP_BOARD_LEAF_EVALUATIONS
-			for (int depth=1;depth==1;depth+=2) //Do not go deeper if logging.
-#else
 			for (int depth=1;depth<=1;depth+=2)
-#endif
 			{
 				moveToMake = OthelloMove();
 				cout << __LINE__ << " CALLING EVALUATEMAX\n";
 				DEBUG_USE_HANDCODED_EVALUATION = 0;
 				DEBUG_USE_HYPERNEAT_EVALUATION = 1;
-				evaluatemax(userEvaluationBoard,OthelloNEATDatatype(INT_MAX/2),0,depth);
+				OthelloBitboard board(userEvaluationBoard);
+				evaluatemax(board,OthelloNEATDatatype(INT_MAX/2),0,depth);
 				if (t.elapsed()>0.5) //When you increase depth by 2, it's about 20 times as long. (maybe 100 times)
 					break;
 			}
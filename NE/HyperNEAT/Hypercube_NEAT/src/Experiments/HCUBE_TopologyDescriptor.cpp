@@ -0,0 +1,106 @@
+#include "HCUBE_Defines.h"
+
+#include "Experiments/HCUBE_TopologyDescriptor.h"
+
+namespace HCUBE
+{
+    TopologyDescriptor::TopologyDescriptor():
+        experimentType(-1), numActions(0), numObjClasses(0), substrateWidth(0), substrateHeight(0)
+    {
+    }
+
+    bool TopologyDescriptor::load(const string &fileName) {
+        ifstream fin(fileName.c_str());
+        if (!fin.good()) {
+            return false;
+        }
+
+        layerInfo = NEAT::LayeredSubstrateInfo();
+        romName = "";
+        experimentType = -1;
+
+        string line;
+        while (getline(fin, line)) {
+            istringstream istr(line);
+            string key;
+            if (!(istr >> key)) {
+                continue;
+            }
+
+            if (key == "RomName") {
+                istr >> romName;
+            } else if (key == "ExperimentType") {
+                istr >> experimentType;
+            } else if (key == "NumActions") {
+                istr >> numActions;
+            } else if (key == "NumObjClasses") {
+                istr >> numObjClasses;
+            } else if (key == "SubstrateWidth") {
+                istr >> substrateWidth;
+            } else if (key == "SubstrateHeight") {
+                istr >> substrateHeight;
+            } else if (key == "Layer") {
+                // Layer (name) (width) (height) (isInput) (x) (y) (z)
+                string name;
+                int width, height, isInput;
+                float x, y, z;
+                if (!(istr >> name >> width >> height >> isInput >> x >> y >> z)) {
+                    return false;
+                }
+                layerInfo.layerNames.push_back(name);
+                layerInfo.layerSizes.push_back(JGTL::Vector2<int>(width,height));
+                layerInfo.layerValidSizes.push_back(JGTL::Vector2<int>(width,height));
+                layerInfo.layerIsInput.push_back(isInput != 0);
+                layerInfo.layerLocations.push_back(JGTL::Vector3<float>(x,y,z));
+            } else if (key == "Adjacency") {
+                string from, to;
+                if (!(istr >> from >> to)) {
+                    return false;
+                }
+                layerInfo.layerAdjacencyList.push_back(std::pair<string,string>(from,to));
+            }
+        }
+
+        return !romName.empty() && experimentType >= 0;
+    }
+
+    void TopologyDescriptor::save(const string &fileName) const {
+        string tmpFileName = fileName + ".tmp";
+        {
+            ofstream fout(tmpFileName.c_str());
+            fout << "RomName " << romName << endl;
+            fout << "ExperimentType " << experimentType << endl;
+            fout << "NumActions " << numActions << endl;
+            fout << "NumObjClasses " << numObjClasses << endl;
+            fout << "SubstrateWidth " << substrateWidth << endl;
+            fout << "SubstrateHeight " << substrateHeight << endl;
+
+            for (int i=0; i<int(layerInfo.layerNames.size()); i++) {
+                fout << "Layer " << layerInfo.layerNames[i] << " "
+                     << layerInfo.layerSizes[i].x << " " << layerInfo.layerSizes[i].y << " "
+                     << int(layerInfo.layerIsInput[i]) << " "
+                     << layerInfo.layerLocations[i].x << " " << layerInfo.layerLocations[i].y << " "
+                     << layerInfo.layerLocations[i].z << endl;
+            }
+            for (int i=0; i<int(layerInfo.layerAdjacencyList.size()); i++) {
+                fout << "Adjacency " << layerInfo.layerAdjacencyList[i].first << " "
+                     << layerInfo.layerAdjacencyList[i].second << endl;
+            }
+
+            if (!fout.good()) {
+                throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not write topology descriptor ")+tmpFileName);
+            }
+        }
+        if (rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not write topology descriptor ")+fileName);
+        }
+    }
+
+    string TopologyDescriptor::getRomName(const string &romFile) {
+        size_t slash = romFile.find_last_of("/\\");
+        if (slash == string::npos) {
+            return romFile;
+        }
+        return romFile.substr(slash+1);
+    }
+}
@@ -217,6 +217,11 @@ namespace HCUBE
         return experiment;
     }
 
+    shared_ptr<NEAT::CoEvoExperiment> XorCoExperiment::cloneCoEvo()
+    {
+        return shared_ptr<NEAT::CoEvoExperiment>(new XorCoExperiment(*this));
+    }
+
     void XorCoExperiment::addGenerationData(shared_ptr<NEAT::GeneticGeneration> generation,shared_ptr<NEAT::GeneticIndividual> individual)
     {
     }
@@ -0,0 +1,606 @@
+#include "HCUBE_Defines.h"
+
+#include "HCUBE_EvaluationCoordinator.h"
+
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#define DEBUG_EVALUATION_COORDINATOR (0)
+
+namespace HCUBE
+{
+    EvaluationCoordinator::EvaluationCoordinator(int _port,double _leaseSeconds)
+        :
+        listenSocket(-1),
+        port(_port),
+        leaseSeconds(_leaseSeconds),
+        generation(-1),
+        breeder(NULL),
+        nextIndividualID(0),
+        steadyStateFinished(false)
+    {
+        //A worker that disconnects while we answer it must not kill the run
+        signal(SIGPIPE,SIG_IGN);
+
+        listenSocket = socket(AF_INET,SOCK_STREAM,0);
+        if (listenSocket<0)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not create coordinator socket: ")+strerror(errno));
+        }
+
+        int reuse=1;
+        setsockopt(listenSocket,SOL_SOCKET,SO_REUSEADDR,&reuse,sizeof(reuse));
+
+        sockaddr_in address;
+        memset(&address,0,sizeof(address));
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons((unsigned short)port);
+
+        if (::bind(listenSocket,(sockaddr*)&address,sizeof(address))<0 || ::listen(listenSocket,SOMAXCONN)<0)
+        {
+            string error = strerror(errno);
+            close(listenSocket);
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not listen on coordinator port: ")+error);
+        }
+
+        socklen_t addressLength = sizeof(address);
+        getsockname(listenSocket,(sockaddr*)&address,&addressLength);
+        port = ntohs(address.sin_port);
+
+        cout << "[HyperNEAT core] Evaluation coordinator listening on port " << port << endl;
+    }
+
+    EvaluationCoordinator::~EvaluationCoordinator()
+    {
+        while (!connections.empty())
+        {
+            closeConnection(connections.begin());
+        }
+
+        if (listenSocket>=0)
+        {
+            close(listenSocket);
+        }
+    }
+
+    void EvaluationCoordinator::writeAddress(const string &fileName)
+    {
+        char hostName[256];
+        if (gethostname(hostName,sizeof(hostName))!=0)
+        {
+            strcpy(hostName,"localhost");
+        }
+        hostName[sizeof(hostName)-1] = '\0';
+
+        //Write to a temporary file first so workers never read half an address
+        string tmpFileName = fileName + ".tmp";
+        {
+            ofstream fout(tmpFileName.c_str());
+            fout << hostName << ' ' << port << endl;
+        }
+
+        if (rename(tmpFileName.c_str(),fileName.c_str())!=0)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not write coordinator address to ")+fileName);
+        }
+    }
+
+    void EvaluationCoordinator::evaluateGeneration(
+        int _generation,
+        const string &_populationFile,
+        int numIndividuals,
+        vector<float> &results
+    )
+    {
+        generation = _generation;
+        populationFile = _populationFile;
+        fitnesses.assign(numIndividuals,0.0f);
+        leaseMessages.clear();
+        leases.clear();
+        unleased.clear();
+        for (int a=0;a<numIndividuals;a++)
+        {
+            ostringstream ostr;
+            ostr << "EVALUATE " << generation << ' ' << a << ' ' << populationFile;
+            leaseMessages[a] = ostr.str();
+            unleased.push_back(a);
+        }
+
+        cout << "[HyperNEAT core] Leasing " << numIndividuals << " individuals of generation " << generation << endl;
+
+        serveLeases();
+
+        results = fitnesses;
+    }
+
+    void EvaluationCoordinator::evaluateSteadyState(
+        const string &_populationFile,
+        SteadyStateBreeder *_breeder
+    )
+    {
+        generation = -1;
+        populationFile = _populationFile;
+        breeder = _breeder;
+        steadyStateFinished = false;
+        leaseMessages.clear();
+        leases.clear();
+        unleased.clear();
+
+        cout << "[HyperNEAT core] Leasing steady-state individuals" << endl;
+
+        serveLeases();
+
+        //Individuals still out with workers are not needed anymore
+        leaseMessages.clear();
+        leases.clear();
+        unleased.clear();
+        breeder = NULL;
+    }
+
+    void EvaluationCoordinator::serveLeases()
+    {
+        //Workers that finished the last generation are already waiting
+        assignLeases();
+
+        while (breeder ? !steadyStateFinished : !leaseMessages.empty())
+        {
+            fd_set readSet;
+            FD_ZERO(&readSet);
+            FD_SET(listenSocket,&readSet);
+            int maxSocket = listenSocket;
+
+            for (list<Connection>::iterator it = connections.begin();it!=connections.end();it++)
+            {
+                FD_SET(it->socketHandle,&readSet);
+                maxSocket = max(maxSocket,it->socketHandle);
+            }
+
+            //Sleep until there is input or the next lease runs out
+            double now = getTime();
+            double nextDeadline = -1;
+            for (map<int,Lease>::iterator it = leases.begin();it!=leases.end();it++)
+            {
+                if (nextDeadline<0 || it->second.deadline<nextDeadline)
+                {
+                    nextDeadline = it->second.deadline;
+                }
+            }
+
+            timeval timeout;
+            timeval *timeoutPtr = NULL;
+            if (nextDeadline>=0)
+            {
+                double waitSeconds = max(0.0,nextDeadline-now);
+                timeout.tv_sec = long(waitSeconds);
+                timeout.tv_usec = long((waitSeconds-timeout.tv_sec)*1e6);
+                timeoutPtr = &timeout;
+            }
+
+            int numReady = select(maxSocket+1,&readSet,NULL,NULL,timeoutPtr);
+            if (numReady<0)
+            {
+                if (errno==EINTR)
+                {
+                    continue;
+                }
+                throw CREATE_LOCATEDEXCEPTION_INFO(string("Coordinator select failed: ")+strerror(errno));
+            }
+
+            if (FD_ISSET(listenSocket,&readSet))
+            {
+                acceptConnection();
+            }
+
+            for (list<Connection>::iterator it = connections.begin();it!=connections.end();)
+            {
+                list<Connection>::iterator current = it++;
+                if (FD_ISSET(current->socketHandle,&readSet) && !readConnection(*current))
+                {
+                    closeConnection(current);
+                }
+            }
+
+            expireLeases(getTime());
+            assignLeases();
+        }
+    }
+
+    void EvaluationCoordinator::finish()
+    {
+        for (list<Connection>::iterator it = connections.begin();it!=connections.end();it++)
+        {
+            if (it->waitingForLease)
+            {
+                sendLine(it->socketHandle,"DONE");
+            }
+        }
+
+        while (!connections.empty())
+        {
+            closeConnection(connections.begin());
+        }
+
+        close(listenSocket);
+        listenSocket = -1;
+    }
+
+    void EvaluationCoordinator::acceptConnection()
+    {
+        int socketHandle = accept(listenSocket,NULL,NULL);
+        if (socketHandle<0)
+        {
+            return;
+        }
+
+        int noDelay=1;
+        setsockopt(socketHandle,IPPROTO_TCP,TCP_NODELAY,&noDelay,sizeof(noDelay));
+
+        connections.push_back(Connection(socketHandle));
+    }
+
+    bool EvaluationCoordinator::readConnection(Connection &connection)
+    {
+        char buffer[4096];
+        ssize_t numRead = recv(connection.socketHandle,buffer,sizeof(buffer),0);
+        if (numRead<=0)
+        {
+            return numRead<0 && errno==EINTR;
+        }
+
+        connection.input.append(buffer,numRead);
+
+        size_t lineEnd;
+        while ((lineEnd = connection.input.find('\n'))!=string::npos)
+        {
+            string line = connection.input.substr(0,lineEnd);
+            connection.input.erase(0,lineEnd+1);
+            processLine(connection,line);
+        }
+
+        return true;
+    }
+
+    void EvaluationCoordinator::processLine(Connection &connection,const string &line)
+    {
+#if DEBUG_EVALUATION_COORDINATOR
+        cout << "[Coordinator] " << connection.socketHandle << ": " << line << endl;
+#endif
+
+        istringstream istr(line);
+        string command;
+        istr >> command;
+
+        if (command=="LEASE")
+        {
+            connection.waitingForLease = true;
+        }
+        else if (command=="RESULT")
+        {
+            int resultGeneration,individual;
+            float fitness;
+            if (!(istr >> resultGeneration >> individual >> fitness))
+            {
+                cout << "[HyperNEAT core] Ignoring malformed result: " << line << endl;
+                return;
+            }
+
+            map<int,string>::iterator leaseMessage = leaseMessages.find(individual);
+            if (resultGeneration!=generation || leaseMessage==leaseMessages.end())
+            {
+                //A reissued lease already produced this fitness
+                return;
+            }
+
+            leaseMessages.erase(leaseMessage);
+            leases.erase(individual);
+
+            if (breeder)
+            {
+                if (!steadyStateFinished && !breeder->addResult(individual,fitness))
+                {
+                    steadyStateFinished = true;
+                }
+            }
+            else
+            {
+                fitnesses[individual] = fitness;
+            }
+        }
+        else
+        {
+            cout << "[HyperNEAT core] Ignoring unknown coordinator command: " << line << endl;
+        }
+    }
+
+    void EvaluationCoordinator::assignLeases()
+    {
+        for (list<Connection>::iterator it = connections.begin();it!=connections.end();it++)
+        {
+            if (!it->waitingForLease)
+            {
+                continue;
+            }
+
+            while (!unleased.empty() && !leaseMessages.count(unleased.front()))
+            {
+                unleased.pop_front();
+            }
+
+            int individual;
+            if (!unleased.empty())
+            {
+                individual = unleased.front();
+                unleased.pop_front();
+            }
+            else if (breeder && !steadyStateFinished)
+            {
+                individual = nextIndividualID++;
+
+                string individualData;
+                breeder->breedIndividual(individual,individualData);
+
+                ostringstream ostr;
+                ostr << "INDIVIDUAL " << individual << ' ' << individualData.size() << ' ' << populationFile
+                    << '\n' << individualData;
+                leaseMessages[individual] = ostr.str();
+            }
+            else
+            {
+                return;
+            }
+
+            leases.insert(make_pair(individual,Lease(it->socketHandle,getTime() + leaseSeconds)));
+            it->waitingForLease = false;
+
+            sendLine(it->socketHandle,leaseMessages[individual]);
+        }
+    }
+
+    void EvaluationCoordinator::releaseLeases(int socketHandle)
+    {
+        for (map<int,Lease>::iterator it = leases.begin();it!=leases.end();)
+        {
+            map<int,Lease>::iterator current = it++;
+            if (current->second.socketHandle==socketHandle)
+            {
+                unleased.push_front(current->first);
+                leases.erase(current);
+            }
+        }
+    }
+
+    void EvaluationCoordinator::expireLeases(double now)
+    {
+        for (map<int,Lease>::iterator it = leases.begin();it!=leases.end();)
+        {
+            map<int,Lease>::iterator current = it++;
+            if (current->second.deadline<=now)
+            {
+                cout << "[HyperNEAT core] Lease on individual " << current->first << " expired, reissuing" << endl;
+                unleased.push_front(current->first);
+                leases.erase(current);
+            }
+        }
+    }
+
+    void EvaluationCoordinator::closeConnection(list<Connection>::iterator connectionIterator)
+    {
+        releaseLeases(connectionIterator->socketHandle);
+        close(connectionIterator->socketHandle);
+        connections.erase(connectionIterator);
+    }
+
+    void EvaluationCoordinator::sendLine(int socketHandle,const string &line)
+    {
+        string message = line + "\n";
+        size_t sent=0;
+        while (sent<message.size())
+        {
+            ssize_t numSent = send(socketHandle,message.c_str()+sent,message.size()-sent,0);
+            if (numSent<0)
+            {
+                if (errno==EINTR)
+                {
+                    continue;
+                }
+                //The connection is closed when select reports it
+                return;
+            }
+            sent += numSent;
+        }
+    }
+
+    double EvaluationCoordinator::getTime()
+    {
+        timeval now;
+        gettimeofday(&now,NULL);
+        return now.tv_sec + now.tv_usec*1e-6;
+    }
+
+    EvaluationLeaseClient::EvaluationLeaseClient(const string &address)
+        :
+        socketHandle(-1)
+    {
+        size_t colon = address.rfind(':');
+        if (colon==string::npos)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Coordinator address must be host:port, got ")+address);
+        }
+
+        string host = address.substr(0,colon);
+        string portString = address.substr(colon+1);
+
+        addrinfo hints;
+        memset(&hints,0,sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+
+        addrinfo *addresses = NULL;
+        if (getaddrinfo(host.c_str(),portString.c_str(),&hints,&addresses)!=0)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not resolve coordinator ")+address);
+        }
+
+        for (addrinfo *it = addresses;it;it=it->ai_next)
+        {
+            socketHandle = socket(it->ai_family,it->ai_socktype,it->ai_protocol);
+            if (socketHandle<0)
+            {
+                continue;
+            }
+            if (connect(socketHandle,it->ai_addr,it->ai_addrlen)==0)
+            {
+                break;
+            }
+            close(socketHandle);
+            socketHandle = -1;
+        }
+        freeaddrinfo(addresses);
+
+        if (socketHandle<0)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not connect to coordinator ")+address);
+        }
+
+        int noDelay=1;
+        setsockopt(socketHandle,IPPROTO_TCP,TCP_NODELAY,&noDelay,sizeof(noDelay));
+
+        signal(SIGPIPE,SIG_IGN);
+    }
+
+    EvaluationLeaseClient::~EvaluationLeaseClient()
+    {
+        if (socketHandle>=0)
+        {
+            close(socketHandle);
+        }
+    }
+
+    bool EvaluationLeaseClient::requestLease(int &generation,int &individual,string &populationFile,string &individualData)
+    {
+        static const char request[] = "LEASE\n";
+        if (send(socketHandle,request,sizeof(request)-1,0)<0)
+        {
+            return false;
+        }
+
+        string line;
+        if (!readLine(line))
+        {
+            return false;
+        }
+
+        istringstream istr(line);
+        string command;
+        istr >> command;
+
+        individualData.clear();
+
+        if (command=="EVALUATE")
+        {
+            if (!(istr >> generation >> individual))
+            {
+                return false;
+            }
+
+            //The rest of the line is the file name, which may contain spaces
+            getline(istr >> ws,populationFile);
+            return !populationFile.empty();
+        }
+        else if (command=="INDIVIDUAL")
+        {
+            int numBytes;
+            if (!(istr >> individual >> numBytes))
+            {
+                return false;
+            }
+            generation = -1;
+
+            getline(istr >> ws,populationFile);
+
+            //The individual data is followed by the end of the message
+            string rest;
+            return !populationFile.empty() && readBytes(numBytes,individualData) && readLine(rest);
+        }
+
+        return false;
+    }
+
+    void EvaluationLeaseClient::sendResult(int generation,int individual,float fitness)
+    {
+        ostringstream ostr;
+        ostr << setprecision(9) << "RESULT " << generation << ' ' << individual << ' ' << fitness << '\n';
+        string message = ostr.str();
+
+        size_t sent=0;
+        while (sent<message.size())
+        {
+            ssize_t numSent = send(socketHandle,message.c_str()+sent,message.size()-sent,0);
+            if (numSent<0)
+            {
+                if (errno==EINTR)
+                {
+                    continue;
+                }
+                //The next requestLease() notices the coordinator is gone
+                return;
+            }
+            sent += numSent;
+        }
+    }
+
+    bool EvaluationLeaseClient::readLine(string &line)
+    {
+        size_t lineEnd;
+        while ((lineEnd = input.find('\n'))==string::npos)
+        {
+            char buffer[4096];
+            ssize_t numRead = recv(socketHandle,buffer,sizeof(buffer),0);
+            if (numRead<0 && errno==EINTR)
+            {
+                continue;
+            }
+            if (numRead<=0)
+            {
+                return false;
+            }
+            input.append(buffer,numRead);
+        }
+
+        line = input.substr(0,lineEnd);
+        input.erase(0,lineEnd+1);
+        return true;
+    }
+
+    bool EvaluationLeaseClient::readBytes(int numBytes,string &data)
+    {
+        while ((int)input.size()<numBytes)
+        {
+            char buffer[4096];
+            ssize_t numRead = recv(socketHandle,buffer,sizeof(buffer),0);
+            if (numRead<0 && errno==EINTR)
+            {
+                continue;
+            }
+            if (numRead<=0)
+            {
+                return false;
+            }
+            input.append(buffer,numRead);
+        }
+
+        data = input.substr(0,numBytes);
+        input.erase(0,numBytes);
+        return true;
+    }
+}
@@ -0,0 +1,130 @@
+#include "HCUBE_Defines.h"
+
+#include "HCUBE_EvaluationTelemetry.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+namespace HCUBE
+{
+    EvaluationRecord::EvaluationRecord()
+        :
+        generation(-1),
+        individual(-1),
+        seed(0),
+        frames(0),
+        score(0),
+        substrateUsec(0),
+        networkUsec(0),
+        emulationUsec(0),
+        visProcUsec(0),
+        episodeEnd(0)
+    {
+    }
+
+    void EvaluationRecord::copyEpisode(const EvaluationRecord &other)
+    {
+        frames = other.frames;
+        score = other.score;
+        substrateUsec = other.substrateUsec;
+        networkUsec = other.networkUsec;
+        emulationUsec = other.emulationUsec;
+        visProcUsec = other.visProcUsec;
+        episodeEnd = other.episodeEnd;
+    }
+
+    void EvaluationRecord::addEpisode(const EvaluationRecord &other)
+    {
+        frames += other.frames;
+        substrateUsec += other.substrateUsec;
+        networkUsec += other.networkUsec;
+        emulationUsec += other.emulationUsec;
+        visProcUsec += other.visProcUsec;
+        if (other.episodeEnd != 0) {
+            episodeEnd = other.episodeEnd;
+        }
+    }
+
+    EvaluationTelemetry::EvaluationTelemetry(const string &fileName,int _chunkSize)
+        :
+        fileHandle(-1),
+        chunkSize(_chunkSize)
+    {
+        fileHandle = open(fileName.c_str(),O_WRONLY|O_CREAT|O_APPEND,0644);
+        if (fileHandle<0)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not open telemetry file ")+fileName+": "+strerror(errno));
+        }
+    }
+
+    EvaluationTelemetry::~EvaluationTelemetry()
+    {
+        try
+        {
+            flush();
+        }
+        catch (const std::exception &ex)
+        {
+            cout << "Lost telemetry records: " << ex.what() << endl;
+        }
+        close(fileHandle);
+    }
+
+    void EvaluationTelemetry::addRecord(const EvaluationRecord &record)
+    {
+        records.push_back(record);
+        if (int(records.size())>=chunkSize)
+        {
+            flush();
+        }
+    }
+
+    void EvaluationTelemetry::flush()
+    {
+        if (records.empty())
+        {
+            return;
+        }
+
+        int n = int(records.size());
+        string columns;
+        columns.reserve(n*56);
+        for (int a=0;a<n;a++) appendColumn(columns,int(records[a].generation));
+        for (int a=0;a<n;a++) appendColumn(columns,int(records[a].individual));
+        for (int a=0;a<n;a++) appendColumn(columns,uint(records[a].seed));
+        for (int a=0;a<n;a++) appendColumn(columns,int(records[a].frames));
+        for (int a=0;a<n;a++) appendColumn(columns,float(records[a].score));
+        for (int a=0;a<n;a++) appendColumn(columns,(long long)(records[a].substrateUsec));
+        for (int a=0;a<n;a++) appendColumn(columns,(long long)(records[a].networkUsec));
+        for (int a=0;a<n;a++) appendColumn(columns,(long long)(records[a].emulationUsec));
+        for (int a=0;a<n;a++) appendColumn(columns,(long long)(records[a].visProcUsec));
+        for (int a=0;a<n;a++) appendColumn(columns,int(records[a].episodeEnd));
+
+        string chunk;
+        chunk.reserve(4*sizeof(uint)+columns.size());
+        appendColumn(chunk,uint(EVALUATION_TELEMETRY_MAGIC));
+        appendColumn(chunk,uint(EVALUATION_TELEMETRY_VERSION));
+        appendColumn(chunk,uint(n));
+        appendColumn(chunk,uint(columns.size()));
+        chunk.append(columns);
+
+        records.clear();
+
+        //A partial write would leave a torn chunk in the middle of the log
+        ssize_t written = write(fileHandle,chunk.data(),chunk.size());
+        if (written!=ssize_t(chunk.size()))
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not write telemetry chunk: ")+strerror(errno));
+        }
+    }
+
+    long long EvaluationTelemetry::getMicroseconds()
+    {
+        timeval now;
+        gettimeofday(&now,NULL);
+        return (long long)(now.tv_sec)*1000000 + now.tv_usec;
+    }
+}
@@ -17,6 +17,7 @@
 #include "Experiments/HCUBE_AtariPixelPreferenceModulesExperiment.h"
 #include "Experiments/HCUBE_AtariNoiseExperiment.h"
 #include "Experiments/HCUBE_AtariCMAExperiment.h"
+#include "Experiments/HCUBE_TopologyDescriptor.h"
 #ifdef EPLEX_INTERNAL
 #include "Experiments/HCUBE_XorCoExperiment.h"
 #include "Experiments/HCUBE_SimpleImageExperiment.h"
@@ -59,6 +60,7 @@
 #endif
 
 #include "HCUBE_EvaluationSet.h"
+#include "HCUBE_EvaluationCoordinator.h"
 
 #include <boost/lexical_cast.hpp>
 #include <boost/archive/binary_oarchive.hpp>
@@ -77,7 +79,10 @@ namespace HCUBE
         started(false),
         cleanup(false),
         populationMutex(new mutex()),
-        frame(NULL)
+        frame(NULL),
+        steadyStateAdded(0),
+        steadyStateMaxGenerations(0),
+        hasEvaluationRecord(false)
     {
         //cout << "Creating experiment run" << endl;
     }
@@ -258,6 +263,30 @@ namespace HCUBE
                                                       string rom_file) {
         createPopulation(populationFile);
 
+        vector<float> fitnesses(population->getIndividualCount());
+
+        // Read the Individual fitness files and remove once read
+        for (int a = 0; a < population->getIndividualCount(); a++) {
+            string individualFile = fitnessFunctionPrefix + boost::lexical_cast<string>(a);
+            ifstream fin(individualFile.c_str());
+            if (fin.fail()) {
+                cout << "Failed to read individual fitness from file " << individualFile << ". Setting fitness to 0." << endl;
+                fitnesses[a] = 0;
+            } else {
+                fin >> fitnesses[a];
+            }
+            // Delete the file
+            if (remove(individualFile.c_str()) != 0) {
+                perror("Error deleting file");
+            }
+        }
+
+        setFitnesses(fitnesses, evaluationFile, rom_file);
+    }
+
+    void ExperimentRun::setFitnesses(const vector<float> &fitnesses,
+                                     string evaluationFile,
+                                     string rom_file) {
         allowGenerationProduction = true;
 
         // Check if we are running and hybrid experiment and it is time to switch over
@@ -277,22 +306,8 @@ namespace HCUBE
         vector<shared_ptr<NEAT::GeneticIndividual> >::iterator tmpIterator =
             population->getIndividualIterator(0);
 
-        // Read the Individual fitness files and remove once read
         for (int a = 0; a < population->getIndividualCount(); a++, tmpIterator++) {
-            string individualFile = fitnessFunctionPrefix + boost::lexical_cast<string>(a);
-            ifstream fin(individualFile.c_str());
-            if (fin.fail()) {
-                cout << "Failed to read individual fitness from file " << individualFile << ". Setting fitness to 0." << endl;
-                (*tmpIterator)->setFitness(0);
-            } else {
-                float fitness;
-                fin >> fitness;
-                (*tmpIterator)->setFitness(fitness);
-            }
-            // Delete the file
-            if (remove(individualFile.c_str()) != 0) {
-                perror("Error deleting file");
-            }
+            (*tmpIterator)->setFitness(fitnesses[a]);
         }
 
         population->adjustFitness();
@@ -310,6 +325,8 @@ namespace HCUBE
         for (int a=0;a<population->getIndividualCount();a++) {
             experiments[0]->addGenerationData(generation,population->getIndividual(a));
         }
+
+        updateRacingThreshold(fitnesses);
     }
 
     void ExperimentRun::createPopulation(string populationString)
@@ -336,6 +353,43 @@ namespace HCUBE
         }
     }
 
+    void ExperimentRun::initializeExperimentTopology(int experimentNum, string rom_file) {
+        shared_ptr<Experiment> experiment = experiments[experimentNum];
+
+        // The hybrid experiment caches the topology of its second experiment separately
+        string fileName = topologyFile;
+        if (experimentNum > 0 && !fileName.empty()) {
+            fileName += string(".") + boost::lexical_cast<string>(experimentNum);
+        }
+
+        string romName = TopologyDescriptor::getRomName(rom_file);
+
+        if (!fileName.empty()) {
+            TopologyDescriptor descriptor;
+            if (descriptor.load(fileName) &&
+                descriptor.experimentType == experimentType &&
+                (romName.empty() || descriptor.romName == romName)) {
+                cout << "Loading topology for " << descriptor.romName << " from " << fileName << endl;
+                experiment->importTopology(descriptor);
+                return;
+            }
+        }
+
+        if (rom_file.empty()) {
+            throw CREATE_LOCATEDEXCEPTION_INFO(
+                string("No ROM file given and no matching topology in ")+fileName);
+        }
+
+        experiment->initializeExperiment(rom_file.c_str());
+
+        TopologyDescriptor descriptor;
+        if (!fileName.empty() && experiment->exportTopology(descriptor)) {
+            descriptor.romName = romName;
+            descriptor.experimentType = experimentType;
+            descriptor.save(fileName);
+        }
+    }
+
     void ExperimentRun::convertPopulation(string rom_file) {
         cout << "Converting Population: HyperNEAT --> FT-NEAT" << endl;
 
@@ -348,8 +402,8 @@ namespace HCUBE
         shared_ptr<AtariFTNeatExperiment> ftNEAT_experiment =
             boost::static_pointer_cast<HCUBE::AtariFTNeatExperiment>(experiments[1]);
         // Both experiments must be initialized to have correct ANN topology
-        hyperNEAT_experiment->initializeExperiment(rom_file.c_str());
-        ftNEAT_experiment->initializeExperiment(rom_file.c_str());
+        initializeExperimentTopology(0, rom_file);
+        initializeExperimentTopology(1, rom_file);
         population = shared_ptr<NEAT::GeneticPopulation>(
             ftNEAT_experiment->convertPopulation(population, hyperNEAT_experiment));
 
@@ -372,15 +426,103 @@ namespace HCUBE
         NEAT::Globals::getSingleton()->addParameter("HybridConversionFinished",1.0);
     }
 
+    // Generation files written by saveGenerationFile start with this, followed by the
+    // name of the file they are a delta against ("-" for keyframes) on the same line
+#define GENERATION_DELTA_HEADER "HyperNEAT-generation-delta"
+
+    // Returns false, with the stream rewound, for files that are a plain population archive
+    static bool readGenerationDeltaHeader(std::ifstream &ifs, string &baseFile) {
+        string header(strlen(GENERATION_DELTA_HEADER), ' ');
+        ifs.read(&header[0], header.size());
+        if (!ifs || header != GENERATION_DELTA_HEADER || ifs.get() != ' ') {
+            ifs.clear();
+            ifs.seekg(0);
+            return false;
+        }
+        getline(ifs, baseFile);
+        return true;
+    }
+
+    static string getGenerationFileDirectory(const string &filename) {
+        size_t slash = filename.rfind('/');
+        if (slash == string::npos) {
+            return "";
+        }
+        return filename.substr(0, slash+1);
+    }
+
+    // Base file names without a directory are relative to the directory of the delta
+    static string getGenerationDeltaBasePath(const string &filename, const string &baseFile) {
+        if (baseFile.find('/') != string::npos) {
+            return baseFile;
+        }
+        return getGenerationFileDirectory(filename) + baseFile;
+    }
+
+    // Reads the generations stored in the base file of a delta, following the chain
+    // back to its keyframe.  The files that were read are added to deltaChain.
+    static vector<shared_ptr<NEAT::GeneticGeneration> > loadGenerationDeltaBase(
+        const string &filename, const string &baseFile, vector<string> &deltaChain) {
+        vector<shared_ptr<NEAT::GeneticGeneration> > base;
+        if (baseFile == "-") {
+            return base;
+        }
+
+        string basePath = getGenerationDeltaBasePath(filename, baseFile);
+        std::ifstream ifs(basePath.c_str(), std::ios::in|std::ios::binary);
+        string baseBaseFile;
+        if (!ifs.good() || !readGenerationDeltaHeader(ifs, baseBaseFile)) {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Missing base of generation file ")+filename+": "+basePath);
+        }
+        vector<shared_ptr<NEAT::GeneticGeneration> > baseBase =
+            loadGenerationDeltaBase(basePath, baseBaseFile, deltaChain);
+
+        boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
+        in.push(boost::iostreams::gzip_decompressor());
+        in.push(ifs);
+        boost::archive::binary_iarchive ia(in);
+        NEAT::GeneticPopulation basePopulation;
+        basePopulation.loadDelta(ia, baseBase);
+
+        deltaChain.push_back(basePath);
+        return basePopulation.getGenerations();
+    }
+
     void ExperimentRun::loadPopulationBoost(string filename) {
         population = shared_ptr<NEAT::GeneticPopulation>(new NEAT::GeneticPopulation());
         std::ifstream ifs(filename.c_str(), std::ios::in|std::ios::binary);
         assert(ifs.good());
+
+        string baseFile;
+        if (!readGenerationDeltaHeader(ifs, baseFile)) {
+            boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
+            in.push(boost::iostreams::gzip_decompressor());
+            in.push(ifs);
+            boost::archive::binary_iarchive ia(in);
+            ia >> (*population);
+
+            savedGenerations.clear();
+            savedDeltaChain.clear();
+            return;
+        }
+
+        vector<string> deltaChain;
+        vector<shared_ptr<NEAT::GeneticGeneration> > base =
+            loadGenerationDeltaBase(filename, baseFile, deltaChain);
+        deltaChain.push_back(filename);
+
         boost::iostreams::filtering_streambuf<boost::iostreams::input> in;
         in.push(boost::iostreams::gzip_decompressor());
         in.push(ifs);
         boost::archive::binary_iarchive ia(in);
-        ia >> (*population);
+        population->loadDelta(ia, base);
+
+        // Keep the generations as they were written, the next generation file is a delta against them
+        savedGenerations = population->copyGenerations();
+        savedDeltaChain = deltaChain;
+
+        ia >> (*NEAT::Globals::getSingleton());
+        population->adjustFitness();
     }
 
     void ExperimentRun::savePopulationBoost(string filename) {
@@ -392,6 +534,68 @@ namespace HCUBE
         oa << *population;
     }
 
+    void ExperimentRun::saveGenerationFile(string filename) {
+        int keyframeInterval = 10;
+        if (NEAT::Globals::getSingleton()->hasParameterValue("GenerationKeyframeInterval")) {
+            keyframeInterval = int(NEAT::Globals::getSingleton()->getParameterValue("GenerationKeyframeInterval")+0.001);
+        }
+
+        bool keyframe =
+            savedDeltaChain.empty() ||
+            int(savedDeltaChain.size()) >= keyframeInterval ||
+            find(savedDeltaChain.begin(), savedDeltaChain.end(), filename) != savedDeltaChain.end() ||
+            !boost::filesystem::exists(savedDeltaChain.back());
+
+        string baseFile = "-";
+        if (!keyframe) {
+            baseFile = savedDeltaChain.back();
+            if (getGenerationFileDirectory(baseFile) == getGenerationFileDirectory(filename)) {
+                baseFile = baseFile.substr(getGenerationFileDirectory(baseFile).size());
+            } else if (baseFile.find('/') == string::npos) {
+                baseFile = "./" + baseFile;
+            }
+        }
+
+        // Write under a temporary name so a crash never leaves a partial generation file
+        string tmpFileName = filename + ".tmp";
+        {
+            std::ofstream ofs(tmpFileName.c_str(),std::ios::out|std::ios::binary|std::ios::trunc);
+            ofs << GENERATION_DELTA_HEADER << ' ' << baseFile << '\n';
+
+            boost::iostreams::filtering_streambuf<boost::iostreams::output> out;
+            out.push(boost::iostreams::gzip_compressor());
+            out.push(ofs);
+            boost::archive::binary_oarchive oa(out);
+            population->saveDelta(oa, keyframe ? vector<shared_ptr<NEAT::GeneticGeneration> >() : savedGenerations);
+            oa << (*NEAT::Globals::getSingleton());
+        }
+        if (rename(tmpFileName.c_str(), filename.c_str()) != 0) {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Could not write generation file ")+filename);
+        }
+
+        savedGenerations = population->copyGenerations();
+        if (keyframe) {
+            savedDeltaChain.clear();
+        }
+        savedDeltaChain.push_back(filename);
+
+        for (int a = 0; a < int(obsoleteGenerationFiles.size()); a++) {
+            if (find(savedDeltaChain.begin(), savedDeltaChain.end(), obsoleteGenerationFiles[a]) == savedDeltaChain.end()) {
+                remove(obsoleteGenerationFiles[a].c_str());
+                obsoleteGenerationFiles.erase(obsoleteGenerationFiles.begin()+a);
+                a--;
+            }
+        }
+    }
+
+    void ExperimentRun::removeGenerationFile(string filename) {
+        if (find(savedDeltaChain.begin(), savedDeltaChain.end(), filename) != savedDeltaChain.end()) {
+            obsoleteGenerationFiles.push_back(filename);
+            return;
+        }
+        remove(filename.c_str());
+    }
+
     void ExperimentRun::setupExperimentInProgress(
         string populationFileName,
         string _outputFileName
@@ -449,7 +653,7 @@ namespace HCUBE
 
         // Save the population
         //population->dumpBest(outputFileName, true, true);
-        savePopulationBoost(outputFileName);
+        saveGenerationFile(outputFileName);
 
         // Try to load the population to make sure it saved correctly
         try {
@@ -459,6 +663,132 @@ namespace HCUBE
         }
     }
 
+    void ExperimentRun::startCoordinator(int port, string resultsDir, int maxGenerations,
+                                         string rom_file, string populationFile) {
+        started = running = true;
+        int generation = (population->getGenerationCount()-1);
+        cout << "[HyperNEAT core] Coordinating experiment from generation: " << generation << endl;
+
+        // A resumed run serves the population file it was loaded from
+        if (iequals(populationFile,"")) {
+            populationFile = getGenerationFileName(resultsDir, generation);
+            saveGenerationFile(populationFile);
+        }
+
+        double leaseSeconds = 1800.0;
+        if (NEAT::Globals::getSingleton()->hasParameterValue("EvaluationLeaseSeconds")) {
+            leaseSeconds = NEAT::Globals::getSingleton()->getParameterValue("EvaluationLeaseSeconds");
+        }
+
+        bool steadyState =
+            NEAT::Globals::getSingleton()->hasParameterValue("SteadyStateEvolution") &&
+            NEAT::Globals::getSingleton()->getParameterValue("SteadyStateEvolution") > 0.5;
+
+        // The hybrid switch and CMA-ES both work on whole generations
+        if (steadyState && (experimentType == 33 || experimentType == 41)) {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Steady-state evolution is not supported for hybrid or CMA experiments");
+        }
+
+        EvaluationCoordinator coordinator(port, leaseSeconds);
+        coordinator.writeAddress(resultsDir + "/coordinator");
+
+        while (generation < maxGenerations) {
+            vector<float> fitnesses;
+            coordinator.evaluateGeneration(generation, populationFile,
+                                           population->getIndividualCount(), fitnesses);
+            setFitnesses(fitnesses, "", rom_file);
+
+            if (steadyState) {
+                evolveSteadyState(coordinator, resultsDir, maxGenerations, populationFile);
+                break;
+            }
+
+            if (allowGenerationProduction) {
+                produceNextGeneration();
+                population->cleanupOld();
+            }
+            generation++;
+
+            string nextPopulationFile = getGenerationFileName(resultsDir, generation);
+            saveGenerationFile(nextPopulationFile);
+
+            removeGenerationFile(populationFile);
+            populationFile = nextPopulationFile;
+        }
+
+        coordinator.finish();
+    }
+
+    void ExperimentRun::evolveSteadyState(EvaluationCoordinator &coordinator, string resultsDir,
+                                          int maxGenerations, string populationFile) {
+        steadyStateIndividuals.clear();
+        steadyStateAdded = 0;
+        steadyStateMaxGenerations = maxGenerations;
+        steadyStateResultsDir = resultsDir;
+        // populationFile is the last generation file that was written or loaded
+        steadyStatePopulationFiles = savedDeltaChain;
+
+        // Workers load the experiment settings from populationFile, so it is kept until the run is over
+        coordinator.evaluateSteadyState(populationFile, this);
+        steadyStateIndividuals.clear();
+
+        string lastGenerationFile = getGenerationFileName(resultsDir, population->getGenerationCount()-1);
+        for (int a = 0; a < int(steadyStatePopulationFiles.size()); a++) {
+            if (steadyStatePopulationFiles[a] != lastGenerationFile) {
+                removeGenerationFile(steadyStatePopulationFiles[a]);
+            }
+        }
+        steadyStatePopulationFiles.clear();
+    }
+
+    void ExperimentRun::breedIndividual(int individualID, string &individualData) {
+        shared_ptr<NEAT::GeneticIndividual> individual = population->produceSteadyStateOffspring();
+        steadyStateIndividuals[individualID] = individual;
+
+        ostringstream ostr;
+        ostr << setprecision(17);
+        individual->dump(ostr);
+        individualData = ostr.str();
+    }
+
+    bool ExperimentRun::addResult(int individualID, float fitness) {
+        map<int,shared_ptr<NEAT::GeneticIndividual> >::iterator it = steadyStateIndividuals.find(individualID);
+        if (it == steadyStateIndividuals.end()) {
+            return true;
+        }
+
+        shared_ptr<NEAT::GeneticIndividual> individual = it->second;
+        steadyStateIndividuals.erase(it);
+
+        individual->setFitness(fitness);
+        population->addSteadyStateIndividual(individual);
+        steadyStateAdded++;
+
+        // Every population's worth of offspring is written out as a generation
+        if (steadyStateAdded % population->getIndividualCount() != 0) {
+            return true;
+        }
+
+        population->getGeneration()->printGenerationalStatistics();
+        population->advanceSteadyStateGeneration();
+        population->cleanupOld();
+
+        int generation = population->getGenerationCount()-1;
+        string generationFile = getGenerationFileName(steadyStateResultsDir, generation);
+        saveGenerationFile(generationFile);
+
+        string previousGenerationFile = getGenerationFileName(steadyStateResultsDir, generation-1);
+        if (find(steadyStatePopulationFiles.begin(), steadyStatePopulationFiles.end(), previousGenerationFile) ==
+            steadyStatePopulationFiles.end()) {
+            removeGenerationFile(previousGenerationFile);
+        }
+
+        return generation < steadyStateMaxGenerations;
+    }
+
+    string ExperimentRun::getGenerationFileName(string resultsDir, int generation) {
+        return resultsDir + "/generation" + boost::lexical_cast<string>(generation) + ".ser.gz";
+    }
 
     void ExperimentRun::start()
     {
@@ -561,12 +891,116 @@ namespace HCUBE
     }
 
     float ExperimentRun::evaluateIndividual(unsigned int individualId) {
+        return evaluateIndividual(population->getIndividual(individualId));
+    }
+
+    float ExperimentRun::evaluateIndividual(shared_ptr<NEAT::GeneticIndividual> individual) {
+        NEAT::Globals *globals = NEAT::Globals::getSingleton();
         shared_ptr<NEAT::GeneticGeneration> generation = population->getGeneration();
-        experiments[0]->preprocessIndividual(generation, generation->getIndividual(individualId));
-        experiments[0]->clearGroup();
-        experiments[0]->addIndividualToGroup(generation->getIndividual(individualId));
-        experiments[0]->processGroup(generation);
-        return generation->getIndividual(individualId)->getFitness();
+
+        int maxEpisodes = 1;
+        if (globals->hasParameterValue("EvaluationEpisodes")) {
+            maxEpisodes = max(1, int(globals->getParameterValue("EvaluationEpisodes")+0.001));
+        }
+        unsigned int seed = globals->getRandom().getSeed();
+
+        evaluationRecord = EvaluationRecord();
+        hasEvaluationRecord = true;
+
+        vector<float> scores;
+        for (int episode = 0; episode < maxEpisodes; episode++) {
+            // Episode a is always played with seed+a, so reevaluations play the same episodes
+            if (episode > 0) {
+                globals->seedRandom(seed + episode);
+            }
+
+            experiments[0]->preprocessIndividual(generation, individual);
+            experiments[0]->clearGroup();
+            experiments[0]->addIndividualToGroup(individual);
+            experiments[0]->processGroup(generation);
+            scores.push_back(individual->getFitness());
+
+            EvaluationRecord episodeRecord;
+            hasEvaluationRecord = hasEvaluationRecord && experiments[0]->getEvaluationRecord(episodeRecord);
+            evaluationRecord.addEpisode(episodeRecord);
+
+            if (isHopeless(scores, maxEpisodes)) {
+                cout << "Racing: stopped after " << scores.size() << " of " << maxEpisodes
+                     << " episodes, below the threshold of " << globals->getParameterValue("RacingThreshold") << endl;
+                break;
+            }
+        }
+
+        if (maxEpisodes > 1) {
+            float total = 0;
+            for (int a = 0; a < int(scores.size()); a++) {
+                total += scores[a];
+            }
+            individual->setFitness(total / scores.size());
+        }
+        evaluationRecord.score = individual->getFitness();
+        return individual->getFitness();
+    }
+
+    bool ExperimentRun::getEvaluationRecord(EvaluationRecord &record) {
+        if (!hasEvaluationRecord) {
+            return false;
+        }
+        record.copyEpisode(evaluationRecord);
+        return true;
+    }
+
+    bool ExperimentRun::isHopeless(const vector<float> &scores, int maxEpisodes) {
+        NEAT::Globals *globals = NEAT::Globals::getSingleton();
+        if (!globals->hasParameterValue("RacingConfidence") ||
+            !globals->hasParameterValue("RacingThreshold") ||
+            globals->getParameterValue("RacingConfidence") <= 0) {
+            return false;
+        }
+
+        int minEpisodes = 2;
+        if (globals->hasParameterValue("RacingMinEpisodes")) {
+            minEpisodes = max(1, int(globals->getParameterValue("RacingMinEpisodes")+0.001));
+        }
+        int n = int(scores.size());
+        if (n < minEpisodes || n >= maxEpisodes) {
+            return false;
+        }
+
+        double mean = 0;
+        for (int a = 0; a < n; a++) {
+            mean += scores[a];
+        }
+        mean /= n;
+
+        double variance = 0;
+        for (int a = 0; a < n; a++) {
+            variance += (scores[a]-mean)*(scores[a]-mean);
+        }
+        if (n > 1) {
+            variance /= (n-1);
+        }
+
+        double upperBound = mean + globals->getParameterValue("RacingConfidence")*sqrt(variance/n);
+        return upperBound < globals->getParameterValue("RacingThreshold");
+    }
+
+    void ExperimentRun::updateRacingThreshold(const vector<float> &fitnesses) {
+        NEAT::Globals *globals = NEAT::Globals::getSingleton();
+        if (fitnesses.empty() ||
+            !globals->hasParameterValue("RacingConfidence") ||
+            globals->getParameterValue("RacingConfidence") <= 0) {
+            return;
+        }
+
+        vector<float> sortedFitnesses(fitnesses);
+        sort(sortedFitnesses.begin(), sortedFitnesses.end(), greater<float>());
+        int lastSurvivor = int(globals->getParameterValue("SurvivalThreshold")*sortedFitnesses.size());
+        lastSurvivor = min(lastSurvivor, int(sortedFitnesses.size())-1);
+
+        // Workers read the threshold from the globals in the next generation file
+        globals->setParameterValue("RacingThreshold", sortedFitnesses[lastSurvivor]);
+        cout << "Racing threshold for the next generation: " << sortedFitnesses[lastSurvivor] << endl;
     }
  
     void ExperimentRun::evaluatePopulation()
@@ -6,12 +6,15 @@
 #endif
 
 #include "HCUBE_ExperimentRun.h"
+#include "HCUBE_EvaluationCoordinator.h"
+#include "HCUBE_EvaluationTelemetry.h"
 #include "Experiments/HCUBE_AtariExperiment.h"
 #include "Experiments/HCUBE_AtariNoGeomExperiment.h"
 #include "Experiments/HCUBE_AtariFTNeatExperiment.h"
 #include "Experiments/HCUBE_AtariFTNeatPixelExperiment.h"
 #include "Experiments/HCUBE_AtariIntrinsicExperiment.h"
 #include "Experiments/HCUBE_AtariCMAExperiment.h"
+#include "Experiments/HCUBE_AtariEpisodeBudget.h"
 #include "Experiments/HCUBE_AtariPixelExperiment.h" // Schrum: Added
 #include "Experiments/HCUBE_AtariPixelPreferenceModulesExperiment.h" // Schrum: Added
 
@@ -26,11 +29,268 @@ using namespace boost;
 using namespace HCUBE;
 using namespace NEAT;
 
+// SubstrateCacheMB in the globals keeps that many megabytes of populated substrates, so genomes that were
+// evaluated before skip their CPPN queries. SubstrateCacheDisk also shares them through the substrateCache
+// directory next to populationFile. The cache lives as long as the process, across generations.
+static void setupSubstrateCache(Globals *globals, const string &populationFile) {
+    if (!globals->hasParameterValue("SubstrateCacheMB") || globals->getParameterValue("SubstrateCacheMB") <= 0) {
+        LayeredSubstrate<float>::setCache(shared_ptr<LayeredSubstrateCache<float> >());
+        return;
+    }
+
+    size_t maxBytes = size_t(globals->getParameterValue("SubstrateCacheMB") * 1024 * 1024);
+    string directory;
+    if (globals->hasParameterValue("SubstrateCacheDisk") && globals->getParameterValue("SubstrateCacheDisk") > 0) {
+        filesystem::path populationDirectory = filesystem::path(populationFile).parent_path();
+        directory = (populationDirectory / "substrateCache").string();
+    }
+
+    shared_ptr<LayeredSubstrateCache<float> > cache = LayeredSubstrate<float>::getCache();
+    if (cache) {
+        cache->setMaxBytes(maxBytes);
+        cache->setDirectory(directory);
+    } else {
+        LayeredSubstrate<float>::setCache(
+            shared_ptr<LayeredSubstrateCache<float> >(new LayeredSubstrateCache<float>(maxBytes, directory)));
+    }
+}
+
+// Loads populationFile, seeds the random generator and initializes the experiment with the rom file
+static void setupEvaluation(HCUBE::ExperimentRun &experimentRun, Globals *globals, int experimentType,
+                            const string &populationFile, const string &rom_file,
+                            CommandLineParser &commandLineParser, int generationNum) {
+    experimentRun.setupExperiment(experimentType, "output.xml");
+
+    experimentRun.createPopulation(populationFile);
+    cout << "[HyperNEAT core] Population Created\n";
+
+    setupSubstrateCache(globals, populationFile);
+
+    if (commandLineParser.HasSwitch("-R")) {
+        double seed = stringTo<double>(commandLineParser.GetArgument("-R",0));
+        globals->setParameterValue("RandomSeed",seed);
+        globals->initRandom();
+    }
+
+    shared_ptr<Experiment> e = experimentRun.getExperiment();
+
+    if (experimentType == 42) { // Schrum: AtariPixelPreferenceModulesExperiment: multimodal
+        shared_ptr<AtariPixelPreferenceModulesExperiment> exp = static_pointer_cast<AtariPixelPreferenceModulesExperiment>(e);
+        int numProcessingLayers = int(globals->getParameterValue("ProcessingLayers") + 0.001);
+        exp->setProcessingLayers(numProcessingLayers);	
+        cout << "[HyperNEAT core] Number of processing layers is: " << numProcessingLayers << endl;
+        int numProcessingLevels = int(globals->getParameterValue("ProcessingLevels") + 0.001);
+        exp->setProcessingLevels(numProcessingLevels);	
+        cout << "[HyperNEAT core] Number of processing levels is: " << numProcessingLevels << endl;
+        int numOutputModules = int(globals->getParameterValue("OutputModules") + 0.001);
+        exp->setOutputModules(numOutputModules);	
+        cout << "[HyperNEAT core] Number of output modules is: " << numOutputModules << endl;
+        exp->initializeExperiment(rom_file.c_str());
+    } else if (experimentType == 35) { // Schrum: The AtariPixelExperiment with HyperNEAT
+        //cout << "evaluate: MY CODE" << endl;
+        shared_ptr<AtariPixelExperiment> exp = static_pointer_cast<AtariPixelExperiment>(e);
+        int numProcessingLevels = int(globals->getParameterValue("ProcessingLevels") + 0.001);
+        exp->setProcessingLevels(numProcessingLevels);	
+        cout << "[HyperNEAT core] Number of processing levels is: " << numProcessingLevels << endl;
+        // Schrum: Want to allow for more flexability in substrate organization
+        int numProcessingLayers = int(globals->getParameterValue("ProcessingLayers") + 0.001);
+        exp->setProcessingLayers(numProcessingLayers);	
+        cout << "[HyperNEAT core] Number of processing layers is: " << numProcessingLayers << endl;
+        exp->initializeExperiment(rom_file.c_str());
+    } else if (experimentType == 30 || experimentType == 36) {
+        shared_ptr<AtariExperiment> exp = static_pointer_cast<AtariExperiment>(e);
+        exp->initializeExperiment(rom_file.c_str());
+    } else if (experimentType == 31 || experimentType == 39 || experimentType == 40) {
+        shared_ptr<AtariNoGeomExperiment> exp = static_pointer_cast<AtariNoGeomExperiment>(e);
+        exp->initializeExperiment(rom_file.c_str());
+    } else if (experimentType == 32 || experimentType == 37 || experimentType == 38) {
+        shared_ptr<AtariFTNeatExperiment> exp = static_pointer_cast<AtariFTNeatExperiment>(e);
+        exp->initializeExperiment(rom_file.c_str());
+    } else if (experimentType == 33) {
+        // This is the Hybrid experiment and can thus be either HyperNEAT or FT-NEAT
+        if (globals->hasParameterValue("HybridConversionFinished") &&
+            globals->getParameterValue("HybridConversionFinished") == 1.0) {
+            // Make the FT-NEAT experiment active
+            experimentRun.setActiveExperiment(1);
+            e = experimentRun.getExperiment();
+            shared_ptr<AtariFTNeatExperiment> exp = static_pointer_cast<AtariFTNeatExperiment>(e);
+            exp->initializeExperiment(rom_file.c_str());
+        } else {
+            // Before the swap both experiments are needed, see evaluateHybridIndividual
+            shared_ptr<AtariExperiment> atariExp = static_pointer_cast<AtariExperiment>(e);
+            atariExp->initializeExperiment(rom_file.c_str());
+            shared_ptr<AtariFTNeatExperiment> ftExp =
+                static_pointer_cast<AtariFTNeatExperiment>(experimentRun.getExperiment(1));
+            ftExp->initializeExperiment(rom_file.c_str());
+        }
+    } else if (experimentType == 34) {
+        shared_ptr<AtariIntrinsicExperiment> exp = static_pointer_cast<AtariIntrinsicExperiment>(e);
+        exp->initializeExperiment(rom_file.c_str());
+    } else if (experimentType == 41) {
+        shared_ptr<AtariCMAExperiment> exp = static_pointer_cast<AtariCMAExperiment>(e);
+        exp->initializeExperiment(rom_file.c_str());
+
+        cout << "Using generation number " << generationNum << endl;
+        exp->generationNumber = generationNum;
+
+        exp->setResultsPath(populationFile);
+    }
+}
+
+// GenerationMaxSeconds counts from when the generation file was written
+static void setGenerationDeadline(const string &populationFile, int generation) {
+    long long generationStartUsec = 0;
+    if (generation >= 0 && filesystem::exists(populationFile)) {
+        generationStartUsec = (long long)(filesystem::last_write_time(populationFile)) * 1000000;
+    }
+    AtariEpisodeBudget::setGenerationDeadline(generationStartUsec);
+}
+
+// This is a nasty-hack like short circuit of the normal evaluation
+// procedure. It is used for HyperNEAT evaluation in Hybrid experiments. The
+// crux of this method is to convert the hyperneat indvidual to be evaluated
+// into a FT-individual and then perform the eval using FT methods. This
+// should ensure that when the swap is done, fitness does not drop off as a
+// result of using different types of networks to evaluate individuals.
+// This is the early generational case before the swap has happened
+static float evaluateHybridIndividual(HCUBE::ExperimentRun &experimentRun, unsigned int individualId) {
+    shared_ptr<AtariExperiment> atariExp = static_pointer_cast<AtariExperiment>(experimentRun.getExperiment(0));
+    shared_ptr<AtariFTNeatExperiment> ftExp = static_pointer_cast<AtariFTNeatExperiment>(experimentRun.getExperiment(1));
+    // Get the individual to evaluate
+    shared_ptr<NEAT::GeneticPopulation> population = experimentRun.getPopulation();
+    shared_ptr<NEAT::GeneticGeneration> generation = population->getGeneration();
+    shared_ptr<NEAT::GeneticIndividual> HyperNEAT_individual = generation->getIndividual(individualId);
+    atariExp->substrate.populateSubstrate(HyperNEAT_individual);
+    NEAT::LayeredSubstrate<float>* HyperNEAT_substrate = &atariExp->substrate;
+    GeneticPopulation* FTNEAT_population = ftExp->createInitialPopulation(1);
+    shared_ptr<GeneticIndividual> FTNEAT_individual = FTNEAT_population->getGeneration()->getIndividual(0);
+    ftExp->convertIndividual(FTNEAT_individual, HyperNEAT_substrate);
+    ftExp->evaluateIndividual(FTNEAT_individual);
+    float fitness = FTNEAT_individual->getFitness();
+    delete FTNEAT_population;
+    return fitness;
+}
+
+static float evaluateIndividual(HCUBE::ExperimentRun &experimentRun, Globals *globals, int experimentType,
+                                unsigned int individualId) {
+    if (experimentType == 33 &&
+        !(globals->hasParameterValue("HybridConversionFinished") &&
+          globals->getParameterValue("HybridConversionFinished") == 1.0)) {
+        return evaluateHybridIndividual(experimentRun, individualId);
+    }
+
+    if (experimentType == 41) {
+        shared_ptr<AtariCMAExperiment> exp = static_pointer_cast<AtariCMAExperiment>(experimentRun.getExperiment());
+        exp->individualToEvaluate = individualId;
+    }
+
+    return experimentRun.evaluateIndividual(individualId);
+}
+
+// Appends the score and stage times of the individual that was just evaluated to the telemetry log
+static void recordEvaluation(EvaluationTelemetry &telemetry, HCUBE::ExperimentRun &experimentRun, Globals *globals,
+                             int experimentType, int generation, unsigned int individualId, unsigned int seed,
+                             float fitness) {
+    EvaluationRecord record;
+    record.generation = generation;
+    record.individual = individualId;
+    record.seed = seed;
+
+    // Before the hybrid switch the FT-NEAT experiment plays the episode, see evaluateHybridIndividual
+    if (experimentType == 33 &&
+        !(globals->hasParameterValue("HybridConversionFinished") &&
+          globals->getParameterValue("HybridConversionFinished") == 1.0)) {
+        experimentRun.getExperiment(1)->getEvaluationRecord(record);
+    } else {
+        experimentRun.getEvaluationRecord(record);
+    }
+    record.score = fitness;
+
+    telemetry.addRecord(record);
+}
+
+// Evaluates individuals leased from an atari_generate -S coordinator until the run is over
+static void evaluateLeases(const string &coordinatorAddress, CommandLineParser &commandLineParser) {
+    shared_ptr<EvaluationTelemetry> telemetry;
+    if (commandLineParser.HasSwitch("-L")) {
+        telemetry = shared_ptr<EvaluationTelemetry>(new EvaluationTelemetry(commandLineParser.GetArgument("-L",0)));
+    }
+
+    EvaluationLeaseClient client(coordinatorAddress);
+    cout << "[HyperNEAT core] Connected to coordinator at " << coordinatorAddress << endl;
+
+    string rom_file = commandLineParser.GetArgument("-G",0);
+    shared_ptr<HCUBE::ExperimentRun> experimentRun;
+    Globals *globals = NULL;
+    int experimentType = 0;
+    string loadedPopulationFile;
+    // The random state after setup, which a single-individual run evaluates from
+    NEAT::Random setupRandom;
+
+    int generation;
+    int individualId;
+    string populationFile;
+    string individualData;
+    while (client.requestLease(generation, individualId, populationFile, individualData)) {
+        // The experiment is set up again once per generation, since the
+        // population file carries the globals (e.g. the hybrid switch)
+        if (populationFile != loadedPopulationFile) {
+            experimentRun.reset();
+            globals = Globals::init(commandLineParser.GetArgument("-I",0));
+            experimentType = int(globals->getParameterValue("ExperimentType") + 0.001);
+
+            cout << "[HyperNEAT core] Loading Experiment: " << experimentType << endl;
+            experimentRun = shared_ptr<HCUBE::ExperimentRun>(new HCUBE::ExperimentRun());
+            setupEvaluation(*experimentRun, globals, experimentType, populationFile, rom_file,
+                            commandLineParser, generation);
+            loadedPopulationFile = populationFile;
+            setupRandom = globals->getRandom();
+            // Steady-state runs have no generation to run out of time in
+            setGenerationDeadline(populationFile, generation);
+        }
+
+        // Every individual starts from the same random state, as with one process per individual
+        if (commandLineParser.HasSwitch("-R")) {
+            globals->getRandom() = setupRandom;
+        }
+
+        // Later episodes of a multi-episode evaluation reseed the generator
+        unsigned int seed = globals->getRandom().getSeed();
+        float fitness;
+        if (individualData.empty()) {
+            cout << "[HyperNEAT core] Evaluating individual: " << individualId << " of generation " << generation << endl;
+            fitness = evaluateIndividual(*experimentRun, globals, experimentType, individualId);
+        } else {
+            // Steady-state offspring are not in the population file, they come with the lease
+            istringstream istr(individualData);
+            shared_ptr<GeneticIndividual> individual(new GeneticIndividual(istr));
+            cout << "[HyperNEAT core] Evaluating steady-state individual: " << individualId << endl;
+            fitness = experimentRun->evaluateIndividual(individual);
+        }
+        cout << "[HyperNEAT core] Fitness found to be " << fitness << endl;
+
+        if (telemetry) {
+            recordEvaluation(*telemetry, *experimentRun, globals, experimentType, generation, individualId, seed,
+                             fitness);
+        }
+
+        client.sendResult(generation, individualId, fitness);
+    }
+
+    cout << "[HyperNEAT core] Coordinator has no more individuals, exiting." << endl;
+}
+
 int HyperNEAT_main(int argc,char **argv) {
     CommandLineParser commandLineParser(argc,argv);
     Globals* globals = Globals::init();
 
     if (commandLineParser.HasSwitch("-I") && // Experiment params
+        commandLineParser.HasSwitch("-C") && // Coordinator to lease individuals from
+        commandLineParser.HasSwitch("-G"))   // Rom file to run
+    {
+        evaluateLeases(commandLineParser.GetArgument("-C",0), commandLineParser);
+    }
+    else if (commandLineParser.HasSwitch("-I") && // Experiment params
         commandLineParser.HasSwitch("-F") && // Fitness file to write to
         commandLineParser.HasSwitch("-P") && // Population file to read from
         commandLineParser.HasSwitch("-N") && // Individual number within pop file
@@ -42,124 +302,25 @@ int HyperNEAT_main(int argc,char **argv) {
 
         cout << "[HyperNEAT core] Loading Experiment: " << experimentType << endl;
         HCUBE::ExperimentRun experimentRun;
-        experimentRun.setupExperiment(experimentType, "output.xml");
 
-        string populationFile = commandLineParser.GetArgument("-P",0);
-        experimentRun.createPopulation(populationFile);
-        cout << "[HyperNEAT core] Population Created\n";
+        unsigned int individualId = stringTo<unsigned int>(commandLineParser.GetArgument("-N",0));
 
-        if (commandLineParser.HasSwitch("-R")) {
-            double seed = stringTo<double>(commandLineParser.GetArgument("-R",0));
-            globals->setParameterValue("RandomSeed",seed);
-            globals->initRandom();
+        unsigned int generationNum = 0;
+        if (experimentType == 41) {
+            assert(commandLineParser.HasSwitch("-g"));
+            generationNum = stringTo<unsigned int>(commandLineParser.GetArgument("-g",0));
         }
 
-        unsigned int individualId = stringTo<unsigned int>(commandLineParser.GetArgument("-N",0));
-        cout << "[HyperNEAT core] Evaluating individual: " << individualId << endl;
-
         // Cast the experiment into the correct subclass and initialize with rom file
+        string populationFile = commandLineParser.GetArgument("-P",0);
         string rom_file = commandLineParser.GetArgument("-G",0);
-        shared_ptr<Experiment> e = experimentRun.getExperiment();
-
-	if (experimentType == 42) { // Schrum: AtariPixelPreferenceModulesExperiment: multimodal
-            shared_ptr<AtariPixelPreferenceModulesExperiment> exp = static_pointer_cast<AtariPixelPreferenceModulesExperiment>(e);
-            int numProcessingLayers = int(globals->getParameterValue("ProcessingLayers") + 0.001);
-	    exp->setProcessingLayers(numProcessingLayers);	
-            cout << "[HyperNEAT core] Number of processing layers is: " << numProcessingLayers << endl;
-            int numProcessingLevels = int(globals->getParameterValue("ProcessingLevels") + 0.001);
-	    exp->setProcessingLevels(numProcessingLevels);	
-            cout << "[HyperNEAT core] Number of processing levels is: " << numProcessingLevels << endl;
-            int numOutputModules = int(globals->getParameterValue("OutputModules") + 0.001);
-	    exp->setOutputModules(numOutputModules);	
-            cout << "[HyperNEAT core] Number of output modules is: " << numOutputModules << endl;
-            exp->initializeExperiment(rom_file.c_str());
-	} else if (experimentType == 35) { // Schrum: The AtariPixelExperiment with HyperNEAT
-	    //cout << "evaluate: MY CODE" << endl;
-            shared_ptr<AtariPixelExperiment> exp = static_pointer_cast<AtariPixelExperiment>(e);
-            int numProcessingLevels = int(globals->getParameterValue("ProcessingLevels") + 0.001);
-	    exp->setProcessingLevels(numProcessingLevels);	
-            cout << "[HyperNEAT core] Number of processing levels is: " << numProcessingLevels << endl;
-	    // Schrum: Want to allow for more flexability in substrate organization
-            int numProcessingLayers = int(globals->getParameterValue("ProcessingLayers") + 0.001);
-	    exp->setProcessingLayers(numProcessingLayers);	
-            cout << "[HyperNEAT core] Number of processing layers is: " << numProcessingLayers << endl;
-            exp->initializeExperiment(rom_file.c_str());
-	} else if (experimentType == 30 || experimentType == 36) {
-            shared_ptr<AtariExperiment> exp = static_pointer_cast<AtariExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 31 || experimentType == 39 || experimentType == 40) {
-            shared_ptr<AtariNoGeomExperiment> exp = static_pointer_cast<AtariNoGeomExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 32 || experimentType == 37 || experimentType == 38) {
-            shared_ptr<AtariFTNeatExperiment> exp = static_pointer_cast<AtariFTNeatExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 33) {
-            // This is the Hybrid experiment and can thus be either HyperNEAT or FT-NEAT
-            if (globals->hasParameterValue("HybridConversionFinished") &&
-                globals->getParameterValue("HybridConversionFinished") == 1.0) {
-                // Make the FT-NEAT experiment active
-                experimentRun.setActiveExperiment(1);
-                e = experimentRun.getExperiment();
-                shared_ptr<AtariFTNeatExperiment> exp = static_pointer_cast<AtariFTNeatExperiment>(e);
-                exp->initializeExperiment(rom_file.c_str());
-            } else {
-                // shared_ptr<AtariExperiment> exp = static_pointer_cast<AtariExperiment>(e);
-                // exp->initializeExperiment(rom_file.c_str());
-
-                // This is a nasty-hack like short circuit of the
-                // normal evaluation procedure. It is used for
-                // HyperNEAT evaluation in Hybrid experiments. The
-                // crux of this method is to convert the hyperneat
-                // indvidual to be evaluated into a FT-individual and
-                // then perform the eval using FT methods. This should
-                // ensure that when the swap is done, fitness does not
-                // drop off as a result of using different types of
-                // networks to evaluate individuals.
-                // This is the early generational case before the swap has happened
-                shared_ptr<AtariExperiment> atariExp = static_pointer_cast<AtariExperiment>(e);
-                // Initialize both experiments
-                atariExp->initializeExperiment(rom_file.c_str());
-                experimentRun.setActiveExperiment(1);
-                e = experimentRun.getExperiment();
-                shared_ptr<AtariFTNeatExperiment> ftExp = static_pointer_cast<AtariFTNeatExperiment>(e);
-                ftExp->initializeExperiment(rom_file.c_str());
-                // Get the individual to evaluate
-                shared_ptr<NEAT::GeneticPopulation> population = experimentRun.getPopulation();
-                shared_ptr<NEAT::GeneticGeneration> generation = population->getGeneration();
-                shared_ptr<NEAT::GeneticIndividual> HyperNEAT_individual = generation->getIndividual(individualId);
-                atariExp->substrate.populateSubstrate(HyperNEAT_individual);
-                NEAT::LayeredSubstrate<float>* HyperNEAT_substrate = &atariExp->substrate;
-                GeneticPopulation* FTNEAT_population = ftExp->createInitialPopulation(1);
-                shared_ptr<GeneticIndividual> FTNEAT_individual = FTNEAT_population->getGeneration()->getIndividual(0);
-                ftExp->convertIndividual(FTNEAT_individual, HyperNEAT_substrate);
-                ftExp->evaluateIndividual(FTNEAT_individual);
-                float fitness = FTNEAT_individual->getFitness();
-                string individualFitnessFile = commandLineParser.GetArgument("-F",0);
-                cout << "[HyperNEAT core] Fitness found to be " << fitness << ". Writing to: " <<
-                    individualFitnessFile << endl;
-                ofstream fout(individualFitnessFile.c_str());
-                fout << fitness << endl;
-                fout.close();
-                cout << "[HyperNEAT core] Individual evaluation fin." << endl;
-                exit(0);
-            }
-        } else if (experimentType == 34) {
-            shared_ptr<AtariIntrinsicExperiment> exp = static_pointer_cast<AtariIntrinsicExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 41) {
-            shared_ptr<AtariCMAExperiment> exp = static_pointer_cast<AtariCMAExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-            exp->individualToEvaluate = individualId;
-
-            assert(commandLineParser.HasSwitch("-g"));
-            unsigned int generationNum = stringTo<unsigned int>(commandLineParser.GetArgument("-g",0));
-            cout << "Using generation number " << generationNum << endl;
-            exp->generationNumber = generationNum;
+        setupEvaluation(experimentRun, globals, experimentType, populationFile, rom_file,
+                        commandLineParser, generationNum);
+        setGenerationDeadline(populationFile, generationNum);
 
-            exp->setResultsPath(populationFile);
-        }
-
-        float fitness = experimentRun.evaluateIndividual(individualId);
+        cout << "[HyperNEAT core] Evaluating individual: " << individualId << endl;
+        unsigned int seed = globals->getRandom().getSeed();
+        float fitness = evaluateIndividual(experimentRun, globals, experimentType, individualId);
 
         string individualFitnessFile = 
             commandLineParser.GetArgument("-F",0);
@@ -168,11 +329,20 @@ int HyperNEAT_main(int argc,char **argv) {
         ofstream fout(individualFitnessFile.c_str());
         fout << fitness << endl;
         fout.close();
+
+        if (commandLineParser.HasSwitch("-L")) {
+            // One record per process, the chunk is written when telemetry goes out of scope
+            EvaluationTelemetry telemetry(commandLineParser.GetArgument("-L",0));
+            int generation = experimentType == 41 ?
+                int(generationNum) : experimentRun.getPopulation()->getGenerationCount()-1;
+            recordEvaluation(telemetry, experimentRun, globals, experimentType, generation, individualId, seed, fitness);
+        }
         cout << "[HyperNEAT core] Individual evaluation fin." << endl;
 
     } else {
-        cout << "./atari_evaluate [-R (seed) -g (generationNum)] -I (datafile) -P (populationfile) -N (individualId) "
-            "-F (fitnessFile) -G (romFile)\n";
+        cout << "./atari_evaluate [-R (seed) -g (generationNum)] [-L (telemetryFile)] -I (datafile) -P (populationfile) "
+            "-N (individualId) -F (fitnessFile) -G (romFile)\n";
+        cout << "./atari_evaluate [-R (seed)] [-L (telemetryFile)] -I (datafile) -C (host:port) -G (romFile)\n";
         cout << "\t\t(datafile) HyperNEAT experiment data file - typically data/AtariExperiment.dat\n";
         cout << "\t\t(populationfile) current population file containing all the individuals - "
             "typically generationXX.xml.gz\n";
@@ -181,6 +351,25 @@ int HyperNEAT_main(int argc,char **argv) {
         cout << "\t\t(fitnessFile) fitness value once estimated written to file - "
             "typically fitness.XX.individualId\n";
         cout << "\t\t(romFile) the Atari rom file to evaluate the agent against.\n";
+        cout << "\t\t(host:port) an atari_generate -S coordinator to lease individuals from "
+            "until the run is over, instead of evaluating a single individual\n";
+        cout << "\t\tEvaluationEpisodes (default 1) in (datafile) plays that many episodes per individual, each with "
+            "its own seed, and uses their mean as the fitness. With RacingConfidence above 0 an individual stops once "
+            "the mean plus that many standard errors is below the top SurvivalThreshold of the last generation, "
+            "after at least RacingMinEpisodes (default 2) episodes. The fitness of a stopped individual is the mean of "
+            "the episodes it played, which is biased low\n";
+        cout << "\t\tEpisodeMaxFrames, EpisodeMaxSeconds, StallScoreFrames, StallRamFrames and GenerationMaxSeconds "
+            "in (datafile) stop episodes early, see HCUBE_AtariEpisodeBudget.h. The score reached so far is kept\n";
+        cout << "\t\tDeltaRefreshFrames (default 0) in (datafile) only propagates the inputs that changed since the "
+            "last frame through object substrates, recomputing the whole network every that many frames\n";
+        cout << "\t\tSubstrateCacheMB (default 0) in (datafile) keeps that many megabytes of populated substrates "
+            "keyed by a hash of the genome, so elites and re-evaluated individuals skip their CPPN queries. With "
+            "SubstrateCacheDisk set to 1 they are also written to substrateCache next to (populationfile) and "
+            "shared between processes; the directory can be deleted at any time\n";
+        cout << "\t\tSubstrateThreads (default 1, 0 for one per core) in (datafile) queries the CPPN for the rows "
+            "of the substrate on that many threads. The weights do not depend on the number of threads\n";
+        cout << "\t\t(telemetryFile) binary log to append the score, frames and stage times of every "
+            "evaluation to - read it with out/telemetry.py\n";
     }
 
     globals->deinit();
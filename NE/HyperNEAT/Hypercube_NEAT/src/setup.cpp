@@ -29,16 +29,27 @@ using namespace NEAT;
 int HyperNEAT_main(int argc,char **argv) {
     CommandLineParser commandLineParser(argc,argv);
 
-    // Quit if we don't have I/O/G
+    // Quit if we don't have I/O
     if (!commandLineParser.HasSwitch("-I") ||
-        !commandLineParser.HasSwitch("-O") ||
-        !commandLineParser.HasSwitch("-G")) {
-        cout << "./atari_generate [-R (seed)] -I (datafile) -O (outputfile) -G (ROMFile) [-P (populationfile) -F (fitnessprefix) [-E (evaluationFile)] ]\n";
+        !commandLineParser.HasSwitch("-O")) {
+        cout << "./atari_generate [-R (seed)] -I (datafile) -O (outputfile) [-G (ROMFile)] [-T (topologyfile)] [-P (populationfile) -F (fitnessprefix) [-E (evaluationFile)] ]\n";
+        cout << "./atari_generate [-R (seed)] -I (datafile) -O (resultsdir) [-G (ROMFile)] [-T (topologyfile)] -S (port) [-g (generations)] [-P (populationfile)]\n";
         cout << "\t(datafile) experiment data file - typically data/AtariExperiment.dat\n";
         cout << "\t(outputfile) the next generation file to be created - typically generationXX.xml\n";
         cout << "\t(populationfile) the current generation file (required when outputfile is > generation0) - typically generationXX(-1).xml.gz\n";
         cout << "\t(fitnessprefix) used to locate the fitness files for individuals in the current generation (required for generation > 0) - typically fitness.XX.\n";
         cout << "\t(evaluationfile) populationfile + fitness + speciation (output only - not required for next cycle) - typicall generationXX(-1).eval.xml\n";
+        cout << "\t(port) run as a coordinator: serve individuals to atari_evaluate -C workers on this TCP port (0 picks one) "
+            "and write each generation to (resultsdir). The address is written to (resultsdir)/coordinator\n";
+        cout << "\t(generations) coordinator only - the generation to stop at, defaults to MaxGenerations\n";
+        cout << "\tWith SteadyStateEvolution 1 in (datafile) the coordinator evaluates the first generation, then breeds "
+            "and replaces one individual at a time; every PopulationSize replacements are written as a generation\n";
+        cout << "\t(ROMFile) the game ROM. Only read when (topologyfile) does not hold the topology for this ROM and "
+            "experiment type yet, and then required\n";
+        cout << "\t(topologyfile) caches what the experiment needs from the ROM - defaults to topology.txt in the "
+            "directory of (outputfile), or in (resultsdir)\n";
+        cout << "\tGeneration files only store the changes since the previous one, with a full keyframe every "
+            "GenerationKeyframeInterval (default 10) files, so the files back to the last keyframe are kept\n";
         return 0;
     }
 
@@ -50,7 +61,19 @@ int HyperNEAT_main(int argc,char **argv) {
     string out_file = commandLineParser.GetArgument("-O",0);
     experimentRun.setupExperiment(experimentType, out_file);
 
-    string rom_file = commandLineParser.GetArgument("-G",0);
+    string rom_file = commandLineParser.GetSafeArgument("-G",0,"");
+
+    // The topology is cached next to the generation files so later generations don't load the ROM
+    string topologyFile;
+    if (commandLineParser.HasSwitch("-T")) {
+        topologyFile = commandLineParser.GetArgument("-T",0);
+    } else if (commandLineParser.HasSwitch("-S")) {
+        topologyFile = out_file + "/topology.txt";
+    } else {
+        size_t slash = out_file.find_last_of("/\\");
+        topologyFile = (slash == string::npos ? string("") : out_file.substr(0,slash+1)) + "topology.txt";
+    }
+    experimentRun.setTopologyFile(topologyFile);
 
     // Is this an experiment in progress? If so we should load the current experiment
     if (commandLineParser.HasSwitch("-P") &&
@@ -60,6 +83,12 @@ int HyperNEAT_main(int argc,char **argv) {
         string evaluationFile = commandLineParser.GetSafeArgument("-E",0,"");
         cout << "[HyperNEAT core] Population for existing generation created from: " << populationFile << endl;
         experimentRun.createPopulationFromCondorRun(populationFile, fitnessFunctionPrefix, evaluationFile, rom_file);
+    } else if (commandLineParser.HasSwitch("-S") &&
+               commandLineParser.HasSwitch("-P")) {
+        // Resume a coordinated run with the generation that was being evaluated
+        string populationFile = commandLineParser.GetArgument("-P",0);
+        cout << "[HyperNEAT core] Population for existing generation loaded from: " << populationFile << endl;
+        experimentRun.createPopulation(populationFile);
     } else {
         cout << "[HyperNEAT core] Population for first generation created" << endl;
         shared_ptr<Experiment> e = experimentRun.getExperiment();       
@@ -75,7 +104,6 @@ int HyperNEAT_main(int argc,char **argv) {
             int numOutputModules = int(globals->getParameterValue("OutputModules") + 0.001);
 	    exp->setOutputModules(numOutputModules);	
             cout << "[HyperNEAT core] Number of output modules is: " << numOutputModules << endl;
-            exp->initializeExperiment(rom_file.c_str());
 	} else if (experimentType == 35) { // Schrum: The AtariPixelExperiment with HyperNEAT
 	    // cout << "setup: MY CODE" << endl;
             shared_ptr<AtariPixelExperiment> exp = static_pointer_cast<AtariPixelExperiment>(e);
@@ -86,27 +114,13 @@ int HyperNEAT_main(int argc,char **argv) {
             int numProcessingLayers = int(globals->getParameterValue("ProcessingLayers") + 0.001);
 	    exp->setProcessingLayers(numProcessingLayers);	
             cout << "[HyperNEAT core] Number of processing layers is: " << numProcessingLayers << endl;
-            exp->initializeExperiment(rom_file.c_str());
-	} else if (experimentType == 30 || experimentType == 36) {
-            shared_ptr<AtariExperiment> exp = static_pointer_cast<AtariExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 31 || experimentType == 39 || experimentType == 40) {
-            shared_ptr<AtariNoGeomExperiment> exp = static_pointer_cast<AtariNoGeomExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 32 || experimentType == 37 || experimentType == 38) {
-            shared_ptr<AtariFTNeatExperiment> exp = static_pointer_cast<AtariFTNeatExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 33) {
-            // This is the Hybrid experiment but always starts as HyperNEAT
-            shared_ptr<AtariExperiment> exp = static_pointer_cast<AtariExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
-        } else if (experimentType == 34) {
-            shared_ptr<AtariIntrinsicExperiment> exp = static_pointer_cast<AtariIntrinsicExperiment>(e);
-            exp->initializeExperiment(rom_file.c_str());
         } else if (experimentType == 41) {
             shared_ptr<AtariCMAExperiment> exp = static_pointer_cast<AtariCMAExperiment>(e);
             exp->setResultsPath(out_file);
-            exp->initializeExperiment(rom_file.c_str());
+        }
+        if (experimentType >= 30 && experimentType <= 42) {
+            // The Hybrid experiment (33) always starts as HyperNEAT
+            experimentRun.initializeExperimentTopology(0, rom_file);
         }
         experimentRun.createPopulation();
     }
@@ -115,7 +129,17 @@ int HyperNEAT_main(int argc,char **argv) {
       globals->setParameterValue("RandomSeed",seed);
       globals->initRandom();
     }
-    experimentRun.startCondor();
+    if (commandLineParser.HasSwitch("-S")) {
+        int port = stringTo<int>(commandLineParser.GetArgument("-S",0));
+        int maxGenerations = int(globals->getParameterValue("MaxGenerations") + 0.001);
+        if (commandLineParser.HasSwitch("-g")) {
+            maxGenerations = stringTo<int>(commandLineParser.GetArgument("-g",0));
+        }
+        experimentRun.startCoordinator(port, out_file, maxGenerations, rom_file,
+                                       commandLineParser.GetSafeArgument("-P",0,""));
+    } else {
+        experimentRun.startCondor();
+    }
 
     NEAT::Globals::deinit();
 }
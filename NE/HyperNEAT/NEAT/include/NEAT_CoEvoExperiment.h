@@ -10,12 +10,43 @@ namespace NEAT
     class NEAT_DLL_EXPORT CoEvoExperiment
     {
     protected:
+        //Which position of the opening pool the next games start from
+        int opening;
 
     public:
+        CoEvoExperiment()
+            :
+            opening(0)
+        {}
+
         virtual pair<double,double> playGame(
             shared_ptr<GeneticIndividual> ind1,
             shared_ptr<GeneticIndividual> ind2) = 0;
 
+        /**
+         * Creates another instance with its own substrates, so games can be
+         * played on several threads at once.
+         */
+        virtual shared_ptr<CoEvoExperiment> cloneCoEvo() = 0;
+
+        /**
+         * The number of starting positions in the opening pool.  0 if every
+         * game starts from the same position.
+         */
+        virtual int getOpeningCount()
+        {
+            return 0;
+        }
+
+        /**
+         * Selects the starting position of the following games.  Indices
+         * past the end of the pool wrap around.
+         */
+        inline void setOpening(int _opening)
+        {
+            opening = _opening;
+        }
+
         virtual ~CoEvoExperiment() {}
     };
 }
@@ -2,6 +2,7 @@
 #define NEAT_COEVOGENETICGENERATION_H_INCLUDED
 
 #include "NEAT_GeneticGeneration.h"
+#include "NEAT_CoEvoTournament.h"
 
 #ifdef EPLEX_INTERNAL
 
@@ -22,6 +23,9 @@ namespace NEAT
 
         shared_ptr<CoEvoExperiment> experiment;
 
+        //Plays the games between tests, shared by all generations of a run
+        shared_ptr<CoEvoTournament> tournament;
+
     public:
 
         /** produceNextGeneration:
@@ -123,10 +127,22 @@ namespace NEAT
             const vector<shared_ptr<GeneticIndividual> > &newTests,
             const vector< vector<bool> > &newTestResults,
             const vector< vector<double> > &newTestFitnesses,
-            shared_ptr<CoEvoExperiment> _experiment
+            shared_ptr<CoEvoExperiment> _experiment,
+            shared_ptr<CoEvoTournament> _tournament
         );
 
         bool getTestResult(int t1,int t2);
+
+        /**
+         * Creates the tournament on first use.  The number of threads is the
+         * CoEvoThreads parameter, 1 if it is missing.
+         */
+        CoEvoTournament *getTournament();
+
+        /**
+         * Stores the outcome of a game between tests t1 and t2
+         */
+        void recordTestGame(int t1,int t2,pair<double,double> rewards);
     };
 }
 
@@ -0,0 +1,120 @@
+#ifndef NEAT_COEVOTOURNAMENT_H_INCLUDED
+#define NEAT_COEVOTOURNAMENT_H_INCLUDED
+
+#include "NEAT_CoEvoExperiment.h"
+
+#ifdef EPLEX_INTERNAL
+
+namespace NEAT
+{
+    /**
+     * A game between two players of a tournament and its outcome
+     */
+    class CoEvoGame
+    {
+    public:
+        int first;
+        int second;
+        pair<double,double> rewards;
+
+        CoEvoGame(int _first,int _second)
+            :
+            first(_first),
+            second(_second),
+            rewards(0.0,0.0)
+        {}
+
+        inline bool operator<(const CoEvoGame &other) const
+        {
+            return first<other.first;
+        }
+    };
+
+    /**
+     * CoEvoTournament plays a list of pairings on several threads.  Every
+     * thread has its own copy of the experiment and with it its own
+     * substrates.  The games are sorted by their first player and handed out
+     * one row at a time, so the first player of a row is only built once.
+     * A game starts from the opening of the pool that belongs to its second
+     * player, the same way an individual plays the tests in processGroup.
+     */
+    class CoEvoTournament
+    {
+    protected:
+        vector<shared_ptr<CoEvoExperiment> > experiments;
+
+        vector<CoEvoGame> games;
+
+        //The index of the first game of every row, and games.size() at the end
+        vector<int> rowStarts;
+
+        int nextRow;
+
+        mutex rowMutex;
+
+        const vector<shared_ptr<GeneticIndividual> > *players;
+
+        string error;
+
+    public:
+        /**
+         * Constructor: The first thread plays on experiment, the others on clones of it
+         */
+        NEAT_DLL_EXPORT CoEvoTournament(shared_ptr<CoEvoExperiment> experiment,int numThreads);
+
+        NEAT_DLL_EXPORT virtual ~CoEvoTournament();
+
+        NEAT_DLL_EXPORT void clearGames();
+
+        /**
+         * Schedules a game of players first and second.  first takes the
+         * first seat of playGame.
+         */
+        NEAT_DLL_EXPORT void addGame(int first,int second);
+
+        /**
+         * Schedules a game between every two of numPlayers players
+         */
+        NEAT_DLL_EXPORT void addRoundRobin(int numPlayers);
+
+        /**
+         * Plays all games that were scheduled.  The indices of the games are
+         * indices into _players.
+         */
+        NEAT_DLL_EXPORT void play(const vector<shared_ptr<GeneticIndividual> > &_players);
+
+        inline int getGameCount()
+        {
+            return (int)games.size();
+        }
+
+        /**
+         * The games in the order they were played, sorted by their first player
+         */
+        inline const CoEvoGame &getGame(int a)
+        {
+            return games[a];
+        }
+
+    protected:
+        void playRows(int threadIndex);
+
+        /**
+         * This class cannot be copied
+         */
+        CoEvoTournament(const CoEvoTournament &other)
+        {}
+
+        /**
+         * This class cannot be copied
+         */
+        const CoEvoTournament &operator=(const CoEvoTournament &other)
+        {
+            return *this;
+        }
+    };
+}
+
+#endif
+
+#endif // NEAT_COEVOTOURNAMENT_H_INCLUDED
@@ -101,6 +101,28 @@ namespace NEAT
          */
         NEAT_DLL_EXPORT void setValue(const string &nodeName,Type newValue);
 
+        /**
+         *  getNodeIndex: gets the index of a node for the
+         *  index versions of getValue and setValue
+         */
+        NEAT_DLL_EXPORT int getNodeIndex(const string &nodeName);
+
+        /**
+         *  getValue: gets the value for a node by its index
+         */
+        inline Type getValue(int nodeIndex)
+        {
+            return nodeValues[nodeIndex];
+        }
+
+        /**
+         *  setValue: sets the value for a node by its index
+         */
+        inline void setValue(int nodeIndex,Type newValue)
+        {
+            nodeValues[nodeIndex] = newValue;
+        }
+
         /**
          *  setValue: sets the value for a specified node
          */
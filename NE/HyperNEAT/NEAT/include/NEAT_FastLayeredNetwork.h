@@ -65,6 +65,25 @@ namespace NEAT
     protected:
         vector<NetworkLayer<Type> > layers;
 
+        //Node values of each layer for updateBatch(), see getBatchLayerValues()
+        vector<vector<Type> > batchValues;
+        vector<Type> batchSums;
+
+        //Scratch space for updateSparse()
+        vector<int> sparseFromNodes;
+        vector<Type> sparseSums;
+
+        //State of updateDelta(): the sums before activation of every layer,
+        //the input nodes and values of the last update and the nodes that
+        //changed in each layer during the current one
+        vector<vector<Type> > deltaSums;
+        vector<Node> deltaInputs;
+        vector<Type> deltaInputValues;
+        vector<vector<int> > deltaChangedNodes;
+        vector<vector<Type> > deltaChanges;
+        bool deltaValid;
+        int deltaUpdates;
+
     public:
         /**
          *  (Constructor) Create a Network with the inputed toplogy
@@ -110,6 +129,16 @@ namespace NEAT
          */
         NEAT_DLL_EXPORT void setValue(const Node &nodeIndex,Type newValue);
 
+        /**
+         *  getLayerValues: gets the node values of a layer, stored row-major
+         *  with the layer's node stride.  Callers may write input layers
+         *  through this pointer directly.
+         */
+        inline Type* getLayerValues(int z)
+        {
+            return &(layers[z].nodeValues[0]);
+        }
+
         /**
          *  getLink: gets the link weight between two specified nodes
          */
@@ -120,6 +149,51 @@ namespace NEAT
          */
         NEAT_DLL_EXPORT void setLink(const Node &fromNodeIndex,const Node &toNodeIndex,Type weight);
 
+        /**
+         *  swapLayers: Takes the layers of _layers, which gets the previous
+         *  layers of this network.  Avoids copying the weight matrices when
+         *  a network is built from its layers.
+         */
+        NEAT_DLL_EXPORT void swapLayers(vector<NetworkLayer<Type> > &_layers);
+
+        /**
+         *  getFromLayerIndex: the index in the from layers of layer z of the
+         *  first link from layer fromZ, or -1 if there is none
+         */
+        NEAT_DLL_EXPORT int getFromLayerIndex(int z,int fromZ);
+
+        inline int getLayerNodeCount(int z)
+        {
+            return (int)layers[z].nodeValues.size();
+        }
+
+        /**
+         *  getLayerWeights: gets the weights of layer z from its a-th from
+         *  layer.  The weight from node f to node t is at t*n+f, where n is
+         *  the number of nodes of layer z, as setLink() stores it.
+         */
+        inline Type* getLayerWeights(int z,int a)
+        {
+            return &(layers[z].fromWeights[a][0]);
+        }
+
+        inline int getLayerWeightCount(int z,int a)
+        {
+            return (int)layers[z].fromWeights[a].size();
+        }
+
+        /**
+         *  getWeights: copies the weight matrices of all layers to weights,
+         *  one after the other in layer order
+         */
+        NEAT_DLL_EXPORT void getWeights(vector<Type> &weights);
+
+        /**
+         *  setWeights: sets the weight matrices of all layers from weights,
+         *  as written by getWeights() for a network with the same layers
+         */
+        NEAT_DLL_EXPORT void setWeights(const vector<Type> &weights);
+
         /**
          * reinitialize: This resets the state of the network
          * to its initial state
@@ -137,7 +211,91 @@ namespace NEAT
          */
         NEAT_DLL_EXPORT virtual void update();
 
+        /**
+         *  updateSparse: Same as update() for input layers that are mostly
+         *  zero.  activeNodes lists every input node with a nonzero value,
+         *  each once; all other input nodes must be zero.  A layer that only
+         *  comes from input layers is computed by adding the weights of the
+         *  active nodes instead of multiplying the whole weight matrix.  The
+         *  results are identical to update().
+         */
+        NEAT_DLL_EXPORT void updateSparse(const vector<Node> &activeNodes);
+
+        /**
+         *  updateDelta: Same as updateSparse(), but starts from the sums of
+         *  the last updateDelta() instead of zero.  Only the inputs that
+         *  changed since then are pushed through their weight columns, and
+         *  only layers reached by a change are activated again, so the cost
+         *  follows how much the inputs changed.  The network must not be
+         *  reinitialized between calls; the caller zeroes the inputs it set
+         *  last time itself.  Every refreshInterval updates, and after
+         *  reinitialize(), update() or updateSparse(), all sums are
+         *  recomputed to bound the float drift of the running sums.
+         */
+        NEAT_DLL_EXPORT void updateDelta(const vector<Node> &activeNodes,int refreshInterval);
+
+        /**
+         *  getBatchLayerValues: gets the node values of layer z for a batch of
+         *  batchSize activations.  The values are node-major: the value of
+         *  node n for batch item b is at n*batchSize+b.  Input layers must be
+         *  filled in through this pointer before calling updateBatch().
+         */
+        NEAT_DLL_EXPORT Type* getBatchLayerValues(int z,int batchSize);
+
+        /**
+         *  updateBatch: Activates the network once for each of batchSize
+         *  inputs, giving the same results as batchSize calls to update().
+         *  Each weight is applied to the whole batch at once, so the inner
+         *  loops run over contiguous batch items and vectorize.
+         */
+        NEAT_DLL_EXPORT void updateBatch(int batchSize);
+
     protected:
+        /**
+         *  checkFeedForward: Throws if a layer comes from itself or a later layer
+         */
+        void checkFeedForward();
+
+        /**
+         *  updateLayer: Computes a layer from all the nodes of its from layers
+         */
+        void updateLayer(NetworkLayer<Type> &layer);
+
+        /**
+         *  sumLayer: Computes the sums before activation of a layer from all
+         *  the nodes of its from layers
+         */
+        void sumLayer(const NetworkLayer<Type> &layer,Type* sums);
+
+        /**
+         *  refreshDelta: Recomputes every layer and the sums of updateDelta()
+         */
+        void refreshDelta();
+
+        /**
+         *  addInputChange: Records a changed input node for updateDelta()
+         */
+        inline void addInputChange(const Node &node,Type change)
+        {
+            if(change!=0)
+            {
+                deltaChangedNodes[node.z].push_back(node.y*layers[node.z].nodeStride + node.x);
+                deltaChanges[node.z].push_back(change);
+            }
+        }
+
+        /**
+         *  activateLayer: Runs the activation function over a layer's sums
+         */
+        void activateLayer(NetworkLayer<Type> &layer);
+
+        /**
+         *  activate: The signed sigmoid activation function
+         */
+        static inline Type activate(Type sum)
+        {
+            return (2.0f / (1.0f + exp(-sum))) - 1.0f;
+        }
     };
 
 }
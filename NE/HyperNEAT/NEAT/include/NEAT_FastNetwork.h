@@ -34,6 +34,27 @@ namespace NEAT
          */
         int numConstantNodes;
 
+        /**
+         * The links from each constant node, as link indices into links, and the
+         * links from the updated nodes.  Built by the first updateSparse().
+         */
+        vector<int> constantLinkStart;
+        vector<int> constantLinks;
+        vector<int> updatedLinks;
+
+        /**
+         * The sums of the links from the active constant nodes for updateSparse()
+         */
+        vector<Type> constantSums;
+
+        /**
+         * The updated nodes in feed-forward order and the links into each of
+         * them from other updated nodes, built by compileLayered()
+         */
+        vector<int> layeredNodes;
+        vector<int> layeredLinkStart;
+        vector<int> layeredLinks;
+
     public:
         /**
          *  (Constructor) Create a Network with the inputed toplogy
@@ -93,6 +114,28 @@ namespace NEAT
          */
         NEAT_DLL_EXPORT void setValue(const string &nodeName,Type newValue);
 
+        /**
+         *  getNodeIndex: gets the index of a node for the
+         *  index versions of getValue and setValue
+         */
+        NEAT_DLL_EXPORT int getNodeIndex(const string &nodeName);
+
+        /**
+         *  getValue: gets the value for a node by its index
+         */
+        inline Type getValue(int nodeIndex)
+        {
+            return nodeValues[nodeIndex];
+        }
+
+        /**
+         *  setValue: sets the value for a node by its index
+         */
+        inline void setValue(int nodeIndex,Type newValue)
+        {
+            nodeValues[nodeIndex] = newValue;
+        }
+
         /**
          *  getLink: gets the link according to its index when created
          */
@@ -141,6 +184,37 @@ namespace NEAT
             updateFixedIterations(1);
         }
 
+        /**
+         * updateSparse: Same as updateFixedIterations() for inputs that are
+         * mostly zero.  activeNodes holds the index of every constant node with
+         * a nonzero value, each once; all other constant nodes must be zero.
+         * The links from the active nodes are summed once instead of relaxing
+         * every link from every input on each iteration.  The results match
+         * updateFixedIterations() up to the rounding of the sums.
+         */
+        NEAT_DLL_EXPORT void updateSparse(const vector<int> &activeNodes,int iterations);
+
+        /**
+         * compileLayered: Checks that the network is feed-forward with at most
+         * iterations levels of updated nodes.  updateFixedIterations(iterations)
+         * on a network that was just reinitialized then leaves every node at its
+         * feed-forward value, which updateLayered() computes in a single pass.
+         * Returns false if the network has recurrent links or more levels; those
+         * have to keep using updateFixedIterations() or updateSparse().
+         */
+        NEAT_DLL_EXPORT bool compileLayered(int iterations);
+
+        /**
+         * updateLayered: Computes every updated node once, in feed-forward
+         * order, after compileLayered() returned true.  activeNodes lists the
+         * nonzero constant nodes as in updateSparse().  The node values of the
+         * last update do not matter, so the network does not need to be
+         * reinitialized in between, only the constant nodes have to be reset.
+         * The results match the relaxation up to the rounding of the sums,
+         * which the signed sigmoid table can move to a neighbouring entry.
+         */
+        NEAT_DLL_EXPORT void updateLayered(const vector<int> &activeNodes);
+
         NEAT_DLL_EXPORT void print();
 
         NEAT_DLL_EXPORT void clearAllLinkWeights();
@@ -150,6 +224,19 @@ namespace NEAT
     protected:
         void copyFrom(const FastNetwork &other);
 
+        void buildSparseLinks();
+
+        /**
+         * Sums the links from the active constant nodes into constantSums
+         */
+        void sumConstantLinks(const vector<int> &activeNodes);
+
+        /**
+         * Runs the activation functions on nodeNewValues and copies them over
+         * the values of the updated nodes
+         */
+        void activateNewValues();
+
         Type runActivationFunction(Type value,ActivationFunction function,bool signedActivation,bool usingTanhSigmoid);
 
         Type activationFunctionDerivative(Type value,ActivationFunction function);
@@ -100,7 +100,7 @@ namespace NEAT
             age++;
         }
 
-        inline const int &getAge()
+        inline const int &getAge() const
         {
             return age;
         }
@@ -32,6 +32,82 @@ namespace NEAT
             ar & cachedAverageFitness;
         }
 
+    public:
+        /**
+         * saveDelta: Serializes this generation with every individual stored as the
+         * difference to the most similar individual of base.  base may be NULL.
+         */
+        template<class Archive>
+            void saveDelta(Archive & ar, const GeneticGeneration *base) const
+        {
+            ar & generationNumber;
+            ar & sortedByFitness;
+            ar & userData;
+            ar & isCached;
+            ar & cachedAverageFitness;
+
+            vector<int> baseIndices;
+            getDeltaBases(base,baseIndices);
+
+            int numIndividuals = (int)individuals.size();
+            ar & numIndividuals;
+
+            GeneticIndividual emptyIndividual;
+            for (int a=0;a<numIndividuals;a++)
+            {
+                ar & baseIndices[a];
+
+                if (baseIndices[a]==-1)
+                    individuals[a]->saveDelta(ar,emptyIndividual);
+                else
+                    individuals[a]->saveDelta(ar,*(base->individuals[baseIndices[a]]));
+            }
+        }
+
+        /**
+         * loadDelta: Reads a generation written by saveDelta.  base must hold the
+         * individuals base held when the generation was saved.
+         */
+        template<class Archive>
+            void loadDelta(Archive & ar, const GeneticGeneration *base)
+        {
+            ar & generationNumber;
+            ar & sortedByFitness;
+            ar & userData;
+            ar & isCached;
+            ar & cachedAverageFitness;
+
+            int numIndividuals;
+            ar & numIndividuals;
+
+            individuals.clear();
+
+            GeneticIndividual emptyIndividual;
+            for (int a=0;a<numIndividuals;a++)
+            {
+                int baseIndex;
+                ar & baseIndex;
+
+                shared_ptr<GeneticIndividual> individual(new GeneticIndividual());
+
+                if (baseIndex==-1)
+                {
+                    individual->loadDelta(ar,emptyIndividual);
+                }
+                else
+                {
+                    if (!base || baseIndex<0 || baseIndex>=(int)base->individuals.size())
+                    {
+                        throw CREATE_LOCATEDEXCEPTION_INFO("Generation delta refers to a missing base individual");
+                    }
+
+                    individual->loadDelta(ar,*(base->individuals[baseIndex]));
+                }
+
+                individuals.push_back(individual);
+            }
+        }
+
     protected:
         vector<shared_ptr<GeneticIndividual> > individuals;
 
@@ -69,6 +145,12 @@ namespace NEAT
 
         NEAT_DLL_EXPORT virtual ~GeneticGeneration();
 
+        /**
+         * deepCopy: Copies the generation along with its individuals, so later changes
+         * to the individuals do not show up in the copy
+         */
+        NEAT_DLL_EXPORT shared_ptr<GeneticGeneration> deepCopy() const;
+
         /**
          * Constructor: Creates a generation from it's serialized XML format
          * \param generationElement Is the root of the XML format
@@ -142,6 +224,14 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void sortByFitness();
 
+        /**
+         * insertIndividual: Adds an individual to a generation that is sorted by fitness,
+         * keeping it sorted
+         */
+        NEAT_DLL_EXPORT void insertIndividual(shared_ptr<GeneticIndividual> individual);
+
+        NEAT_DLL_EXPORT void removeIndividual(shared_ptr<GeneticIndividual> individual);
+
         NEAT_DLL_EXPORT void printGenerationalStatistics();
         
         NEAT_DLL_EXPORT virtual shared_ptr<GeneticIndividual> getGenerationChampion();
@@ -170,6 +260,12 @@ namespace NEAT
             int _generationNumber);
 
         void setAttributes(TiXmlElement *generationElement);
+
+        /**
+         * getDeltaBases: For every individual, finds the individual of base that shares the most
+         * link genes with it, or -1 if there is none
+         */
+        void getDeltaBases(const GeneticGeneration *base,vector<int> &baseIndices) const;
     };
 
 }
@@ -19,6 +19,55 @@
 namespace NEAT
 {
 
+    /**
+     * The genes of an individual, stored as the difference to another individual.
+     * nodeRuns and linkRuns are (kind,baseIndex,count) triples that build the genes
+     * in order: copies of consecutive base genes (with their age shifted by ageDelta),
+     * copies that take their weight from newWeights, or genes taken from newNodes
+     * and newLinks.
+     */
+    class GeneticIndividualDelta
+    {
+    public:
+        /**
+         * serialize: The genes are copies that only live as long as the delta, so they
+         * are written without object tracking
+         */
+        template<class Archive>
+            void serialize(Archive & ar)
+        {
+            ar & ageDelta;
+            ar & nodeRuns;
+            ar & linkRuns;
+            ar & newWeights;
+
+            int numNewNodes = (int)newNodes.size();
+            ar & numNewNodes;
+            newNodes.resize(numNewNodes);
+            for (int a=0;a<numNewNodes;a++)
+            {
+                newNodes[a].serializeFields(ar);
+            }
+
+            int numNewLinks = (int)newLinks.size();
+            ar & numNewLinks;
+            newLinks.resize(numNewLinks);
+            for (int a=0;a<numNewLinks;a++)
+            {
+                newLinks[a].serializeFields(ar);
+            }
+        }
+
+        int ageDelta;
+
+        vector<int> nodeRuns;
+        vector<GeneticNodeGene> newNodes;
+
+        vector<int> linkRuns;
+        vector<double> newWeights;
+        vector<GeneticLinkGene> newLinks;
+    };
+
     class GeneticIndividual
     {
         friend class boost::serialization::access;
@@ -33,6 +82,38 @@ namespace NEAT
             ar & userData;
         }
 
+    public:
+        /**
+         * saveDelta: Serializes this individual as the difference to base, which
+         * must be available again when the individual is loaded with loadDelta.
+         * An empty base gives a full copy of the genes.
+         */
+        template<class Archive>
+            void saveDelta(Archive & ar, const GeneticIndividual &base) const
+        {
+            GeneticIndividualDelta delta;
+            makeDelta(base,delta);
+
+            delta.serialize(ar);
+            ar & fitness;
+            ar & speciesID;
+            ar & canReproduce;
+            ar & userData;
+        }
+
+        template<class Archive>
+            void loadDelta(Archive & ar, const GeneticIndividual &base)
+        {
+            GeneticIndividualDelta delta;
+
+            delta.serialize(ar);
+            applyDelta(base,delta);
+            ar & fitness;
+            ar & speciesID;
+            ar & canReproduce;
+            ar & userData;
+        }
+
     protected:
         vector<GeneticNodeGene> nodes;
         vector<GeneticLinkGene> links;
@@ -222,7 +303,15 @@ namespace NEAT
         NEAT_DLL_EXPORT void addLink(GeneticLinkGene link);
 
         NEAT_DLL_EXPORT bool isValid();
+
+        /**
+         * getSortedLinkIDs: returns the IDs of this individual's links in ascending order
+         */
+        NEAT_DLL_EXPORT void getSortedLinkIDs(vector<int> &linkIDs) const;
 	protected:
+        void makeDelta(const GeneticIndividual &base,GeneticIndividualDelta &delta) const;
+
+        void applyDelta(const GeneticIndividual &base,const GeneticIndividualDelta &delta);
     };
 }
 
@@ -26,6 +26,23 @@ namespace NEAT
             ar & fixed;
         }
 
+    public:
+        /**
+         * serializeFields: Serializes the same fields as serialize(), but without boost's
+         * object tracking, for copies of genes that are not around for the lifetime of the archive
+         */
+        template<class Archive>
+            void serializeFields(Archive & ar)
+        {
+            ar & ID;
+            ar & enabled;
+            ar & age;
+            ar & fromNodeID;
+            ar & toNodeID;
+            ar & weight;
+            ar & fixed;
+        }
+
     protected:
         int fromNodeID,toNodeID;
 
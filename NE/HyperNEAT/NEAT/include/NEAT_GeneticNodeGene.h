@@ -27,6 +27,23 @@ namespace NEAT
             ar & activationFunction;
         }
 
+    public:
+        /**
+         * serializeFields: Serializes the same fields as serialize(), but without boost's
+         * object tracking, for copies of genes that are not around for the lifetime of the archive
+         */
+        template<class Archive>
+            void serializeFields(Archive & ar)
+        {
+            ar & ID;
+            ar & enabled;
+            ar & age;
+            ar & name;
+            ar & type;
+            ar & topologyFrozen;
+            ar & activationFunction;
+        }
+
     protected:
         string name,type;
 
@@ -100,7 +117,7 @@ namespace NEAT
             activationFunction = _activationFunction;
         }
 
-        inline bool isTopologyFrozen()
+        inline bool isTopologyFrozen() const
         {
             return topologyFrozen;
         }
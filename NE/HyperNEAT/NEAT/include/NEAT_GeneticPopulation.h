@@ -41,6 +41,47 @@ namespace NEAT
         }
         BOOST_SERIALIZATION_SPLIT_MEMBER()
 
+    public:
+        /**
+         * saveDelta: Serializes the generations as differences to base, where generation
+         * a is stored against base[a] (or the last generation of base, which holds the
+         * parents of a new generation).  An empty base stores every gene.  Globals are not
+         * written, and loading does not speciate or adjust the fitness.
+         */
+        template<class Archive>
+            void saveDelta(Archive & ar, const vector<shared_ptr<GeneticGeneration> > &base) const
+        {
+            ar & onGeneration;
+
+            int numGenerations = (int)generations.size();
+            ar & numGenerations;
+
+            for (int a=0;a<numGenerations;a++)
+            {
+                generations[a]->saveDelta(ar,getDeltaBase(base,a));
+            }
+        }
+
+        template<class Archive>
+            void loadDelta(Archive & ar, const vector<shared_ptr<GeneticGeneration> > &base)
+        {
+            ar & onGeneration;
+
+            int numGenerations;
+            ar & numGenerations;
+
+            generations.clear();
+
+            for (int a=0;a<numGenerations;a++)
+            {
+                shared_ptr<GeneticGeneration> generation(new GeneticGeneration());
+                generation->loadDelta(ar,getDeltaBase(base,a));
+                generations.push_back(generation);
+            }
+        }
+
+    protected:
+
         vector<shared_ptr<GeneticGeneration> > generations;
 
         vector<shared_ptr<GeneticSpecies> > species;
@@ -101,6 +142,28 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void produceNextGeneration();
 
+        /**
+         * produceSteadyStateOffspring: Breeds a single offspring for steady-state evolution.
+         * The parent species is chosen with probability proportional to its adjusted fitness.
+         * The offspring is not part of the population until addSteadyStateIndividual is called
+         * with its fitness set.
+         */
+        NEAT_DLL_EXPORT shared_ptr<GeneticIndividual> produceSteadyStateOffspring();
+
+        /**
+         * addSteadyStateIndividual: Speciates an evaluated offspring, adds it to the current
+         * generation and removes the member with the lowest adjusted fitness, so the size
+         * of the population does not change.  The generation champion is never removed.
+         */
+        NEAT_DLL_EXPORT void addSteadyStateIndividual(shared_ptr<GeneticIndividual> individual);
+
+        /**
+         * advanceSteadyStateGeneration: Called after a population's worth of offspring has been
+         * added.  Ages the species, adjusts the compatibility threshold and starts a new
+         * generation with the current members, so generation numbers keep their meaning.
+         */
+        NEAT_DLL_EXPORT void advanceSteadyStateGeneration();
+
         NEAT_DLL_EXPORT void dump(string filename,bool includeGenes,bool doGZ);
 
         NEAT_DLL_EXPORT void dumpBest(string filename,bool includeGenes,bool doGZ);
@@ -113,6 +176,37 @@ namespace NEAT
         {
             return (int)generations.size();
         }
+
+        inline const vector<shared_ptr<GeneticGeneration> > &getGenerations() const
+        {
+            return generations;
+        }
+
+        /**
+         * copyGenerations: Returns a deep copy of the generations, to use as the base of a later saveDelta
+         */
+        NEAT_DLL_EXPORT vector<shared_ptr<GeneticGeneration> > copyGenerations() const;
+
+    protected:
+        //Puts the individual in the first compatible species, or in a new species if there is none
+        shared_ptr<GeneticSpecies> assignSpecies(shared_ptr<GeneticIndividual> individual,double compatThreshold);
+
+        //Moves the compatibility threshold towards the one that gives SpeciesSizeTarget species
+        void adjustCompatibilityThreshold();
+
+        //Lowers MinPossibleFitness to the lowest adjusted species fitness and returns it
+        double updateMinPossibleFitness();
+
+        static inline const GeneticGeneration *getDeltaBase(
+            const vector<shared_ptr<GeneticGeneration> > &base,
+            int generationIndex
+        )
+        {
+            if (base.empty())
+                return NULL;
+
+            return base[min(generationIndex,(int)base.size()-1)].get();
+        }
     };
 
 }
@@ -80,6 +80,14 @@ namespace NEAT
             currentIndividuals.push_back(ind);
         }
 
+        /**
+         * insertIndividual: Adds an individual behind every member that is at least as fit,
+         * so the species stays sorted by fitness.
+         */
+        NEAT_DLL_EXPORT void insertIndividual(shared_ptr<GeneticIndividual> ind);
+
+        NEAT_DLL_EXPORT void removeIndividual(shared_ptr<GeneticIndividual> ind);
+
         inline void setOffspringCount(int _offspringCount)
         {
             offspringCount = _offspringCount;
@@ -128,6 +136,12 @@ namespace NEAT
 
         NEAT_DLL_EXPORT void makeBabies(vector<shared_ptr<GeneticIndividual> > &babies, double minGenerationalFitness);
 
+        /**
+         * makeBaby: Creates one offspring from the members above the survival threshold.
+         * The members must be sorted by fitness.
+         */
+        NEAT_DLL_EXPORT shared_ptr<GeneticIndividual> makeBaby(double minGenerationalFitness);
+
         NEAT_DLL_EXPORT void dump(TiXmlElement *speciesElement);
     };
 
@@ -4,6 +4,7 @@
 #include "NEAT_FastNetwork.h"
 #include "NEAT_FastLayeredNetwork.h"
 #include "NEAT_FastBiasNetwork.h"
+#include "NEAT_LayeredSubstrateCache.h"
 #ifdef USE_GPU
 #include "NEAT_GPUANN.h"
 #endif
@@ -36,6 +37,12 @@ namespace NEAT
             }
     };
 
+    template<class NetworkDataType>
+    class LayerPairWeights;
+
+    template<class NetworkDataType>
+    class LayeredSubstrateQueries;
+
 	template< class NetworkDataType >
 	class LayeredSubstrate
 	{
@@ -69,15 +76,41 @@ namespace NEAT
 		//Location of the layer is only used for drawing purposes
 		vector< JGTL::Vector3<float> > layerLocations;
 
+        //Hash of everything in the layer info that changes the link weights
+        ulong layerInfoHash;
+
+        vector<NetworkDataType> cachedWeights;
+
+        static shared_ptr<LayeredSubstrateCache<NetworkDataType> > cache;
+
 	public:
 		NEAT_DLL_EXPORT LayeredSubstrate();
 
 		NEAT_DLL_EXPORT void setLayerInfo(LayeredSubstrateInfo layerInfo);
 
+		/**
+		 * populateSubstrate: Sets the link weights by querying the CPPN of
+		 * individual for every connection.  If a cache is set and holds the
+		 * weights of the same genome and layer info, they are loaded instead.
+		 */
 		NEAT_DLL_EXPORT void populateSubstrate(
 			shared_ptr<NEAT::GeneticIndividual> individual
 			);
 
+		/**
+		 * setCache: Sets the cache all substrates look up and store their
+		 * weights in.  A null cache disables caching.
+		 */
+		static inline void setCache(shared_ptr<LayeredSubstrateCache<NetworkDataType> > _cache)
+		{
+			cache = _cache;
+		}
+
+		static inline shared_ptr<LayeredSubstrateCache<NetworkDataType> > getCache()
+		{
+			return cache;
+		}
+
 		inline NetworkDataType convertOutputToWeight(
 			NetworkDataType output
 			)
@@ -105,6 +138,17 @@ namespace NEAT
 
 		NEAT_DLL_EXPORT void setValue(const Node &node,NetworkDataType _value);
 
+		// Returns the node values of layer z, row-major.  Only meaningful for
+		// layers whose valid size is their full size.
+		inline NetworkDataType* getLayerValues(int z)
+		{
+#ifdef USE_GPU
+			return gpuNetwork.getLayerValues(z);
+#else
+			return network.getLayerValues(z);
+#endif
+		}
+
 		inline int getNumLayers()
 		{
 			return (int)layerSizes.size();
@@ -160,6 +204,23 @@ namespace NEAT
         }
 		
 	protected:
+		void createLayers(vector<NetworkLayer<NetworkDataType> > &layers);
+
+		/**
+		 * queryRows: Queries the CPPN for the rows of queries until none
+		 * are left.  Runs on every thread of populateSubstrate.
+		 */
+		void queryRows(LayeredSubstrateQueries<NetworkDataType> *queries);
+
+		/**
+		 * queryRow: Queries cppn for every link of a layer pair that ends in
+		 * one valid row of the to-layer
+		 */
+		void queryRow(
+			NEAT::FastNetwork<NetworkDataType> &cppn,
+			LayerPairWeights<NetworkDataType> &pairWeights,
+			int validRow
+			);
 	};
 }
 
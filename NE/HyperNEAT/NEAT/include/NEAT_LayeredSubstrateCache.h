@@ -0,0 +1,167 @@
+#ifndef __NEAT_LAYERED_SUBSTRATE_CACHE_H__
+#define __NEAT_LAYERED_SUBSTRATE_CACHE_H__
+
+#include "NEAT_Defines.h"
+
+#define LAYERED_SUBSTRATE_CACHE_MAGIC (0x43534C4E)
+
+#define LAYERED_SUBSTRATE_CACHE_VERSION (1)
+
+namespace NEAT
+{
+    class GeneticIndividual;
+
+    /**
+     * LayeredSubstrateCache keeps the link weights of populated substrates so
+     * that a genome that was already populated (an elite copied into the
+     * next generation, a re-evaluation with another seed) skips querying its
+     * CPPN.  Entries are keyed by a hash of the genome and of the substrate's
+     * layer info, see getKey().
+     *
+     * The memory tier holds up to maxBytes of weights and drops the least
+     * recently used entries beyond that.  If a directory is set, every entry
+     * is also written there as one file, substrate_<key>.bin, so other
+     * processes sharing the directory find it too.  A file holds four uint32s,
+     * LAYERED_SUBSTRATE_CACHE_MAGIC, LAYERED_SUBSTRATE_CACHE_VERSION, the size
+     * of a weight in bytes and the number of weights, the uint64 key and then
+     * the weights.  Files are written under a temporary name and renamed, so
+     * readers never see a partial one.
+     */
+    template<class Type>
+    class LayeredSubstrateCache
+    {
+    protected:
+        class Entry
+        {
+        public:
+            vector<Type> weights;
+            //Position of the key in recentKeys
+            typename list<ulong>::iterator recentPosition;
+        };
+
+        map<ulong,Entry> entries;
+
+        //Keys of the entries, the most recently used first
+        list<ulong> recentKeys;
+
+        size_t maxBytes;
+        size_t usedBytes;
+
+        string directory;
+
+        int memoryHits,diskHits,misses;
+
+    public:
+        /**
+         * Constructor: keeps up to _maxBytes of weights in memory.  An empty
+         * _directory disables the disk tier.
+         */
+        NEAT_DLL_EXPORT LayeredSubstrateCache(size_t _maxBytes,const string &_directory="");
+
+        NEAT_DLL_EXPORT virtual ~LayeredSubstrateCache();
+
+        /**
+         * setMaxBytes: changes the memory budget, dropping entries if needed
+         */
+        NEAT_DLL_EXPORT void setMaxBytes(size_t _maxBytes);
+
+        /**
+         * setDirectory: changes the directory of the disk tier, creating it
+         * if it does not exist.  An empty directory disables the disk tier.
+         */
+        NEAT_DLL_EXPORT void setDirectory(const string &_directory);
+
+        /**
+         * load: copies the weights stored under key to weights.  Looks in
+         * memory first, then on disk.  Returns false if key is not cached.
+         */
+        NEAT_DLL_EXPORT bool load(ulong key,vector<Type> &weights);
+
+        /**
+         * store: caches weights under key, in memory and on disk
+         */
+        NEAT_DLL_EXPORT void store(ulong key,const vector<Type> &weights);
+
+        /**
+         * getKey: the key of the substrate individual populates, given the
+         * hash of the layer info it is populated with.  Covers the nodes and
+         * links of the genome and the globals that change the output of its
+         * CPPN.
+         */
+        NEAT_DLL_EXPORT static ulong getKey(const GeneticIndividual &individual,ulong layerInfoHash);
+
+        /**
+         * hashBytes: continues the 64-bit FNV-1a hash of a byte sequence.
+         * Start with getEmptyHash().
+         */
+        static inline ulong hashBytes(ulong hash,const void *data,size_t size)
+        {
+            const unsigned char *bytes = (const unsigned char*)data;
+            for(size_t a=0;a<size;a++)
+            {
+                hash ^= ulong(bytes[a]);
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        template<class ValueType>
+        static inline ulong hashValue(ulong hash,const ValueType &value)
+        {
+            return hashBytes(hash,&value,sizeof(ValueType));
+        }
+
+        static inline ulong hashString(ulong hash,const string &value)
+        {
+            hash = hashValue(hash,int(value.size()));
+            return hashBytes(hash,value.data(),value.size());
+        }
+
+        static inline ulong getEmptyHash()
+        {
+            return 14695981039346656037ULL;
+        }
+
+        inline int getMemoryHits() const
+        {
+            return memoryHits;
+        }
+
+        inline int getDiskHits() const
+        {
+            return diskHits;
+        }
+
+        inline int getMisses() const
+        {
+            return misses;
+        }
+
+    protected:
+        void storeInMemory(ulong key,const vector<Type> &weights);
+
+        void dropLeastRecent();
+
+        bool loadFromDisk(ulong key,vector<Type> &weights);
+
+        void storeOnDisk(ulong key,const vector<Type> &weights);
+
+        string getFileName(ulong key);
+
+        /**
+         * This class cannot be copied
+         */
+        LayeredSubstrateCache(const LayeredSubstrateCache &other)
+        {}
+
+        /**
+         * This class cannot be copied
+         */
+        const LayeredSubstrateCache &operator=(const LayeredSubstrateCache &other)
+        {
+            return *this;
+        }
+    };
+}
+
+#endif
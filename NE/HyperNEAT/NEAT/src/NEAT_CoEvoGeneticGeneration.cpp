@@ -29,14 +29,16 @@ namespace NEAT
         const vector<shared_ptr<GeneticIndividual> > &newTests,
         const vector< vector<bool> > &newTestResults,
         const vector< vector<double> > &newTestFitnesses,
-        shared_ptr<CoEvoExperiment> _experiment
+        shared_ptr<CoEvoExperiment> _experiment,
+        shared_ptr<CoEvoTournament> _tournament
         )
         :
     GeneticGeneration(previousGeneration,newIndividuals,_generationNumber),
         tests(newTests),
         testResults(newTestResults),
         testFitnesses(newTestFitnesses),
-        experiment(_experiment)
+        experiment(_experiment),
+        tournament(_tournament)
     {}
 
     shared_ptr<GeneticGeneration> CoEvoGeneticGeneration::produceNextGeneration(
@@ -52,7 +54,8 @@ namespace NEAT
             tests,
             testResults,
             testFitnesses,
-            experiment
+            experiment,
+            tournament
             )
             );
     }
@@ -81,7 +84,8 @@ namespace NEAT
         tests(other.tests),
         testResults(other.testResults),
         testFitnesses(other.testFitnesses),
-        experiment(other.experiment)
+        experiment(other.experiment),
+        tournament(other.tournament)
     {
     }
 
@@ -96,6 +100,8 @@ namespace NEAT
 
         experiment = other.experiment;
 
+        tournament = other.tournament;
+
         return *this;
     }
 
@@ -256,6 +262,48 @@ namespace NEAT
         tests.clear();
     }
 
+    CoEvoTournament *CoEvoGeneticGeneration::getTournament()
+    {
+        if (!tournament)
+        {
+            int numThreads=1;
+
+            if (Globals::getSingleton()->hasParameterValue("CoEvoThreads"))
+            {
+                numThreads = max(1,int(Globals::getSingleton()->getParameterValue("CoEvoThreads")+0.001));
+            }
+
+            tournament = shared_ptr<CoEvoTournament>(new CoEvoTournament(experiment,numThreads));
+        }
+
+        return tournament.get();
+    }
+
+    void CoEvoGeneticGeneration::recordTestGame(int t1,int t2,pair<double,double> rewards)
+    {
+        tests[t1]->reward(rewards.first);
+        tests[t2]->reward(rewards.second);
+
+        /*
+        NOTE:
+        I'm not really interested in tieing.  If two players tie, I don't really care what happens.
+        Basically, try to make games which do not have ties in fitness very often!
+        */
+        if (rewards.first > rewards.second)
+        {
+            testResults[t1][t2] = true;
+            testResults[t2][t1] = false;
+        }
+        else
+        {
+            testResults[t1][t2] = false;
+            testResults[t2][t1] = true;
+        }
+
+        testFitnesses[t1][t2] = rewards.first;
+        testFitnesses[t2][t1] = rewards.second;
+    }
+
     void CoEvoGeneticGeneration::bootstrap()
     {
         //Play all the tests against each other.
@@ -267,46 +315,23 @@ namespace NEAT
             testA->setFitness(0.0);
         }
 
-        for (int a=0;a<getTestCount();a++)
-        {
-            shared_ptr<GeneticIndividual> testA = getTest(a);
-
-            for (int b=(a+1);b<getTestCount();b++)
-            {
-                shared_ptr<GeneticIndividual> testB = getTest(b);
-
-                pair<double,double> rewards = experiment->playGame(
-                    testA,
-                    testB
-                    );
+        CoEvoTournament *testTournament = getTournament();
 
-                testA->reward(rewards.first);
-                testB->reward(rewards.second);
+        testTournament->clearGames();
+        testTournament->addRoundRobin(getTestCount());
+        testTournament->play(tests);
 
-                if (rewards.first > rewards.second)
-                {
-                    /*
-                    NOTE:
-                    I'm not really interested in tieing.  If two players tie, I don't really care what happens.
-                    Basically, try to make games which do not have ties in fitness very often!
-                    */
-
-                    testResults[a][b] = true;
-                    testResults[b][a] = false;
-                }
-                else
-                {
-                    testResults[a][b] = false;
-                    testResults[b][a] = true;
-                }
+        for (int a=0;a<testTournament->getGameCount();a++)
+        {
+            const CoEvoGame &game = testTournament->getGame(a);
 
-                testFitnesses[a][b] = rewards.first;
-                testFitnesses[b][a] = rewards.second;
-            }
+            recordTestGame(game.first,game.second,game.rewards);
+        }
 
+        for (int a=0;a<getTestCount();a++)
+        {
             cout << "Test fitness: " << getTest(a)->getFitness() << endl;
         }
-
     }
 
     void CoEvoGeneticGeneration::updateTests()
@@ -337,43 +362,21 @@ namespace NEAT
                 //Play games so that it's still true that all tests have played each other
                 //This is important because it's needed for the other tests' fitnesses to be accurate.
                 test->setFitness(0);
-                for (int a=0;a<getTestCount();a++)
-                {
 
-                    shared_ptr<GeneticIndividual> testA = getTest(a);
+                CoEvoTournament *testTournament = getTournament();
 
-                    if (test != getTest(a))
-                    {
-                        //cout << "*";
-                        pair<double,double> rewards =
-                            experiment->playGame(
-                            test,
-                            testA
-                            );
-
-                        test->reward(rewards.first);
-
-                        testA->reward(rewards.second);
-
-                        /*
-                        NOTE:
-                        I'm not really interested in tieing.  If two players tie, I don't really care what happens.
-                        Basically, try to make games which do not have ties in fitness very often!
-                        */
-                        if (rewards.first > rewards.second)
-                        {
-                            testResults[a][newTestIndex] = true;
-                            testResults[newTestIndex][a] = false;
-                        }
-                        else
-                        {
-                            testResults[a][newTestIndex] = false;
-                            testResults[newTestIndex][a] = true;
-                        }
+                testTournament->clearGames();
+                for (int b=0;b<newTestIndex;b++)
+                {
+                    testTournament->addGame(newTestIndex,b);
+                }
+                testTournament->play(tests);
 
-                        testFitnesses[a][newTestIndex] = rewards.first;
-                        testFitnesses[newTestIndex][a] = rewards.second;
-                    }
+                for (int b=0;b<testTournament->getGameCount();b++)
+                {
+                    const CoEvoGame &game = testTournament->getGame(b);
+
+                    recordTestGame(game.first,game.second,game.rewards);
                 }
 
                 //Only allow adding one individual every generation
@@ -0,0 +1,160 @@
+#include "NEAT_Defines.h"
+
+#include "NEAT_CoEvoTournament.h"
+
+#ifdef EPLEX_INTERNAL
+
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
+
+namespace NEAT
+{
+    CoEvoTournament::CoEvoTournament(shared_ptr<CoEvoExperiment> experiment,int numThreads)
+        :
+        nextRow(0),
+        players(NULL)
+    {
+        experiments.push_back(experiment);
+
+        for (int a=1;a<numThreads;a++)
+        {
+            experiments.push_back(experiment->cloneCoEvo());
+        }
+    }
+
+    CoEvoTournament::~CoEvoTournament()
+    {}
+
+    void CoEvoTournament::clearGames()
+    {
+        games.clear();
+        rowStarts.clear();
+    }
+
+    void CoEvoTournament::addGame(int first,int second)
+    {
+        games.push_back(CoEvoGame(first,second));
+    }
+
+    void CoEvoTournament::addRoundRobin(int numPlayers)
+    {
+        for (int a=0;a<numPlayers;a++)
+        {
+            for (int b=a+1;b<numPlayers;b++)
+            {
+                addGame(a,b);
+            }
+        }
+    }
+
+    void CoEvoTournament::play(const vector<shared_ptr<GeneticIndividual> > &_players)
+    {
+        players = &_players;
+
+        //The games of a row stay in the order they were added
+        stable_sort(games.begin(),games.end());
+
+        rowStarts.clear();
+        for (int a=0;a<(int)games.size();a++)
+        {
+            if (a==0 || games[a].first!=games[a-1].first)
+            {
+                rowStarts.push_back(a);
+            }
+        }
+        rowStarts.push_back((int)games.size());
+
+        nextRow=0;
+        error.clear();
+
+        int numThreads = min((int)experiments.size(),(int)rowStarts.size()-1);
+
+        if (numThreads<=1)
+        {
+            playRows(0);
+        }
+        else
+        {
+            boost::thread** threads = new boost::thread*[numThreads];
+
+            for (int i=0;i<numThreads;i++)
+            {
+                threads[i] =
+                    new boost::thread(
+                        boost::bind(
+                            &CoEvoTournament::playRows,
+                            this,
+                            i
+                            )
+                        );
+            }
+
+            for (int i=0;i<numThreads;i++)
+            {
+                threads[i]->join();
+                delete threads[i];
+            }
+
+            delete[] threads;
+        }
+
+        players = NULL;
+
+        if (error.length())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Error while playing a tournament: ")+error);
+        }
+    }
+
+    void CoEvoTournament::playRows(int threadIndex)
+    {
+        shared_ptr<CoEvoExperiment> experiment = experiments[threadIndex];
+
+        try
+        {
+            while (true)
+            {
+                int row;
+                {
+                    mutex::scoped_lock scoped_lock(rowMutex);
+
+                    if (nextRow+1>=(int)rowStarts.size() || error.length())
+                    {
+                        break;
+                    }
+
+                    row = nextRow++;
+                }
+
+                for (int a=rowStarts[row];a<rowStarts[row+1];a++)
+                {
+                    CoEvoGame &game = games[a];
+
+                    experiment->setOpening(game.second);
+
+                    game.rewards = experiment->playGame(
+                        (*players)[game.first],
+                        (*players)[game.second]
+                        );
+                }
+            }
+        }
+        catch (const std::exception &ex)
+        {
+            mutex::scoped_lock scoped_lock(rowMutex);
+            error = ex.what();
+        }
+        catch (const string &s)
+        {
+            mutex::scoped_lock scoped_lock(rowMutex);
+            error = s;
+        }
+        catch (const char *s)
+        {
+            mutex::scoped_lock scoped_lock(rowMutex);
+            error = s;
+        }
+    }
+}
+
+#endif
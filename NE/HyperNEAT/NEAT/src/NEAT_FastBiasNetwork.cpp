@@ -440,6 +440,19 @@ namespace NEAT
 		}
 	}
 
+	template<class Type>
+	int FastBiasNetwork<Type>::getNodeIndex(const string &nodeName)
+	{
+		map<string,int>::iterator nodeIterator = nodeNameToIndex.find(nodeName);
+		if (nodeIterator==nodeNameToIndex.end())
+		{
+			cout << "ERROR: Could not find node named " << nodeName << endl;
+			throw (string("ERROR: Could not find node named ") + string(nodeName) + string("\n"));
+		}
+
+		return nodeIterator->second;
+	}
+
 	template<class Type>
 	void FastBiasNetwork<Type>::setBias(const string &nodeName,Type newBias)
 	{
@@ -26,25 +26,18 @@ namespace NEAT
     FastLayeredNetwork<Type>::FastLayeredNetwork(const vector<NetworkLayer<Type> > &_layers)
         :
         Network<Type>(),
-        layers(_layers)
+        layers(_layers),
+        deltaValid(false),
+        deltaUpdates(0)
     {
-        //Perform a sanity check on the layers
-        for(size_t toLayer=0;toLayer<layers.size();toLayer++)
-        {
-            for(int a=0;a<(int)layers[toLayer].fromLayers.size();a++)
-            {
-                size_t fromLayer = layers[toLayer].fromLayers[a];
-
-                if(fromLayer>=toLayer)
-                {
-                    throw CREATE_LOCATEDEXCEPTION_INFO("Network is not feed-forward!");
-                }
-            }
-        }
+        checkFeedForward();
     }
 
     template<class Type>
     FastLayeredNetwork<Type>::FastLayeredNetwork()
+        :
+        deltaValid(false),
+        deltaUpdates(0)
     {
     }
 
@@ -177,9 +170,94 @@ namespace NEAT
         throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
     }
 
+    template<class Type>
+    void FastLayeredNetwork<Type>::checkFeedForward()
+    {
+        //Perform a sanity check on the layers
+        for(size_t toLayer=0;toLayer<layers.size();toLayer++)
+        {
+            for(int a=0;a<(int)layers[toLayer].fromLayers.size();a++)
+            {
+                size_t fromLayer = layers[toLayer].fromLayers[a];
+
+                if(fromLayer>=toLayer)
+                {
+                    throw CREATE_LOCATEDEXCEPTION_INFO("Network is not feed-forward!");
+                }
+            }
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::swapLayers(vector<NetworkLayer<Type> > &_layers)
+    {
+        layers.swap(_layers);
+        deltaValid=false;
+        checkFeedForward();
+    }
+
+    template<class Type>
+    int FastLayeredNetwork<Type>::getFromLayerIndex(int z,int fromZ)
+    {
+        if(z>=(int)layers.size())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
+        }
+
+        for(int a=0;a<(int)layers[z].fromLayers.size();a++)
+        {
+            if(layers[z].fromLayers[a]==fromZ)
+            {
+                return a;
+            }
+        }
+        return -1;
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::getWeights(vector<Type> &weights)
+    {
+        weights.clear();
+        for(size_t a=0;a<layers.size();a++)
+        {
+            for(size_t b=0;b<layers[a].fromWeights.size();b++)
+            {
+                weights.insert(weights.end(),layers[a].fromWeights[b].begin(),layers[a].fromWeights[b].end());
+            }
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::setWeights(const vector<Type> &weights)
+    {
+        deltaValid=false;
+
+        size_t offset=0;
+        for(size_t a=0;a<layers.size();a++)
+        {
+            for(size_t b=0;b<layers[a].fromWeights.size();b++)
+            {
+                vector<Type> &fromWeights = layers[a].fromWeights[b];
+                if(offset+fromWeights.size()>weights.size())
+                {
+                    throw CREATE_LOCATEDEXCEPTION_INFO("Too few weights for the network layers!");
+                }
+                std::copy(weights.begin()+offset,weights.begin()+offset+fromWeights.size(),fromWeights.begin());
+                offset += fromWeights.size();
+            }
+        }
+
+        if(offset!=weights.size())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Too many weights for the network layers!");
+        }
+    }
+
     template<class Type>
     void FastLayeredNetwork<Type>::reinitialize()
     {
+        deltaValid=false;
+
         for(size_t a=0;a<layers.size();a++)
         {
             layers[a].initialize();
@@ -189,51 +267,364 @@ namespace NEAT
     template<class Type>
     void FastLayeredNetwork<Type>::update()
     {
+        deltaValid=false;
+
         for(typename vector<NetworkLayer<Type> >::iterator layer = layers.begin();layer != layers.end();layer++)
         {
-            vector<Type> &toNodes = layer->nodeValues;
-            int numToNodes = (int)toNodes.size();
-            int toNode;
-
             //If you don't come from any layers, it's assumed that you are an input
             //layer and your node values are constant
             if(layer->fromLayers.size())
             {
-                for(toNode=0;toNode<numToNodes;toNode++)
+                updateLayer(*layer);
+            }
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::updateLayer(NetworkLayer<Type> &layer)
+    {
+        sumLayer(layer,&(layer.nodeValues[0]));
+        activateLayer(layer);
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::sumLayer(const NetworkLayer<Type> &layer,Type* sums)
+    {
+        int numToNodes = (int)layer.nodeValues.size();
+        int toNode;
+
+        for(toNode=0;toNode<numToNodes;toNode++)
+        {
+            sums[toNode]=0.0f;
+        }
+
+        for(size_t a=0;a<layer.fromLayers.size();a++)
+        {
+            const NetworkLayer<Type> &fromLayer = layers[layer.fromLayers[a]];
+
+            const vector<Type> &fromNodes = fromLayer.nodeValues;
+            const Type* fromNodesPtr = &(fromLayer.nodeValues[0]);
+            int numFromNodes = (int)fromNodes.size();
+
+            Type nodeValue;
+            int fromNode;
+            const Type* weightsPtr;
+            for(toNode=0;toNode<numToNodes;toNode++)
+            {
+                nodeValue=0;
+                weightsPtr = &(layer.fromWeights[a][toNode*numToNodes]);
+                for(fromNode=0;fromNode<numFromNodes;fromNode++)
                 {
-                    toNodes[toNode]=0.0f;
+                    nodeValue += fromNodesPtr[fromNode] * weightsPtr[fromNode];
                 }
 
-                for(size_t a=0;a<layer->fromLayers.size();a++)
+                sums[toNode] += nodeValue;
+            }
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::activateLayer(NetworkLayer<Type> &layer)
+    {
+        vector<Type> &toNodes = layer.nodeValues;
+        int numToNodes = (int)toNodes.size();
+
+        for(int toNode=0;toNode<numToNodes;toNode++)
+        {
+            toNodes[toNode] = activate(toNodes[toNode]);
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::updateSparse(const vector<Node> &activeNodes)
+    {
+        deltaValid=false;
+
+        for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
+        {
+            NetworkLayer<Type> &layer = layers[layerIndex];
+
+            if(!layer.fromLayers.size())
+            {
+                continue;
+            }
+
+            bool fromInputsOnly=true;
+            for(size_t a=0;a<layer.fromLayers.size();a++)
+            {
+                if(layers[layer.fromLayers[a]].fromLayers.size())
                 {
-                    const NetworkLayer<Type> &fromLayer = layers[layer->fromLayers[a]];
+                    fromInputsOnly=false;
+                }
+            }
 
-                    const vector<Type> &fromNodes = fromLayer.nodeValues;
-                    const Type* fromNodesPtr = &(fromLayer.nodeValues[0]);
-                    int numFromNodes = (int)fromNodes.size();
+            if(!fromInputsOnly)
+            {
+                updateLayer(layer);
+                continue;
+            }
+
+            vector<Type> &toNodes = layer.nodeValues;
+            int numToNodes = (int)toNodes.size();
+            memset(&toNodes[0],0,sizeof(Type)*numToNodes);
 
-                    Type nodeValue;
-                    int fromNode;
-                    Type* weightsPtr;
-                    for(toNode=0;toNode<numToNodes;toNode++)
+            if(sparseSums.size()<size_t(numToNodes))
+            {
+                sparseSums.resize(numToNodes);
+            }
+            Type* sums = &sparseSums[0];
+
+            for(size_t a=0;a<layer.fromLayers.size();a++)
+            {
+                const NetworkLayer<Type> &fromLayer = layers[layer.fromLayers[a]];
+
+                sparseFromNodes.clear();
+                for(size_t b=0;b<activeNodes.size();b++)
+                {
+                    if(activeNodes[b].z==layer.fromLayers[a])
+                    {
+                        sparseFromNodes.push_back(activeNodes[b].y*fromLayer.nodeStride + activeNodes[b].x);
+                    }
+                }
+
+                if(sparseFromNodes.empty())
+                {
+                    continue;
+                }
+
+                //Adding the active nodes in ascending order sums the same products
+                //in the same order as update(), the skipped ones are all zero
+                sort(sparseFromNodes.begin(),sparseFromNodes.end());
+
+                memset(sums,0,sizeof(Type)*numToNodes);
+                const Type* weightsPtr = &(layer.fromWeights[a][0]);
+                for(size_t b=0;b<sparseFromNodes.size();b++)
+                {
+                    int fromNode = sparseFromNodes[b];
+                    Type fromValue = fromLayer.nodeValues[fromNode];
+
+                    //The weights of a from node are a column with a stride of
+                    //one row per to node
+                    for(int toNode=0;toNode<numToNodes;toNode++)
+                    {
+                        sums[toNode] += fromValue * weightsPtr[toNode*numToNodes+fromNode];
+                    }
+                }
+
+                for(int toNode=0;toNode<numToNodes;toNode++)
+                {
+                    toNodes[toNode] += sums[toNode];
+                }
+            }
+
+            activateLayer(layer);
+        }
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::refreshDelta()
+    {
+        deltaSums.resize(layers.size());
+
+        for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
+        {
+            NetworkLayer<Type> &layer = layers[layerIndex];
+
+            if(!layer.fromLayers.size())
+            {
+                continue;
+            }
+
+            int numToNodes = (int)layer.nodeValues.size();
+            deltaSums[layerIndex].resize(numToNodes);
+            Type* sums = &(deltaSums[layerIndex][0]);
+
+            sumLayer(layer,sums);
+            for(int toNode=0;toNode<numToNodes;toNode++)
+            {
+                layer.nodeValues[toNode] = activate(sums[toNode]);
+            }
+        }
+
+        deltaValid=true;
+        deltaUpdates=0;
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::updateDelta(const vector<Node> &activeNodes,int refreshInterval)
+    {
+        if(!deltaValid || deltaUpdates>=refreshInterval)
+        {
+            refreshDelta();
+        }
+        else
+        {
+            deltaChangedNodes.resize(layers.size());
+            deltaChanges.resize(layers.size());
+            for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
+            {
+                deltaChangedNodes[layerIndex].clear();
+                deltaChanges[layerIndex].clear();
+            }
+
+            //The inputs of the last update that were cleared or changed,
+            //then the ones that were zero before
+            for(size_t a=0;a<deltaInputs.size();a++)
+            {
+                addInputChange(deltaInputs[a],getValue(deltaInputs[a])-deltaInputValues[a]);
+            }
+
+            for(size_t a=0;a<activeNodes.size();a++)
+            {
+                if(find(deltaInputs.begin(),deltaInputs.end(),activeNodes[a])==deltaInputs.end())
+                {
+                    addInputChange(activeNodes[a],getValue(activeNodes[a]));
+                }
+            }
+
+            for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
+            {
+                NetworkLayer<Type> &layer = layers[layerIndex];
+
+                if(!layer.fromLayers.size())
+                {
+                    continue;
+                }
+
+                int numToNodes = (int)layer.nodeValues.size();
+                Type* sums = &(deltaSums[layerIndex][0]);
+                bool changed=false;
+
+                for(size_t a=0;a<layer.fromLayers.size();a++)
+                {
+                    const vector<int> &fromNodes = deltaChangedNodes[layer.fromLayers[a]];
+                    const vector<Type> &fromChanges = deltaChanges[layer.fromLayers[a]];
+                    const Type* weightsPtr = &(layer.fromWeights[a][0]);
+
+                    for(size_t b=0;b<fromNodes.size();b++)
                     {
-                        nodeValue=0;
-                        weightsPtr = &(layer->fromWeights[a][toNode*layer->nodeValues.size()]);
-                        for(fromNode=0;fromNode<numFromNodes;fromNode++)
+                        int fromNode = fromNodes[b];
+                        Type change = fromChanges[b];
+                        for(int toNode=0;toNode<numToNodes;toNode++)
                         {
-                            nodeValue += fromNodesPtr[fromNode] * weightsPtr[fromNode];
+                            sums[toNode] += change * weightsPtr[toNode*numToNodes+fromNode];
                         }
+                        changed=true;
+                    }
+                }
+
+                if(!changed)
+                {
+                    continue;
+                }
 
-                        toNodes[toNode] += nodeValue;
+                vector<int> &toNodes = deltaChangedNodes[layerIndex];
+                vector<Type> &toChanges = deltaChanges[layerIndex];
+                for(int toNode=0;toNode<numToNodes;toNode++)
+                {
+                    Type newValue = activate(sums[toNode]);
+                    if(newValue!=layer.nodeValues[toNode])
+                    {
+                        toNodes.push_back(toNode);
+                        toChanges.push_back(newValue-layer.nodeValues[toNode]);
+                        layer.nodeValues[toNode] = newValue;
                     }
                 }
+            }
+
+            deltaUpdates++;
+        }
+
+        deltaInputs = activeNodes;
+        deltaInputValues.resize(activeNodes.size());
+        for(size_t a=0;a<activeNodes.size();a++)
+        {
+            deltaInputValues[a] = getValue(activeNodes[a]);
+        }
+    }
+
+    template<class Type>
+    Type* FastLayeredNetwork<Type>::getBatchLayerValues(int z,int batchSize)
+    {
+        if(batchValues.size()!=layers.size())
+        {
+            batchValues.resize(layers.size());
+        }
+
+        size_t size = layers[z].nodeValues.size()*batchSize;
+        if(batchValues[z].size()<size)
+        {
+            batchValues[z].resize(size);
+        }
+
+        return &(batchValues[z][0]);
+    }
+
+    template<class Type>
+    void FastLayeredNetwork<Type>::updateBatch(int batchSize)
+    {
+        for(size_t layerIndex=0;layerIndex<layers.size();layerIndex++)
+        {
+            NetworkLayer<Type> &layer = layers[layerIndex];
+
+            //Input layers were filled in by the caller
+            if(!layer.fromLayers.size())
+            {
+                continue;
+            }
+
+            int numToNodes = (int)layer.nodeValues.size();
+            Type* toNodesPtr = getBatchLayerValues((int)layerIndex,batchSize);
+
+            memset(toNodesPtr,0,sizeof(Type)*numToNodes*batchSize);
+
+            if(batchSums.size()<size_t(batchSize))
+            {
+                batchSums.resize(batchSize);
+            }
+            Type* sums = &batchSums[0];
+
+            for(size_t a=0;a<layer.fromLayers.size();a++)
+            {
+                int fromLayerIndex = layer.fromLayers[a];
+                int numFromNodes = (int)layers[fromLayerIndex].nodeValues.size();
+                const Type* fromNodesPtr = &(batchValues[fromLayerIndex][0]);
 
-                for(toNode=0;toNode<numToNodes;toNode++)
+                for(int toNode=0;toNode<numToNodes;toNode++)
                 {
-                    //Signed sigmoid activation function
-                    toNodes[toNode] = (2.0f / (1.0f + exp(-toNodes[toNode]))) - 1.0f;
+                    const Type* weightsPtr = &(layer.fromWeights[a][toNode*numToNodes]);
+
+                    //Every item is summed in the same order as in update(), so the
+                    //results are identical, but the inner loop runs across the batch
+                    for(int item=0;item<batchSize;item++)
+                    {
+                        sums[item]=0;
+                    }
+
+                    const Type* fromItems = fromNodesPtr;
+                    for(int fromNode=0;fromNode<numFromNodes;fromNode++)
+                    {
+                        Type weight = weightsPtr[fromNode];
+                        for(int item=0;item<batchSize;item++)
+                        {
+                            sums[item] += fromItems[item] * weight;
+                        }
+                        fromItems += batchSize;
+                    }
+
+                    Type* toItems = toNodesPtr + toNode*batchSize;
+                    for(int item=0;item<batchSize;item++)
+                    {
+                        toItems[item] += sums[item];
+                    }
                 }
             }
+
+            for(int node=0;node<numToNodes*batchSize;node++)
+            {
+                //Signed sigmoid activation function
+                toNodesPtr[node] = activate(toNodesPtr[node]);
+            }
         }
     }
 
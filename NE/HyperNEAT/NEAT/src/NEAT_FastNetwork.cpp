@@ -325,6 +325,13 @@ namespace NEAT
             nodeNameToIndex = other.nodeNameToIndex;
             numConstantNodes = other.numConstantNodes;
             nodeLinkMap = other.nodeLinkMap;
+            constantLinkStart = other.constantLinkStart;
+            constantLinks = other.constantLinks;
+            updatedLinks = other.updatedLinks;
+            constantSums = other.constantSums;
+            layeredNodes = other.layeredNodes;
+            layeredLinkStart = other.layeredLinkStart;
+            layeredLinks = other.layeredLinks;
 
             data = (char*)realloc(
                 data,
@@ -418,6 +425,18 @@ namespace NEAT
         }
     }
 
+    template<class Type>
+    int FastNetwork<Type>::getNodeIndex(const string &nodeName)
+    {
+        map<string,int>::iterator nodeIterator = nodeNameToIndex.find(nodeName);
+        if (nodeIterator==nodeNameToIndex.end())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO( (string("ERROR: Could not find node named ") + string(nodeName) + string("\n")) );
+        }
+
+        return nodeIterator->second;
+    }
+
     template<class Type>
     NetworkIndexedLink<Type> *FastNetwork<Type>::getLink(const string &fromNodeName,const string &toNodeName)
     {
@@ -532,49 +551,252 @@ namespace NEAT
             }
 #endif
 
-			bool signedActivation=false;
+            activateNewValues();
 
-			if (Globals::getSingleton()->hasSignedActivation())
-			{
-				signedActivation=true;
-			}
+            //cout << "Done updating values.\n";
+        }
+    }
 
-			bool usingTanhSigmoid = Globals::getSingleton()->isUsingTanhSigmoid();
+    template<class Type>
+    void FastNetwork<Type>::activateNewValues()
+    {
+        bool signedActivation=false;
 
-            for (int a=numConstantNodes;a<numNodes;a++)
+        if (Globals::getSingleton()->hasSignedActivation())
+        {
+            signedActivation=true;
+        }
+
+        bool usingTanhSigmoid = Globals::getSingleton()->isUsingTanhSigmoid();
+
+        for (int a=numConstantNodes;a<numNodes;a++)
+        {
+            nodeNewValues[a] = runActivationFunction(nodeNewValues[a],activationFunctions[a],signedActivation,usingTanhSigmoid);
+        }
+
+#if DEBUG_NETWORK_UPDATE
+        cout << "Before Copy: " << endl;
+        for (int a=0;a<numNodes;a++)
+        {
+            cout << a << ": " << nodeValues[a] << '/' << nodeNewValues[a] << ' ' << activationFunctions[a] << endl;
+        }
+
+        cout << "NumNodes: " << numNodes << ". NumConstantNodes: " << numConstantNodes << endl;
+        cout << "Copying " << (nodeValues+numConstantNodes) << " from " << (nodeNewValues+numConstantNodes)
+            << " Size: " << (sizeof(Type)*(numNodes-numConstantNodes)) << endl;
+#endif
+
+        memcpy(
+            nodeValues+numConstantNodes,
+            nodeNewValues+numConstantNodes,
+            sizeof(Type)*(numNodes-numConstantNodes)
+            );
+
+#if DEBUG_NETWORK_UPDATE
+        cout << "After Copy: " << endl;
+        for (int a=0;a<numNodes;a++)
+        {
+            cout << a << ": " << nodeValues[a] << '/' << nodeNewValues[a] << endl;
+        }
+
+        //system("PAUSE");
+#endif
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::buildSparseLinks()
+    {
+        constantLinkStart.assign(numConstantNodes+1,0);
+        constantLinks.clear();
+        updatedLinks.clear();
+
+        for (int a=0;a<numLinks;a++)
+        {
+            if (links[a].toNode<numConstantNodes)
             {
-                nodeNewValues[a] = runActivationFunction(nodeNewValues[a],activationFunctions[a],signedActivation,usingTanhSigmoid);
+                //Constant nodes are never updated
+                continue;
             }
 
-#if DEBUG_NETWORK_UPDATE
-            cout << "Before Copy: " << endl;
-            for (int a=0;a<numNodes;a++)
+            if (links[a].fromNode<numConstantNodes)
             {
-                cout << a << ": " << nodeValues[a] << '/' << nodeNewValues[a] << ' ' << activationFunctions[a] << endl;
+                constantLinkStart[links[a].fromNode+1]++;
             }
+            else
+            {
+                updatedLinks.push_back(a);
+            }
+        }
 
-            cout << "NumNodes: " << numNodes << ". NumConstantNodes: " << numConstantNodes << endl;
-            cout << "Copying " << (nodeValues+numConstantNodes) << " from " << (nodeNewValues+numConstantNodes)
-                << " Size: " << (sizeof(Type)*(numNodes-numConstantNodes)) << endl;
-#endif
+        for (int a=0;a<numConstantNodes;a++)
+        {
+            constantLinkStart[a+1] += constantLinkStart[a];
+        }
 
-            memcpy(
-                nodeValues+numConstantNodes,
-                nodeNewValues+numConstantNodes,
-                sizeof(Type)*(numNodes-numConstantNodes)
-                );
+        constantLinks.resize(constantLinkStart[numConstantNodes]);
+        vector<int> nextLink(constantLinkStart.begin(),constantLinkStart.end()-1);
+        for (int a=0;a<numLinks;a++)
+        {
+            if (links[a].toNode>=numConstantNodes && links[a].fromNode<numConstantNodes)
+            {
+                constantLinks[nextLink[links[a].fromNode]++] = a;
+            }
+        }
 
-#if DEBUG_NETWORK_UPDATE
-            cout << "After Copy: " << endl;
-            for (int a=0;a<numNodes;a++)
+        constantSums.resize(numNodes);
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::updateSparse(const vector<int> &activeNodes,int iterations)
+    {
+        if (int(constantLinkStart.size())!=numConstantNodes+1)
+        {
+            buildSparseLinks();
+        }
+
+        int count=iterations;
+        if (!this->activated)
+        {
+            count += Globals::getSingleton()->getExtraActivationUpdates();
+            this->activated=true;
+        }
+
+        //The constant nodes keep their values, so their links add the same sums
+        //on every iteration
+        sumConstantLinks(activeNodes);
+
+        int numUpdatedLinks = (int)updatedLinks.size();
+        for (int a=0;a<count;a++)
+        {
+            memcpy(nodeNewValues,&constantSums[0],sizeof(Type)*numNodes);
+
+            for (int b=0;b<numUpdatedLinks;b++)
             {
-                cout << a << ": " << nodeValues[a] << '/' << nodeNewValues[a] << endl;
+                const NetworkIndexedLink<Type> &link = links[updatedLinks[b]];
+                nodeNewValues[link.toNode] += nodeValues[link.fromNode]*link.weight;
             }
 
-            //system("PAUSE");
-#endif
+            activateNewValues();
+        }
+    }
 
-            //cout << "Done updating values.\n";
+    template<class Type>
+    void FastNetwork<Type>::sumConstantLinks(const vector<int> &activeNodes)
+    {
+        memset(&constantSums[0],0,sizeof(Type)*numNodes);
+        for (int a=0;a<(int)activeNodes.size();a++)
+        {
+            int fromNode = activeNodes[a];
+            Type fromValue = nodeValues[fromNode];
+            for (int b=constantLinkStart[fromNode];b<constantLinkStart[fromNode+1];b++)
+            {
+                const NetworkIndexedLink<Type> &link = links[constantLinks[b]];
+                constantSums[link.toNode] += fromValue*link.weight;
+            }
+        }
+    }
+
+    template<class Type>
+    bool FastNetwork<Type>::compileLayered(int iterations)
+    {
+        layeredNodes.clear();
+        layeredLinkStart.clear();
+        layeredLinks.clear();
+
+        if (int(constantLinkStart.size())!=numConstantNodes+1)
+        {
+            buildSparseLinks();
+        }
+
+        //The level of a node is the longest path to it from a constant node.
+        //After i iterations every node up to level i has its final value.  On a
+        //recurrent path the levels keep growing past iterations.
+        vector<int> level(numNodes,1);
+        int numUpdatedLinks = (int)updatedLinks.size();
+        int maxLevel = 1;
+        bool changed=true;
+        for (int pass=0;changed;pass++)
+        {
+            if (pass>iterations)
+            {
+                return false;
+            }
+
+            changed=false;
+            for (int a=0;a<numUpdatedLinks;a++)
+            {
+                const NetworkIndexedLink<Type> &link = links[updatedLinks[a]];
+                if (level[link.fromNode]+1>level[link.toNode])
+                {
+                    level[link.toNode] = level[link.fromNode]+1;
+                    if (level[link.toNode]>iterations)
+                    {
+                        return false;
+                    }
+                    maxLevel = max(maxLevel,level[link.toNode]);
+                    changed=true;
+                }
+            }
+        }
+
+        for (int currentLevel=1;currentLevel<=maxLevel;currentLevel++)
+        {
+            for (int a=numConstantNodes;a<numNodes;a++)
+            {
+                if (level[a]==currentLevel)
+                {
+                    layeredNodes.push_back(a);
+                }
+            }
+        }
+
+        //The links into each updated node, in the order they are summed by the
+        //relaxation
+        layeredLinkStart.assign(numNodes+1,0);
+        for (int a=0;a<numUpdatedLinks;a++)
+        {
+            layeredLinkStart[links[updatedLinks[a]].toNode+1]++;
+        }
+        for (int a=0;a<numNodes;a++)
+        {
+            layeredLinkStart[a+1] += layeredLinkStart[a];
+        }
+        layeredLinks.resize(numUpdatedLinks);
+        vector<int> nextLink(layeredLinkStart.begin(),layeredLinkStart.end()-1);
+        for (int a=0;a<numUpdatedLinks;a++)
+        {
+            layeredLinks[nextLink[links[updatedLinks[a]].toNode]++] = updatedLinks[a];
+        }
+
+        return true;
+    }
+
+    template<class Type>
+    void FastNetwork<Type>::updateLayered(const vector<int> &activeNodes)
+    {
+        if (layeredLinkStart.empty())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("updateLayered called on a network that was not compiled");
+        }
+
+        this->activated=true;
+
+        sumConstantLinks(activeNodes);
+
+        bool signedActivation = Globals::getSingleton()->hasSignedActivation();
+        bool usingTanhSigmoid = Globals::getSingleton()->isUsingTanhSigmoid();
+
+        for (int a=0;a<(int)layeredNodes.size();a++)
+        {
+            int toNode = layeredNodes[a];
+            Type sum = constantSums[toNode];
+            for (int b=layeredLinkStart[toNode];b<layeredLinkStart[toNode+1];b++)
+            {
+                const NetworkIndexedLink<Type> &link = links[layeredLinks[b]];
+                sum += nodeValues[link.fromNode]*link.weight;
+            }
+
+            nodeValues[toNode] = runActivationFunction(sum,activationFunctions[toNode],signedActivation,usingTanhSigmoid);
         }
     }
 
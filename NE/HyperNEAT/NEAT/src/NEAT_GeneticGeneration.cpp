@@ -97,6 +97,79 @@ namespace NEAT
     {
     }
 
+    shared_ptr<GeneticGeneration> GeneticGeneration::deepCopy() const
+    {
+        shared_ptr<GeneticGeneration> copy(new GeneticGeneration(*this));
+
+        for (int a=0;a<(int)copy->individuals.size();a++)
+        {
+            copy->individuals[a] = shared_ptr<GeneticIndividual>(new GeneticIndividual(*(individuals[a])));
+        }
+
+        return copy;
+    }
+
+    void GeneticGeneration::getDeltaBases(const GeneticGeneration *base,vector<int> &baseIndices) const
+    {
+        baseIndices.assign(individuals.size(),-1);
+
+        if (!base || base->individuals.empty())
+        {
+            return;
+        }
+
+        vector<vector<int> > baseLinkIDs(base->individuals.size());
+        for (int a=0;a<(int)base->individuals.size();a++)
+        {
+            base->individuals[a]->getSortedLinkIDs(baseLinkIDs[a]);
+        }
+
+        vector<int> linkIDs;
+        for (int a=0;a<(int)individuals.size();a++)
+        {
+            individuals[a]->getSortedLinkIDs(linkIDs);
+
+            //Start with the individual at the same index, which is usually the
+            //same individual when the generation has not changed since base
+            int firstCandidate = (a<(int)base->individuals.size())?a:0;
+            int bestIndex=firstCandidate;
+            int bestCount=-1;
+
+            for (int b=0;b<(int)base->individuals.size();b++)
+            {
+                int candidate = (b==0)?firstCandidate:((b==firstCandidate)?0:b);
+                const vector<int> &candidateIDs = baseLinkIDs[candidate];
+
+                int count=0;
+                vector<int>::const_iterator it1=linkIDs.begin(),it2=candidateIDs.begin();
+                while (it1!=linkIDs.end() && it2!=candidateIDs.end())
+                {
+                    if (*it1<*it2)
+                        it1++;
+                    else if (*it2<*it1)
+                        it2++;
+                    else
+                    {
+                        count++;
+                        it1++;
+                        it2++;
+                    }
+                }
+
+                if (count>bestCount)
+                {
+                    bestIndex = candidate;
+                    bestCount = count;
+
+                    if (count==(int)linkIDs.size() && count==(int)candidateIDs.size())
+                        break;
+                }
+            }
+
+            baseIndices[a] = bestIndex;
+        }
+    }
+
     void GeneticGeneration::setAttributes(TiXmlElement *generationElement)
     {
         generationElement->SetAttribute("GenNumber",int(generationNumber));
@@ -221,6 +294,34 @@ namespace NEAT
         return bestIndividual;
     }
 
+    void GeneticGeneration::insertIndividual(shared_ptr<GeneticIndividual> individual)
+    {
+        if (!sortedByFitness)
+        {
+            sortByFitness();
+        }
+
+        vector<shared_ptr<GeneticIndividual> >::iterator it = individuals.begin();
+        while (it!=individuals.end() && (*it)->getFitness()>=individual->getFitness())
+        {
+            it++;
+        }
+        individuals.insert(it,individual);
+    }
+
+    void GeneticGeneration::removeIndividual(shared_ptr<GeneticIndividual> individual)
+    {
+        vector<shared_ptr<GeneticIndividual> >::iterator it =
+            find(individuals.begin(),individuals.end(),individual);
+
+        if (it==individuals.end())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Tried to remove an individual that is not in the generation!");
+        }
+
+        individuals.erase(it);
+    }
+
     void GeneticGeneration::cleanup()
     {
         if (!sortedByFitness)
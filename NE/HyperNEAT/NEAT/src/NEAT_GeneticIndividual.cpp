@@ -1369,4 +1369,223 @@ namespace NEAT
 
     return true;
   }
+
+    void GeneticIndividual::getSortedLinkIDs(vector<int> &linkIDs) const
+    {
+        linkIDs.resize(links.size());
+
+        for (int a=0;a<(int)links.size();a++)
+        {
+            linkIDs[a] = links[a].getID();
+        }
+
+        sort(linkIDs.begin(),linkIDs.end());
+    }
+
+#define GENE_DELTA_COPY (0)
+
+#define GENE_DELTA_COPY_WEIGHT (1)
+
+#define GENE_DELTA_NEW (2)
+
+    //Appends a gene to the last run if it continues it, otherwise starts a new run
+    static void addGeneDeltaRun(vector<int> &runs,int kind,int baseIndex)
+    {
+        int size = (int)runs.size();
+
+        if (size &&
+            runs[size-3]==kind &&
+            (kind==GENE_DELTA_NEW || runs[size-2]+runs[size-1]==baseIndex))
+        {
+            runs[size-1]++;
+            return;
+        }
+
+        runs.push_back(kind);
+        runs.push_back( (kind==GENE_DELTA_NEW)?0:baseIndex );
+        runs.push_back(1);
+    }
+
+    void GeneticIndividual::makeDelta(const GeneticIndividual &base,GeneticIndividualDelta &delta) const
+    {
+        map<int,int> baseNodeIndices,baseLinkIndices;
+
+        for (int a=0;a<(int)base.nodes.size();a++)
+        {
+            baseNodeIndices[base.nodes[a].getID()] = a;
+        }
+
+        for (int a=0;a<(int)base.links.size();a++)
+        {
+            baseLinkIndices[base.links[a].getID()] = a;
+        }
+
+        //Use the age difference shared by most of the links, typically every
+        //gene is one generation older than in the parent
+        map<int,int> ageDeltaCounts;
+
+        for (int a=0;a<(int)links.size();a++)
+        {
+            map<int,int>::iterator baseIterator = baseLinkIndices.find(links[a].getID());
+
+            if (baseIterator!=baseLinkIndices.end())
+            {
+                ageDeltaCounts[links[a].getAge() - base.links[baseIterator->second].getAge()]++;
+            }
+        }
+
+        delta.ageDelta = 0;
+        int bestCount=0;
+        for (map<int,int>::iterator it=ageDeltaCounts.begin();it!=ageDeltaCounts.end();it++)
+        {
+            if (it->second>bestCount)
+            {
+                delta.ageDelta = it->first;
+                bestCount = it->second;
+            }
+        }
+
+        for (int a=0;a<(int)nodes.size();a++)
+        {
+            const GeneticNodeGene &node = nodes[a];
+            map<int,int>::iterator baseIterator = baseNodeIndices.find(node.getID());
+
+            if (baseIterator!=baseNodeIndices.end())
+            {
+                const GeneticNodeGene &baseNode = base.nodes[baseIterator->second];
+
+                if (
+                    baseNode.isEnabled()==node.isEnabled() &&
+                    baseNode.getAge()+delta.ageDelta==node.getAge() &&
+                    baseNode.getName()==node.getName() &&
+                    baseNode.getType()==node.getType() &&
+                    baseNode.isTopologyFrozen()==node.isTopologyFrozen() &&
+                    baseNode.getActivationFunction()==node.getActivationFunction()
+                )
+                {
+                    addGeneDeltaRun(delta.nodeRuns,GENE_DELTA_COPY,baseIterator->second);
+                    continue;
+                }
+            }
+
+            addGeneDeltaRun(delta.nodeRuns,GENE_DELTA_NEW,0);
+            delta.newNodes.push_back(node);
+        }
+
+        for (int a=0;a<(int)links.size();a++)
+        {
+            const GeneticLinkGene &link = links[a];
+            map<int,int>::iterator baseIterator = baseLinkIndices.find(link.getID());
+
+            if (baseIterator!=baseLinkIndices.end())
+            {
+                const GeneticLinkGene &baseLink = base.links[baseIterator->second];
+
+                if (
+                    baseLink.isEnabled()==link.isEnabled() &&
+                    baseLink.getAge()+delta.ageDelta==link.getAge() &&
+                    baseLink.getFromNodeID()==link.getFromNodeID() &&
+                    baseLink.getToNodeID()==link.getToNodeID() &&
+                    baseLink.isFixed()==link.isFixed()
+                )
+                {
+                    if (baseLink.getWeight()==link.getWeight())
+                    {
+                        addGeneDeltaRun(delta.linkRuns,GENE_DELTA_COPY,baseIterator->second);
+                    }
+                    else
+                    {
+                        addGeneDeltaRun(delta.linkRuns,GENE_DELTA_COPY_WEIGHT,baseIterator->second);
+                        delta.newWeights.push_back(link.getWeight());
+                    }
+                    continue;
+                }
+            }
+
+            addGeneDeltaRun(delta.linkRuns,GENE_DELTA_NEW,0);
+            delta.newLinks.push_back(link);
+        }
+    }
+
+    void GeneticIndividual::applyDelta(const GeneticIndividual &base,const GeneticIndividualDelta &delta)
+    {
+        nodes.clear();
+        links.clear();
+
+        if (delta.nodeRuns.size()%3 || delta.linkRuns.size()%3)
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Corrupt individual delta: incomplete gene run");
+        }
+
+        int newNodeIndex=0;
+        for (int a=0;a<(int)delta.nodeRuns.size();a+=3)
+        {
+            int kind = delta.nodeRuns[a];
+            int baseIndex = delta.nodeRuns[a+1];
+            int count = delta.nodeRuns[a+2];
+
+            if (kind==GENE_DELTA_NEW)
+            {
+                if (newNodeIndex+count>(int)delta.newNodes.size())
+                {
+                    throw CREATE_LOCATEDEXCEPTION_INFO("Corrupt individual delta: missing node genes");
+                }
+
+                nodes.insert(nodes.end(),delta.newNodes.begin()+newNodeIndex,delta.newNodes.begin()+newNodeIndex+count);
+                newNodeIndex += count;
+                continue;
+            }
+
+            if (kind!=GENE_DELTA_COPY || baseIndex<0 || count<0 || baseIndex+count>(int)base.nodes.size())
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO("Corrupt individual delta: bad node run");
+            }
+
+            for (int b=baseIndex;b<baseIndex+count;b++)
+            {
+                nodes.push_back(base.nodes[b]);
+                nodes.back().setAge(base.nodes[b].getAge()+delta.ageDelta);
+            }
+        }
+
+        int newLinkIndex=0,newWeightIndex=0;
+        for (int a=0;a<(int)delta.linkRuns.size();a+=3)
+        {
+            int kind = delta.linkRuns[a];
+            int baseIndex = delta.linkRuns[a+1];
+            int count = delta.linkRuns[a+2];
+
+            if (kind==GENE_DELTA_NEW)
+            {
+                if (newLinkIndex+count>(int)delta.newLinks.size())
+                {
+                    throw CREATE_LOCATEDEXCEPTION_INFO("Corrupt individual delta: missing link genes");
+                }
+
+                links.insert(links.end(),delta.newLinks.begin()+newLinkIndex,delta.newLinks.begin()+newLinkIndex+count);
+                newLinkIndex += count;
+                continue;
+            }
+
+            if (
+                (kind!=GENE_DELTA_COPY && kind!=GENE_DELTA_COPY_WEIGHT) ||
+                baseIndex<0 || count<0 || baseIndex+count>(int)base.links.size() ||
+                (kind==GENE_DELTA_COPY_WEIGHT && newWeightIndex+count>(int)delta.newWeights.size())
+            )
+            {
+                throw CREATE_LOCATEDEXCEPTION_INFO("Corrupt individual delta: bad link run");
+            }
+
+            for (int b=baseIndex;b<baseIndex+count;b++)
+            {
+                links.push_back(base.links[b]);
+                links.back().setAge(base.links[b].getAge()+delta.ageDelta);
+
+                if (kind==GENE_DELTA_COPY_WEIGHT)
+                {
+                    links.back().setWeight(delta.newWeights[newWeightIndex++]);
+                }
+            }
+        }
+    }
 }
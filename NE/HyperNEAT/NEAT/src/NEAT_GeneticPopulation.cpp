@@ -241,6 +241,25 @@ namespace NEAT
         return bestIndividual;
     }
 
+    shared_ptr<GeneticSpecies> GeneticPopulation::assignSpecies(shared_ptr<GeneticIndividual> individual,double compatThreshold)
+    {
+        for (int b=0;b<(int)species.size();b++)
+        {
+            double compatibility = species[b]->getBestIndividual()->getCompatibility(individual);
+            if (compatibility<compatThreshold)
+            {
+                //Found a compatible species
+                individual->setSpeciesID(species[b]->getID());
+                return species[b];
+            }
+        }
+
+        //Make a new species.  The process of making a new speceis sets the ID for the individual.
+        shared_ptr<GeneticSpecies> newSpecies(new GeneticSpecies(individual));
+        species.push_back(newSpecies);
+        return newSpecies;
+    }
+
     void GeneticPopulation::speciate()
     {
         double compatThreshold = Globals::getSingleton()->getParameterValue("CompatibilityThreshold");
@@ -249,27 +268,15 @@ namespace NEAT
         {
             shared_ptr<GeneticIndividual> individual = generations[onGeneration]->getIndividual(a);
 
-            bool makeNewSpecies=true;
+            assignSpecies(individual,compatThreshold);
+        }
 
-            for (int b=0;b<(int)species.size();b++)
-            {
-                double compatibility = species[b]->getBestIndividual()->getCompatibility(individual);
-                if (compatibility<compatThreshold)
-                {
-                    //Found a compatible species
-                    individual->setSpeciesID(species[b]->getID());
-                    makeNewSpecies=false;
-                    break;
-                }
-            }
+        adjustCompatibilityThreshold();
+    }
 
-            if (makeNewSpecies)
-            {
-                //Make a new species.  The process of making a new speceis sets the ID for the individual.
-                shared_ptr<GeneticSpecies> newSpecies(new GeneticSpecies(individual));
-                species.push_back(newSpecies);
-            }
-        }
+    void GeneticPopulation::adjustCompatibilityThreshold()
+    {
+        double compatThreshold = Globals::getSingleton()->getParameterValue("CompatibilityThreshold");
 
         int speciesTarget = int(Globals::getSingleton()->getParameterValue("SpeciesSizeTarget"));
 
@@ -374,18 +381,7 @@ namespace NEAT
         cout << "[HyperNEAT Core - Genetic Population] numParents: " << numParents << ", speciesSize: " << species.size() << endl;
 
         cout << "[HyperNEAT Core - Genetic Population] Bad parents thrown out\n";
-        double minFitness = species[0]->getAdjustedFitness();
-        if (Globals::getSingleton()->hasParameterValue("MinPossibleFitness"))
-            minFitness = Globals::getSingleton()->getParameterValue("MinPossibleFitness");
-        for (int a=0;a<(int)species.size();a++)
-        {
-            double adjustedFitness = species[a]->getAdjustedFitness();
-            if (adjustedFitness < minFitness) {
-                minFitness = adjustedFitness;
-            }
-        }
-        // Set the minimum global fitness
-        Globals::getSingleton()->setParameterValue("MinPossibleFitness", minFitness);
+        double minFitness = updateMinPossibleFitness();
         cout << "[HyperNEAT Core - Genetic Population] MinFitness: " << minFitness << endl;
         double totalFitness=0;
         for (int a=0;a<(int)species.size();a++)
@@ -534,6 +530,144 @@ namespace NEAT
     }
 
 
+    double GeneticPopulation::updateMinPossibleFitness()
+    {
+        double minFitness = species[0]->getAdjustedFitness();
+        if (Globals::getSingleton()->hasParameterValue("MinPossibleFitness"))
+            minFitness = Globals::getSingleton()->getParameterValue("MinPossibleFitness");
+        for (int a=0;a<(int)species.size();a++)
+        {
+            double adjustedFitness = species[a]->getAdjustedFitness();
+            if (adjustedFitness < minFitness) {
+                minFitness = adjustedFitness;
+            }
+        }
+        // Set the minimum global fitness
+        Globals::getSingleton()->setParameterValue("MinPossibleFitness", minFitness);
+        return minFitness;
+    }
+
+    shared_ptr<GeneticIndividual> GeneticPopulation::produceSteadyStateOffspring()
+    {
+        double minFitness = updateMinPossibleFitness();
+
+        //Same fitness shift as produceNextGeneration, so every species has a chance to reproduce
+        double totalFitness=0;
+        for (int a=0;a<(int)species.size();a++)
+        {
+            double adjustedFitness = species[a]->getAdjustedFitness() - minFitness;
+            if (adjustedFitness <= 0) adjustedFitness = 1e-6;
+            totalFitness += adjustedFitness;
+        }
+
+        double choice = Globals::getSingleton()->getRandom().getRandomDouble()*totalFitness;
+        int parentSpecies=0;
+        for (;parentSpecies+1<(int)species.size();parentSpecies++)
+        {
+            double adjustedFitness = species[parentSpecies]->getAdjustedFitness() - minFitness;
+            if (adjustedFitness <= 0) adjustedFitness = 1e-6;
+            choice -= adjustedFitness;
+            if (choice<0)
+                break;
+        }
+
+        return species[parentSpecies]->makeBaby(minFitness);
+    }
+
+    void GeneticPopulation::addSteadyStateIndividual(shared_ptr<GeneticIndividual> individual)
+    {
+        shared_ptr<GeneticGeneration> generation = generations[onGeneration];
+
+        double compatThreshold = Globals::getSingleton()->getParameterValue("CompatibilityThreshold");
+        shared_ptr<GeneticSpecies> individualSpecies = assignSpecies(individual,compatThreshold);
+        individualSpecies->insertIndividual(individual);
+        generation->insertIndividual(individual);
+
+        if (individual->getFitness()>individualSpecies->getBestIndividual()->getFitness())
+        {
+            //We have a new all-time species champion!
+            individualSpecies->setBestIndividual(individual);
+            cout << "Species " << individualSpecies->getID() << " has a new champ with fitness " << individual->getFitness() << endl;
+        }
+
+        individualSpecies->setMultiplier();
+
+        //The generation is sorted, so the last individual has the lowest fitness
+        double lowestFitness = generation->getIndividual(generation->getIndividualCount()-1)->getFitness();
+
+        shared_ptr<GeneticIndividual> worstIndividual;
+        double worstAdjustedFitness=0;
+        for (int a=1;a<generation->getIndividualCount();a++)
+        {
+            shared_ptr<GeneticIndividual> ind = generation->getIndividual(a);
+            double adjustedFitness =
+                (ind->getFitness()-lowestFitness+1e-6)*getSpecies(ind->getSpeciesID())->getMultiplier();
+
+            if (!worstIndividual||adjustedFitness<=worstAdjustedFitness)
+            {
+                worstIndividual = ind;
+                worstAdjustedFitness = adjustedFitness;
+            }
+        }
+
+        if (worstIndividual)
+        {
+            shared_ptr<GeneticSpecies> worstSpecies = getSpecies(worstIndividual->getSpeciesID());
+            worstSpecies->removeIndividual(worstIndividual);
+            generation->removeIndividual(worstIndividual);
+
+            if (worstSpecies->getIndividualCount()==0)
+            {
+                extinctSpecies.push_back(worstSpecies);
+                species.erase(find(species.begin(),species.end(),worstSpecies));
+            }
+        }
+
+        for (int a=0;a<(int)species.size();a++)
+        {
+            species[a]->setMultiplier();
+            species[a]->setFitness();
+        }
+    }
+
+    void GeneticPopulation::advanceSteadyStateGeneration()
+    {
+        shared_ptr<GeneticGeneration> generation = generations[onGeneration];
+
+        for (int a=0;a<(int)species.size();a++)
+        {
+            species[a]->incrementAge();
+        }
+
+        //Keep the species of the generation champion from being penalized for stagnation
+        getSpecies(generation->getIndividual(0)->getSpeciesID())->updateAgeOfLastImprovement();
+
+        for (int a=0;a<(int)species.size();a++)
+        {
+            species[a]->setMultiplier();
+        }
+
+        adjustCompatibilityThreshold();
+
+        cout << "Generation " << int(onGeneration) << ": # of Species: " << int(species.size())
+             << " compat threshold: " << Globals::getSingleton()->getParameterValue("CompatibilityThreshold") << endl;
+
+        //Structural innovations of the next generation get new IDs, as in produceNextGeneration
+        Globals::getSingleton()->clearLinkHistory();
+
+        vector<shared_ptr<GeneticIndividual> > members;
+        for (int a=0;a<generation->getIndividualCount();a++)
+        {
+            members.push_back(generation->getIndividual(a));
+        }
+
+        shared_ptr<GeneticGeneration> newGeneration(generation->produceNextGeneration(members,onGeneration+1));
+        newGeneration->sortByFitness();
+
+        generations.push_back(newGeneration);
+        onGeneration++;
+    }
+
     void GeneticPopulation::dump(string filename,bool includeGenes,bool doGZ)
     {
         TiXmlDocument doc( filename );
@@ -617,5 +751,17 @@ namespace NEAT
     {
         for (int a=0;a<onGeneration;a++)
             generations[a]->cleanup();
+    }
+
+    vector<shared_ptr<GeneticGeneration> > GeneticPopulation::copyGenerations() const
+    {
+        vector<shared_ptr<GeneticGeneration> > copies;
+
+        for (int a=0;a<(int)generations.size();a++)
+        {
+            copies.push_back(generations[a]->deepCopy());
+        }
+
+        return copies;
     }        
 }
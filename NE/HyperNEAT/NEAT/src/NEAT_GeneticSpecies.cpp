@@ -86,6 +86,29 @@ namespace NEAT
         }
     }
 
+    void GeneticSpecies::insertIndividual(shared_ptr<GeneticIndividual> ind)
+    {
+        vector<shared_ptr<GeneticIndividual> >::iterator it = currentIndividuals.begin();
+        while (it!=currentIndividuals.end() && (*it)->getFitness()>=ind->getFitness())
+        {
+            it++;
+        }
+        currentIndividuals.insert(it,ind);
+    }
+
+    void GeneticSpecies::removeIndividual(shared_ptr<GeneticIndividual> ind)
+    {
+        vector<shared_ptr<GeneticIndividual> >::iterator it =
+            find(currentIndividuals.begin(),currentIndividuals.end(),ind);
+
+        if (it==currentIndividuals.end())
+        {
+            throw CREATE_LOCATEDEXCEPTION_INFO("Tried to remove an individual that is not in the species!");
+        }
+
+        currentIndividuals.erase(it);
+    }
+
     void GeneticSpecies::makeBabies(vector<shared_ptr<GeneticIndividual> > &babies, double minGenerationalFitness)
     {
         int lastIndex = int(Globals::getSingleton()->getParameterValue("SurvivalThreshold")*currentIndividuals.size());
@@ -95,7 +118,6 @@ namespace NEAT
             currentIndividuals[a]->setCanReproduce(false);
         }
 
-        double mutateOnlyProb = Globals::getSingleton()->getParameterValue("MutateOnlyProbability");
         for (int a=0;offspringCount>0;a++)
         {
             if (a>=1000000)
@@ -109,50 +131,56 @@ namespace NEAT
                 continue;
             }
 
-            bool onlyOneParent = (int(lastIndex)==0);
-            if (onlyOneParent||Globals::getSingleton()->getRandom().getRandomDouble()<mutateOnlyProb)
-            {
-                int parent = Globals::getSingleton()->getRandom().getRandomWithinRange(0,int(lastIndex));
-                shared_ptr<GeneticIndividual> ind = currentIndividuals[parent];
-                babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(ind,true)));
-                offspringCount--;
-            }
-            else
+            babies.push_back(makeBaby(minGenerationalFitness));
+            offspringCount--;
+        }
+    }
+
+    shared_ptr<GeneticIndividual> GeneticSpecies::makeBaby(double minGenerationalFitness)
+    {
+        int lastIndex = int(Globals::getSingleton()->getParameterValue("SurvivalThreshold")*currentIndividuals.size());
+
+        double mutateOnlyProb = Globals::getSingleton()->getParameterValue("MutateOnlyProbability");
+
+        bool onlyOneParent = (int(lastIndex)==0);
+        if (onlyOneParent||Globals::getSingleton()->getRandom().getRandomDouble()<mutateOnlyProb)
+        {
+            int parent = Globals::getSingleton()->getRandom().getRandomWithinRange(0,int(lastIndex));
+            shared_ptr<GeneticIndividual> ind = currentIndividuals[parent];
+            return shared_ptr<GeneticIndividual>(new GeneticIndividual(ind,true));
+        }
+
+        shared_ptr<GeneticIndividual> parent1,parent2;
+
+        //while(parent1==NULL)
+        {
+            int parentIndex = Globals::getSingleton()->getRandom().getRandomWithinRange(0,int(lastIndex));
+            parent1 = currentIndividuals[parentIndex];
+        }
+        //while(parent2==NULL)
+        int tt=0;
+        do
+        {
+            tt++;
+            if (tt==1000000)
             {
-                shared_ptr<GeneticIndividual> parent1,parent2;
-
-                //while(parent1==NULL)
-                {
-                    int parentIndex = Globals::getSingleton()->getRandom().getRandomWithinRange(0,int(lastIndex));
-                    parent1 = currentIndividuals[parentIndex];
-                }
-                //while(parent2==NULL)
-                int tt=0;
-                do
-                {
-                    tt++;
-                    if (tt==1000000)
-                    {
-                        cout << "Error while choosing parents.  Doing asexual reproduction\n";
-                    }
-
-                    int parentIndex = Globals::getSingleton()->getRandom().getRandomWithinRange(0,int(lastIndex));
-                    parent2 = currentIndividuals[parentIndex];
-                    //if(parent2==parent1)
-                    //parent2=shared_ptr<GeneticIndividual>();
-                }
-                while (parent2==parent1&&tt<=1000000);
-
-                if (parent1==parent2)
-                {
-                    babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(parent1,true)));
-                }
-                else
-                {
-                    babies.push_back(shared_ptr<GeneticIndividual>(new GeneticIndividual(parent1,parent2,false,minGenerationalFitness)));
-                }
-                offspringCount--;
+                cout << "Error while choosing parents.  Doing asexual reproduction\n";
             }
+
+            int parentIndex = Globals::getSingleton()->getRandom().getRandomWithinRange(0,int(lastIndex));
+            parent2 = currentIndividuals[parentIndex];
+            //if(parent2==parent1)
+            //parent2=shared_ptr<GeneticIndividual>();
+        }
+        while (parent2==parent1&&tt<=1000000);
+
+        if (parent1==parent2)
+        {
+            return shared_ptr<GeneticIndividual>(new GeneticIndividual(parent1,true));
+        }
+        else
+        {
+            return shared_ptr<GeneticIndividual>(new GeneticIndividual(parent1,parent2,false,minGenerationalFitness));
         }
     }
 
@@ -6,6 +6,8 @@
 
 #include "Board.h"
 #include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 
 #define LAYERED_SUBSTRATE_DEBUG (0)
 
@@ -15,8 +17,15 @@
 
 #define DEBUG_MAX_DELTA_RANGE (2)
 
+#if LAYERED_SUBSTRATE_ENABLE_BIASES || defined(USE_GPU)
+#define LAYERED_SUBSTRATE_USE_CACHE (0)
+#else
+#define LAYERED_SUBSTRATE_USE_CACHE (1)
+#endif
+
 namespace NEAT
 {
+#if LAYERED_SUBSTRATE_DEBUG
     template<class NetworkDataType>
     class LinkWeightPair
     {
@@ -34,9 +43,163 @@ namespace NEAT
             {
             }
     };
+#endif
+
+    /**
+     * Where populateSubstrate writes the weights between a pair of layers.
+     * The weight from valid node f of z1 to valid node t of z2 goes to
+     * getTargetWeights(t)[f].  That is the network's own weight slot unless
+     * the network stores the weights of several nodes in the same slots or
+     * the layers have invalid borders.  Then the weights are staged and set
+     * with setLink() in node order.
+     */
+    template<class NetworkDataType>
+    class LayerPairWeights
+    {
+    public:
+        int z1,z2;
+        string outputNodeName;
+
+        //Number of valid nodes of z1
+        int numFromNodes;
+
+        bool staged;
+
+        NetworkDataType *networkWeights;
+        int networkStride;
+
+        vector<NetworkDataType> stagedWeights;
+
+        inline NetworkDataType *getTargetWeights(int toIndex)
+        {
+            if(staged)
+            {
+                return &stagedWeights[toIndex*numFromNodes];
+            }
+            return networkWeights + toIndex*networkStride;
+        }
+    };
+
+    /**
+     * The CPPN queries of populateSubstrate, one row of the to-layer of a
+     * layer pair at a time.  Rows write to their own nodes' weights, so
+     * threads only share the index of the next row.
+     */
+    template<class NetworkDataType>
+    class LayeredSubstrateQueries
+    {
+    public:
+        const NEAT::FastNetwork<NetworkDataType> *cppn;
+
+        vector<LayerPairWeights<NetworkDataType> > pairs;
+
+        //The index in pairs and the valid row in the to-layer of each row
+        vector<JGTL::Vector2<int> > rows;
+
+        int nextRow;
+
+        mutex rowMutex;
+
+        string error;
+
+        LayeredSubstrateQueries()
+            :
+            cppn(NULL),
+            nextRow(0)
+        {
+        }
+    };
+
+    /**
+     * Scales the incoming weights of node toIndex of layer z2 to a magnitude
+     * of 3, removes the ones below 0.05 and scales the rest to 3 again.  A
+     * weight of zero is no link and stays zero.
+     */
+    template<class NetworkDataType>
+    static void normalizeWeights(vector<LayerPairWeights<NetworkDataType> > &pairs,int z2,int toIndex)
+    {
+        //Normalize
+        NetworkDataType sumSq=0;
+        for(int p=0;p<(int)pairs.size();p++)
+        {
+            if(pairs[p].z2!=z2)
+                continue;
+
+            NetworkDataType *weights = pairs[p].getTargetWeights(toIndex);
+            for(int f=0;f<pairs[p].numFromNodes;f++)
+            {
+                if(weights[f]!=0)
+                {
+                    sumSq += weights[f]*weights[f];
+                }
+            }
+        }
+        NetworkDataType magnitude = sqrt(sumSq);
+
+        //Divide by magnitude & delete small weight links
+        for(int p=0;p<(int)pairs.size();p++)
+        {
+            if(pairs[p].z2!=z2)
+                continue;
+
+            NetworkDataType *weights = pairs[p].getTargetWeights(toIndex);
+            for(int f=0;f<pairs[p].numFromNodes;f++)
+            {
+                if(weights[f]!=0)
+                {
+                    //Normalize to 3.0
+                    weights[f] = weights[f]*3.0f/magnitude;
+
+                    if(fabs(weights[f])<0.05)
+                    {
+                        //The weight is too small, kill it
+                        weights[f] = 0;
+                    }
+                }
+            }
+        }
+
+        //Renormalize
+        sumSq=0;
+        for(int p=0;p<(int)pairs.size();p++)
+        {
+            if(pairs[p].z2!=z2)
+                continue;
+
+            NetworkDataType *weights = pairs[p].getTargetWeights(toIndex);
+            for(int f=0;f<pairs[p].numFromNodes;f++)
+            {
+                if(weights[f]!=0)
+                {
+                    sumSq += weights[f]*weights[f];
+                }
+            }
+        }
+        magnitude = sqrt(sumSq);
+        for(int p=0;p<(int)pairs.size();p++)
+        {
+            if(pairs[p].z2!=z2)
+                continue;
+
+            NetworkDataType *weights = pairs[p].getTargetWeights(toIndex);
+            for(int f=0;f<pairs[p].numFromNodes;f++)
+            {
+                if(weights[f]!=0)
+                {
+                    //Normalize to 3.0
+                    weights[f] = weights[f]*3.0f/magnitude;
+                }
+            }
+        }
+    }
+
+    template< class NetworkDataType >
+    shared_ptr<LayeredSubstrateCache<NetworkDataType> > LayeredSubstrate<NetworkDataType>::cache;
 
     template< class NetworkDataType >
     LayeredSubstrate<NetworkDataType>::LayeredSubstrate()
+        :
+        layerInfoHash(0)
     {
     }
 
@@ -80,6 +243,23 @@ namespace NEAT
         maxDeltaLength = layerInfo.maxDeltaLength;
         maxConnectionLength = layerInfo.maxConnectionLength;
 
+        typedef LayeredSubstrateCache<NetworkDataType> Cache;
+        layerInfoHash = Cache::getEmptyHash();
+        for(int a=0;a<int(layerNames.size());a++)
+        {
+            layerInfoHash = Cache::hashString(layerInfoHash,layerNames[a]);
+            layerInfoHash = Cache::hashValue(layerInfoHash,layerSizes[a]);
+            layerInfoHash = Cache::hashValue(layerInfoHash,layerValidSizes[a]);
+        }
+        for(int a=0;a<int(layerAdjacencyList.size());a++)
+        {
+            layerInfoHash = Cache::hashValue(layerInfoHash,layerAdjacencyList[a]);
+        }
+        layerInfoHash = Cache::hashValue(layerInfoHash,normalize);
+        layerInfoHash = Cache::hashValue(layerInfoHash,useOldOutputNames);
+        layerInfoHash = Cache::hashValue(layerInfoHash,maxDeltaLength);
+        layerInfoHash = Cache::hashValue(layerInfoHash,maxConnectionLength);
+
         /*
           for(int a=0;a<int(layerSizes.size());a++)
           {
@@ -110,35 +290,35 @@ namespace NEAT
     {
         nameLookup.clear();
 
-        NEAT::FastNetwork<NetworkDataType> cppn = individual->spawnFastPhenotypeStack<NetworkDataType>();
-
-        int linkCounter=0;
-
-#if LAYERED_SUBSTRATE_DEBUG
-        double linkChecksum=0.0;
+        vector<NetworkLayer<NetworkDataType> > layers;
+        createLayers(layers);
+#ifdef USE_GPU
+        gpuNetwork = NEAT::GPUANN(layers);
 #endif
 
-        int connectionCount=0;
+        // The network takes the new layers without copying them, so the CPPN
+        // outputs are written straight to their weight slots.  The weights
+        // of the previous individual are freed first.
+        network.swapLayers(layers);
+        layers.clear();
 
-        map<JGTL::Vector3<int>, vector<LinkWeightPair<NetworkDataType> > > allIncomingLinks;
-
-        vector<NetworkLayer<NetworkDataType> > layers;
-
-        // Parse the layer adjacency list
-        for(int a=0;a<int(layerNames.size());a++) //For each layer 'a'
+#if LAYERED_SUBSTRATE_USE_CACHE
+        ulong cacheKey=0;
+        if(cache)
         {
-            // Find all layers that propagate to 'a'
-            vector<int> fromLayers; // All layers that go to 'a'
-            for(int b=0;b<int(layerAdjacencyList.size());b++) // For each layerAdjencyPair 'b'
+            cacheKey = LayeredSubstrateCache<NetworkDataType>::getKey(*individual,layerInfoHash);
+            if(cache->load(cacheKey,cachedWeights))
             {
-                if(layerAdjacencyList[b].y==a) // If pair terminates at 'a'
-                {
-                    fromLayers.push_back(layerAdjacencyList[b].x); // Add to the list
-                }
+                network.setWeights(cachedWeights);
+                return;
             }
-            // Save this info into the layers data struct
-            layers.push_back(NetworkLayer<NetworkDataType>(layerNames[a],layerValidSizes[a].x*layerValidSizes[a].y,layerValidSizes[a].x,fromLayers,layerValidSizes));
         }
+#endif
+
+        NEAT::FastNetwork<NetworkDataType> cppn = individual->spawnFastPhenotypeStack<NetworkDataType>();
+
+        LayeredSubstrateQueries<NetworkDataType> queries;
+        queries.cppn = &cppn;
 
         for (int z1=0;z1<(int)layerSizes.size();z1++)
         {
@@ -166,396 +346,196 @@ namespace NEAT
 
                 printf("Setting weights between layers %s and %s\n",layerNames[z1].c_str(),layerNames[z2].c_str());
 
-                // Find the (x1,y1) (x2,y2) coordinate sizes of the input,output layers
-                JGTL::Vector2<int> validInputStart = (layerSizes[z1] - layerValidSizes[z1])/2;
-                JGTL::Vector2<int> validInputEnd = ((layerSizes[z1] - layerValidSizes[z1])/2) + layerValidSizes[z1];
-
-                JGTL::Vector2<int> validOutputStart = (layerSizes[z2] - layerValidSizes[z2])/2;
-                JGTL::Vector2<int> validOutputEnd = ((layerSizes[z2] - layerValidSizes[z2])/2) + layerValidSizes[z2];
-
-                for (int y1=validInputStart.y;y1<validInputEnd.y;y1++)
-                {
-                    for (int x1=validInputStart.x;x1<validInputEnd.x;x1++)
-                    {
-                        for (int y2=validOutputStart.y;y2<validOutputEnd.y;y2++)
-                        {
-                            for (int x2=validOutputStart.x;x2<validOutputEnd.x;x2++)
-                            {
-                                // If the distance between x,y coordinates is too large, ignore
-                                int chessDistance = max(abs(x1-x2),abs(y1-y2));
-                                if(chessDistance>maxConnectionLength)
-                                {
-                                    continue;
-                                }
-
-
-#if DEBUG_NO_LONG_RANGE_LINKS
-                                if(z1==0 && max(abs(x2-x1),abs(y2-y1))>DEBUG_MAX_DELTA_RANGE)
-                                {
-                                    continue;
-                                }
-#endif
-
-                                /*Remap the nodes to the [-1,1] domain*/
-                                NetworkDataType x1normal,y1normal,x2normal,y2normal;
-
-                                if (layerSizes[z1].x>1)
-                                {
-                                    x1normal = -1.0f + (NetworkDataType(x1)/(layerSizes[z1].x-1))*2.0f;
-                                }
-                                else
-                                {
-                                    x1normal = 0.0f;
-                                }
-
-                                if (layerSizes[z1].y>1)
-                                {
-                                    y1normal = -1.0f + (NetworkDataType(y1)/(layerSizes[z1].y-1))*2.0f;
-                                }
-                                else
-                                {
-                                    y1normal = 0.0f;
-                                }
-
-                                if (layerSizes[z2].x>1)
-                                {
-                                    x2normal = -1.0f + (NetworkDataType(x2)/(layerSizes[z2].x-1))*2.0f;
-                                }
-                                else
-                                {
-                                    x2normal = 0.0f;
-                                }
-
-                                if (layerSizes[z2].y>1)
-                                {
-                                    y2normal = -1.0f + (NetworkDataType(y2)/(layerSizes[z2].y-1))*2.0f;
-                                }
-                                else
-                                {
-                                    y2normal = 0.0f;
-                                }
-
-                                // Set the values of the CPPNs inputs
-                                cppn.reinitialize();
-                                if (cppn.hasNode("X1"))
-                                {
-                                    cppn.setValue("X1",x1normal);
-                                    cppn.setValue("Y1",y1normal);
-                                }
-                                if (cppn.hasNode("X2"))
-                                {
-                                    cppn.setValue("X2",x2normal);
-                                    cppn.setValue("Y2",y2normal);
-                                }
-                                // This is a specialized handler for Atari Game CPPNs
-                                // for (int inputSubstrate=0; ; inputSubstrate++) {
-                                //   string name("Input" + boost::lexical_cast<std::string>(inputSubstrate));
-                                //   if (cppn.hasNode(name)) {
-                                //     if (layerNames[z1] == name) {
-                                //       printf("Activating Atari Specific input node: %s\n",name.c_str());
-                                //       cppn.setValue(name,1.0);
-                                //     } else {
-                                //       cppn.setValue(name,0.0);
-                                //     }
-                                //   } else
-                                //     break;
-                                // }
-                                // TODO self input node
-                                if(cppn.hasNode("DeltaX"))
-                                {
-                                    if(
-#if DEBUG_USE_DELTAS_ON_LONG_RANGE
-#else
-                                        max(abs(x2-x1),abs(y2-y1))<=DEBUG_MAX_DELTA_RANGE && 
-#endif
-                                        chessDistance<=maxDeltaLength
-                                        )
-                                    {
-                                        //cout << x1 << ',' << x2 << ',' << y1 << ',' << y2 << endl;
-                                        //cout << x1normal << ',' << x2normal << ',' << y1normal << ',' << y2normal << endl;
-                                        //cout << "DeltaX:" << (x2normal-x1normal)
-                                        //<< ", DeltaY: " << (y2normal-y1normal)
-                                        //<< endl;
-                                        cppn.setValue("DeltaX",x2normal-x1normal);
-                                        cppn.setValue("DeltaY",y2normal-y1normal);
-                                    }
-                                    else
-                                    {
-                                        cppn.setValue("DeltaX",0);
-                                        cppn.setValue("DeltaY",0);
-                                    }
-                                }
-
-                                if(cppn.hasNode("Bias"))
-                                {
-                                    cppn.setValue("Bias",(NetworkDataType)0.3);
-                                }
-
-                                cppn.update();
-
-                                NetworkDataType output;
-
-                                output = cppn.getValue(outputNodeName);
-
-                                output = convertOutputToWeight(output);
-
-                                JGTL::Vector3<int> inputNode(x1,y1,z1);
-                                JGTL::Vector3<int> outputNode(x2,y2,z2);
-                                if(allIncomingLinks.find(outputNode)==allIncomingLinks.end())
-                                {
-                                    allIncomingLinks[outputNode] = vector<LinkWeightPair<NetworkDataType> >();
-                                }
-
-                                vector<LinkWeightPair<NetworkDataType> > &incomingLinks = allIncomingLinks[outputNode];
-                                // Set the output value for this link
-                                if(fabs(output)>0.0)
-                                {
-                                    incomingLinks.push_back(LinkWeightPair<NetworkDataType> (inputNode,output));
-                                }
-
-                                linkCounter++;
-
-#if LAYERED_SUBSTRATE_ENABLE_BIASES
-                                throw CREATE_LOCATEDEXCEPTION_INFO("NOT SUPPORTED YET");
-                                if (x1==0&&y1==0&&z1==0)
-                                {
-                                    NetworkDataType nodeBias;
-
-                                    if (z2==1)
-                                    {
-                                        nodeBias = network.getValue("Bias_b");
-
-                                        nodeBias = convertOutputToWeight(nodeBias);
-
-                                        /*{
-                                          cout << "Setting bias for "
-                                          << nameLookup[Node(x2-layerSizes[z2].x/2,y2-layerSizes[z2].y/2,1)]
-                                          << endl;
-                                          cout << "Bias: " << nodeBias << endl;
-                                          CREATE_PAUSE("");
-                                          }*/
-
-                                        substrate.setBias(
-                                            *nameLookup.getData(Node(x2,y2,z2)),
-                                            nodeBias
-                                            );
-                                    }
-                                    else if (z2==2)
-                                    {
-                                        nodeBias = network.getValue("Bias_c");
-
-                                        nodeBias = convertOutputToWeight(nodeBias);
-
-                                        /*{
-                                          cout << "Setting bias for "
-                                          << nameLookup[Node(x2-layerSizes[z2].x/2,y2-layerSizes[z2].y/2,2)]
-                                          << endl;
-                                          cout << "Bias: " << nodeBias << endl;
-                                          CREATE_PAUSE("");
-                                          }*/
-
-                                        substrate.setBias(
-                                            *nameLookup.getData(Node(x2,y2,z2)),
-                                            nodeBias
-                                            );
-                                    }
-                                    else
-                                    {
-                                        throw CREATE_LOCATEDEXCEPTION_INFO("wtf");
-                                    }
-                                }
+                queries.pairs.push_back(LayerPairWeights<NetworkDataType>());
+                LayerPairWeights<NetworkDataType> &pairWeights = queries.pairs.back();
+                pairWeights.z1 = z1;
+                pairWeights.z2 = z2;
+                pairWeights.outputNodeName = outputNodeName;
+                pairWeights.numFromNodes = layerValidSizes[z1].x*layerValidSizes[z1].y;
+
+                // The network stores the weight from node f to node t at
+                // t*numToNodes+f, so nodes only have slots of their own if
+                // z1 has no more nodes than z2
+                int numToNodes = layerValidSizes[z2].x*layerValidSizes[z2].y;
+                int a = network.getFromLayerIndex(z2,z1);
+                pairWeights.staged = !(
+                    a>=0 &&
+                    layerValidSizes[z1]==layerSizes[z1] &&
+                    layerValidSizes[z2]==layerSizes[z2] &&
+                    pairWeights.numFromNodes<=numToNodes &&
+                    (numToNodes-1)*numToNodes+pairWeights.numFromNodes<=network.getLayerWeightCount(z2,a)
+                    );
+#ifdef USE_GPU
+                // The GPU network only gets its weights through setLink()
+                pairWeights.staged = true;
 #endif
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        // Normalizes all incoming links to a given output node 
-        if(normalize)
-        {
-            //cout << "NORMALIZING\n";
-            //Normalize (and potentially delete) connections
 
-            // For each set of incoming links
-            typename map<JGTL::Vector3<int>,  vector< LinkWeightPair<NetworkDataType> > >::iterator it;
-            for(it = allIncomingLinks.begin(); it!=allIncomingLinks.end(); it++)
-            {
-                
-                //Normalize
-                NetworkDataType sumSq=0;
-                vector<LinkWeightPair<NetworkDataType> > &incomingLinks = it->second;
-                for(int b=0;b<(int)incomingLinks.size();b++)
+                if(pairWeights.staged)
                 {
-                    sumSq += incomingLinks[b].weight*incomingLinks[b].weight;
+                    pairWeights.stagedWeights.resize(numToNodes*pairWeights.numFromNodes,0);
+                    pairWeights.networkWeights = NULL;
+                    pairWeights.networkStride = 0;
                 }
-                NetworkDataType magnitude = sqrt(sumSq);
-
-                //Divide by magnitude & delete small weight links
-                for(int b=int(incomingLinks.size())-1;b>=0;b--)
+                else
                 {
-                    //Normalize to 3.0
-                    incomingLinks[b].weight = incomingLinks[b].weight*3.0f/magnitude;
-
-                    if(fabs(incomingLinks[b].weight)<0.05)
-                    {
-                        //The weight is too small, kill it
-                        incomingLinks.erase(incomingLinks.begin()+b);
-                    }
+                    pairWeights.networkWeights = network.getLayerWeights(z2,a);
+                    pairWeights.networkStride = numToNodes;
                 }
 
-                //Renormalize
-                sumSq=0;
-                incomingLinks = it->second;
-                for(int b=0;b<(int)incomingLinks.size();b++)
+                // Every row of z2 is queried on its own
+                for(int y2=0;y2<layerValidSizes[z2].y;y2++)
                 {
-                    sumSq += incomingLinks[b].weight*incomingLinks[b].weight;
-                }
-                magnitude = sqrt(sumSq);
-                for(int b=int(incomingLinks.size())-1;b>=0;b--)
-                {
-                    //Normalize to 3.0
-                    incomingLinks[b].weight = incomingLinks[b].weight*3.0f/magnitude;
+                    queries.rows.push_back(JGTL::Vector2<int>(int(queries.pairs.size())-1,y2));
                 }
             }
         }
 
-// CODE NOT USED!
-#if 0
-        //Create network from connections
-        // Counts the number of links
-        int numLinks=0;
-        typename map<JGTL::Vector3<int>,  vector< LinkWeightPair<NetworkDataType> > >::iterator it;
-        for(
-            it = allIncomingLinks.begin();
-            it!=allIncomingLinks.end();
-            it++
-            )
+        int numThreads = 1;
+        if(Globals::getSingleton()->hasParameterValue("SubstrateThreads"))
         {
-            vector<LinkWeightPair<NetworkDataType> > &incomingLinks = it->second;
-            for(int b=0;b<(int)incomingLinks.size();b++)
+            numThreads = int(Globals::getSingleton()->getParameterValue("SubstrateThreads")+0.001);
+            if(numThreads<=0)
             {
-                numLinks++;
+                numThreads = int(boost::thread::hardware_concurrency());
             }
         }
+        numThreads = max(1,min(numThreads,(int)queries.rows.size()));
 
-        // Count the total number of nodes
-        int numNodes = 0;
-        for(int a=0;a<(int)layerSizes.size();a++)
+        if (numThreads<=1)
         {
-            numNodes += (layerSizes[a].x*layerSizes[a].y);
-            //cout << "LAYER SIZE: " << layerSizes[a] << endl;
+            queryRows(&queries);
         }
+        else
+        {
+            boost::thread** threads = new boost::thread*[numThreads];
+
+            for (int i=0;i<numThreads;i++)
+            {
+                threads[i] =
+                    new boost::thread(
+                        boost::bind(
+                            &LayeredSubstrate<NetworkDataType>::queryRows,
+                            this,
+                            &queries
+                            )
+                        );
+            }
 
-        //cout << "NUM NODES: " << numNodes << endl;
-        //cout << "NUM LINKS: " << numLinks << endl;
+            for (int i=0;i<numThreads;i++)
+            {
+                threads[i]->join();
+                delete threads[i];
+            }
 
-        NetworkNode* tmpNodes = new NetworkNode[numNodes];
-        NetworkLink* tmpLinks = new NetworkLink[numLinks];
+            delete[] threads;
+        }
 
-        // Fill in the tmpNodes structure with info of whether each node needs to be updated or not
-        map<Node,int> nodeToIndex;
-        int currentNodeIndex=0;
-        for (int z1=0;z1<(int)layerSizes.size();z1++)
+        if (queries.error.length())
         {
-            for (int y1=0;y1<layerSizes[z1].y;y1++)
+            throw CREATE_LOCATEDEXCEPTION_INFO(string("Error while populating a substrate: ")+queries.error);
+        }
+
+        // Normalize the incoming weights of every node and set the staged
+        // ones.  Nodes are visited layer by layer in row-major order, so
+        // when nodes share weight slots the result is the same for any
+        // number of threads.
+        for(int z2=0;z2<(int)layerSizes.size();z2++)
+        {
+            JGTL::Vector2<int> validOutputStart = (layerSizes[z2] - layerValidSizes[z2])/2;
+
+            for(int toIndex=0;toIndex<layerValidSizes[z2].x*layerValidSizes[z2].y;toIndex++)
             {
-                for (int x1=0;x1<layerSizes[z1].x;x1++)
+                if(normalize)
                 {
-                    Node curNode(x1,y1,z1);
-                    nodeToIndex[curNode] = currentNodeIndex;
+                    normalizeWeights(queries.pairs,z2,toIndex);
+                }
 
-                    string name = (toString(x1)+string("/")+toString(y1)+string("/")+toString(z1));
-                    nameLookup[curNode] = name;
+                Node toNode(
+                    validOutputStart.x + toIndex%layerValidSizes[z2].x,
+                    validOutputStart.y + toIndex/layerValidSizes[z2].x,
+                    z2
+                    );
 
-                    bool update;
-                    if (layerIsInput[z1])
-                    {
-                        update=false; //base level nodes are constant
-                    }
-                    else
-                    {
-                        update=true;
-                    }
+                for(int p=0;p<(int)queries.pairs.size();p++)
+                {
+                    LayerPairWeights<NetworkDataType> &pairWeights = queries.pairs[p];
+                    if(pairWeights.z2!=z2 || !pairWeights.staged)
+                        continue;
 
-                    if(currentNodeIndex>=numNodes)
+                    int z1 = pairWeights.z1;
+                    JGTL::Vector2<int> validInputStart = (layerSizes[z1] - layerValidSizes[z1])/2;
+                    const NetworkDataType *weights = pairWeights.getTargetWeights(toIndex);
+
+                    for(int fromIndex=0;fromIndex<pairWeights.numFromNodes;fromIndex++)
                     {
-                        throw CREATE_LOCATEDEXCEPTION_INFO("OOPS");
-                    }
+                        if(weights[fromIndex]==0)
+                            continue;
 
-                    tmpNodes[currentNodeIndex] = NetworkNode(name,update);
+                        Node fromNode(
+                            validInputStart.x + fromIndex%layerValidSizes[z1].x,
+                            validInputStart.y + fromIndex/layerValidSizes[z1].x,
+                            z1
+                            );
 
-                    currentNodeIndex++;
+                        network.setLink(fromNode,toNode,weights[fromIndex]);
+#ifdef USE_GPU
+                        gpuNetwork.setLink(fromNode,toNode,weights[fromIndex]);
+#endif
+                    }
                 }
             }
         }
 
-        // Fill in the network links
-        int currentLinkIndex=0;
-        for(
-            it = allIncomingLinks.begin();
-            it!=allIncomingLinks.end();
-            it++
-            )
+#if LAYERED_SUBSTRATE_DEBUG
+        // Count the links that were set and sum their weights
+        double linkChecksum=0.0;
+        int connectionCount=0;
+        for(int p=0;p<(int)queries.pairs.size();p++)
         {
-            vector<LinkWeightPair<NetworkDataType> > &incomingLinks = it->second;
-            Node node = it->first;
-            NetworkNode *toNode = &tmpNodes[ nodeToIndex[ node ] ];
-            for(int b=0;b<(int)incomingLinks.size();b++)
+            int z1 = queries.pairs[p].z1;
+            int z2 = queries.pairs[p].z2;
+            JGTL::Vector2<int> validInputStart = (layerSizes[z1] - layerValidSizes[z1])/2;
+            JGTL::Vector2<int> validOutputStart = (layerSizes[z2] - layerValidSizes[z2])/2;
+
+            for(int toIndex=0;toIndex<layerValidSizes[z2].x*layerValidSizes[z2].y;toIndex++)
             {
-                NetworkNode *fromNode = &tmpNodes[ nodeToIndex[ incomingLinks[b].fromPos ] ];
+                Node toNode(
+                    validOutputStart.x + toIndex%layerValidSizes[z2].x,
+                    validOutputStart.y + toIndex/layerValidSizes[z2].x,
+                    z2
+                    );
+
+                vector<LinkWeightPair<NetworkDataType> > incomingLinks;
+                for(int fromIndex=0;fromIndex<queries.pairs[p].numFromNodes;fromIndex++)
+                {
+                    Node fromNode(
+                        validInputStart.x + fromIndex%layerValidSizes[z1].x,
+                        validInputStart.y + fromIndex/layerValidSizes[z1].x,
+                        z1
+                        );
+                    NetworkDataType weight = network.getLink(fromNode,toNode);
+                    if(weight!=0)
+                    {
+                        incomingLinks.push_back(LinkWeightPair<NetworkDataType>(fromNode,weight));
+                    }
+                }
 
-                tmpLinks[currentLinkIndex] = NetworkLink(fromNode,toNode,true,incomingLinks[b].weight);
-                currentLinkIndex++;
+                for(int b=0;b<(int)incomingLinks.size();b++)
+                {
+                    linkChecksum += incomingLinks[b].weight;
+                    connectionCount++;
+                }
             }
         }
-
-        if(currentNodeIndex!=numNodes || currentLinkIndex!=numLinks)
-        {
-            throw CREATE_LOCATEDEXCEPTION_INFO("OOPS!");
-        }
-
-        // Create the ANN
-        originalNetwork = NEAT::FastNetwork<NetworkDataType>(
-            tmpNodes,
-            numNodes,
-            tmpLinks,
-            numLinks
-            );
-#endif
-        // Create the ANN from the layers
-        network = NEAT::FastLayeredNetwork<NetworkDataType>(layers);
-#ifdef USE_GPU
-        gpuNetwork = NEAT::GPUANN(layers);
+        cout << "CONNECTION COUNT: " << connectionCount << " CHECKSUM: " << linkChecksum << endl;
 #endif
 
-        // Set the link weights in the ANN
-        typename map<JGTL::Vector3<int>,  vector< LinkWeightPair<NetworkDataType> > >::iterator it;
-        for(
-            it = allIncomingLinks.begin();
-            it!=allIncomingLinks.end();
-            it++
-            )
+#if LAYERED_SUBSTRATE_USE_CACHE
+        if(cache)
         {
-            vector<LinkWeightPair<NetworkDataType> > &incomingLinks = it->second;
-            Node toNode = it->first;
-
-            for(int b=0;b<(int)incomingLinks.size();b++)
-            {
-                Node fromNode = incomingLinks[b].fromPos;
-                NetworkDataType weight = incomingLinks[b].weight;
-
-                network.setLink(fromNode,toNode,weight);
-#ifdef USE_GPU
-                gpuNetwork.setLink(fromNode,toNode,weight);
-#endif
-            }
+            network.getWeights(cachedWeights);
+            cache->store(cacheKey,cachedWeights);
         }
-
-#if 0
-        delete[] tmpNodes;
-        delete[] tmpLinks;
 #endif
 
 #if 0
@@ -616,6 +596,271 @@ namespace NEAT
 #endif
     }
 
+    template< class NetworkDataType >
+    void LayeredSubstrate<NetworkDataType>::queryRows(LayeredSubstrateQueries<NetworkDataType> *queries)
+    {
+        try
+        {
+            // Each thread activates its own copy of the CPPN
+            NEAT::FastNetwork<NetworkDataType> cppn(*queries->cppn);
+
+            while (true)
+            {
+                int row;
+                {
+                    mutex::scoped_lock scoped_lock(queries->rowMutex);
+
+                    if (queries->nextRow>=(int)queries->rows.size() || queries->error.length())
+                    {
+                        break;
+                    }
+
+                    row = queries->nextRow++;
+                }
+
+                queryRow(cppn,queries->pairs[queries->rows[row].x],queries->rows[row].y);
+            }
+        }
+        catch (const std::exception &ex)
+        {
+            mutex::scoped_lock scoped_lock(queries->rowMutex);
+            queries->error = ex.what();
+        }
+        catch (const string &s)
+        {
+            mutex::scoped_lock scoped_lock(queries->rowMutex);
+            queries->error = s;
+        }
+    }
+
+    template< class NetworkDataType >
+    void LayeredSubstrate<NetworkDataType>::queryRow(
+        NEAT::FastNetwork<NetworkDataType> &cppn,
+        LayerPairWeights<NetworkDataType> &pairWeights,
+        int validRow
+        )
+    {
+        int z1 = pairWeights.z1;
+        int z2 = pairWeights.z2;
+        const string &outputNodeName = pairWeights.outputNodeName;
+
+        // Find the (x1,y1) (x2,y2) coordinate sizes of the input,output layers
+        JGTL::Vector2<int> validInputStart = (layerSizes[z1] - layerValidSizes[z1])/2;
+        JGTL::Vector2<int> validInputEnd = ((layerSizes[z1] - layerValidSizes[z1])/2) + layerValidSizes[z1];
+
+        JGTL::Vector2<int> validOutputStart = (layerSizes[z2] - layerValidSizes[z2])/2;
+        JGTL::Vector2<int> validOutputEnd = ((layerSizes[z2] - layerValidSizes[z2])/2) + layerValidSizes[z2];
+
+        int y2 = validOutputStart.y + validRow;
+        int rowStart = validRow*layerValidSizes[z2].x;
+
+        for (int y1=validInputStart.y;y1<validInputEnd.y;y1++)
+        {
+            for (int x1=validInputStart.x;x1<validInputEnd.x;x1++)
+            {
+                int fromIndex = (y1-validInputStart.y)*layerValidSizes[z1].x + (x1-validInputStart.x);
+
+                for (int x2=validOutputStart.x;x2<validOutputEnd.x;x2++)
+                {
+                    // If the distance between x,y coordinates is too large, ignore
+                    int chessDistance = max(abs(x1-x2),abs(y1-y2));
+                    if(chessDistance>maxConnectionLength)
+                    {
+                        continue;
+                    }
+
+
+#if DEBUG_NO_LONG_RANGE_LINKS
+                    if(z1==0 && max(abs(x2-x1),abs(y2-y1))>DEBUG_MAX_DELTA_RANGE)
+                    {
+                        continue;
+                    }
+#endif
+
+                    /*Remap the nodes to the [-1,1] domain*/
+                    NetworkDataType x1normal,y1normal,x2normal,y2normal;
+
+                    if (layerSizes[z1].x>1)
+                    {
+                        x1normal = -1.0f + (NetworkDataType(x1)/(layerSizes[z1].x-1))*2.0f;
+                    }
+                    else
+                    {
+                        x1normal = 0.0f;
+                    }
+
+                    if (layerSizes[z1].y>1)
+                    {
+                        y1normal = -1.0f + (NetworkDataType(y1)/(layerSizes[z1].y-1))*2.0f;
+                    }
+                    else
+                    {
+                        y1normal = 0.0f;
+                    }
+
+                    if (layerSizes[z2].x>1)
+                    {
+                        x2normal = -1.0f + (NetworkDataType(x2)/(layerSizes[z2].x-1))*2.0f;
+                    }
+                    else
+                    {
+                        x2normal = 0.0f;
+                    }
+
+                    if (layerSizes[z2].y>1)
+                    {
+                        y2normal = -1.0f + (NetworkDataType(y2)/(layerSizes[z2].y-1))*2.0f;
+                    }
+                    else
+                    {
+                        y2normal = 0.0f;
+                    }
+
+                    // Set the values of the CPPNs inputs
+                    cppn.reinitialize();
+                    if (cppn.hasNode("X1"))
+                    {
+                        cppn.setValue("X1",x1normal);
+                        cppn.setValue("Y1",y1normal);
+                    }
+                    if (cppn.hasNode("X2"))
+                    {
+                        cppn.setValue("X2",x2normal);
+                        cppn.setValue("Y2",y2normal);
+                    }
+                    // This is a specialized handler for Atari Game CPPNs
+                    // for (int inputSubstrate=0; ; inputSubstrate++) {
+                    //   string name("Input" + boost::lexical_cast<std::string>(inputSubstrate));
+                    //   if (cppn.hasNode(name)) {
+                    //     if (layerNames[z1] == name) {
+                    //       printf("Activating Atari Specific input node: %s\n",name.c_str());
+                    //       cppn.setValue(name,1.0);
+                    //     } else {
+                    //       cppn.setValue(name,0.0);
+                    //     }
+                    //   } else
+                    //     break;
+                    // }
+                    // TODO self input node
+                    if(cppn.hasNode("DeltaX"))
+                    {
+                        if(
+#if DEBUG_USE_DELTAS_ON_LONG_RANGE
+#else
+                            max(abs(x2-x1),abs(y2-y1))<=DEBUG_MAX_DELTA_RANGE && 
+#endif
+                            chessDistance<=maxDeltaLength
+                            )
+                        {
+                            //cout << x1 << ',' << x2 << ',' << y1 << ',' << y2 << endl;
+                            //cout << x1normal << ',' << x2normal << ',' << y1normal << ',' << y2normal << endl;
+                            //cout << "DeltaX:" << (x2normal-x1normal)
+                            //<< ", DeltaY: " << (y2normal-y1normal)
+                            //<< endl;
+                            cppn.setValue("DeltaX",x2normal-x1normal);
+                            cppn.setValue("DeltaY",y2normal-y1normal);
+                        }
+                        else
+                        {
+                            cppn.setValue("DeltaX",0);
+                            cppn.setValue("DeltaY",0);
+                        }
+                    }
+
+                    if(cppn.hasNode("Bias"))
+                    {
+                        cppn.setValue("Bias",(NetworkDataType)0.3);
+                    }
+
+                    cppn.update();
+
+                    NetworkDataType output;
+
+                    output = cppn.getValue(outputNodeName);
+
+                    output = convertOutputToWeight(output);
+
+                    // Set the output value for this link
+                    if(fabs(output)>0.0)
+                    {
+                        pairWeights.getTargetWeights(rowStart + x2-validOutputStart.x)[fromIndex] = output;
+                    }
+
+#if LAYERED_SUBSTRATE_ENABLE_BIASES
+                    throw CREATE_LOCATEDEXCEPTION_INFO("NOT SUPPORTED YET");
+                    if (x1==0&&y1==0&&z1==0)
+                    {
+                        NetworkDataType nodeBias;
+
+                        if (z2==1)
+                        {
+                            nodeBias = network.getValue("Bias_b");
+
+                            nodeBias = convertOutputToWeight(nodeBias);
+
+                            /*{
+                              cout << "Setting bias for "
+                              << nameLookup[Node(x2-layerSizes[z2].x/2,y2-layerSizes[z2].y/2,1)]
+                              << endl;
+                              cout << "Bias: " << nodeBias << endl;
+                              CREATE_PAUSE("");
+                              }*/
+
+                            substrate.setBias(
+                                *nameLookup.getData(Node(x2,y2,z2)),
+                                nodeBias
+                                );
+                        }
+                        else if (z2==2)
+                        {
+                            nodeBias = network.getValue("Bias_c");
+
+                            nodeBias = convertOutputToWeight(nodeBias);
+
+                            /*{
+                              cout << "Setting bias for "
+                              << nameLookup[Node(x2-layerSizes[z2].x/2,y2-layerSizes[z2].y/2,2)]
+                              << endl;
+                              cout << "Bias: " << nodeBias << endl;
+                              CREATE_PAUSE("");
+                              }*/
+
+                            substrate.setBias(
+                                *nameLookup.getData(Node(x2,y2,z2)),
+                                nodeBias
+                                );
+                        }
+                        else
+                        {
+                            throw CREATE_LOCATEDEXCEPTION_INFO("wtf");
+                        }
+                    }
+#endif
+                }
+            }
+        }
+    }
+
+    template< class NetworkDataType >
+    void LayeredSubstrate<NetworkDataType>::createLayers(vector<NetworkLayer<NetworkDataType> > &layers)
+    {
+        // Parse the layer adjacency list
+        for(int a=0;a<int(layerNames.size());a++) //For each layer 'a'
+        {
+            // Find all layers that propagate to 'a'
+            vector<int> fromLayers; // All layers that go to 'a'
+            for(int b=0;b<int(layerAdjacencyList.size());b++) // For each layerAdjencyPair 'b'
+            {
+                if(layerAdjacencyList[b].y==a) // If pair terminates at 'a'
+                {
+                    fromLayers.push_back(layerAdjacencyList[b].x); // Add to the list
+                }
+            }
+            // Save this info into the layers data struct
+            layers.push_back(NetworkLayer<NetworkDataType>(layerNames[a],layerValidSizes[a].x*layerValidSizes[a].y,layerValidSizes[a].x,fromLayers,layerValidSizes));
+        }
+    }
+
     template< class NetworkDataType >
     NetworkDataType LayeredSubstrate<NetworkDataType>::getValue(const Node &node)
     {
@@ -0,0 +1,256 @@
+#include "NEAT_Defines.h"
+
+#include "NEAT_LayeredSubstrateCache.h"
+
+#include "NEAT_GeneticIndividual.h"
+#include "NEAT_Globals.h"
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+namespace NEAT
+{
+    template<class Type>
+    LayeredSubstrateCache<Type>::LayeredSubstrateCache(size_t _maxBytes,const string &_directory)
+        :
+        maxBytes(_maxBytes),
+        usedBytes(0),
+        memoryHits(0),
+        diskHits(0),
+        misses(0)
+    {
+        setDirectory(_directory);
+    }
+
+    template<class Type>
+    LayeredSubstrateCache<Type>::~LayeredSubstrateCache()
+    {
+    }
+
+    template<class Type>
+    void LayeredSubstrateCache<Type>::setMaxBytes(size_t _maxBytes)
+    {
+        maxBytes = _maxBytes;
+        while(usedBytes>maxBytes)
+        {
+            dropLeastRecent();
+        }
+    }
+
+    template<class Type>
+    void LayeredSubstrateCache<Type>::setDirectory(const string &_directory)
+    {
+        directory = _directory;
+        if(directory.length())
+        {
+            boost::filesystem::create_directories(directory);
+        }
+    }
+
+    template<class Type>
+    bool LayeredSubstrateCache<Type>::load(ulong key,vector<Type> &weights)
+    {
+        typename map<ulong,Entry>::iterator it = entries.find(key);
+        if(it!=entries.end())
+        {
+            weights = it->second.weights;
+
+            //Move the key to the front of the recently used keys
+            recentKeys.splice(recentKeys.begin(),recentKeys,it->second.recentPosition);
+
+            memoryHits++;
+            return true;
+        }
+
+        if(directory.length() && loadFromDisk(key,weights))
+        {
+            storeInMemory(key,weights);
+            diskHits++;
+            return true;
+        }
+
+        misses++;
+        return false;
+    }
+
+    template<class Type>
+    void LayeredSubstrateCache<Type>::store(ulong key,const vector<Type> &weights)
+    {
+        storeInMemory(key,weights);
+
+        if(directory.length())
+        {
+            storeOnDisk(key,weights);
+        }
+    }
+
+    template<class Type>
+    ulong LayeredSubstrateCache<Type>::getKey(const GeneticIndividual &individual,ulong layerInfoHash)
+    {
+        ulong hash = hashValue(getEmptyHash(),layerInfoHash);
+        hash = hashValue(hash,int(sizeof(Type)));
+
+        for(int a=0;a<individual.getNodesCount();a++)
+        {
+            const GeneticNodeGene *node = individual.getNode(a);
+            hash = hashValue(hash,node->getID());
+            hash = hashString(hash,node->getName());
+            hash = hashString(hash,node->getType());
+            hash = hashValue(hash,int(node->getActivationFunction()));
+            hash = hashValue(hash,bool(node->isEnabled()));
+        }
+
+        for(int a=0;a<individual.getLinksCount();a++)
+        {
+            const GeneticLinkGene *link = individual.getLink(a);
+            hash = hashValue(hash,link->getFromNodeID());
+            hash = hashValue(hash,link->getToNodeID());
+            hash = hashValue(hash,link->getWeight());
+            hash = hashValue(hash,bool(link->isEnabled()));
+        }
+
+        //These change the phenotype or the activation of the CPPN
+        Globals *globals = Globals::getSingleton();
+        hash = hashValue(hash,globals->getParameterValue("LinkGeneMinimumWeightForPhentoype"));
+        hash = hashValue(hash,globals->getExtraActivationUpdates());
+        hash = hashValue(hash,globals->hasSignedActivation());
+        hash = hashValue(hash,globals->isUsingTanhSigmoid());
+
+        return hash;
+    }
+
+    template<class Type>
+    void LayeredSubstrateCache<Type>::storeInMemory(ulong key,const vector<Type> &weights)
+    {
+        size_t bytes = weights.size()*sizeof(Type);
+        if(bytes>maxBytes)
+        {
+            return;
+        }
+
+        typename map<ulong,Entry>::iterator it = entries.find(key);
+        if(it!=entries.end())
+        {
+            usedBytes -= it->second.weights.size()*sizeof(Type);
+            recentKeys.erase(it->second.recentPosition);
+            entries.erase(it);
+        }
+
+        while(usedBytes+bytes>maxBytes)
+        {
+            dropLeastRecent();
+        }
+
+        Entry &entry = entries[key];
+        entry.weights = weights;
+        recentKeys.push_front(key);
+        entry.recentPosition = recentKeys.begin();
+        usedBytes += bytes;
+    }
+
+    template<class Type>
+    void LayeredSubstrateCache<Type>::dropLeastRecent()
+    {
+        typename map<ulong,Entry>::iterator it = entries.find(recentKeys.back());
+        usedBytes -= it->second.weights.size()*sizeof(Type);
+        entries.erase(it);
+        recentKeys.pop_back();
+    }
+
+    template<class Type>
+    bool LayeredSubstrateCache<Type>::loadFromDisk(ulong key,vector<Type> &weights)
+    {
+        ifstream fin(getFileName(key).c_str(),ios::in|ios::binary);
+        if(!fin.is_open())
+        {
+            return false;
+        }
+
+        uint header[4];
+        ulong fileKey;
+        fin.read((char*)header,sizeof(header));
+        fin.read((char*)&fileKey,sizeof(fileKey));
+        if(
+            !fin ||
+            header[0]!=LAYERED_SUBSTRATE_CACHE_MAGIC ||
+            header[1]!=LAYERED_SUBSTRATE_CACHE_VERSION ||
+            header[2]!=sizeof(Type) ||
+            fileKey!=key
+            )
+        {
+            cout << "WARNING: Ignoring bad substrate cache file " << getFileName(key) << endl;
+            return false;
+        }
+
+        weights.resize(header[3]);
+        if(header[3])
+        {
+            fin.read((char*)&weights[0],sizeof(Type)*header[3]);
+        }
+        if(!fin)
+        {
+            cout << "WARNING: Ignoring truncated substrate cache file " << getFileName(key) << endl;
+            return false;
+        }
+        return true;
+    }
+
+    template<class Type>
+    void LayeredSubstrateCache<Type>::storeOnDisk(ulong key,const vector<Type> &weights)
+    {
+        string fileName = getFileName(key);
+        if(boost::filesystem::exists(fileName))
+        {
+            return;
+        }
+
+        //Another process may be writing the same entry, so each uses its own temporary file
+        string tempFileName = fileName + string(".") + toString(int(getpid())) + string(".tmp");
+        {
+            ofstream fout(tempFileName.c_str(),ios::out|ios::binary);
+            uint header[4] = {
+                LAYERED_SUBSTRATE_CACHE_MAGIC,
+                LAYERED_SUBSTRATE_CACHE_VERSION,
+                uint(sizeof(Type)),
+                uint(weights.size())
+            };
+            fout.write((const char*)header,sizeof(header));
+            fout.write((const char*)&key,sizeof(key));
+            if(weights.size())
+            {
+                fout.write((const char*)&weights[0],sizeof(Type)*weights.size());
+            }
+            if(!fout)
+            {
+                cout << "WARNING: Could not write substrate cache file " << tempFileName << endl;
+                fout.close();
+                boost::filesystem::remove(tempFileName);
+                return;
+            }
+        }
+
+        try
+        {
+            boost::filesystem::rename(tempFileName,fileName);
+        }
+        catch(const boost::filesystem::filesystem_error &)
+        {
+            //Another process renamed its copy first
+            boost::filesystem::remove(tempFileName);
+        }
+    }
+
+    template<class Type>
+    string LayeredSubstrateCache<Type>::getFileName(ulong key)
+    {
+        char keyString[32];
+        sprintf(keyString,"substrate_%016llx.bin",key);
+        return (boost::filesystem::path(directory) / keyString).string();
+    }
+
+    template class LayeredSubstrateCache<float>; // explicit instantiation
+}
@@ -44,6 +44,8 @@ int max(int a,int b)
 // globals below here are shared - even with these, cake *should* be thread-safe //
 //-------------------------------------------------------------------------------//
 
+// the per-search tables of analyze() and bookgen(). cake_getmove uses the tables of
+// its SEARCHINFO instead, see cake_initsearchinfo.
 static int iscapture[MAXDEPTH];		// tells whether move at realdepth was a capture
 
 int hashmegabytes = 64;				// default hashtable size in MB if no value in registry is found
@@ -78,8 +80,6 @@ static unsigned char bitsinword[65536];
 static unsigned char bitsinbyte[256];
 static unsigned char LSBarray[256];
 
-static int   norefresh;
-
 int bookentries = 0; // number of entries in book hashtable
 int bookmovenum = 0; // number of used entries in book
 
@@ -144,7 +144,7 @@ int initcake(char str[1024])
 	// allocate hashtable
 	sprintf(str,"allocating hashtable...");
 	printf("Allocating hashtable...");
-	hashtable = inithashtable(hashsize);
+	hashtable = inithashtable(hashsize, NULL);
 	printf("Done!\n");
 
 	// initialize xors 
@@ -220,6 +220,71 @@ void resetsearchinfo(SEARCHINFO *s)
 	s->wm = 0;
 }
 
+static void usesharedtables(SEARCHINFO *si)
+{
+	// points si to the shared tables above, for the entry points which are not reentrant
+	si->hashtable = hashtable;
+	si->hashsize = hashsize;
+#ifdef MOHISTORY
+	si->history = history;
+#else
+	si->history = NULL;
+#endif
+	si->iscapture = iscapture;
+	si->norefresh = 0;
+	si->randseed = 1;
+	si->hashmemory = NULL;
+	si->advisor = NULL;
+}
+
+int cake_initsearchinfo(SEARCHINFO *si, int hashMB)
+{
+	// allocates the tables of a search: hashtable, history table and repcheck array.
+	// every thread that calls cake_getmove needs a SEARCHINFO of its own which was
+	// set up with this function, then the threads can search at the same time.
+	// the hashtable has hashMB MB rounded down to a power of 2 entries, or the
+	// default size if hashMB <= 0.
+	int newsize = hashsize;
+
+	if(hashMB > 0)
+	{
+		newsize = 1;
+		while(newsize*2 <= (int)(hashMB*1024*1024/sizeof(HASHENTRY)))
+			newsize *= 2;
+	}
+
+	resetsearchinfo(si);
+	si->hashtable = inithashtable(newsize, &(si->hashmemory));
+	si->hashsize = newsize;
+	memset(si->hashtable,0,(newsize+HASHITER)*sizeof(HASHENTRY));
+	si->history = (int32 (*)[32])malloc(32*32*sizeof(int32));
+	memset(si->history,0,32*32*sizeof(int32));
+	si->iscapture = (int*)malloc(MAXDEPTH*sizeof(int));
+	memset(si->iscapture,0,MAXDEPTH*sizeof(int));
+	si->repcheck = (REPETITION*)malloc((MAXDEPTH+HISTORYOFFSET) * sizeof(REPETITION));
+	si->norefresh = 0;
+	si->randseed = 1;
+	si->advisor = NULL;
+	return 1;
+}
+
+void cake_exitsearchinfo(SEARCHINFO *si)
+{
+	// frees what cake_initsearchinfo allocated
+	if(si->hashmemory != NULL)
+	{
+		free(si->hashmemory);
+		free(si->history);
+		free(si->iscapture);
+	}
+	free(si->repcheck);
+	si->hashmemory = NULL;
+	si->hashtable = NULL;
+	si->history = NULL;
+	si->iscapture = NULL;
+	si->repcheck = NULL;
+}
+
 
 
 
@@ -306,6 +371,7 @@ int bookgen(OLDPOSITION *q, int color, int *numberofmoves, int values[MAXMOVES],
 
 	// reset all counters, nodes, database lookups etc 
 	resetsearchinfo(&si);
+	usesharedtables(&si);
 
 	// allocate memory for repcheck array
 	si.repcheck = (REPETITION*)malloc((MAXDEPTH+HISTORYOFFSET) * sizeof(REPETITION));
@@ -338,7 +404,7 @@ int bookgen(OLDPOSITION *q, int color, int *numberofmoves, int values[MAXMOVES],
 	// clear the hashtable 
 	memset(hashtable,0,(hashsize+HASHITER)*sizeof(HASHENTRY));
 
-	norefresh=0;
+	si.norefresh=0;
 
 	n = makecapturelist(&p, movelist, values, 0);
 	if(!n)
@@ -457,7 +523,7 @@ int bookgen(OLDPOSITION *q, int color, int *numberofmoves, int values[MAXMOVES],
 
 		lastvalue=value;	// save the value for this iteration 
 		last=best;			// save the best move on this iteration 
-		norefresh=1;
+		si.norefresh=1;
 	}
 
 	free(si.repcheck);
@@ -538,6 +604,7 @@ int analyze(POSITION *p, int color, int how, int depth, double searchtime, int *
 	d = getorderedmovelist(p, movelist);
 
 	resetsearchinfo(&si);
+	usesharedtables(&si);
 
 	// allocate memory for repcheck array
 	si.repcheck = (REPETITION*)malloc((MAXDEPTH+HISTORYOFFSET) * sizeof(REPETITION));
@@ -573,7 +640,7 @@ int analyze(POSITION *p, int color, int how, int depth, double searchtime, int *
 	memset(hashtable,0,(hashsize+HASHITER)*sizeof(HASHENTRY));
 	//	}
 
-	norefresh=0;
+	si.norefresh=0;
 
 	// initialize hash key 
 	absolutehashkey(p, &(si.hash));
@@ -643,7 +710,7 @@ int analyze(POSITION *p, int color, int how, int depth, double searchtime, int *
 
 		lastvalue=value;	// save the value for this iteration 
 		last=best;			// save the best move on this iteration 
-		norefresh=1;
+		si.norefresh=1;
 	}
 
 	free(si.repcheck);
@@ -676,6 +743,7 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 	// info&2 means exact time level
 	// info&4 means increment time level
 	// info&8 means allscore search
+	// si must have been set up with cake_initsearchinfo, it holds the hashtable.
 	/*
 	/*----------------------------------------------------------------------------*/
 
@@ -709,7 +777,7 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 	resetsearchinfo(si);
 
 	for(i=0;i<MAXDEPTH;i++)
-		iscapture[i] = 0;
+		si->iscapture[i] = 0;
 
 
 	*playnow = 0;
@@ -741,12 +809,12 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 #ifdef MOHISTORY
 	// reset history table 
 	fflush(stdout);
-	memset(history,0,32*32*sizeof(int));
+	memset(si->history,0,32*32*sizeof(int32));
 #endif
 
 	// clear the hashtable 
 	fflush(stdout);
-	memset(hashtable,0,(hashsize+HASHITER)*sizeof(HASHENTRY));
+	memset(si->hashtable,0,(si->hashsize+HASHITER)*sizeof(HASHENTRY));
 
 	// initialize hash key 
 	absolutehashkey(p, &(si->hash));
@@ -757,7 +825,7 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 #endif
 
 	// what is this doing at all?
-	norefresh=0;
+	si->norefresh=0;
 
 	// what is this doing here?
 	n = makecapturelist(p, movelist, values, 0);
@@ -796,7 +864,7 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 		bookfound=0;
 		bookindex=0;
 
-		if(booklookup(p,&booklookupvalue,0,&bookdepth,&bookindex,str))
+		if(booklookup(si,p,&booklookupvalue,0,&bookdepth,&bookindex,str))
 		{
 			// booklookup was successful, it sets bookindex to the index of the move in movelist that it wants to play
 			bookfound = 1;
@@ -929,7 +997,7 @@ int cake_getmove(SEARCHINFO *si, POSITION *p, int how,double maximaltime,
 
 			lastvalue=value;	// save the value for this iteration 
 			last=best;			// save the best move on this iteration 
-			norefresh=1;
+			si->norefresh=1;
 		}
 	}
 
@@ -1319,7 +1387,7 @@ int firstnegamax(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES], int
 	// what if we don't set forcefirst here, i.e. set it to 0?
 	n = makecapturelist(p, ml2, statvalues, 0);
 
-	iscapture[si->realdepth] = n;
+	si->iscapture[si->realdepth] = n;
 
 	if(n==0)
 		n = makemovelist(si, p, ml2, statvalues, 0,0);
@@ -1524,7 +1592,7 @@ int negamax(SEARCHINFO *si, POSITION *p, int d, int alpha, int *protokiller, int
 	else
 		n = 0;
 
-	iscapture[si->realdepth] = n;
+	si->iscapture[si->realdepth] = n;
 
 	//--------------------------------------------//
 	// check for database use                     // 
@@ -1809,45 +1877,45 @@ void hashstore(SEARCHINFO *si, POSITION *p, int value, int alpha, int depth, CAK
 	{
 		from = (best->bm|best->bk)&(p->bm|p->bk);    /* bit set on square from */
 		to   = (best->bm|best->bk)&(~(p->bm|p->bk));
-		history[LSB(from)][LSB(to)]++;
+		si->history[LSB(from)][LSB(to)]++;
 	}
 	else
 	{
 		from = (best->wm|best->wk)&(p->wm|p->wk);    /* bit set on square from */
 		to   = (best->wm|best->wk)&(~(p->wm|p->wk));
-		history[LSB(from)][LSB(to)]++;
+		si->history[LSB(from)][LSB(to)]++;
 	}
 #endif
 
-	index = si->hash.key & (hashsize-1);
+	index = si->hash.key & (si->hashsize-1);
 	minindex = index;
 
 
 	while(iter<HASHITER)
 	{
-		if(hashtable[index].lock == si->hash.lock || hashtable[index].lock==0) // vtune: use | instead of ||
+		if(si->hashtable[index].lock == si->hash.lock || si->hashtable[index].lock==0) // vtune: use | instead of ||
 			/* found an index where we can write the entry */
 		{
-			hashtable[index].lock = si->hash.lock;
-			hashtable[index].depth =(int16) (depth);
-			hashtable[index].best = bestindex;
-			hashtable[index].color = (p->color>>1);
-			hashtable[index].value =( sint16)value;
+			si->hashtable[index].lock = si->hash.lock;
+			si->hashtable[index].depth =(int16) (depth);
+			si->hashtable[index].best = bestindex;
+			si->hashtable[index].color = (p->color>>1);
+			si->hashtable[index].value =( sint16)value;
 			/* determine valuetype */
 			if(value > alpha) 
-				hashtable[index].valuetype = LOWER;
+				si->hashtable[index].valuetype = LOWER;
 			else
-				hashtable[index].valuetype = UPPER;
+				si->hashtable[index].valuetype = UPPER;
 
 			return;
 		}
 		else
 		{
 			/* have to overwrite */
-			if((int) hashtable[index].depth < mindepth)
+			if((int) si->hashtable[index].depth < mindepth)
 			{
 				minindex=index;
-				mindepth=hashtable[index].depth;
+				mindepth=si->hashtable[index].depth;
 			}
 		}
 		iter++;
@@ -1864,17 +1932,17 @@ void hashstore(SEARCHINFO *si, POSITION *p, int value, int alpha, int depth, CAK
 		return;
 #endif
 
-	hashtable[minindex].lock = si->hash.lock;
-	hashtable[minindex].depth=depth;
-	hashtable[minindex].best=bestindex;
-	hashtable[minindex].color=(p->color>>1);
-	hashtable[minindex].value=value;
+	si->hashtable[minindex].lock = si->hash.lock;
+	si->hashtable[minindex].depth=depth;
+	si->hashtable[minindex].best=bestindex;
+	si->hashtable[minindex].color=(p->color>>1);
+	si->hashtable[minindex].value=value;
 	/* determine valuetype */
 	//if(value>=beta) 
 	if(value > alpha)
-		hashtable[minindex].valuetype = LOWER;
+		si->hashtable[minindex].valuetype = LOWER;
 	else
-		hashtable[minindex].valuetype = UPPER;
+		si->hashtable[minindex].valuetype = UPPER;
 
 	return;
 
@@ -1895,23 +1963,23 @@ int hashlookup(SEARCHINFO *si, int *value, int *valuetype, int depth, int *force
 	int32 index;
 	int iter=0;
 
-	index = si->hash.key & (hashsize-1); // expects that hashsize is a power of 2!
+	index = si->hash.key & (si->hashsize-1); // expects that hashsize is a power of 2!
 
-	// TODO: what is this "hashtable[index].lock" good for? 
-	while(iter<HASHITER && hashtable[index].lock) 
+	// TODO: what is this "si->hashtable[index].lock" good for? 
+	while(iter<HASHITER && si->hashtable[index].lock) 
 	{
-		if(hashtable[index].lock == si->hash.lock && ((int)hashtable[index].color==(color>>1)))
+		if(si->hashtable[index].lock == si->hash.lock && ((int)si->hashtable[index].color==(color>>1)))
 		{
 			// we have found the position 
-			*ispvnode=hashtable[index].ispvnode;
+			*ispvnode=si->hashtable[index].ispvnode;
 
 			// move ordering 
-			*forcefirst=hashtable[index].best;
+			*forcefirst=si->hashtable[index].best;
 			// use value if depth in hashtable >= current depth
-			if((int)hashtable[index].depth>=depth)
+			if((int)si->hashtable[index].depth>=depth)
 			{
-				*value=hashtable[index].value;
-				*valuetype=hashtable[index].valuetype;
+				*value=si->hashtable[index].value;
+				*valuetype=si->hashtable[index].valuetype;
 
 				return 1;
 			}
@@ -1930,27 +1998,27 @@ int pvhashlookup(SEARCHINFO *si, int *value, int *valuetype, int depth, int32 *f
 	int32 index;
 	int iter=0;
 
-	index = si->hash.key & (hashsize-1);
+	index = si->hash.key & (si->hashsize-1);
 
 #ifdef THREADSAFEHT
 	EnterCriticalSection(&hash_access);
 #endif
 
 
-	while(iter<HASHITER && hashtable[index].lock) // vtune: use & instead
+	while(iter<HASHITER && si->hashtable[index].lock) // vtune: use & instead
 	{
-		if(hashtable[index].lock == si->hash.lock && ((int)hashtable[index].color==(color>>1)))
+		if(si->hashtable[index].lock == si->hash.lock && ((int)si->hashtable[index].color==(color>>1)))
 		{
 			// here's the only difference to the normal hashlookup!
-			hashtable[index].ispvnode=1;
+			si->hashtable[index].ispvnode=1;
 
 			/* move ordering */
-			*forcefirst=hashtable[index].best;
+			*forcefirst=si->hashtable[index].best;
 			/* use value if depth in hashtable >= current depth)*/
-			if((int)hashtable[index].depth>=depth)
+			if((int)si->hashtable[index].depth>=depth)
 			{
-				*value=hashtable[index].value;
-				*valuetype=hashtable[index].valuetype;
+				*value=si->hashtable[index].value;
+				*valuetype=si->hashtable[index].valuetype;
 #ifdef THREADSAFEHT
 				LeaveCriticalSection(&hash_access);
 #endif				
@@ -2208,7 +2276,7 @@ void countmaterial(POSITION *p, MATERIALCOUNT *m)
 
 // TODO: put this into book.c
 
-int booklookup(POSITION *p, int *value, int depth, int32 *remainingdepth, int *best, char str[256])
+int booklookup(SEARCHINFO *si, POSITION *p, int *value, int depth, int32 *remainingdepth, int *best, char str[256])
 {
 	/* searches for a position in the book hashtable.
 	*/
@@ -2388,7 +2456,9 @@ int booklookup(POSITION *p, int *value, int depth, int32 *remainingdepth, int *b
 			if(bookmoves !=0)
 			{
 				//srand( (unsigned)time( NULL ) );
-				i = rand() % bookmoves;
+				// the same generator as rand(), but with a seed per search
+				si->randseed = si->randseed*1103515245 + 12345;
+				i = ((si->randseed>>16) & 0x7FFF) % bookmoves;
 				*remainingdepth = depths[i];
 				*value = values[i];
 				*best = indices[i];
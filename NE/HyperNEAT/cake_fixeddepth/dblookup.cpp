@@ -79,6 +79,11 @@ typedef long long int int64;
 
 #include "dblookup.h"
 
+#ifdef DBMMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 
 
 
@@ -161,6 +166,16 @@ static int maxblockid = 0;  // maximal unique block id, set by initlookup after
 static FILE *dbfp[MAXFP]; // file pointers to db2...dbn - always open.
 static char dbnames[MAXFP][256]; // write in here what each dbfp is pointing to
 
+#ifdef DBMMAP
+// with DBMMAP every db file is mapped read-only as a whole, and there is no LRU cache.
+// the mapping is shared, so all threads and processes that use the same db files
+// look up blocks in the same pages of the page cache. dblookup only reads, so it can
+// be called from several threads at the same time.
+static unsigned char *dbmap[MAXFP]; // start of the mapped db file, NULL if it is not mapped
+static int64 dbmapsize[MAXFP];      // size of the mapped db file in bytes
+static void mapdbfile(int n);
+#endif
+
 // database path
 char DBpath[256];
 
@@ -199,14 +214,18 @@ int dblookup(POSITION *q,int cl)
 	int32 bmindex=0,bkindex=0,wmindex=0,wkindex=0;
 	int32 bmrange=1, wmrange=1, bkrange=1;
 	int blocknumber;	
+#ifndef DBMMAP
 	int uniqueblockid;
+#endif
 	//int index512 = 0;
 
 	int reverse = 0;
 	int returnvalue=DB_UNKNOWN;
 	int memsize = 0;
 	unsigned char *diskblock;
+#ifndef DBMMAP
 	int newhead,prev, next;
+#endif
 
 	int n;
 	int n1,n2,n3;
@@ -293,8 +312,13 @@ int dblookup(POSITION *q,int cl)
 	// are stuffed into single files; db6.cpr for instance. if MAXPIECES/MAXPIECE
 	// were different during generation and in this code, then it is possible that
 	// there are slices which this code thinks are present, but in fact, they are not!
+#ifdef DBMMAP
+	if(dbpointer->ispresent == 0 || (dbmap[dbpointer->fp] == NULL))
+		return DB_UNKNOWN;
+#else
 	if(dbpointer->ispresent == 0 || (dbfp[dbpointer->fp] == NULL))
 		return DB_UNKNOWN;
+#endif
 	// check if the db contains only a single value
 	if(dbpointer->value != DB_UNKNOWN)
 		return dbpointer->value;
@@ -429,12 +453,20 @@ int dblookup(POSITION *q,int cl)
 		}
 
 	// we now have the blocknumber inside the database slice in which the position is located.
+
+#ifdef DBMMAP
+	// the block is in the mapped file, the page cache takes the place of the LRU cache.
+	// a conditional lookup (cl==1) can cause a page fault here, there is no cheap way
+	// to tell whether the block is in memory.
+	if((int64)(blocknumber+dbpointer->firstblock)*1024 >= dbmapsize[dbpointer->fp])
+		return DB_UNKNOWN;
+	diskblock = dbmap[dbpointer->fp] + (int64)(blocknumber+dbpointer->firstblock)*1024;
+#else
 	// get the unique number which identifies this block
 	uniqueblockid = dbpointer->blockoffset+
 					dbpointer->firstblock +
 					blocknumber;
 
-
 	// check if it is loaded:
 	if(blockpointer[uniqueblockid] != NULL)
 		//yes!
@@ -535,6 +567,7 @@ int dblookup(POSITION *q,int cl)
 	printf("\nblock with ID %i, loaded to address %i",uniqueblockid,diskblock);
 #endif
 		}
+#endif // DBMMAP
 	// the block we were looking for is now pointed to by diskblock
 	// and it has been moved to the head of the linked list
 	// now we decompress the memory block
@@ -792,6 +825,15 @@ int db_exit(void)
     free(cachebaseaddress);
     free(blockpointer);
     free(blockinfo);
+
+#ifdef DBMMAP
+	for(i=0;i<MAXFP;i++)
+		{
+		if(dbmap[i] != NULL)
+			munmap(dbmap[i], dbmapsize[i]);
+		dbmap[i] = NULL;
+		}
+#endif
 	
 	for(i=0;i<50;i++)
 		{
@@ -817,11 +859,15 @@ int db_init(int suggestedMB, char out[256])
 	int bm,bk,wm,wk;
 	int singlevalue=0;
 	int blockoffset = 0;
+#ifndef DBMMAP
 	int autoloadnum = 0;
+#endif
 	int fpcount = 0;
 	int pifreturnvalue;
 	int pieces=0;
+#ifndef DBMMAP
 	int memsize;
+#endif
 	char str[256];
 
 
@@ -1082,6 +1128,10 @@ int db_init(int suggestedMB, char out[256])
 	// index files are parsed!
 	
 	
+#ifdef DBMMAP
+	// no cache, the db files are mapped below
+	cachesize = 0;
+#else
 	// allocate memory for the cache
 	memsize = cachesize*1024;
 	//cachebaseaddress = VirtualAlloc(0,memsize,MEM_RESERVE|MEM_COMMIT|MEM_TOP_DOWN,PAGE_READWRITE);
@@ -1166,6 +1216,7 @@ int db_init(int suggestedMB, char out[256])
 	
 	head=autoloadnum; //0
 	tail = cachesize-1;
+#endif // DBMMAP
 
 
 
@@ -1183,6 +1234,9 @@ int db_init(int suggestedMB, char out[256])
 			//getch();
 			//exit(0);
 			}
+#ifdef DBMMAP
+		mapdbfile(fpcount);
+#endif
 		fpcount++;
 		}
 
@@ -1211,6 +1265,9 @@ int db_init(int suggestedMB, char out[256])
 						//getch();
 						//exit(0);
 						}
+#ifdef DBMMAP
+					mapdbfile(fpcount);
+#endif
 					fpcount++;
 					}
 				}
@@ -1220,6 +1277,32 @@ int db_init(int suggestedMB, char out[256])
 	return maxpieces;
 	}
 
+#ifdef DBMMAP
+static void mapdbfile(int n)
+	{
+	// maps the db file dbfp[n] read-only. leaves dbmap[n] NULL if that fails.
+	struct stat st;
+	void *address;
+
+	dbmap[n] = NULL;
+	dbmapsize[n] = 0;
+	if(dbfp[n] == NULL)
+		return;
+	if(fstat(fileno(dbfp[n]), &st) != 0 || st.st_size == 0)
+		return;
+	address = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fileno(dbfp[n]), 0);
+	if(address == MAP_FAILED)
+		{
+		printf("\ncould not map %s",dbnames[n]);
+		return;
+		}
+	// lookups jump around in the file, reading ahead only wastes memory
+	madvise(address, st.st_size, MADV_RANDOM);
+	dbmap[n] = (unsigned char*)address;
+	dbmapsize[n] = st.st_size;
+	}
+#endif
+
 #ifdef PRELOAD
 static int preload(char out[256])
 	{
@@ -9,6 +9,11 @@
 
 #define PRELOAD // preload (parts) of db in cache? 
 
+#ifdef SYS_UNIX
+#define DBMMAP // map the db files read-only instead of loading blocks into a private cache
+#undef PRELOAD // nothing to preload without the cache
+#endif
+
 #define AUTOLOADSIZE 0
 
 #define DB_BLACK 0
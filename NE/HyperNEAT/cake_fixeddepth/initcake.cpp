@@ -99,11 +99,12 @@ int initbitoperations(unsigned char bitsinword[65536], unsigned char LSBarray[25
 }
 
 
-HASHENTRY *inithashtable(int hashsize)
+HASHENTRY *inithashtable(int hashsize, char **memory)
 	{
 	// allocate memory for the hashtable. 
 	// align the hashtable on a 64-byte-boundary
 	// terminate program if hashtable cannot be allocated.
+	// if memory is not NULL, the unaligned pointer is written to it so the table can be freed.
 	char Lstr[256];
 	unsigned long long int i;
 	HASHENTRY *ptr;
@@ -125,6 +126,9 @@ HASHENTRY *inithashtable(int hashsize)
 		exit(0);
 		}
 
+	if(memory != NULL)
+		*memory = (char*)ptr;
+
 	// TODO: the code below generates warnings - can i do that suomehow without warnings?
 	// we have a hashtable, now align it on a 64-bit-boundary:
 	i = (unsigned long long int)ptr;
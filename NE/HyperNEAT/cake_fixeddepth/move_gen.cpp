@@ -279,8 +279,6 @@ void CheckersCommon_printBoard(uchar b[8][8])
     }
 }
 
-CheckersAdvisor *checkersAdvisor = NULL;
-
 int makemovelist(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES],int values[MAXMOVES], int bestindex, int32 killer)
 {
 
@@ -548,14 +546,14 @@ int makemovelist(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES],int v
 			}
 		}
 
-        if(checkersAdvisor && si->realdepth>2)
+        if(si->advisor && si->realdepth>2)
         {
             float advisorMoveValue[MAXMOVES];
 
 			unsigned char fromB[8][8];
 			ucharbitboardtoboard(*p,fromB);
 
-            checkersAdvisor->setBoardPosition(fromB);
+            si->advisor->setBoardPosition(fromB);
 
             for(int a=0;a<int(n);a++)
             {
@@ -571,7 +569,7 @@ int makemovelist(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES],int v
                 int destX,destY;
                 CheckersCommon_getDestination(fromB,p->color,toB,destX,destY);
 
-                advisorMoveValue[a] = checkersAdvisor->getBoardValue(destX,destY);
+                advisorMoveValue[a] = si->advisor->getBoardValue(destX,destY);
             }
 
             for(int a=0;a<int(n);a++)
@@ -859,14 +857,14 @@ int makemovelist(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES],int v
 			}
 		}
 
-        if(checkersAdvisor && si->realdepth>2)
+        if(si->advisor && si->realdepth>2)
         {
             float advisorMoveValue[MAXMOVES];
 
 			unsigned char fromB[8][8];
 			ucharbitboardtoboard(*p,fromB);
 
-            checkersAdvisor->setBoardPosition(fromB);
+            si->advisor->setBoardPosition(fromB);
 
             for(int a=0;a<int(n);a++)
             {
@@ -882,7 +880,7 @@ int makemovelist(SEARCHINFO *si, POSITION *p, CAKE_MOVE movelist[MAXMOVES],int v
                 int destX,destY;
                 CheckersCommon_getDestination(fromB,p->color,toB,destX,destY);
 
-                advisorMoveValue[a] = checkersAdvisor->getBoardValue(destX,destY);
+                advisorMoveValue[a] = si->advisor->getBoardValue(destX,destY);
             }
 
             for(int a=0;a<int(n);a++)
@@ -930,10 +928,6 @@ void blackorderevaluation(SEARCHINFO *si, POSITION *p,CAKE_MOVE ml[MAXMOVES],int
 	//	eval += (blackbackrankeval[p->bm & 0xFF] - whitebackrankeval[p->wm >> 24]); //2!!
 
 
-#ifdef MOHISTORY
-	extern int32 history[32][32]; /*has entries for how often a move was good */
-	//extern SEARCHINFO si;        /* is the number of entries in history list */
-#endif
 	
 	black = p->bm|p->bk;
 
@@ -947,7 +941,7 @@ void blackorderevaluation(SEARCHINFO *si, POSITION *p,CAKE_MOVE ml[MAXMOVES],int
 #ifdef MOHISTORY
 		/* history...*/
 		if(si->hashstores>MINHASH) 
-			eval+=( (HISTORY*history[LSB(from)][LSB(to)]) / (si->hashstores));  // vtune: if is loopindependent - take out
+			eval+=( (HISTORY*si->history[LSB(from)][LSB(to)]) / (si->hashstores));  // vtune: if is loopindependent - take out
 #endif
 
 #ifdef MOSTATIC
@@ -1076,7 +1070,6 @@ void whiteorderevaluation(SEARCHINFO *si, POSITION *p,CAKE_MOVE ml[MAXMOVES],int
 	int32 white;
 	int i;
 
-	extern int32 history[32][32];
 	//extern SEARCHINFO si;
 	extern char whitebackrankeval[256];
 	
@@ -1092,7 +1085,7 @@ void whiteorderevaluation(SEARCHINFO *si, POSITION *p,CAKE_MOVE ml[MAXMOVES],int
 #ifdef MOHISTORY
 		/* history...*/
 		if(si->hashstores > MINHASH)
-			eval+=( (HISTORY*history[LSB(from)][LSB(to)]) / (si->hashstores));
+			eval+=( (HISTORY*si->history[LSB(from)][LSB(to)]) / (si->hashstores));
 #endif
 
 #ifdef MOSTATIC
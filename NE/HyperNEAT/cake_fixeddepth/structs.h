@@ -50,6 +50,18 @@ typedef struct
 	int32 lock;
 	} HASH;
 
+typedef struct
+// struct hashentry needs 8 bytes 
+	{
+	int32  lock;
+	unsigned int best:6;
+	int value:12;
+	unsigned int color:1;
+	unsigned int ispvnode:1;
+	unsigned int depth:10;
+	unsigned int valuetype:2;
+	} HASHENTRY;
+
 typedef struct
 	{
 	int32 hash;
@@ -92,6 +104,17 @@ typedef struct
 	double start;
 	double maxtime;
 	double aborttime;
+	// the tables below belong to one search. cake_initsearchinfo allocates them, so
+	// that every thread can search with its own SEARCHINFO at the same time.
+	// resetsearchinfo leaves them alone, like repcheck.
+	HASHENTRY *hashtable;	// the hashtable of this search
+	int hashsize;			// number of entries in the hashtable, a power of 2
+	int32 (*history)[32];	// history table for move ordering
+	int *iscapture;			// tells whether move at realdepth was a capture
+	int norefresh;
+	unsigned int randseed;	// picks among equal book moves, see booklookup
+	char *hashmemory;		// unaligned hashtable memory, NULL if the tables are not owned
+	class CheckersAdvisor *advisor;	// orders moves deeper than 2 ply if not NULL
 	} SEARCHINFO;
 
 
@@ -171,17 +194,7 @@ typedef struct
 	} KINGINFO;
 
 
-typedef struct
-// struct hashentry needs 8 bytes 
-	{
-	int32  lock;
-	unsigned int best:6;
-	int value:12;
-	unsigned int color:1;
-	unsigned int ispvnode:1;
-	unsigned int depth:10;
-	unsigned int valuetype:2;
-	} HASHENTRY;
+
 
 
 
@@ -49,83 +49,55 @@ maxGeneration            = args.g
 resultsDir               = args.r
 individualsPerGeneration = args.n
 
-# TODO: Check if there exists a .bak file. If so convert to a normal generational file
+# Restore generations left behind by the file based generator and drop partially written ones
 for f in os.listdir(resultsDir):
-    if f.startswith('generation') and (f.endswith('.bak') or f.endswith('.tmp')):
-        j = os.path.join(resultsDir,f)
+    j = os.path.join(resultsDir,f)
+    if f.startswith('generation') and f.endswith('.bak'):
         subprocess.check_call(["mv", j, j[0:-4]])
+    elif f.startswith('generation') and f.endswith('.tmp'):
+        os.remove(j)
 
-currentGeneration = util.getCurrentGen(resultsDir)
-
-# Generate the first generation if not present
-if currentGeneration < 0:
-        currentGeneration = 0
-        os.system("echo Starting Generation Production... >> " + os.path.join(resultsDir,"nohup.out"))
-        os.system("date >> " + os.path.join(resultsDir,"nohup.out"))
+# Workers must not connect to the address of a previous coordinator
+coordinatorFile = os.path.join(resultsDir,'coordinator')
+if os.path.exists(coordinatorFile):
+    os.remove(coordinatorFile)
 
-        cmd = "./" + executable + \
-        " -R " + str(seed) + \
-        " -I " + dataFile + \
-        " -O " + os.path.join(resultsDir,"generation0.ser.gz") + \
-        " -G " + rom + " >> " + os.path.join(resultsDir,"nohup.out")
-        os.system(cmd)
-        os.system("date >> " + os.path.join(resultsDir,"nohup.out"))
-        os.system("echo Generation Production Done. >> " + os.path.join(resultsDir,"nohup.out"))
+currentGeneration = util.getCurrentGen(resultsDir)
+if currentGeneration >= maxGeneration:
+    sys.exit(0)
+
+# atari_generate runs as the evaluation coordinator for the rest of the run:
+# it writes each generation, leases its individuals to the workers and
+# produces the next generation as soon as the last fitness comes back.
+cmd = ["./" + executable,
+       "-I", dataFile,
+       "-R", str(seed),
+       "-O", resultsDir,
+       "-G", rom,
+       "-S", "0",
+       "-g", str(maxGeneration)]
+if currentGeneration >= 0:
+    cmd += ["-P", os.path.join(resultsDir,"generation"+str(currentGeneration)+".ser.gz")]
+
+log = open(os.path.join(resultsDir,"nohup.out"),'a')
+log.write('Starting Coordinator...\n')
+log.flush()
+coordinator = subprocess.Popen(cmd, stdout=log, stderr=subprocess.STDOUT)
+atexit.register(lambda: coordinator.poll() is None and coordinator.kill())
 
 lastHeardFromMaster = time.time()
 timeout_secs = 300
 
-while currentGeneration < maxGeneration:
-    print 'Starting Generation', currentGeneration
-
-    # Loop until all fitness files for current generation are present
-    individualIds = range(individualsPerGeneration)
-    while individualIds:
-        for individualId in list(individualIds):
-            fitnessFile = "fitness."+str(currentGeneration)+"."+str(individualId)
-            fitnessPath = os.path.join(resultsDir,fitnessFile)
-            if os.path.exists(fitnessPath):
-                individualIds.remove(individualId)
-        if os.path.exists(os.path.join(resultsDir,'master_alive')):
-            os.remove(os.path.join(resultsDir,'master_alive'))
-            lastHeardFromMaster = time.time()
-        if time.time() - lastHeardFromMaster >= timeout_secs:
-            sys.stderr.write('Havent heard from master... quitting\n')
-            sys.stderr.flush()
-            sys.exit(0)
-        time.sleep(5)
-
-    # Create next generation
-    currGenFile = os.path.join(resultsDir,"generation"+str(currentGeneration)+".ser.gz")
-    nextGenFile = os.path.join(resultsDir,"generation"+str(currentGeneration+1)+".ser.gz")
-    tmpCurrGen  = currGenFile + ".bak"
-    tmpNextGen  = nextGenFile + ".tmp"
-
-    # Current gen gets moved to tmp file
-    subprocess.check_call(["mv", currGenFile, tmpCurrGen])
-
-    os.system("echo Starting Generation Production... >> " + os.path.join(resultsDir,"nohup.out"))
-    os.system("date >> " + os.path.join(resultsDir,"nohup.out"))
-    # Create the actual next generation. This may take a while...
-    fitnessRoot = os.path.join(resultsDir,"fitness." + str(currentGeneration)+".")
-    cmd = "./" + executable + \
-    " -I " + dataFile + \
-    " -R " + str(seed) + \
-    " -O " + tmpNextGen + \
-    " -P " + tmpCurrGen + \
-    " -F " + fitnessRoot + \
-    " -G " + rom + " >> " + os.path.join(resultsDir,"nohup.out")
-    os.system(cmd)
-    os.system("date >> " + os.path.join(resultsDir,"nohup.out"))
-    os.system("echo Generation Production Done. >> " + os.path.join(resultsDir,"nohup.out"))
-
-    # Move the temp next gen file to the actual one.
-    # This is necessary to keep workers from trying to read the
-    # next gen file as it was being written.
-    subprocess.check_call(["mv", tmpNextGen, nextGenFile])
-
-    # Delete current generation file
-    # Schrum: Useful to comment the below sometimes for troubleshooting
-    os.remove(tmpCurrGen)
-
-    currentGeneration += 1
+while coordinator.poll() is None:
+    if os.path.exists(os.path.join(resultsDir,'master_alive')):
+        os.remove(os.path.join(resultsDir,'master_alive'))
+        lastHeardFromMaster = time.time()
+    if time.time() - lastHeardFromMaster >= timeout_secs:
+        sys.stderr.write('Havent heard from master... quitting\n')
+        sys.stderr.flush()
+        sys.exit(0)
+    time.sleep(5)
+
+if coordinator.returncode != 0:
+    sys.stderr.write('Coordinator exited with status ' + str(coordinator.returncode) + '\n')
+    sys.stderr.flush()
@@ -0,0 +1,67 @@
+#!/usr/bin/python
+
+# Reads the telemetry log written by atari_evaluate -L. See
+# HCUBE_EvaluationTelemetry.h for the format.
+
+from __future__ import print_function
+
+import sys, struct
+
+MAGIC = 0x4C544E48
+VERSION = 2
+
+# Column name, struct format character, first version with the column
+COLUMNS = [('generation','i',1), ('individual','i',1), ('seed','I',1), ('frames','i',1), ('score','f',1),
+           ('substrateUsec','q',1), ('networkUsec','q',1), ('emulationUsec','q',1), ('visProcUsec','q',1),
+           ('episodeEnd','i',2)]
+
+# Returns a dictionary from column name to a list with the values of every record
+def readTelemetry(fileName):
+    columns = dict((name, []) for name, code, version in COLUMNS)
+    f = open(fileName,'rb')
+    while True:
+        header = f.read(16)
+        if len(header) < 16:
+            break
+        magic, version, numRecords, numBytes = struct.unpack('=IIII', header)
+        if magic != MAGIC or version > VERSION:
+            raise IOError('Bad telemetry chunk in ' + fileName)
+        for name, code, firstVersion in COLUMNS:
+            if version >= firstVersion:
+                # The array module of Python 2 has no 64-bit typecode, so the columns go through struct
+                format = '=%d%s' % (numRecords, code)
+                data = f.read(struct.calcsize(format))
+                if len(data) < struct.calcsize(format):
+                    raise IOError('Truncated telemetry chunk in ' + fileName)
+                columns[name].extend(struct.unpack(format, data))
+            else:
+                columns[name].extend([0] * numRecords)
+    f.close()
+    return columns
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        print('Usage:',sys.argv[0],'telemetry.bin')
+        sys.exit(0)
+
+    columns = readTelemetry(sys.argv[1])
+
+    # Per generation: evaluations, mean score, mean frames, where the time went in seconds
+    # and the number of evaluations with an episode that was stopped early
+    generations = {}
+    for i in range(len(columns['generation'])):
+        g = generations.setdefault(columns['generation'][i], [0, 0.0, 0, 0, 0, 0, 0, 0])
+        g[0] += 1
+        g[1] += columns['score'][i]
+        g[2] += columns['frames'][i]
+        g[3] += columns['substrateUsec'][i]
+        g[4] += columns['networkUsec'][i]
+        g[5] += columns['emulationUsec'][i]
+        g[6] += columns['visProcUsec'][i]
+        if columns['episodeEnd'][i] != 0:
+            g[7] += 1
+
+    print('generation evaluations score frames substrate network emulation visproc stopped')
+    for gen in sorted(generations):
+        n, score, frames, substrate, network, emulation, visProc, stopped = generations[gen]
+        print(gen, n, score / n, float(frames) / n, substrate / 1e6, network / 1e6, emulation / 1e6, visProc / 1e6, stopped)
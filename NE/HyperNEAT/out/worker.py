@@ -26,11 +26,11 @@
 
 import argparse, os, random, time, sys, util
 
-# This runs a single Atari game.
-def run_game(executable, dataFile, generationFile, individualId, fitnessFile, seed, rom):
+# This evaluates individuals leased from the coordinator until the run is over.
+def run_games(executable, dataFile, coordinatorAddress, seed, rom):
     from subprocess import check_call
-    check_call(["./" + executable, "-I", dataFile, "-P", generationFile, "-N",
-                     str(individualId), "-F", fitnessFile, "-R", seed, "-G", rom])
+    check_call(["./" + executable, "-I", dataFile, "-C", coordinatorAddress,
+                     "-R", seed, "-G", rom])
                     
 parser = argparse.ArgumentParser(description='Runs Atari games without tire.')
 parser.add_argument('-e', metavar='atari_evaulate', required=True,
@@ -56,42 +56,17 @@ dataFile                 = args.d
 maxGeneration            = args.g
 resultsDir               = args.r
 individualsPerGeneration = args.n
-timeout_secs = 1
+timeout_secs = 300
 
-# Detect the current generation
-currentGeneration = util.getCurrentGen(resultsDir)
-if currentGeneration < 0:
-        sys.stderr.write('Did not find any generation files! Exiting.\n')
+# Wait for the generator to start the coordinator and publish its address
+coordinatorFile = os.path.join(resultsDir,'coordinator')
+start = time.time()
+while not os.path.exists(coordinatorFile):
+    if time.time() - start >= timeout_secs:
+        sys.stderr.write('Reached timeout waiting for the coordinator... quitting\n')
         sys.stderr.flush()
         sys.exit(0)
+    time.sleep(5)
 
-while currentGeneration < maxGeneration:
-    # Wait until we see a generation file for the current generation
-    generationFile = "generation" + str(currentGeneration) + ".ser.gz"
-    generationPath = os.path.join(resultsDir,generationFile)
-
-    start = time.time()
-    while not os.path.exists(generationPath):
-        time.sleep(5)
-        if time.time() - start >= timeout_secs:
-            sys.stderr.write('Reached timeout waiting for new generation... quitting\n')
-            sys.stderr.flush()
-            sys.exit(0)
-
-    # Look for fitness files which indicate that games are being run
-    individualIds = range(individualsPerGeneration)
-    random.shuffle(individualIds)
-    for individualId in individualIds:
-        # Break out of this loop if the generation has ended
-        nextGenPath = os.path.join(resultsDir,"generation" + str(currentGeneration+1) + ".ser.gz")
-        if os.path.exists(nextGenPath): 
-            break
-        fitnessFile = "fitness."+str(currentGeneration)+"."+str(individualId)
-        fitnessPath = os.path.join(resultsDir,fitnessFile)
-        if os.path.exists(fitnessPath):
-            continue
-
-        run_game(executable, dataFile, generationPath, individualId, fitnessPath, seed, rom)
-
-    # By this time all fitness evaluations should be complete
-    currentGeneration += 1
+host, port = open(coordinatorFile).read().split()
+run_games(executable, dataFile, host + ":" + port, seed, rom)
@@ -3,6 +3,7 @@
 
 #include <fstream>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include "emucore/m6502/src/bspf/src/bspf.hxx"
 #include "emucore/Console.hxx"
@@ -18,6 +19,7 @@
 #include "common/Constants.h"
 #include "common/Defaults.hpp"
 #include "common/visual_processor.h"
+#include "common/screen_preprocessor.h"
 #include "games/RomSettings.hpp"
 #include "games/Roms.hpp"
 #include "agents/PlayerAgent.hpp"
@@ -53,7 +55,8 @@ public:
     VisualProcessor* visProc;
 
     int screen_width, screen_height;  // Dimensions of the screen
-    IntMatrix screen_matrix;     // This contains the raw pixel representation of the screen
+    vector<uInt8> screen_buffer; // Palette-indexed pixels of the screen, row-major
+    IntMatrix screen_matrix;     // Copy of screen_buffer for the display, only kept when display_active
     IntVect ram_content;         // This contains the ram content of the Atari
 
     int frame;                   // Current frame number
@@ -67,10 +70,22 @@ public:
     bool process_screen;         // Should visual processing be performed or not
     ofstream *trajFile;          // Trajectory file
 
+    // Per-stage timing of act(), only accumulated when profile_stages is set
+    bool profile_stages;         // Should act() time its individual stages
+    long emulation_usec;         // Time spent applying actions and running the emulator
+    long screen_usec;            // Time spent copying the frame buffer and ram
+    long vis_proc_usec;          // Time spent in the visual processor
+
 public:
     ALEInterface(): theOSystem(NULL), game_controller(NULL), mediasrc(NULL), emulator_system(NULL),
                     game_settings(NULL), frame(0), max_num_frames(-1),
-                    game_score(0), display_active(false), process_screen(false), trajFile(NULL) {
+                    game_score(0), display_active(false), process_screen(false), trajFile(NULL),
+                    profile_stages(false), emulation_usec(0), screen_usec(0), vis_proc_usec(0) {
+    }
+
+    // Clears the accumulated stage timers
+    void reset_stage_timers() {
+        emulation_usec = screen_usec = vis_proc_usec = 0;
     }
 
     ~ALEInterface() {
@@ -86,8 +101,8 @@ public:
     bool loadROM(string rom_file, bool display_screen, bool process_screen) {
         display_active = display_screen;
         this->process_screen = process_screen;
-        int argc = 8;
-        char** argv = new char*[argc];
+        int argc = display_screen ? 8 : 10;
+        char** argv = new char*[argc+1];
         for (int i=0; i<=argc; i++) {
             argv[i] = new char[200];
         }
@@ -100,7 +115,12 @@ public:
         strcpy(argv[5],"-process_screen");
         if (process_screen) strcpy(argv[6],"true");
         else                strcpy(argv[6],"false");
-        strcpy(argv[7],rom_file.c_str());  
+        if (!display_screen) {
+            // Only the interactive display looks at past frames
+            strcpy(argv[7],"-vis_history_len");
+            strcpy(argv[8],"0");
+        }
+        strcpy(argv[argc-1],rom_file.c_str());  
 
         cout << welcomeMessage() << endl;
     
@@ -168,11 +188,15 @@ public:
         mediasrc = &theOSystem->console().mediaSource();
         screen_width = mediasrc->width();
         screen_height = mediasrc->height();
-        for (int i=0; i<screen_height; ++i) { // Initialize our screen matrix
-            IntVect row;
-            for (int j=0; j<screen_width; ++j)
-                row.push_back(-1);
-            screen_matrix.push_back(row);
+        screen_buffer.assign(screen_width * screen_height, 0);
+        if (display_active) {
+            screen_matrix.clear();
+            for (int i=0; i<screen_height; ++i) { // Initialize our screen matrix
+                IntVect row;
+                for (int j=0; j<screen_width; ++j)
+                    row.push_back(-1);
+                screen_matrix.push_back(row);
+            }
         }
 
         // Intialize the ram array
@@ -191,6 +215,20 @@ public:
         return true;
     }
 
+    // Copies the latest frame buffer into screen_buffer (and screen_matrix if displaying)
+    void update_screen() {
+        const uInt8* pi_curr_frame_buffer = mediasrc->currentFrameBuffer();
+        memcpy(&screen_buffer[0], pi_curr_frame_buffer, screen_width * screen_height);
+        if (display_active) {
+            for (int i = 0; i < screen_height; i++) {
+                const uInt8* row = pi_curr_frame_buffer + i * screen_width;
+                IntVect& matrix_row = screen_matrix[i];
+                for (int j = 0; j < screen_width; j++)
+                    matrix_row[j] = row[j];
+            }
+        }
+    }
+
     // Resets the game
     void reset_game() {
         game_controller->systemReset();
@@ -200,14 +238,7 @@ public:
         
         // Get the first screen
         mediasrc->update();
-        int ind_i, ind_j;
-        uInt8* pi_curr_frame_buffer = mediasrc->currentFrameBuffer();
-        for (int i = 0; i < screen_width * screen_height; i++) {
-            uInt8 v = pi_curr_frame_buffer[i];
-            ind_i = i / screen_width;
-            ind_j = i - (ind_i * screen_width);
-            screen_matrix[ind_i][ind_j] = v;
-        }
+        update_screen();
 
         // Get the first ram content
         for(int i = 0; i<RAM_LENGTH; i++) {
@@ -240,20 +271,19 @@ public:
     float act(Action action) {
         frame++;
         float action_reward = 0;
+        uInt32 stage_start = profile_stages ? theOSystem->getTicks() : 0;
             
         // Apply action to simulator and update the simulator
         game_controller->getState()->apply_action(action, PLAYER_B_NOOP);
 
         // Get the latest screen
         mediasrc->update();
-        int ind_i, ind_j;
-        uInt8* pi_curr_frame_buffer = mediasrc->currentFrameBuffer();
-        for (int i = 0; i < screen_width * screen_height; i++) {
-            uInt8 v = pi_curr_frame_buffer[i];
-            ind_i = i / screen_width;
-            ind_j = i - (ind_i * screen_width);
-            screen_matrix[ind_i][ind_j] = v;
+        if (profile_stages) {
+            uInt32 now = theOSystem->getTicks();
+            emulation_usec += now - stage_start;
+            stage_start = now;
         }
+        update_screen();
 
         // Get the latest ram content
         for(int i = 0; i<RAM_LENGTH; i++) {
@@ -261,6 +291,8 @@ public:
             offset &= 0x7f; // there are only 128 bytes
             ram_content[i] = emulator_system->peek(offset + 0x80);
         }
+        if (profile_stages)
+            screen_usec += theOSystem->getTicks() - stage_start;
 
         // Get the reward
         game_settings->step(*emulator_system);
@@ -279,7 +311,10 @@ public:
         }
 
         if (process_screen) {
+            if (profile_stages) stage_start = theOSystem->getTicks();
             theOSystem->p_vis_proc->process_image(*mediasrc, action);
+            if (profile_stages)
+                vis_proc_usec += theOSystem->getTicks() - stage_start;
         }
 
         if (trajFile != NULL && trajFile->is_open())
@@ -0,0 +1,302 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2012 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  ale_benchmark.cpp
+ *
+ *  Throughput and regression benchmark. Every supported rom found in a local
+ *  rom directory is played with a fixed no-op trace and a seeded random trace.
+ *  For each trace we report frames/sec, the time spent in the emulator, in
+ *  copying the screen and in the visual processor, and a checksum of the final
+ *  ram and score so that emulator changes can be checked for bit-exactness.
+ *  Roms run in forked worker processes, one per core by default.
+ **************************************************************************** */
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "../ale_interface.hpp"
+#include "../emucore/Random.hxx"
+#include "../common/misc_tools.h"
+
+/* Results of playing one action trace */
+struct TraceResult {
+    int frames;           // Number of frames emulated
+    int episodes;         // Number of episodes started
+    float score;          // Summed score over all episodes
+    long total_usec;      // Wall time spent in act()
+    long emulation_usec;  // Time spent in the emulator
+    long screen_usec;     // Time spent copying screen and ram
+    long vis_proc_usec;   // Time spent in the visual processor
+    uInt32 checksum;      // Hash of final ram, frame and score
+};
+
+/* Results for one rom, sent from a worker back to the parent through a pipe */
+struct RomResult {
+    bool loaded;
+    TraceResult noop;
+    TraceResult random;
+};
+
+struct BenchmarkConfig {
+    string rom_dir;
+    int frames;
+    int seed;
+    int jobs;
+    bool process_screen;
+};
+
+/* FNV-1a hash of a block of memory */
+static uInt32 fnvHash(uInt32 hash, const void* data, size_t len) {
+    const unsigned char* bytes = (const unsigned char*) data;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/* Small xorshift generator so the random trace does not depend on libc rand() */
+static uInt32 nextRandom(uInt32& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+/* Plays frames steps of either the no-op or the seeded random trace */
+static TraceResult runTrace(ALEInterface& ale, const BenchmarkConfig& config, bool random_actions) {
+    TraceResult result;
+    memset(&result, 0, sizeof(result));
+
+    uInt32 rng_state = 2463534242u ^ (uInt32) config.seed;
+    ActionVect& actions = ale.minimal_actions;
+
+    ale.reset_game();
+    ale.reset_stage_timers();
+    result.episodes = 1;
+
+    uInt32 start = ale.theOSystem->getTicks();
+    for (int i = 0; i < config.frames; i++) {
+        if (ale.game_over()) {
+            ale.reset_game();
+            result.episodes++;
+        }
+        Action a = PLAYER_A_NOOP;
+        if (random_actions)
+            a = actions[nextRandom(rng_state) % actions.size()];
+        result.score += ale.act(a);
+        result.frames++;
+    }
+    result.total_usec = ale.theOSystem->getTicks() - start;
+    result.emulation_usec = ale.emulation_usec;
+    result.screen_usec = ale.screen_usec;
+    result.vis_proc_usec = ale.vis_proc_usec;
+
+    uInt32 hash = 2166136261u;
+    for (int i = 0; i < RAM_LENGTH; i++) {
+        unsigned char byte = (unsigned char) ale.ram_content[i];
+        hash = fnvHash(hash, &byte, 1);
+    }
+    hash = fnvHash(hash, &ale.frame, sizeof(ale.frame));
+    hash = fnvHash(hash, &result.score, sizeof(result.score));
+    result.checksum = hash;
+    return result;
+}
+
+/* Worker body: benchmarks one rom and writes a RomResult to fd.
+   Returns false if the result could not be delivered to the parent. */
+static bool benchmarkRom(const string& rom, const BenchmarkConfig& config, int fd) {
+    RomResult result;
+    memset(&result, 0, sizeof(result));
+
+    // Keep the emulator's chatter out of the report
+    if (freopen("/dev/null", "w", stdout) == NULL) {
+        perror("freopen");
+        close(fd);
+        return false;
+    }
+
+    // Seed the emulator before it creates the console so power-on state is fixed
+    Random::seed((uInt32) config.seed);
+
+    string rom_file = config.rom_dir + "/" + rom + ".bin";
+    ALEInterface ale;
+    result.loaded = ale.loadROM(rom_file, false, config.process_screen);
+    if (result.loaded) {
+        srand((unsigned) config.seed);
+        ale.profile_stages = true;
+        result.noop = runTrace(ale, config, false);
+        result.random = runTrace(ale, config, true);
+    }
+
+    bool sent = write(fd, &result, sizeof(result)) == (ssize_t) sizeof(result);
+    if (!sent) perror("write");
+    close(fd);
+    return sent;
+}
+
+static void printTrace(const string& rom, const char* trace, const TraceResult& r) {
+    double secs = r.total_usec / 1e6;
+    double fps = secs > 0 ? r.frames / secs : 0;
+    printf("%-18s %-6s %7d %4d %9.0f %9.1f %9.1f %9.1f %9.1f  %08x\n",
+           rom.c_str(), trace, r.frames, r.episodes, r.score, fps,
+           r.emulation_usec / 1000.0, r.screen_usec / 1000.0, r.vis_proc_usec / 1000.0,
+           r.checksum);
+}
+
+/* Reads "rom trace ... checksum" lines from a previous report */
+static map<string, uInt32> loadReference(const string& filename) {
+    map<string, uInt32> checksums;
+    ifstream in(filename.c_str());
+    string line;
+    while (getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        istringstream iss(line);
+        string rom, trace, field, last;
+        iss >> rom >> trace;
+        while (iss >> field) last = field;
+        if (last.empty()) continue;
+        checksums[rom + " " + trace] = (uInt32) strtoul(last.c_str(), NULL, 16);
+    }
+    return checksums;
+}
+
+static void usage() {
+    cerr << "Usage: ale_benchmark -rom_dir DIR [-frames N] [-seed S] [-jobs J]" << endl
+         << "                     [-process_screen true|false] [-roms a,b,...] [-check REPORT]" << endl;
+}
+
+int main(int argc, char** argv) {
+    BenchmarkConfig config;
+    config.frames = 5000;
+    config.seed = 0;
+    config.jobs = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    config.process_screen = false;
+    string rom_filter, reference_file;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) { usage(); return 2; }
+        string value = argv[++i];
+        if (arg == "-rom_dir")             config.rom_dir = value;
+        else if (arg == "-frames")         config.frames = atoi(value.c_str());
+        else if (arg == "-seed")           config.seed = atoi(value.c_str());
+        else if (arg == "-jobs")           config.jobs = atoi(value.c_str());
+        else if (arg == "-process_screen") config.process_screen = (value == "true");
+        else if (arg == "-roms")           rom_filter = "," + value + ",";
+        else if (arg == "-check")          reference_file = value;
+        else { usage(); return 2; }
+    }
+    if (config.rom_dir.empty()) { usage(); return 2; }
+    if (config.jobs < 1) config.jobs = 1;
+
+    // Only benchmark roms that have a settings class and a local image
+    vector<string> roms;
+    vector<string> supported = getSupportedRoms();
+    for (size_t i = 0; i < supported.size(); i++) {
+        const string& rom = supported[i];
+        if (!rom_filter.empty() && rom_filter.find("," + rom + ",") == string::npos) continue;
+        string rom_file = config.rom_dir + "/" + rom + ".bin";
+        if (!FilesystemNode::fileExists(rom_file)) {
+            cerr << "Skipping " << rom << ": " << rom_file << " not found" << endl;
+            continue;
+        }
+        roms.push_back(rom);
+    }
+
+    fflush(stdout);
+    fflush(stderr);
+
+    // Fork up to config.jobs workers at a time, one per rom
+    map<pid_t, pair<size_t, int> > running;
+    vector<RomResult> results(roms.size());
+    vector<bool> finished(roms.size(), false);
+    size_t next_rom = 0;
+    long wall_start = timeMillis();
+    while (next_rom < roms.size() || !running.empty()) {
+        while (next_rom < roms.size() && (int) running.size() < config.jobs) {
+            int fds[2];
+            if (pipe(fds) != 0) { perror("pipe"); return 1; }
+            pid_t pid = fork();
+            if (pid < 0) { perror("fork"); return 1; }
+            if (pid == 0) {
+                close(fds[0]);
+                _exit(benchmarkRom(roms[next_rom], config, fds[1]) ? 0 : 1);
+            }
+            close(fds[1]);
+            running[pid] = make_pair(next_rom, fds[0]);
+            next_rom++;
+        }
+
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) break;
+        map<pid_t, pair<size_t, int> >::iterator it = running.find(pid);
+        if (it == running.end()) continue;
+        size_t index = it->second.first;
+        int fd = it->second.second;
+        RomResult& result = results[index];
+        if (read(fd, &result, sizeof(result)) == (ssize_t) sizeof(result) &&
+            WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+            finished[index] = true;
+        }
+        close(fd);
+        running.erase(it);
+    }
+    long wall_ms = timeMillis() - wall_start;
+
+    // Report
+    map<string, uInt32> reference;
+    if (!reference_file.empty()) reference = loadReference(reference_file);
+
+    printf("# frames=%d seed=%d jobs=%d process_screen=%s\n", config.frames, config.seed,
+           config.jobs, config.process_screen ? "true" : "false");
+    printf("# %-16s %-6s %7s %4s %9s %9s %9s %9s %9s  %s\n", "rom", "trace", "frames", "eps",
+           "score", "fps", "emu_ms", "screen_ms", "vis_ms", "checksum");
+
+    int failures = 0, mismatches = 0;
+    long total_frames = 0, total_usec = 0;
+    for (size_t i = 0; i < roms.size(); i++) {
+        if (!finished[i] || !results[i].loaded) {
+            printf("# %s FAILED\n", roms[i].c_str());
+            failures++;
+            continue;
+        }
+        const TraceResult* traces[2] = { &results[i].noop, &results[i].random };
+        const char* names[2] = { "noop", "random" };
+        for (int t = 0; t < 2; t++) {
+            printTrace(roms[i], names[t], *traces[t]);
+            total_frames += traces[t]->frames;
+            total_usec += traces[t]->total_usec;
+            if (!reference.empty()) {
+                map<string, uInt32>::iterator ref = reference.find(roms[i] + " " + names[t]);
+                if (ref != reference.end() && ref->second != traces[t]->checksum) {
+                    printf("# %s %s MISMATCH: expected %08x\n", roms[i].c_str(), names[t], ref->second);
+                    mismatches++;
+                }
+            }
+        }
+    }
+
+    printf("# %d roms, %ld frames, %.1f frames/sec per core, %.1f frames/sec aggregate\n",
+           (int) roms.size() - failures, total_frames,
+           total_usec > 0 ? total_frames / (total_usec / 1e6) : 0.0,
+           wall_ms > 0 ? total_frames / (wall_ms / 1e3) : 0.0);
+    if (!reference.empty())
+        printf("# %d checksum mismatches\n", mismatches);
+
+    return (failures > 0 || mismatches > 0) ? 1 : 0;
+}
@@ -39,4 +39,5 @@ void setDefaultSettings(Settings &settings) {
 
     // Visual Processing Setting
     settings.setBool("process_screen", false);
+    settings.setInt("vis_history_len", 50);
 }
@@ -7,6 +7,7 @@ MODULE_OBJS := \
 	src/common/Constants.o \
 	src/common/Defaults.o \
 	src/common/visual_processor.o \
+	src/common/screen_preprocessor.o \
 
 MODULE_DIRS += \
 	src/common
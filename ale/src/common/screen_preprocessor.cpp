@@ -0,0 +1,173 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2012 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  screen_preprocessor.cpp
+ *
+ *  Implementation of the ScreenPreprocessor. Atari screens are made of long
+ *  horizontal runs of one color, so pixels are counted run by run: SSE2 compares
+ *  sixteen pixels at a time to find where a run ends, and each run adds its
+ *  length to a single cell. Counts are converted to floats four at a time.
+ **************************************************************************** */
+#include <cstring>
+#include <algorithm>
+#include "screen_preprocessor.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define SCREEN_PREPROCESSOR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Number of leading pixels equal to the first one, given a 16 bit compare mask
+static inline int leading_matches(int mask) {
+    int inverted = ~mask & 0xFFFF;
+    if (inverted == 0) return 16;
+#ifdef __GNUC__
+    return __builtin_ctz(inverted);
+#else
+    int n = 0;
+    while (!(inverted & 1)) { inverted >>= 1; n++; }
+    return n;
+#endif
+}
+
+ScreenPreprocessor::ScreenPreprocessor() :
+    screen_width(0), screen_height(0), grid_width(0), grid_height(0), num_cells(0),
+    num_planes(0), have_prev(false)
+{
+    memset(plane_map, 0, sizeof(plane_map));
+}
+
+ScreenPreprocessor::ScreenPreprocessor(int _screen_width, int _screen_height,
+                                       int _grid_width, int _grid_height,
+                                       const uInt8* _plane_map, int _num_planes) :
+    screen_width(_screen_width), screen_height(_screen_height),
+    grid_width(_grid_width), grid_height(_grid_height), num_cells(_grid_width * _grid_height),
+    num_planes(_num_planes), have_prev(false)
+{
+    assert(grid_width > 0 && grid_height > 0);
+    assert(grid_width <= screen_width && grid_height <= screen_height);
+    for (int i=0; i<256; i++) {
+        assert(_plane_map[i] < num_planes);
+        plane_map[i] = _plane_map[i];
+    }
+
+    col_cell.resize(screen_width);
+    col_cell_end.resize(screen_width);
+    for (int x=0; x<screen_width; x++)
+        col_cell[x] = x * grid_width / screen_width;
+    for (int x=screen_width-1; x>=0; x--) {
+        if (x == screen_width-1 || col_cell[x+1] != col_cell[x])
+            col_cell_end[x] = x + 1;
+        else
+            col_cell_end[x] = col_cell_end[x+1];
+    }
+
+    row_cell.resize(screen_height);
+    for (int y=0; y<screen_height; y++)
+        row_cell[y] = (y * grid_height / screen_height) * grid_width;
+
+    // The area of each cell is the product of its column and row extents
+    vector<int> cols_per_cell(grid_width, 0), rows_per_cell(grid_height, 0);
+    for (int x=0; x<screen_width; x++) cols_per_cell[col_cell[x]]++;
+    for (int y=0; y<screen_height; y++) rows_per_cell[row_cell[y] / grid_width]++;
+    cell_scale.resize(num_cells);
+    for (int gy=0; gy<grid_height; gy++)
+        for (int gx=0; gx<grid_width; gx++)
+            cell_scale[gy*grid_width + gx] = 1.0f / (cols_per_cell[gx] * rows_per_cell[gy]);
+
+    plane_counts.resize(num_planes * num_cells);
+    curr_planes.resize(num_planes * num_cells);
+    prev_planes.resize(num_planes * num_cells);
+}
+
+void ScreenPreprocessor::reset() {
+    have_prev = false;
+}
+
+void ScreenPreprocessor::process(const uInt8* frame, float* const* planes,
+                                 PoolingMode mode, bool pool_frames) {
+    count_pixels(frame);
+
+    for (int p=0; p<num_planes; p++) {
+        const int* counts = &plane_counts[p * num_cells];
+        if (!pool_frames) {
+            pool_plane(counts, planes[p], mode);
+            continue;
+        }
+        float* curr = &curr_planes[p * num_cells];
+        pool_plane(counts, curr, mode);
+        if (have_prev)
+            max_pool(curr, &prev_planes[p * num_cells], planes[p], num_cells);
+        else
+            memcpy(planes[p], curr, sizeof(float) * num_cells);
+    }
+
+    if (pool_frames) {
+        curr_planes.swap(prev_planes);
+        have_prev = true;
+    }
+}
+
+void ScreenPreprocessor::count_pixels(const uInt8* frame) {
+    memset(&plane_counts[0], 0, sizeof(int) * plane_counts.size());
+
+    for (int y=0; y<screen_height; y++) {
+        const uInt8* row = frame + y * screen_width;
+        int* row_counts = &plane_counts[row_cell[y]];
+        int x = 0;
+        while (x < screen_width) {
+            uInt8 color = row[x];
+            int end = col_cell_end[x];
+            int run = x + 1;
+#ifdef SCREEN_PREPROCESSOR_SSE2
+            __m128i broadcast = _mm_set1_epi8((char) color);
+            while (run + 16 <= end) {
+                __m128i pixels = _mm_loadu_si128((const __m128i*) (row + run));
+                int matches = leading_matches(_mm_movemask_epi8(_mm_cmpeq_epi8(pixels, broadcast)));
+                run += matches;
+                if (matches < 16) break;
+            }
+#endif
+            while (run < end && row[run] == color) run++;
+            row_counts[plane_map[color] * num_cells + col_cell[x]] += run - x;
+            x = run;
+        }
+    }
+}
+
+void ScreenPreprocessor::pool_plane(const int* counts, float* out, PoolingMode mode) {
+    int i = 0;
+#ifdef SCREEN_PREPROCESSOR_SSE2
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 <= num_cells; i += 4) {
+        __m128 c = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*) (counts + i)));
+        if (mode == POOL_MAX)
+            _mm_storeu_ps(out + i, _mm_min_ps(c, one));
+        else
+            _mm_storeu_ps(out + i, _mm_mul_ps(c, _mm_loadu_ps(&cell_scale[i])));
+    }
+#endif
+    for (; i < num_cells; i++) {
+        if (mode == POOL_MAX)
+            out[i] = counts[i] > 0 ? 1.0f : 0.0f;
+        else
+            out[i] = counts[i] * cell_scale[i];
+    }
+}
+
+void ScreenPreprocessor::max_pool(const float* a, const float* b, float* out, int n) {
+    int i = 0;
+#ifdef SCREEN_PREPROCESSOR_SSE2
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, _mm_max_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#endif
+    for (; i < n; i++)
+        out[i] = std::max(a[i], b[i]);
+}
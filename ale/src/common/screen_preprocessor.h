@@ -0,0 +1,72 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2012 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  screen_preprocessor.h
+ *
+ *  Turns the palette-indexed frame buffer into pixel input for a learner. The
+ *  screen is decomposed into one-hot palette planes, each plane is pooled down
+ *  to an arbitrary grid and the result is written into caller-provided float
+ *  buffers, one per plane, laid out row-major like a substrate input layer.
+ **************************************************************************** */
+#ifndef SCREEN_PREPROCESSOR_H
+#define SCREEN_PREPROCESSOR_H
+
+#include "Constants.h"
+
+class ScreenPreprocessor {
+public:
+    enum PoolingMode {
+        POOL_MAX,  // A cell is 1 if any of its pixels belongs to the plane
+        POOL_AREA  // A cell holds the fraction of its pixels that belong to the plane
+    };
+
+    ScreenPreprocessor();
+
+    // plane_map gives the plane index (< num_planes) of each of the 256 colors
+    ScreenPreprocessor(int screen_width, int screen_height, int grid_width, int grid_height,
+                       const uInt8* plane_map, int num_planes);
+
+    // Pools the frame into planes[0..num_planes-1], each holding grid_width*grid_height
+    // floats. If pool_frames is set, every cell is max-pooled with the previous frame.
+    void process(const uInt8* frame, float* const* planes, PoolingMode mode, bool pool_frames);
+
+    // Forgets the previous frame used for frame pooling. Call at the start of an episode.
+    void reset();
+
+    int get_grid_width() const { return grid_width; }
+    int get_grid_height() const { return grid_height; }
+    int get_num_planes() const { return num_planes; }
+
+protected:
+    // Counts the pixels of each plane in each cell into plane_counts
+    void count_pixels(const uInt8* frame);
+
+    // Converts the counts of one plane into pooled values
+    void pool_plane(const int* counts, float* out, PoolingMode mode);
+
+    // out[i] = max(a[i], b[i])
+    static void max_pool(const float* a, const float* b, float* out, int n);
+
+    int screen_width, screen_height;
+    int grid_width, grid_height, num_cells;
+    int num_planes;
+    uInt8 plane_map[256];
+
+    vector<int> col_cell;      // Grid column of each screen column
+    vector<int> col_cell_end;  // First screen column past the grid cell of each screen column
+    vector<int> row_cell;      // Offset of the grid row of each screen row
+    vector<float> cell_scale;  // 1 / number of pixels in each cell
+    vector<int> plane_counts;  // Pixel counts, num_planes * num_cells
+    vector<float> curr_planes; // Unpooled output of the current frame
+    vector<float> prev_planes; // Unpooled output of the previous frame
+    bool have_prev;
+};
+
+#endif
@@ -12,6 +12,11 @@
 #include "../emucore/m6502/src/System.hxx"
 #include "../games/Roms.hpp"
 #include <limits>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sstream>
 #include <omp.h>
 #include <boost/lexical_cast.hpp>
@@ -253,34 +258,95 @@ long Blob::find_matching_blob(map<long,Blob>& blobs) {
     return best_match_id;
 };
 
-void Blob::to_string(bool verbose, deque<map<long,Blob> >* blob_hist) {
+void Blob::to_string(bool verbose, const VisualHistory* history) {
     printf("Blob: %p BB: (%d,%d)->(%d,%d) Size: %d Col: %d\n",this,x_min,y_min,x_max,y_max,
            mask.size,color);
 
     if (verbose) {
         mask.to_string();
         
-        if (blob_hist != NULL) {
+        if (history != NULL) {
             printf("Velocity History: \n");
-            Blob* b = this;
             // Get the velocity history of this blob
-            int blob_history_len = 1;
-            while (b->parent_id >= 0 && blob_history_len < blob_hist->size()) {
-                // Push back the velocity
-                pair<int,int> vel(b->x_velocity, b->y_velocity);
-                printf("Age %d Blob %ld Vel (%d,%d)\n", blob_history_len-1, b->id, b->x_velocity, b->y_velocity);
-                blob_history_len++;
-
+            printf("Age %d Blob %ld Vel (%d,%d)\n", 0, id, x_velocity, y_velocity);
+            long parent = parent_id;
+            for (int age=1; parent >= 0 && age < history->size(); ++age) {
                 // Get the parent
-                map<long,Blob>& old_blobs = (*blob_hist)[blob_hist->size() - blob_history_len];
-                long parent_id = b->parent_id;
-                assert(old_blobs.find(parent_id) != old_blobs.end());
-                b = &old_blobs[parent_id];
+                const BlobRecord* b = history->find_blob(age, parent);
+                assert(b != NULL);
+                printf("Age %d Blob %ld Vel (%d,%d)\n", age, b->id, b->x_velocity, b->y_velocity);
+                parent = b->parent_id;
             }
         }
     }
 };
 
+BlobRecord::BlobRecord(const Blob& b) :
+    id(b.id), parent_id(b.parent_id), color(b.color),
+    x_min(b.x_min), x_max(b.x_max), y_min(b.y_min), y_max(b.y_max),
+    x_velocity(b.x_velocity), y_velocity(b.y_velocity), size(b.mask.size)
+{};
+
+VisualHistory::VisualHistory() :
+    history_len(0), num_frames(0), newest(0), screen_width(0), screen_height(0)
+{};
+
+void VisualHistory::set_max_len(int max_len, int _screen_width, int _screen_height) {
+    history_len = max(0, max_len);
+    screen_width = _screen_width;
+    screen_height = _screen_height;
+    num_frames = 0;
+    newest = 0;
+    screens.assign(history_len * screen_width * screen_height, 0);
+    actions.assign(history_len, PLAYER_A_NOOP);
+    blobs.assign(history_len, vector<BlobRecord>());
+    for (int i=0; i<history_len; ++i)
+        blobs[i].reserve(256);
+};
+
+void VisualHistory::add_frame(const IntMatrix& screen, Action action, const map<long,Blob>& frame_blobs) {
+    if (history_len == 0)
+        return;
+
+    newest = (newest + 1) % history_len;
+    num_frames = min(num_frames + 1, history_len);
+
+    uInt8* pixels = &screens[newest * screen_width * screen_height];
+    for (int i=0; i<screen_height; ++i) {
+        const IntVect& row = screen[i];
+        for (int j=0; j<screen_width; ++j)
+            *pixels++ = uInt8(row[j]);
+    }
+
+    actions[newest] = action;
+
+    // The map is ordered by id, so the records come out sorted
+    vector<BlobRecord>& records = blobs[newest];
+    records.clear();
+    for (map<long,Blob>::const_iterator it=frame_blobs.begin(); it!=frame_blobs.end(); ++it)
+        records.push_back(BlobRecord(it->second));
+};
+
+void VisualHistory::get_screen(int age, IntMatrix& screen) const {
+    const uInt8* pixels = &screens[slot(age) * screen_width * screen_height];
+    screen.resize(screen_height);
+    for (int i=0; i<screen_height; ++i) {
+        screen[i].resize(screen_width);
+        for (int j=0; j<screen_width; ++j)
+            screen[i][j] = *pixels++;
+    }
+};
+
+const BlobRecord* VisualHistory::find_blob(int age, long id) const {
+    const vector<BlobRecord>& records = get_blobs(age);
+    BlobRecord key;
+    key.id = id;
+    vector<BlobRecord>::const_iterator it = lower_bound(records.begin(), records.end(), key);
+    if (it == records.end() || it->id != id)
+        return NULL;
+    return &(*it);
+};
+
 CompositeObject::CompositeObject() {
     id = -1;
     frames_since_last_movement = 0;
@@ -431,6 +497,278 @@ void Prototype::find_matching_objects(float similarity_threshold, map<long,Compo
     }
 };
 
+PrototypeIndex::PrototypeIndex() :
+    header(NULL), proto_entries(NULL), mask_entries(NULL), buckets(NULL), bucket_masks(NULL),
+    words(NULL), image_size(0), mapping(NULL), mapping_size(0)
+{};
+
+PrototypeIndex::~PrototypeIndex() {
+    clear();
+};
+
+void PrototypeIndex::clear() {
+    header = NULL;
+    proto_entries = NULL;
+    mask_entries = NULL;
+    buckets = NULL;
+    bucket_masks = NULL;
+    words = NULL;
+    image_size = 0;
+    owned_image.clear();
+    if (mapping != NULL) {
+        munmap(mapping, mapping_size);
+        mapping = NULL;
+        mapping_size = 0;
+    }
+    indexed_protos.clear();
+};
+
+// Orders buckets by mask size
+static bool bucket_less(const PrototypeIndex::Bucket& a, const PrototypeIndex::Bucket& b) {
+    return a.width < b.width || (a.width == b.width && a.height < b.height);
+};
+
+void PrototypeIndex::build(const vector<Prototype*>& prototypes) {
+    clear();
+
+    // Number the masks in prototype order and group them by size
+    vector<ProtoEntry> protos;
+    vector<MaskEntry> masks;
+    vector<const PixelMask*> mask_data;
+    map<pair<int,int>,vector<Int32> > size_groups;
+    for (int i=0; i<int(prototypes.size()); ++i) {
+        ProtoEntry proto;
+        proto.first_mask = masks.size();
+        proto.num_masks = prototypes[i]->masks.size();
+        protos.push_back(proto);
+        for (int j=0; j<int(prototypes[i]->masks.size()); ++j) {
+            const PixelMask& pixel_mask = prototypes[i]->masks[j];
+            MaskEntry mask;
+            mask.proto = i;
+            mask.width = pixel_mask.width;
+            mask.height = pixel_mask.height;
+            mask.size = pixel_mask.size;
+            mask.num_bytes = pixel_mask.pixel_mask.size();
+            mask.first_word = 0;
+            size_groups[make_pair(mask.width, mask.height)].push_back(masks.size());
+            masks.push_back(mask);
+            mask_data.push_back(&pixel_mask);
+        }
+    }
+
+    // Lay the words out bucket by bucket so a lookup reads one contiguous block
+    vector<Bucket> bucket_list;
+    vector<Int32> bucket_mask_list;
+    int num_words = 0;
+    for (map<pair<int,int>,vector<Int32> >::iterator it=size_groups.begin(); it!=size_groups.end(); ++it) {
+        Bucket bucket;
+        bucket.width = it->first.first;
+        bucket.height = it->first.second;
+        bucket.first_entry = bucket_mask_list.size();
+        bucket.num_entries = it->second.size();
+        bucket_list.push_back(bucket);
+        for (int i=0; i<int(it->second.size()); ++i) {
+            MaskEntry& mask = masks[it->second[i]];
+            mask.first_word = num_words;
+            num_words += get_num_words(mask.num_bytes);
+            bucket_mask_list.push_back(it->second[i]);
+        }
+    }
+
+    Header image_header;
+    image_header.magic = PROTOTYPE_LIBRARY_MAGIC;
+    image_header.version = PROTOTYPE_LIBRARY_VERSION;
+    image_header.num_protos = protos.size();
+    image_header.num_masks = masks.size();
+    image_header.num_buckets = bucket_list.size();
+    image_header.num_words = num_words;
+
+    size_t protos_offset  = align(sizeof(Header));
+    size_t masks_offset   = align(protos_offset + protos.size() * sizeof(ProtoEntry));
+    size_t buckets_offset = align(masks_offset + masks.size() * sizeof(MaskEntry));
+    size_t entries_offset = align(buckets_offset + bucket_list.size() * sizeof(Bucket));
+    size_t words_offset   = align(entries_offset + bucket_mask_list.size() * sizeof(Int32));
+    size_t total_size     = words_offset + num_words * sizeof(unsigned long long);
+
+    owned_image.assign(total_size / sizeof(unsigned long long), 0);
+    char* image = (char*) &owned_image[0];
+    memcpy(image, &image_header, sizeof(Header));
+    if (!protos.empty())
+        memcpy(image + protos_offset, &protos[0], protos.size() * sizeof(ProtoEntry));
+    if (!masks.empty())
+        memcpy(image + masks_offset, &masks[0], masks.size() * sizeof(MaskEntry));
+    if (!bucket_list.empty())
+        memcpy(image + buckets_offset, &bucket_list[0], bucket_list.size() * sizeof(Bucket));
+    if (!bucket_mask_list.empty())
+        memcpy(image + entries_offset, &bucket_mask_list[0], bucket_mask_list.size() * sizeof(Int32));
+
+    // Overlap only needs the same bits in the same places of both masks, so
+    // the mask bytes are copied as they are
+    for (int i=0; i<int(masks.size()); ++i) {
+        if (masks[i].num_bytes > 0)
+            memcpy(image + words_offset + masks[i].first_word * sizeof(unsigned long long),
+                   &mask_data[i]->pixel_mask[0], masks[i].num_bytes);
+    }
+
+    bool valid = set_image(image, total_size);
+    assert(valid);
+    indexed_protos = prototypes;
+};
+
+bool PrototypeIndex::set_image(const char* image, size_t size) {
+    if (size < sizeof(Header))
+        return false;
+    const Header* h = (const Header*) image;
+    if (h->magic != PROTOTYPE_LIBRARY_MAGIC || h->version != PROTOTYPE_LIBRARY_VERSION ||
+        h->num_protos < 0 || h->num_masks < 0 || h->num_buckets < 0 || h->num_words < 0)
+        return false;
+
+    size_t protos_offset  = align(sizeof(Header));
+    size_t masks_offset   = align(protos_offset + h->num_protos * sizeof(ProtoEntry));
+    size_t buckets_offset = align(masks_offset + h->num_masks * sizeof(MaskEntry));
+    size_t entries_offset = align(buckets_offset + h->num_buckets * sizeof(Bucket));
+    size_t words_offset   = align(entries_offset + h->num_masks * sizeof(Int32));
+    if (words_offset + h->num_words * sizeof(unsigned long long) != size)
+        return false;
+
+    // Every table entry is checked once here, so lookups can use them unchecked
+    const ProtoEntry* protos = (const ProtoEntry*) (image + protos_offset);
+    const MaskEntry* masks = (const MaskEntry*) (image + masks_offset);
+    const Bucket* bucket_list = (const Bucket*) (image + buckets_offset);
+    const Int32* bucket_mask_list = (const Int32*) (image + entries_offset);
+    for (int i=0; i<h->num_protos; ++i) {
+        if (protos[i].first_mask < 0 || protos[i].num_masks < 0 ||
+            (long long) protos[i].first_mask + protos[i].num_masks > h->num_masks)
+            return false;
+    }
+    for (int i=0; i<h->num_masks; ++i) {
+        const MaskEntry& mask = masks[i];
+        if (mask.proto < 0 || mask.proto >= h->num_protos ||
+            mask.num_bytes < 0 || mask.first_word < 0 ||
+            (long long) mask.first_word + ((long long) mask.num_bytes + 7) / 8 > h->num_words)
+            return false;
+        if (bucket_mask_list[i] < 0 || bucket_mask_list[i] >= h->num_masks)
+            return false;
+    }
+    for (int i=0; i<h->num_buckets; ++i) {
+        if (bucket_list[i].first_entry < 0 || bucket_list[i].num_entries < 0 ||
+            (long long) bucket_list[i].first_entry + bucket_list[i].num_entries > h->num_masks)
+            return false;
+        // Lookups binary search the buckets by size
+        if (i > 0 && !bucket_less(bucket_list[i-1], bucket_list[i]))
+            return false;
+    }
+
+    header = h;
+    proto_entries = protos;
+    mask_entries = masks;
+    buckets = bucket_list;
+    bucket_masks = bucket_mask_list;
+    words = (const unsigned long long*) (image + words_offset);
+    image_size = size;
+    return true;
+};
+
+bool PrototypeIndex::map_library(const string& filename) {
+    clear();
+
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* address = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED)
+        return false;
+
+    mapping = address;
+    mapping_size = st.st_size;
+    // A library always holds the self prototype
+    if (!set_image((const char*) mapping, mapping_size) || get_num_protos() < 1) {
+        printf("Invalid prototype library: %s\n", filename.c_str());
+        clear();
+        return false;
+    }
+    return true;
+};
+
+bool PrototypeIndex::save_library(const string& filename) const {
+    if (header == NULL)
+        return false;
+
+    string tmp_filename = filename + ".tmp";
+    ofstream out(tmp_filename.c_str(), ios_base::binary);
+    if (!out)
+        return false;
+    out.write((const char*) header, image_size);
+    out.close();
+    if (!out || rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        remove(tmp_filename.c_str());
+        return false;
+    }
+    return true;
+};
+
+void PrototypeIndex::attach_prototypes(const vector<Prototype*>& prototypes) {
+    assert(int(prototypes.size()) == get_num_protos());
+    indexed_protos = prototypes;
+    for (int i=0; i<get_num_protos(); ++i) {
+        Prototype& proto = *prototypes[i];
+        proto.masks.clear();
+        for (int j=0; j<proto_entries[i].num_masks; ++j) {
+            const MaskEntry& mask = mask_entries[proto_entries[i].first_mask + j];
+            PixelMask pixel_mask;
+            pixel_mask.width = mask.width;
+            pixel_mask.height = mask.height;
+            pixel_mask.size = mask.size;
+            const char* bytes = (const char*) &words[mask.first_word];
+            pixel_mask.pixel_mask.assign(bytes, bytes + mask.num_bytes);
+            proto.masks.push_back(pixel_mask);
+        }
+    }
+};
+
+void PrototypeIndex::find_matching_objects(float similarity_threshold, map<long,CompositeObject>& obj_map) {
+    for (int i=0; i<int(indexed_protos.size()); ++i)
+        indexed_protos[i]->obj_ids.clear();
+    if (header == NULL)
+        return;
+
+    const Bucket* buckets_end = buckets + header->num_buckets;
+    for (map<long,CompositeObject>::iterator it=obj_map.begin(); it!=obj_map.end(); it++) {
+        CompositeObject& obj = it->second;
+        Bucket key;
+        key.width = obj.mask.width;
+        key.height = obj.mask.height;
+        const Bucket* bucket = lower_bound(buckets, buckets_end, key, bucket_less);
+        if (bucket == buckets_end || bucket->width != key.width || bucket->height != key.height)
+            continue;
+
+        int num_bytes = obj.mask.pixel_mask.size();
+        int num_words = get_num_words(num_bytes);
+        obj_words.assign(num_words, 0);
+        if (num_bytes > 0)
+            memcpy(&obj_words[0], &obj.mask.pixel_mask[0], num_bytes);
+
+        for (int i=0; i<bucket->num_entries; ++i) {
+            const MaskEntry& mask = mask_entries[bucket_masks[bucket->first_entry + i]];
+            if (mask.num_bytes != num_bytes)
+                continue;
+            const unsigned long long* mask_words = &words[mask.first_word];
+            int overlap = 0;
+            for (int w=0; w<num_words; ++w)
+                overlap += count_ones64(mask_words[w] & obj_words[w]);
+            // Same test as Prototype::get_pixel_match
+            if (overlap / (float) mask.size >= similarity_threshold)
+                indexed_protos[mask.proto]->obj_ids.insert(obj.id);
+        }
+    }
+};
+
 void Prototype::to_string(bool verbose) {
     printf("Prototype %ld: num_obj_instances %d num_masks %d self_likelihood %f\n",
            id, int(obj_ids.size()), int(masks.size()), self_likelihood);
@@ -446,7 +784,7 @@ void Prototype::to_string(bool verbose) {
 VisualProcessor::VisualProcessor(OSystem* _osystem, string myRomFile) : 
     p_osystem(_osystem),
     game_settings(NULL),
-    max_history_len(50), //numeric_limits<int>::max()),
+    frames_processed(0),
     blob_ids(0), obj_ids(0), proto_ids(0),
     self_id(-1),
     focused_entity_id(-1), focus_level(-1), display_mode(0), display_self(false),
@@ -467,26 +805,23 @@ VisualProcessor::VisualProcessor(OSystem* _osystem, string myRomFile) :
         screen_matrix.push_back(row);
     }
 
-    // Load up saved self images
+    int history_len = p_osystem->settings().getInt("vis_history_len");
+    set_history_len(history_len < 0 ? 50 : history_len);
+
+    // Use the compiled prototype library of the rom if there is one, it is
+    // shared with every other process on the machine
     using namespace boost::filesystem;
     path p(IMAGE_FILENAME);
     string rom_name = game_settings->rom();
-    p /= rom_name;
-    p /= SELF_IMAGE_DIR;
-    loadPrototype(p, SELF_IMAGE_PREFIX, SELF_IMAGE_SUFFIX, manual_self);
-    p = p.parent_path();
-
-    // Load saved prototype images
-    for (int protoNum=1; ; protoNum++) {
-        p /= CLASS_IMAGE_DIR + boost::lexical_cast<std::string>(protoNum);
-        if (exists(p) && is_directory(p)) {
-            Prototype proto;
-            loadPrototype(p, CLASS_IMAGE_PREFIX, CLASS_IMAGE_SUFFIX, proto);
-            manual_obj_classes.push_back(proto);
-            p = p.parent_path();
-        } else {
-            break;
-        }
+    path library_path = p / (rom_name + PROTOTYPE_LIBRARY_SUFFIX);
+    if (manual_proto_index.map_library(library_path.string())) {
+        printf("Loaded prototype library: %s\n", library_path.string().c_str());
+        manual_obj_classes.resize(manual_proto_index.get_num_protos() - 1);
+        manual_proto_index.attach_prototypes(get_manual_prototypes());
+    } else {
+        // Load up saved self and prototype images
+        loadPrototypeImages(p / rom_name, manual_self, manual_obj_classes);
+        build_prototype_index();
     }
 
     // Register ourselves as an event handler if a screen is present
@@ -507,11 +842,18 @@ void VisualProcessor::process_image(const MediaSource& mediaSrc, Action action)
     process_image(&screen_matrix, action);
 };
 
+void VisualProcessor::set_history_len(int len) {
+    history.set_max_len(len, screen_width, screen_height);
+};
+
 void VisualProcessor::process_image(const IntMatrix* screen_matrix, Action action) {
+    // The blobs of the last frame are kept for matching, everything older is
+    // only in the history
+    prev_blobs.swap(curr_blobs);
     curr_blobs.clear();
     find_connected_components(*screen_matrix, curr_blobs);
 
-    if (blob_hist.size() > 1) {
+    if (frames_processed > 1) {
         find_blob_matches(curr_blobs);
 
         // Merge blobs into objects
@@ -524,26 +866,15 @@ void VisualProcessor::process_image(const IntMatrix* screen_matrix, Action actio
         // Merge objects into classes
         //merge_objects(.96);
 
-        // Identify which object we are
+        // Identify which object we are and assign objects to the saved obj
+        // class files
         // identify_self();
-        manual_self.find_matching_objects(.99, composite_objs);
-
-        // Assign objects to the saved obj class files
-        for (int i=0; i<manual_obj_classes.size(); ++i)
-            manual_obj_classes[i].find_matching_objects(.99, composite_objs);
+        manual_proto_index.find_matching_objects(.99, composite_objs);
     }
 
     // Save State and action history
-    blob_hist.push_back(curr_blobs);
-    screen_hist.push_back(*screen_matrix);
-    action_hist.push_back(action);
-    assert(action_hist.size() == screen_hist.size());
-    assert(action_hist.size() == blob_hist.size());  
-    while (action_hist.size() > max_history_len) {
-        action_hist.pop_front();
-        screen_hist.pop_front();
-        blob_hist.pop_front();
-    }
+    history.add_frame(*screen_matrix, action, curr_blobs);
+    frames_processed++;
 };
 
 void VisualProcessor::find_connected_components(const IntMatrix& screen_matrix, map<long,Blob>& blob_map) {
@@ -699,7 +1030,7 @@ void VisualProcessor::find_connected_components(const IntMatrix& screen_matrix,
 void VisualProcessor::find_blob_matches(map<long,Blob>& blobs) {
 #ifdef MUNKRES
     // Solve blob matching via Hungarian algorithm. Better matches but more time.
-    map<long,Blob>& old_blobs = blob_hist.back();
+    map<long,Blob>& old_blobs = prev_blobs;
     int width = max(old_blobs.size(), blobs.size());
     Matrix<double> matrix(width, width);
     int old_blob_cnt = 0;
@@ -744,7 +1075,7 @@ void VisualProcessor::find_blob_matches(map<long,Blob>& blobs) {
     }
 #else
     // Do greedy (fast) blob matching
-    map<long,Blob>& old_blobs = blob_hist.back();
+    map<long,Blob>& old_blobs = prev_blobs;
     for (map<long,Blob>::iterator it=blobs.begin(); it!=blobs.end(); ++it) {
         Blob& b = it->second;
         long blob_match_id = b.find_matching_blob(old_blobs);
@@ -763,7 +1094,7 @@ void VisualProcessor::update_existing_objs() {
     set<long> used_blob_ids; // A blob becomes used when it is integrated into an existing object
     set<long> new_blob_ids; // Blobs who have children in the current timestep
     vector<long> to_remove;
-    map<long,Blob>& old_blobs = blob_hist.back();
+    map<long,Blob>& old_blobs = prev_blobs;
 
     for (map<long,CompositeObject>::iterator it=composite_objs.begin(); it!=composite_objs.end(); it++) {
         CompositeObject& obj = it->second;
@@ -1065,6 +1396,18 @@ point VisualProcessor::get_self_centroid() {
     return composite_objs[obj_id].get_centroid();
 };
 
+vector<Prototype*> VisualProcessor::get_manual_prototypes() {
+    vector<Prototype*> prototypes;
+    prototypes.push_back(&manual_self);
+    for (int i=0; i<manual_obj_classes.size(); ++i)
+        prototypes.push_back(&manual_obj_classes[i]);
+    return prototypes;
+};
+
+void VisualProcessor::build_prototype_index() {
+    manual_proto_index.build(get_manual_prototypes());
+};
+
 bool VisualProcessor::found_self() {
     return manual_self.obj_ids.size() >= 1;
 }
@@ -1161,19 +1504,18 @@ void VisualProcessor::printVelHistory(CompositeObject& obj) {
         assert(curr_blobs.find(b_id) != curr_blobs.end());
         Blob* b = &curr_blobs[b_id];
         printf("Blob %ld: ",b_id);
-        // Get the velocity history of this blob
-        int blob_history_len = 1;
-        while (b->parent_id >= 0 && blob_history_len < max_history_len) {
-            // Push back the velocity
-            pair<int,int> vel(b->x_velocity, b->y_velocity);
-            blob_history_len++;
-            string action_name = action_to_string(action_hist[action_hist.size() - blob_history_len]);
-            printf("%s (%d,%d)\n",action_name.c_str(), b->x_velocity, b->y_velocity);
+        // Get the velocity history of this blob, with the action taken before each frame
+        long parent = b->parent_id;
+        int x_velocity = b->x_velocity, y_velocity = b->y_velocity;
+        for (int age=1; parent >= 0 && age < history.size(); ++age) {
+            string action_name = action_to_string(history.get_action(age));
+            printf("%s (%d,%d)\n",action_name.c_str(), x_velocity, y_velocity);
             // Get the parent
-            map<long,Blob>& old_blobs = blob_hist[blob_hist.size() - blob_history_len];
-            long parent_id = b->parent_id;
-            assert(old_blobs.find(parent_id) != old_blobs.end());
-            b = &old_blobs[parent_id];
+            const BlobRecord* old_blob = history.find_blob(age, parent);
+            assert(old_blob != NULL);
+            x_velocity = old_blob->x_velocity;
+            y_velocity = old_blob->y_velocity;
+            parent = old_blob->parent_id;
         }
         printf("\n");
     }  
@@ -1236,6 +1578,27 @@ bool VisualProcessor::saveSelection() {
     return true;
 }
 
+void VisualProcessor::loadPrototypeImages(boost::filesystem::path p, Prototype& self,
+                                          vector<Prototype>& obj_classes) {
+    // Load up saved self images
+    p /= SELF_IMAGE_DIR;
+    loadPrototype(p, SELF_IMAGE_PREFIX, SELF_IMAGE_SUFFIX, self);
+    p = p.parent_path();
+
+    // Load saved prototype images
+    for (int protoNum=1; ; protoNum++) {
+        p /= CLASS_IMAGE_DIR + boost::lexical_cast<std::string>(protoNum);
+        if (exists(p) && is_directory(p)) {
+            Prototype proto;
+            loadPrototype(p, CLASS_IMAGE_PREFIX, CLASS_IMAGE_SUFFIX, proto);
+            obj_classes.push_back(proto);
+            p = p.parent_path();
+        } else {
+            break;
+        }
+    }
+};
+
 void VisualProcessor::loadPrototype(boost::filesystem::path p, const string& prefix,
                                     const string& suffix, Prototype& proto) {
     if (exists(p) && is_directory(p)) {
@@ -1322,7 +1685,7 @@ bool VisualProcessor::handleSDLEvent(const SDL_Event& event) {
             }
             // TODO: Consolidate all of these display screen calls
             // Update the screen if an object has been found
-            if (screen_hist.size() >= 1 && focused_entity_id != -1) {
+            if (history.size() >= 1 && focused_entity_id != -1) {
                 refreshDisplay = true;
             }
         }
@@ -1363,6 +1726,14 @@ bool VisualProcessor::handleSDLEvent(const SDL_Event& event) {
                 } else {
                     manual_self.masks.push_back(composite_objs[focused_entity_id].mask);
                 }
+                build_prototype_index();
+
+                // Keep a compiled library in step with the saved images
+                boost::filesystem::path library_path(IMAGE_FILENAME);
+                library_path /= string(game_settings->rom()) + PROTOTYPE_LIBRARY_SUFFIX;
+                if (boost::filesystem::exists(library_path) &&
+                    !manual_proto_index.save_library(library_path.string()))
+                    printf("Unable to update prototype library %s\n", library_path.string().c_str());
             }
             return true;
         case SDLK_q:
@@ -1394,7 +1765,7 @@ bool VisualProcessor::handleSDLEvent(const SDL_Event& event) {
                 break;
             if (focus_level == 0) {
                 if (curr_blobs.find(focused_entity_id) != curr_blobs.end())
-                    curr_blobs[focused_entity_id].to_string(true,&blob_hist);
+                    curr_blobs[focused_entity_id].to_string(true,&history);
             } else if (focus_level == 1) {
                 if (composite_objs.find(focused_entity_id) != composite_objs.end())
                     composite_objs[focused_entity_id].to_string(true);
@@ -1432,6 +1803,7 @@ bool VisualProcessor::handleSDLEvent(const SDL_Event& event) {
             printf("Creating and selecting new Prototype. Press \"s\" to save masks.\n");
             manual_obj_classes.push_back(Prototype());
             proto_indx = manual_obj_classes.size()-1;
+            build_prototype_index();
             focus_level = 1;
             return true;
         default: // switch(sdl.keydown)
@@ -1443,7 +1815,8 @@ bool VisualProcessor::handleSDLEvent(const SDL_Event& event) {
     }
 
     if (refreshDisplay) {
-        IntMatrix screen_cpy(screen_hist.back());
+        IntMatrix screen_cpy;
+        history.get_screen(0, screen_cpy);
         display_screen(screen_cpy, screen_width, screen_height);
         p_osystem->p_display_screen->display_screen(screen_cpy, screen_cpy[0].size(),screen_cpy.size());
                                                     
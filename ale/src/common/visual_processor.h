@@ -61,6 +61,19 @@ static int count_ones(unsigned char x) {
     return results;
 };
 
+// Counts the number of 1 bits in a 64 bit word. Compiles to a single popcnt
+// instruction where the target has one.
+static inline int count_ones64(unsigned long long x) {
+#ifdef __GNUC__
+    return __builtin_popcountll(x);
+#else
+    int results = 0;
+    for (; x; x &= x-1)
+        results++;
+    return results;
+#endif
+};
+
 struct point {
     int x, y;
 
@@ -127,6 +140,8 @@ struct PixelMask {
     void to_string();
 };
 
+class VisualHistory;
+
 /*|------------ The blob is a region of contiguous color found in the game screen ------------|*/
 struct Blob {
     long id;                        // Used for the comparator function. Should be unique.
@@ -162,13 +177,69 @@ struct Blob {
     long find_matching_blob(map<long,Blob>& blobs);
 
     // Prints the blob and its velocity history
-    void to_string(bool verbose=false, deque<map<long,Blob> >* blob_hist=NULL);
+    void to_string(bool verbose=false, const VisualHistory* history=NULL);
 
     bool operator< (const Blob& other) const {
         return id < other.id;
     };
 };
 
+/*|------------ The part of a blob that is kept in the visual history ------------|*/
+struct BlobRecord {
+    long id, parent_id;
+    int color;
+    int x_min, x_max, y_min, y_max;
+    int x_velocity, y_velocity;
+    int size;                       // Number of pixels in the blob
+
+    BlobRecord() {};
+    BlobRecord(const Blob& b);
+
+    bool operator< (const BlobRecord& other) const {
+        return id < other.id;
+    };
+};
+
+/*|------------ Ring buffer of the last screens, actions and blobs ------------|*/
+// All of the storage is allocated up front by set_max_len, so adding a frame
+// does not allocate once the blob record lists have grown to the number of
+// blobs on the screen. A length of 0 keeps nothing.
+class VisualHistory {
+public:
+    VisualHistory();
+
+    // Drops all frames and makes room for max_len frames of the given size
+    void set_max_len(int max_len, int screen_width, int screen_height);
+
+    // Adds a frame, replacing the oldest one once the history is full
+    void add_frame(const IntMatrix& screen, Action action, const map<long,Blob>& blobs);
+
+    void clear() { num_frames = 0; };
+
+    int size() const { return num_frames; };
+    int max_len() const { return history_len; };
+
+    // Frames are accessed by age: 0 is the last frame added, size()-1 the oldest
+    void get_screen(int age, IntMatrix& screen) const;
+    Action get_action(int age) const { return actions[slot(age)]; };
+    const vector<BlobRecord>& get_blobs(int age) const { return blobs[slot(age)]; };
+
+    // Returns the record of the blob with the given id, or NULL if that frame has no such blob
+    const BlobRecord* find_blob(int age, long id) const;
+
+protected:
+    int slot(int age) const {
+        assert(age >= 0 && age < num_frames);
+        return (newest - age + history_len) % history_len;
+    };
+
+    int history_len, num_frames, newest;
+    int screen_width, screen_height;
+    vector<uInt8>               screens; // history_len screens of one byte per pixel
+    vector<Action>              actions;
+    vector<vector<BlobRecord> > blobs;   // Sorted by blob id
+};
+
 /*|------------ A composite object is an object composed of blobs ------------|*/
 struct CompositeObject {
     long id;                        // Unique identifier
@@ -232,6 +303,101 @@ struct Prototype {
 };
 
 
+#define PROTOTYPE_LIBRARY_MAGIC (0x42494C50)
+#define PROTOTYPE_LIBRARY_VERSION (1)
+#define PROTOTYPE_LIBRARY_SUFFIX ".protolib"
+
+/*|------------ Index of prototype masks for classifying objects ------------|*/
+// Masks are grouped by width and height and stored as 64 bit words, so an
+// object is only compared against the masks of its own size and every
+// comparison is a popcount over a few words.
+//
+// The index lives in one flat image: a Header followed by the ProtoEntry,
+// MaskEntry and Bucket tables, the mask numbers of each bucket and the mask
+// words, every table starting on an 8 byte boundary. A prototype library
+// file (images/<rom>.protolib, written by ale_protolib) is that image in the
+// byte order of the machine that wrote it, so it is used straight from a
+// read-only mapping that all processes on a machine share.
+class PrototypeIndex {
+public:
+    struct Header {
+        uInt32 magic;    // PROTOTYPE_LIBRARY_MAGIC
+        uInt32 version;  // PROTOTYPE_LIBRARY_VERSION
+        Int32 num_protos, num_masks, num_buckets, num_words;
+    };
+
+    struct ProtoEntry {
+        Int32 first_mask, num_masks; // The masks of a prototype are numbered consecutively
+    };
+
+    struct MaskEntry {
+        Int32 proto;
+        Int32 width, height;
+        Int32 size;       // Active pixels of the mask
+        Int32 num_bytes;  // Length of the PixelMask, masks of other lengths never overlap
+        Int32 first_word; // Offset of the mask in the words
+    };
+
+    struct Bucket {
+        Int32 width, height;
+        Int32 first_entry, num_entries; // Range of the bucket's mask numbers
+    };
+
+    PrototypeIndex();
+    ~PrototypeIndex();
+
+    // Indexes the masks of the given prototypes in memory. The prototypes must
+    // stay where they are until the next build or attach.
+    void build(const vector<Prototype*>& prototypes);
+
+    // Maps a prototype library read-only and uses it as the index. Returns
+    // false, leaving the index empty, if the file is missing or not valid.
+    bool map_library(const string& filename);
+
+    // Writes the index as a prototype library. The file is replaced in one
+    // rename so running processes never see half of it. Returns false on error.
+    bool save_library(const string& filename) const;
+
+    // Number of prototypes in the index, the first one is the self
+    int get_num_protos() const { return header ? header->num_protos : 0; };
+
+    // Binds prototype i of the index to prototypes[i] and gives it copies of its masks
+    void attach_prototypes(const vector<Prototype*>& prototypes);
+
+    // Same result as calling Prototype::find_matching_objects on every indexed prototype
+    void find_matching_objects(float similarity_threshold, map<long,CompositeObject>& obj_map);
+
+protected:
+    // Points the tables into a complete image. Returns false if it is not valid.
+    bool set_image(const char* image, size_t image_size);
+
+    // Frees the image and the mapping
+    void clear();
+
+    static size_t align(size_t offset) { return (offset + 7) & ~size_t(7); };
+    static int get_num_words(int num_bytes) { return (num_bytes + 7) / 8; };
+
+    const Header*             header;
+    const ProtoEntry*         proto_entries;
+    const MaskEntry*          mask_entries;
+    const Bucket*             buckets;
+    const Int32*              bucket_masks;
+    const unsigned long long* words;
+    size_t                    image_size;
+
+    vector<unsigned long long> owned_image; // Image made by build
+    void* mapping;                          // Image mapped by map_library
+    size_t mapping_size;
+
+    vector<Prototype*> indexed_protos;
+    vector<unsigned long long> obj_words; // Packed mask of the object being classified
+
+private:
+    // This class cannot be copied, it may own a mapping
+    PrototypeIndex(const PrototypeIndex& other);
+    PrototypeIndex& operator=(const PrototypeIndex& other);
+};
+
 class VisualProcessor { //: public SDLEventHandler {
 public:
     VisualProcessor(OSystem* _osystem, string myRomFile);
@@ -243,6 +409,9 @@ public:
     // return the results.
     void process_image(const IntMatrix* screen_matrix, Action a);
 
+    // Sets how many past frames are kept in the history
+    void set_history_len(int len);
+
     // Blob Detection
     void find_connected_components(const IntMatrix& screen_matrix, map<long,Blob>& blobs);
 
@@ -272,6 +441,12 @@ public:
     // Returns true if a self object has been located.
     bool found_self();
 
+    // The manual self followed by the manual object classes
+    vector<Prototype*> get_manual_prototypes();
+
+    // Rebuilds the index of the manual prototypes after their masks change
+    void build_prototype_index();
+
     // Methods for the SDLEventHandler class
     bool handleSDLEvent(const SDL_Event& event);
     void display_screen(IntMatrix& screen_matrix, int screen_width, int screen_height);
@@ -290,8 +465,11 @@ public:
     // Saves an image of the currently selected object. Returns true if successful, false otherwise.
     bool saveSelection();
     // Loads masks of images. Assumes files have format prefix + image_num + suffix.
-    void loadPrototype(boost::filesystem::path p, const string& prefix, const string& suffix,
-                       Prototype& proto);
+    static void loadPrototype(boost::filesystem::path p, const string& prefix, const string& suffix,
+                              Prototype& proto);
+    // Loads the self and object class images of a rom from images/<rom>
+    static void loadPrototypeImages(boost::filesystem::path rom_dir, Prototype& self,
+                                    vector<Prototype>& obj_classes);
     
 public:
     OSystem* p_osystem;
@@ -300,15 +478,14 @@ public:
     IntMatrix screen_matrix;
 
     // History of past screens, actions, and blobs
-    int max_history_len;
-    deque<IntMatrix>        screen_hist;
-    deque<Action>           action_hist;
-    deque<map<long,Blob> >  blob_hist;
+    VisualHistory history;
+    long frames_processed; // Frames seen since the processor was created
 
     // Used to generate new IDs
     long blob_ids, obj_ids, proto_ids;
 
     map<long,Blob>            curr_blobs;      // Map of blob ids to blobs for the current frame
+    map<long,Blob>            prev_blobs;      // Blobs of the last frame, which the current ones are matched to
     map<long,CompositeObject> composite_objs;  // Map of obj ids to objs for the current frame
     vector<Prototype>         obj_classes;     // Classes of objects
 
@@ -317,6 +494,7 @@ public:
     // Prototypes which are manually identified. These are loaded up from saved files of the game
     Prototype manual_self;
     vector<Prototype> manual_obj_classes;
+    PrototypeIndex manual_proto_index;
 
     // Graphical display variables
     long focused_entity_id; // The focused object is selected by a click
@@ -289,6 +289,9 @@ void Settings::usage() {
     << " *  -max_num_frames_per_episode m"                                                  << endl
     << " *  Ends each episode after this number of frames. 0 (default) means never."       << endl
 << endl                                                                                 
+    << " *  -vis_history_len n"                                                            << endl
+    << " *  Number of past frames visual processing keeps for inspection. Default is 50."  << endl
+<< endl
     << " *  -ld [A/B]"                                                                      << endl
     << " *   Left player difficulty. B (default) means easy"                                << endl
 << endl
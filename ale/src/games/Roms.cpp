@@ -158,3 +158,15 @@ RomSettings *buildRomRLWrapper(const std::string &rom) {
     return NULL;
 }
 
+
+/* returns the rom titles of every supported game */
+std::vector<std::string> getSupportedRoms() {
+
+    std::vector<std::string> names;
+    for (size_t i=0; i < sizeof(roms)/sizeof(roms[0]); i++) {
+        names.push_back(roms[i]->rom());
+    }
+
+    return names;
+}
+
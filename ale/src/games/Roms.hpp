@@ -13,6 +13,7 @@
 #define __ROMS_HPP__
 
 #include <string>
+#include <vector>
 
 class RomSettings;
 
@@ -20,6 +21,9 @@ class RomSettings;
 // looks for the RL wrapper corresponding to a particular rom title 
 extern RomSettings *buildRomRLWrapper(const std::string &rom);
 
+// returns the rom titles of every supported game
+extern std::vector<std::string> getSupportedRoms();
+
 
 #endif // __ROMS_HPP__
 
@@ -0,0 +1,87 @@
+/* *****************************************************************************
+ * A.L.E (Arcade Learning Environment)
+ * Copyright (c) 2009-2012 by Yavar Naddaf, Joel Veness, Marc G. Bellemare and
+ *   the Reinforcement Learning and Artificial Intelligence Laboratory
+ * Released under the GNU General Public License; see License.txt for details.
+ *
+ * Based on: Stella  --  "An Atari 2600 VCS Emulator"
+ * Copyright (c) 1995-2007 by Bradford W. Mott and the Stella team
+ *
+ * *****************************************************************************
+ *  ale_protolib.cpp
+ *
+ *  Compiles the self and object class images of every rom in an images
+ *  directory (images/<rom>/self, images/<rom>/class<N>) into one prototype
+ *  library per rom, images/<rom>.protolib. The visual processor maps the
+ *  library instead of reading the images one by one. Rerun it after adding
+ *  images by hand; masks saved from the interactive display update an
+ *  existing library themselves.
+ **************************************************************************** */
+#include <cstdio>
+#include <iostream>
+#include <boost/filesystem.hpp>
+
+#include "../common/visual_processor.h"
+
+static void usage() {
+    cerr << "Usage: ale_protolib [-images_dir dir] [-roms rom1,rom2,...]" << endl
+         << "  -images_dir  Directory with one image directory per rom (default images)" << endl
+         << "  -roms        Only compile these roms" << endl;
+}
+
+/* Compiles the images of one rom. Returns false if the library could not be written. */
+static bool compileRom(const boost::filesystem::path& images_dir, const string& rom) {
+    Prototype self;
+    vector<Prototype> obj_classes;
+    VisualProcessor::loadPrototypeImages(images_dir / rom, self, obj_classes);
+
+    vector<Prototype*> prototypes;
+    prototypes.push_back(&self);
+    int num_masks = self.masks.size();
+    for (size_t i = 0; i < obj_classes.size(); i++) {
+        prototypes.push_back(&obj_classes[i]);
+        num_masks += obj_classes[i].masks.size();
+    }
+
+    PrototypeIndex index;
+    index.build(prototypes);
+
+    boost::filesystem::path library_path = images_dir / (rom + PROTOTYPE_LIBRARY_SUFFIX);
+    if (!index.save_library(library_path.string())) {
+        cerr << "Unable to write " << library_path.string() << endl;
+        return false;
+    }
+    printf("%s: %d object classes, %d masks\n", library_path.string().c_str(),
+           int(obj_classes.size()), num_masks);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    string images_dir = "images";
+    string rom_filter;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (i + 1 >= argc) { usage(); return 2; }
+        string value = argv[++i];
+        if (arg == "-images_dir") images_dir = value;
+        else if (arg == "-roms")  rom_filter = "," + value + ",";
+        else { usage(); return 2; }
+    }
+
+    using namespace boost::filesystem;
+    path dir(images_dir);
+    if (!exists(dir) || !is_directory(dir)) {
+        cerr << "No images directory " << images_dir << endl;
+        return 1;
+    }
+
+    int failures = 0;
+    for (directory_iterator it(dir); it != directory_iterator(); ++it) {
+        if (!is_directory(it->status())) continue;
+        string rom = it->path().filename().string();
+        if (!rom_filter.empty() && rom_filter.find("," + rom + ",") == string::npos) continue;
+        if (!compileRom(dir, rom)) failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}